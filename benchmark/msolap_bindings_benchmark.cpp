@@ -0,0 +1,190 @@
+// Benchmark of the native OLE DB column bindings against the VARIANT bindings they replaced, on a mock rowset.
+// Every row of the mock has an I4, an I8, an R8 and a WSTR column, with some NULLs. The mock fills a row buffer
+// laid out like the accessor of MSOLAPOLEDBRowset (status, length and value of every column), either with the
+// native DBTYPEs or with a VARIANT per column, and both are decoded by MSOLAPBindings::WriteRow, the code the
+// rowset runs on Windows. The VARIANT path boxes every cell into a Value and converts strings like
+// WindowsUtil::UnicodeToUTF8, as the rowset did before. Both run on any platform, only the provider is mocked:
+//
+//   make benchmarks
+//   build/release/extension/msolap/msolap_bindings_benchmark
+
+#include "msolap_bindings.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace duckdb;
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr idx_t CHUNK_COUNT = 2000;
+static constexpr idx_t COLUMN_COUNT = 4;
+
+static const std::vector<LogicalType> TYPES = {LogicalType::INTEGER, LogicalType::BIGINT, LogicalType::DOUBLE,
+                                               LogicalType::VARCHAR};
+static const std::vector<std::string> COLUMN_NAMES = {"[I4]", "[I8]", "[R8]", "[WSTR]"};
+
+static const char *const NAMES[] = {"Bikes", "Components", "Clothing", "Accessories", "Mountain-200 Black, 38"};
+
+// Rows generated by the mock, the same for both bindings
+class MockRowset {
+public:
+    explicit MockRowset(bool variant) : variant(variant) {
+        for (auto name : NAMES) {
+            std::vector<uint16_t> text;
+            for (auto c = name; *c; c++) {
+                text.push_back((uint16_t)*c);
+            }
+            text.push_back(0);
+            strings.push_back(std::move(text));
+        }
+        // Row buffer: status, length and value of every column, 8 byte aligned
+        static const uint16_t NATIVE_TYPES[] = {MSOLAPBindings::TYPE_I4, MSOLAPBindings::TYPE_I8,
+                                                MSOLAPBindings::TYPE_R8,
+                                                MSOLAPBindings::TYPE_WSTR | MSOLAPBindings::TYPE_BYREF};
+        idx_t offset = 0;
+        for (idx_t i = 0; i < COLUMN_COUNT; i++) {
+            MSOLAPColumnBinding binding;
+            binding.status_offset = offset;
+            binding.length_offset = offset + 8;
+            binding.value_offset = offset + 16;
+            binding.type = variant ? MSOLAPBindings::TYPE_VARIANT : NATIVE_TYPES[i];
+            bindings.push_back(binding);
+            offset += 16 + (variant ? sizeof(MSOLAPBindings::DBVariant) : 8);
+        }
+        row_data.resize(offset);
+    }
+
+    bool IsNull(idx_t row, idx_t column) const {
+        return (row + column) % 17 == 0;
+    }
+
+    // Fill the row buffer, like IRowset::GetData
+    void GetData(idx_t row) {
+        for (idx_t column = 0; column < COLUMN_COUNT; column++) {
+            auto &binding = bindings[column];
+            auto status = IsNull(row, column) ? MSOLAPBindings::STATUS_ISNULL : MSOLAPBindings::STATUS_OK;
+            memcpy(&row_data[binding.status_offset], &status, sizeof(status));
+            if (status != MSOLAPBindings::STATUS_OK) {
+                continue;
+            }
+            if (variant) {
+                GetVariant(row, column, binding);
+            } else {
+                GetNative(row, column, binding);
+            }
+        }
+    }
+
+    std::vector<MSOLAPColumnBinding> bindings;
+    std::vector<uint8_t> row_data;
+
+private:
+    void GetNative(idx_t row, idx_t column, const MSOLAPColumnBinding &binding) {
+        auto value = &row_data[binding.value_offset];
+        switch (column) {
+        case 0: {
+            auto result = int32_t(row);
+            memcpy(value, &result, sizeof(result));
+            break;
+        }
+        case 1: {
+            auto result = int64_t(row) * 1000003;
+            memcpy(value, &result, sizeof(result));
+            break;
+        }
+        case 2: {
+            auto result = double(row) * 0.25;
+            memcpy(value, &result, sizeof(result));
+            break;
+        }
+        default: {
+            // By reference, the length part is in bytes
+            auto &text = strings[row % strings.size()];
+            auto data = text.data();
+            size_t length = (text.size() - 1) * sizeof(uint16_t);
+            memcpy(value, &data, sizeof(data));
+            memcpy(&row_data[binding.length_offset], &length, sizeof(length));
+            break;
+        }
+        }
+    }
+
+    void GetVariant(idx_t row, idx_t column, const MSOLAPColumnBinding &binding) {
+        MSOLAPBindings::DBVariant result;
+        memset(&result, 0, sizeof(result));
+        switch (column) {
+        case 0:
+            result.vt = MSOLAPBindings::TYPE_I4;
+            result.lVal = int32_t(row);
+            break;
+        case 1:
+            result.vt = MSOLAPBindings::TYPE_I8;
+            result.llVal = int64_t(row) * 1000003;
+            break;
+        case 2:
+            result.vt = MSOLAPBindings::TYPE_R8;
+            result.dblVal = double(row) * 0.25;
+            break;
+        default:
+            result.vt = MSOLAPBindings::TYPE_BSTR;
+            result.bstrVal = strings[row % strings.size()].data();
+            break;
+        }
+        memcpy(&row_data[binding.value_offset], &result, sizeof(result));
+    }
+
+    bool variant;
+    std::vector<std::vector<uint16_t>> strings;
+};
+
+static void Fetch(MockRowset &rowset, idx_t first_row, DataChunk &output) {
+    for (idx_t row = 0; row < STANDARD_VECTOR_SIZE; row++) {
+        rowset.GetData(first_row + row);
+        MSOLAPBindings::WriteRow(rowset.bindings, rowset.row_data.data(), COLUMN_NAMES, output, row);
+    }
+    output.SetCardinality(STANDARD_VECTOR_SIZE);
+}
+
+// Scan all chunks of the mock, returns the elapsed seconds
+static double Scan(bool variant) {
+    MockRowset rowset(variant);
+    DataChunk output;
+    output.Initialize(Allocator::DefaultAllocator(), TYPES);
+    auto start = Clock::now();
+    for (idx_t chunk = 0; chunk < CHUNK_COUNT; chunk++) {
+        output.Reset();
+        Fetch(rowset, chunk * STANDARD_VECTOR_SIZE, output);
+    }
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int main() {
+    // Both bindings produce the same chunk
+    MockRowset variant_rowset(true), native_rowset(false);
+    DataChunk variant_chunk, native_chunk;
+    variant_chunk.Initialize(Allocator::DefaultAllocator(), TYPES);
+    native_chunk.Initialize(Allocator::DefaultAllocator(), TYPES);
+    Fetch(variant_rowset, 12345, variant_chunk);
+    Fetch(native_rowset, 12345, native_chunk);
+    for (idx_t row = 0; row < STANDARD_VECTOR_SIZE; row++) {
+        for (idx_t column = 0; column < COLUMN_COUNT; column++) {
+            if (!Value::NotDistinctFrom(variant_chunk.GetValue(column, row), native_chunk.GetValue(column, row))) {
+                printf("Results differ in row %llu, column %llu\n", (unsigned long long)row,
+                       (unsigned long long)column);
+                return 1;
+            }
+        }
+    }
+
+    auto rows = double(CHUNK_COUNT * STANDARD_VECTOR_SIZE);
+    auto variant = Scan(true);
+    auto native = Scan(false);
+    printf("%.0f rows of %llu columns\n", rows, (unsigned long long)COLUMN_COUNT);
+    printf("VARIANT bindings: %8.1f ms, %6.1f M rows/s\n", variant * 1000, rows / variant / 1e6);
+    printf("native bindings:  %8.1f ms, %6.1f M rows/s, %.1fx\n", native * 1000, rows / native / 1e6,
+           variant / native);
+    return 0;
+}
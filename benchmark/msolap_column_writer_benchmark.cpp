@@ -0,0 +1,125 @@
+// Benchmark of the column writer against the per-cell Values MSOLAPScan used to build, on a synthetic row source.
+// Every row has an INTEGER, a DECIMAL(18,4), a DATE, a TIMESTAMP and a VARCHAR cell in the lexical form XMLA
+// sends, some of them NULL. The Value path collects the cells of a chunk as std::vector<std::vector<Value>>,
+// casts every cell and copies it with Vector::SetValue. The writer path parses every cell straight into the
+// vectors:
+//
+//   make benchmarks
+//   build/release/extension/msolap/msolap_column_writer_benchmark
+
+#include "msolap_column_writer.hpp"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace duckdb;
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr idx_t CHUNK_COUNT = 500;
+static constexpr idx_t ROW_COUNT = 1000;
+
+static const std::vector<LogicalType> TYPES = {LogicalType::INTEGER, LogicalType::DECIMAL(18, 4), LogicalType::DATE,
+                                               LogicalType::TIMESTAMP, LogicalType::VARCHAR};
+
+// Lexical forms of ROW_COUNT rows, the cells of a chunk repeat them. An empty string is a NULL.
+static std::vector<std::vector<std::string>> GenerateRows() {
+    static const char *const NAMES[] = {"Bikes", "Components", "Clothing", "Accessories", "Mountain-200 Black, 38"};
+    std::vector<std::vector<std::string>> rows;
+    for (idx_t row = 0; row < ROW_COUNT; row++) {
+        auto day = std::to_string(1 + row % 28);
+        if (day.size() == 1) {
+            day = "0" + day;
+        }
+        std::vector<std::string> cells;
+        cells.push_back(std::to_string(row));
+        cells.push_back(row % 17 == 0 ? "" : std::to_string(row * 37) + "." + std::to_string(1000 + row % 10000));
+        cells.push_back("2024-03-" + day);
+        cells.push_back("2024-03-" + day + "T12:34:56");
+        cells.push_back(NAMES[row % 5]);
+        rows.push_back(std::move(cells));
+    }
+    return rows;
+}
+
+static void ScanValues(const std::vector<std::vector<std::string>> &rows, DataChunk &output) {
+    std::vector<std::vector<Value>> values;
+    for (idx_t row = 0; row < STANDARD_VECTOR_SIZE; row++) {
+        auto &cells = rows[row % rows.size()];
+        std::vector<Value> row_values;
+        for (idx_t column = 0; column < TYPES.size(); column++) {
+            row_values.push_back(cells[column].empty() ? Value(TYPES[column])
+                                                       : Value(cells[column]).DefaultCastAs(TYPES[column]));
+        }
+        values.push_back(std::move(row_values));
+    }
+    for (idx_t row = 0; row < values.size(); row++) {
+        for (idx_t column = 0; column < TYPES.size(); column++) {
+            output.data[column].SetValue(row, values[row][column]);
+        }
+    }
+    output.SetCardinality(values.size());
+}
+
+static void ScanWriters(const std::vector<std::vector<std::string>> &rows,
+                        const std::vector<MSOLAPColumnWriter> &writers, DataChunk &output) {
+    for (idx_t row = 0; row < STANDARD_VECTOR_SIZE; row++) {
+        auto &cells = rows[row % rows.size()];
+        for (idx_t column = 0; column < writers.size(); column++) {
+            auto &cell = cells[column];
+            if (cell.empty()) {
+                MSOLAPColumnWriter::WriteNull(output.data[column], row);
+            } else {
+                writers[column].WriteText(output.data[column], row, cell.data(), cell.size());
+            }
+        }
+    }
+    output.SetCardinality(STANDARD_VECTOR_SIZE);
+}
+
+// Scan all chunks, returns the elapsed seconds
+template <class SCAN>
+static double Scan(SCAN scan) {
+    DataChunk output;
+    output.Initialize(Allocator::DefaultAllocator(), TYPES);
+    auto start = Clock::now();
+    for (idx_t chunk = 0; chunk < CHUNK_COUNT; chunk++) {
+        output.Reset();
+        scan(output);
+    }
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int main() {
+    auto rows = GenerateRows();
+    std::vector<MSOLAPColumnWriter> writers;
+    for (auto &type : TYPES) {
+        writers.emplace_back(type);
+    }
+
+    // Both paths produce the same chunk
+    DataChunk value_chunk, writer_chunk;
+    value_chunk.Initialize(Allocator::DefaultAllocator(), TYPES);
+    writer_chunk.Initialize(Allocator::DefaultAllocator(), TYPES);
+    ScanValues(rows, value_chunk);
+    ScanWriters(rows, writers, writer_chunk);
+    for (idx_t row = 0; row < STANDARD_VECTOR_SIZE; row++) {
+        for (idx_t column = 0; column < TYPES.size(); column++) {
+            if (!Value::NotDistinctFrom(value_chunk.GetValue(column, row), writer_chunk.GetValue(column, row))) {
+                printf("Results differ in row %llu, column %llu\n", (unsigned long long)row,
+                       (unsigned long long)column);
+                return 1;
+            }
+        }
+    }
+
+    auto row_count = double(CHUNK_COUNT * STANDARD_VECTOR_SIZE);
+    auto values = Scan([&](DataChunk &output) { ScanValues(rows, output); });
+    auto direct = Scan([&](DataChunk &output) { ScanWriters(rows, writers, output); });
+    printf("%.0f rows of %llu columns\n", row_count, (unsigned long long)TYPES.size());
+    printf("per-cell Values: %8.1f ms, %6.1f M rows/s\n", values * 1000, row_count / values / 1e6);
+    printf("column writers:  %8.1f ms, %6.1f M rows/s, %.1fx\n", direct * 1000, row_count / direct / 1e6,
+           values / direct);
+    return 0;
+}
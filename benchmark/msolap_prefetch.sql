@@ -0,0 +1,20 @@
+-- Wall time of a full scan with and without reading ahead, against the stand-in server with a simulated
+-- network delay of 5 ms per response chunk of 256 rows:
+--
+--   python3 test/xmla_server.py --port 8765 --latency 5 &
+--   build/release/duckdb -unsigned < benchmark/msolap_prefetch.sql
+
+LOAD msolap;
+.timer on
+SET msolap_aggregate_pushdown = false;
+CREATE MACRO scan() AS TABLE
+    SELECT sum(hash(Sales_Color_) % 1000), sum(Sales_Amount_), count(*)
+    FROM msolap('Data Source=http://localhost:8765/xmla;Catalog=Stub', 'EVALUATE Sales');
+
+SET msolap_prefetch_chunks = 0;
+FROM scan();
+FROM scan();
+
+SET msolap_prefetch_chunks = 4;
+FROM scan();
+FROM scan();
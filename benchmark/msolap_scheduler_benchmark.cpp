@@ -0,0 +1,194 @@
+// Many concurrent scans over a fake slow row source, read through the I/O scheduler. Checks every scan gets all
+// of its rows in order, that scans stuck waiting for the server only hold up their own I/O thread, and that
+// cancelling them aborts the wait. Reports how long a small scan takes next to large ones. Runs on any platform,
+// no server needed:
+//
+//   make benchmarks
+//   build/release/extension/msolap/msolap_scheduler_benchmark
+
+#include "msolap_prefetch.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+using namespace duckdb;
+
+using Clock = std::chrono::steady_clock;
+
+static double Milliseconds(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Session whose server never answers: Fetch blocks until the query is cancelled
+class StalledSession : public MSOLAPSession {
+public:
+    unique_ptr<MSOLAPRowset> ExecuteQuery(const std::string &dax_query) override {
+        throw std::runtime_error("not used");
+    }
+    void DescribeQuery(const std::string &dax_query, std::vector<std::string> &names,
+                       std::vector<LogicalType> &types) override {
+        throw std::runtime_error("not used");
+    }
+    bool IsOpen() const override {
+        return true;
+    }
+    void Ping() override {
+    }
+    void Close() override {
+    }
+
+    void Cancel() override {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            cancelled = true;
+        }
+        changed.notify_all();
+    }
+
+    void Wait() {
+        std::unique_lock<std::mutex> guard(lock);
+        changed.wait(guard, [&]() { return cancelled; });
+        aborted = true;
+        throw std::runtime_error("The query was cancelled");
+    }
+
+    // The blocked call returned
+    bool IsAborted() {
+        std::lock_guard<std::mutex> guard(lock);
+        return aborted;
+    }
+
+private:
+    std::mutex lock;
+    std::condition_variable changed;
+    bool cancelled = false;
+    bool aborted = false;
+};
+
+// Rows 0, 1, 2, ... in chunks of 2048, with a delay per chunk like a server sending its response. A stalled
+// rowset waits for its session instead.
+class SlowRowset : public MSOLAPRowset {
+public:
+    SlowRowset(idx_t chunk_count, std::chrono::milliseconds delay, StalledSession *stalled)
+        : chunk_count(chunk_count), delay(delay), stalled(stalled), fetched(0) {
+    }
+
+    void GetColumnInfo(std::vector<std::string> &names, std::vector<LogicalType> &types) override {
+        names = {"Fake[Row]"};
+        types = {LogicalType::BIGINT};
+    }
+
+    idx_t Fetch(DataChunk &output) override {
+        if (stalled) {
+            stalled->Wait();
+        }
+        if (fetched == chunk_count) {
+            return 0;
+        }
+        std::this_thread::sleep_for(delay);
+        auto data = FlatVector::GetData<int64_t>(output.data[0]);
+        for (idx_t i = 0; i < STANDARD_VECTOR_SIZE; i++) {
+            data[i] = int64_t(fetched * STANDARD_VECTOR_SIZE + i);
+        }
+        fetched++;
+        output.SetCardinality(STANDARD_VECTOR_SIZE);
+        return STANDARD_VECTOR_SIZE;
+    }
+
+private:
+    idx_t chunk_count;
+    std::chrono::milliseconds delay;
+    StalledSession *stalled;
+    idx_t fetched;
+};
+
+struct Scan {
+    idx_t chunk_count;
+    double elapsed = 0;
+    bool correct = false;
+};
+
+// Read scans concurrently, each on its own thread like DuckDB scan threads, with some work per chunk
+static void Run(MSOLAPIOScheduler &scheduler, std::vector<Scan> &scans) {
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+    for (auto &scan : scans) {
+        threads.emplace_back([&scheduler, &scan, start]() {
+            auto open = [&scan](MSOLAPCancellation &cancellation,
+                                const std::function<void()> &retry) -> unique_ptr<MSOLAPRowset> {
+                return make_uniq<SlowRowset>(scan.chunk_count, std::chrono::milliseconds(2), nullptr);
+            };
+            MSOLAPPrefetchRowset rowset(scheduler, open, 4);
+            DataChunk chunk;
+            chunk.Initialize(Allocator::DefaultAllocator(), {LogicalType::BIGINT});
+            int64_t expected = 0;
+            bool correct = true;
+            while (rowset.Fetch(chunk) > 0) {
+                auto data = FlatVector::GetData<int64_t>(chunk.data[0]);
+                for (idx_t i = 0; i < chunk.size(); i++) {
+                    correct = correct && data[i] == expected++;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            scan.correct = correct && expected == int64_t(scan.chunk_count * STANDARD_VECTOR_SIZE);
+            scan.elapsed = Milliseconds(start);
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+int main() {
+    const idx_t io_threads = 4;
+    MSOLAPIOScheduler scheduler(io_threads);
+
+    // Two queries the server does not answer, each holding an I/O thread
+    std::vector<unique_ptr<StalledSession>> sessions;
+    std::vector<unique_ptr<MSOLAPPrefetchRowset>> stalled;
+    for (idx_t i = 0; i < 2; i++) {
+        sessions.push_back(make_uniq<StalledSession>());
+        auto session = sessions.back().get();
+        auto open = [session](MSOLAPCancellation &cancellation,
+                               const std::function<void()> &retry) -> unique_ptr<MSOLAPRowset> {
+            cancellation.SetSession(session);
+            return make_uniq<SlowRowset>(1, std::chrono::milliseconds(0), session);
+        };
+        stalled.push_back(make_uniq<MSOLAPPrefetchRowset>(scheduler, open, 4));
+    }
+
+    // 30 report queries: 2 large extracts and 28 small ones, on the remaining I/O threads
+    std::vector<Scan> scans(30);
+    for (idx_t i = 0; i < scans.size(); i++) {
+        scans[i].chunk_count = i < 2 ? 200 : 10;
+    }
+    auto start = Clock::now();
+    Run(scheduler, scans);
+    auto elapsed = Milliseconds(start);
+
+    double small_max = 0;
+    bool correct = true;
+    for (idx_t i = 0; i < scans.size(); i++) {
+        correct = correct && scans[i].correct;
+        if (i >= 2) {
+            small_max = std::max(small_max, scans[i].elapsed);
+        }
+    }
+    printf("%zu scans on %llu I/O threads, 2 of them stalled: %s\n", scans.size(), (unsigned long long)io_threads,
+           correct ? "all rows in order" : "WRONG RESULTS");
+    printf("small scans done after %.0f ms, large ones after %.0f ms\n", small_max, elapsed);
+
+    // The scans give up on the stalled queries, which aborts the calls waiting for the server
+    auto cancel_start = Clock::now();
+    stalled.clear();
+    bool aborted = false;
+    while (!aborted && Milliseconds(cancel_start) < 1000) {
+        aborted = sessions[0]->IsAborted() && sessions[1]->IsAborted();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    printf("stalled queries %s after %.0f ms\n", aborted ? "cancelled" : "NOT CANCELLED", Milliseconds(cancel_start));
+    return correct && aborted ? 0 : 1;
+}
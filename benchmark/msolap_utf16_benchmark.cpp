@@ -0,0 +1,155 @@
+// Microbenchmark of the UTF-16 to UTF-8 transcoder against the per code point conversion it replaced.
+// Runs anywhere:
+//
+//   make benchmarks
+//   build/release/extension/msolap/msolap_utf16_benchmark
+
+#include "msolap_utf16.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace duckdb;
+
+// Previous conversion: append every code point to a std::string, then copy it into the vector
+static void AppendUTF8(uint32_t code_point, std::string &target) {
+    if (code_point < 0x80) {
+        target += (char)code_point;
+    } else if (code_point < 0x800) {
+        target += (char)(0xC0 | (code_point >> 6));
+        target += (char)(0x80 | (code_point & 0x3F));
+    } else if (code_point < 0x10000) {
+        target += (char)(0xE0 | (code_point >> 12));
+        target += (char)(0x80 | ((code_point >> 6) & 0x3F));
+        target += (char)(0x80 | (code_point & 0x3F));
+    } else {
+        target += (char)(0xF0 | (code_point >> 18));
+        target += (char)(0x80 | ((code_point >> 12) & 0x3F));
+        target += (char)(0x80 | ((code_point >> 6) & 0x3F));
+        target += (char)(0x80 | (code_point & 0x3F));
+    }
+}
+
+static void AppendUTF16Scalar(const uint8_t *data, idx_t length, std::string &target) {
+    for (idx_t i = 0; i < length; i++) {
+        uint32_t unit = data[2 * i] | (data[2 * i + 1] << 8);
+        if (unit < 0x80) {
+            target += (char)unit;
+        } else if (unit < 0xD800 || unit > 0xDFFF) {
+            AppendUTF8(unit, target);
+        } else if (unit <= 0xDBFF && i + 1 < length) {
+            uint32_t low = data[2 * i + 2] | (data[2 * i + 3] << 8);
+            if (low >= 0xDC00 && low <= 0xDFFF) {
+                AppendUTF8(0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00), target);
+                i++;
+            } else {
+                AppendUTF8(0xFFFD, target);
+            }
+        } else {
+            AppendUTF8(0xFFFD, target);
+        }
+    }
+}
+
+// Cells of random length (1-40 code units), non_ascii of them containing accented, CJK and astral characters
+static std::vector<std::vector<uint8_t>> GenerateCells(idx_t count, double non_ascii) {
+    static const uint16_t OTHER_UNITS[] = {0x00E9, 0x00FC, 0x4E2D, 0x6587, 0xD83D, 0xDE00};
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> lengths(1, 40);
+    std::uniform_int_distribution<int> letters('a', 'z');
+    std::uniform_real_distribution<double> fraction(0, 1);
+    std::vector<std::vector<uint8_t>> cells(count);
+    for (auto &cell : cells) {
+        std::vector<uint16_t> units;
+        auto length = lengths(random);
+        bool mixed = fraction(random) < non_ascii;
+        for (int i = 0; i < length; i++) {
+            if (mixed && i % 5 == 4) {
+                auto index = random() % 5;
+                units.push_back(OTHER_UNITS[index]);
+                if (OTHER_UNITS[index] == 0xD83D) {
+                    units.push_back(0xDE00);
+                }
+            } else {
+                units.push_back((uint16_t)letters(random));
+            }
+        }
+        for (auto unit : units) {
+            cell.push_back(unit & 0xFF);
+            cell.push_back(unit >> 8);
+        }
+    }
+    return cells;
+}
+
+template <class FUNC>
+static double Measure(FUNC &&convert, idx_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (idx_t i = 0; i < iterations; i++) {
+        convert();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / double(iterations);
+}
+
+static void Run(const char *name, double non_ascii) {
+    static constexpr idx_t CELLS = 1000000;
+    static constexpr idx_t ITERATIONS = 5;
+    auto cells = GenerateCells(CELLS, non_ascii);
+    idx_t units = 0;
+    for (auto &cell : cells) {
+        units += cell.size() / 2;
+    }
+
+    // The output stands in for the string heap of a vector
+    std::vector<char> heap(units * 3);
+    std::string buffer;
+    idx_t checksum = 0;
+    auto scalar = Measure(
+        [&]() {
+            auto out = heap.data();
+            for (auto &cell : cells) {
+                buffer.clear();
+                AppendUTF16Scalar(cell.data(), cell.size() / 2, buffer);
+                memcpy(out, buffer.data(), buffer.size());
+                out += buffer.size();
+            }
+            checksum += out - heap.data();
+        },
+        ITERATIONS);
+    auto transcoded = Measure(
+        [&]() {
+            auto out = heap.data();
+            for (auto &cell : cells) {
+                auto length = MSOLAPUTF16::GetUTF8Length(cell.data(), cell.size() / 2);
+                out += MSOLAPUTF16::ToUTF8(cell.data(), cell.size() / 2, out);
+                checksum += length;
+            }
+        },
+        ITERATIONS);
+
+    // Both conversions must agree
+    for (auto &cell : cells) {
+        buffer.clear();
+        AppendUTF16Scalar(cell.data(), cell.size() / 2, buffer);
+        std::string result(MSOLAPUTF16::GetUTF8Length(cell.data(), cell.size() / 2), '\0');
+        MSOLAPUTF16::ToUTF8(cell.data(), cell.size() / 2, &result[0]);
+        if (result != buffer) {
+            fprintf(stderr, "%s: conversions differ\n", name);
+            exit(1);
+        }
+    }
+
+    printf("%-10s %8.1f ms %8.1f M units/s (per code point) %8.1f ms %8.1f M units/s (transcoder) %5.2fx [%llu]\n",
+           name, scalar * 1000, double(units) / scalar / 1e6, transcoded * 1000, double(units) / transcoded / 1e6,
+           scalar / transcoded, (unsigned long long)checksum);
+}
+
+int main() {
+    Run("ascii", 0);
+    Run("mixed", 0.2);
+    Run("non-ascii", 1);
+    return 0;
+}
@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_batch.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "msolap_session.hpp"
+#include "msolap_pool.hpp"
+#include "msolap_dax.hpp"
+
+namespace duckdb {
+
+struct MSOLAPBatchBindData : public TableFunctionData {
+    std::string connection_string;
+    // The query with the @Name references of its table expression replaced by the columns of the DATATABLE of
+    // parameter values it is evaluated for, and the DATATABLE column declarations ("@Name", INTEGER, ...)
+    MSOLAPDaxQuery query;
+    std::string parameter_columns;
+    // Input columns holding the parameter values
+    std::vector<LogicalType> parameter_types;
+    // Columns of the table expression, as reported by the server, and their types
+    std::vector<std::string> dax_names;
+    std::vector<LogicalType> types;
+};
+
+struct MSOLAPBatchLocalState : public LocalTableFunctionState {
+    // Session the batches of the thread are evaluated on, taken when the first batch is sent
+    MSOLAPPooledSession session;
+    // Result of the batch sent last, null while a batch is collected
+    unique_ptr<MSOLAPRowset> rowset;
+    // Parameter rows of the batch being collected, as DATATABLE rows
+    std::string rows;
+    idx_t row_count;
+    // Rows of the current input chunk already added to a batch
+    idx_t input_offset;
+    idx_t batch_size;
+    // Columns of the result with the types the server reports, set up when the first result is opened
+    DataChunk chunk;
+
+    MSOLAPBatchLocalState() : row_count(0), input_offset(0), batch_size(0) {}
+
+    ~MSOLAPBatchLocalState() {
+        // Release the rowset before the session it was read from goes back to the pool
+        rowset.reset();
+        session.Release();
+    }
+};
+
+// msolap_batch(connection_string, dax_query, (SELECT ...)): evaluates the query for every row of the subquery,
+// whose columns are the @Name parameters of the query. The rows are sent in batches, each evaluated by a single
+// GENERATE(DATATABLE(...), <query>), and returned with the rows of the query they produced.
+class MSOLAPBatchFunction : public TableFunction {
+public:
+    // Default of the msolap_batch_size setting
+    static constexpr idx_t DEFAULT_BATCH_SIZE = 1000;
+
+    MSOLAPBatchFunction();
+};
+
+} // namespace duckdb
@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_binary_xml.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "msolap_xml_reader.hpp"
+#include <string>
+#include <vector>
+
+namespace duckdb {
+
+// Reader for the SQL Server binary XML encoding ([MS-BINXML]) that Analysis Services uses for
+// Protocol Format=Binary responses. Names are defined once in a name table and referenced by index, values are
+// sent as typed atoms. Atoms are reported as text nodes holding their XSD lexical form, so the rowset decoder
+// is shared with the textual format.
+class MSOLAPBinaryXMLReader : public MSOLAPXMLReader {
+public:
+    explicit MSOLAPBinaryXMLReader(MSOLAPInputStream &stream);
+
+    XMLNodeType Next() override;
+
+private:
+    // Make sure at least count bytes are buffered, returns false if the stream ends first
+    bool Ensure(idx_t count);
+    uint8_t ReadByte();
+    void ReadBytes(void *target, idx_t length);
+    // Variable length unsigned integer, 7 bits per byte, least significant group first
+    uint32_t ReadMultiByte32();
+    // Length prefixed UTF-16 string, appended as UTF-8
+    void ReadTextData(std::string &target);
+
+    void ReadHeader();
+    // Process a name table token, returns false if token is not one
+    bool ReadNameDefinition(uint8_t token);
+    void ReadStartElement();
+    // Local name of a qualified name index
+    const std::string &GetQualifiedName(idx_t index) const;
+    // Decode the atom introduced by token and append its lexical form to target
+    void ReadAtom(uint8_t token, std::string &target);
+    static bool IsAtomToken(uint8_t token);
+
+    MSOLAPInputStream &stream;
+    std::unique_ptr<char[]> buffer;
+    idx_t buffer_pos;
+    idx_t buffer_end;
+    bool header_read;
+
+    // Name table, index 0 is the empty name
+    std::vector<std::string> names;
+    // Local name index of every qualified name, index 0 is unused
+    std::vector<idx_t> qualified_names;
+    // Names of the open elements, end element tokens don't repeat them
+    std::vector<std::string> element_stack;
+};
+
+} // namespace duckdb
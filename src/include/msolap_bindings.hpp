@@ -0,0 +1,141 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_bindings.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include <string>
+#include <vector>
+
+namespace duckdb {
+
+// Column of the row buffer an OLE DB accessor fills: where its status, length and value parts are and the DBTYPE
+// it is bound as. Mirrors DBBINDING without the Windows headers, so decoding the buffer runs (and is benchmarked)
+// on any platform.
+struct MSOLAPColumnBinding {
+    idx_t status_offset = 0;
+    idx_t length_offset = 0;
+    idx_t value_offset = 0;
+    uint16_t type = 0;
+};
+
+// Decodes the row buffer of MSOLAPOLEDBRowset into the output vectors. The constants and structures are those of
+// oledb.h and oleauto.h, with the same values and layouts.
+class MSOLAPBindings {
+public:
+    // DBTYPE values
+    static constexpr uint16_t TYPE_EMPTY = 0;
+    static constexpr uint16_t TYPE_NULL = 1;
+    static constexpr uint16_t TYPE_I2 = 2;
+    static constexpr uint16_t TYPE_I4 = 3;
+    static constexpr uint16_t TYPE_R4 = 4;
+    static constexpr uint16_t TYPE_R8 = 5;
+    static constexpr uint16_t TYPE_CY = 6;
+    static constexpr uint16_t TYPE_DATE = 7;
+    static constexpr uint16_t TYPE_BSTR = 8;
+    static constexpr uint16_t TYPE_BOOL = 11;
+    static constexpr uint16_t TYPE_VARIANT = 12;
+    static constexpr uint16_t TYPE_DECIMAL = 14;
+    static constexpr uint16_t TYPE_I1 = 16;
+    static constexpr uint16_t TYPE_UI1 = 17;
+    static constexpr uint16_t TYPE_UI2 = 18;
+    static constexpr uint16_t TYPE_UI4 = 19;
+    static constexpr uint16_t TYPE_I8 = 20;
+    static constexpr uint16_t TYPE_UI8 = 21;
+    static constexpr uint16_t TYPE_WSTR = 130;
+    static constexpr uint16_t TYPE_NUMERIC = 131;
+    static constexpr uint16_t TYPE_DBDATE = 133;
+    static constexpr uint16_t TYPE_DBTIMESTAMP = 135;
+    static constexpr uint16_t TYPE_BYREF = 0x4000;
+
+    // DBSTATUS values
+    static constexpr uint32_t STATUS_OK = 0;
+    static constexpr uint32_t STATUS_ISNULL = 3;
+    static constexpr uint32_t STATUS_TRUNCATED = 4;
+
+    // DECIMAL
+    struct DBDecimal {
+        uint16_t reserved;
+        uint8_t scale;
+        // 0x80 for negative values
+        uint8_t sign;
+        uint32_t hi32;
+        uint64_t lo64;
+    };
+
+    // DB_NUMERIC, val is a little endian magnitude
+    struct DBNumeric {
+        uint8_t precision;
+        uint8_t scale;
+        // 1 for positive values
+        uint8_t sign;
+        uint8_t val[16];
+    };
+
+    // DBDATE
+    struct DBDate {
+        int16_t year;
+        uint16_t month;
+        uint16_t day;
+    };
+
+    // DBTIMESTAMP, fraction in nanoseconds
+    struct DBTimestamp {
+        int16_t year;
+        uint16_t month;
+        uint16_t day;
+        uint16_t hour;
+        uint16_t minute;
+        uint16_t second;
+        uint32_t fraction;
+    };
+
+    // VARIANT, with the members the provider returns query results in
+    struct DBVariant {
+        uint16_t vt;
+        uint16_t reserved1;
+        uint16_t reserved2;
+        uint16_t reserved3;
+        union {
+            int8_t cVal;
+            int16_t iVal;
+            int32_t lVal;
+            int64_t llVal;
+            uint8_t bVal;
+            uint16_t uiVal;
+            uint32_t ulVal;
+            uint64_t ullVal;
+            float fltVal;
+            double dblVal;
+            int16_t boolVal;
+            int64_t cyVal;
+            double date;
+            const uint16_t *bstrVal;
+            // BRECORD, the largest member
+            void *record[2];
+        };
+    };
+
+    // Write the columns of the row in the buffer into row of the output vectors: values with status OK, NULL for
+    // NULLs and values the provider could not convert. Throws for a truncated value. Strings bound by reference
+    // are not freed.
+    static void WriteRow(const std::vector<MSOLAPColumnBinding> &bindings, const uint8_t *row_data,
+                         const std::vector<std::string> &names, DataChunk &output, idx_t row);
+
+    // Write the value of a column with status OK into row of the vector
+    static void WriteValue(const MSOLAPColumnBinding &binding, const uint8_t *row_data, Vector &vector, idx_t row);
+
+private:
+    // Columns bound as DBTYPE_VARIANT, as the rowset bound every column before the typed bindings: the value is
+    // boxed into a Value and cast to the type of the vector, strings go through a std::wstring and the conversion
+    // of WindowsUtil::UnicodeToUTF8. Only the bindings benchmark still binds columns this way, as the baseline of
+    // the typed bindings.
+    static void WriteVariant(const DBVariant &variant, Vector &vector, idx_t row);
+};
+
+} // namespace duckdb
@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_cache.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "msolap_session.hpp"
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace duckdb {
+
+class FileSystem;
+
+struct MSOLAPCacheStats {
+    std::string directory;
+    idx_t entries = 0;
+    idx_t size = 0;
+    idx_t max_size = 0;
+    // Results read from the cache, looked up without a usable entry, stored and removed for space
+    idx_t hits = 0;
+    idx_t misses = 0;
+    idx_t writes = 0;
+    idx_t evictions = 0;
+};
+
+// Process-wide cache of DAX query results in local files. Entries are keyed by normalized connection string,
+// query and the time the model was last refreshed, so a refresh makes all older results unreachable; they are
+// removed least recently used first once the cache exceeds its size limit. Disabled while no directory is set.
+class MSOLAPResultCache {
+public:
+    // Default of the msolap_cache_max_size setting
+    static constexpr const char *DEFAULT_MAX_SIZE = "1GB";
+    // Seconds the model version of a data source is reused for before the server is asked again
+    static constexpr idx_t MODEL_VERSION_TTL = 5;
+
+    static MSOLAPResultCache &Get();
+
+    // Directory the results are stored in, empty disables the cache
+    void SetDirectory(const std::string &directory);
+    void SetMaxSize(idx_t max_size);
+    bool IsEnabled();
+
+    // Last refresh of the model of the data source, empty if the server does not tell. Asked at most once every
+    // MODEL_VERSION_TTL seconds, throws if the data source cannot be connected to.
+    std::string GetModelVersion(const std::string &connection_string);
+    // Whether the query calls a function whose result depends on when it is evaluated (NOW, TODAY, RAND, ...),
+    // such results are not cached
+    static bool IsVolatile(const std::string &dax_query);
+    // SHA-256 digest (hex) of the normalized connection string, query and model version. Passwords of the
+    // connection string are never written to the cache directory.
+    static std::string MakeKey(const std::string &connection_string, const std::string &dax_query,
+                               const std::string &model_version);
+
+    // Rowset reading the cached result of key, null if there is none. Entries that cannot be read (damaged, written
+    // by another DuckDB version) are removed and reported as missing.
+    unique_ptr<MSOLAPRowset> Open(const std::string &key);
+    // Remove the entry of key, e.g. after it failed to be read
+    void Remove(const std::string &key);
+    // Rowset returning the rows of source, they are stored under key once source has been read to the end
+    unique_ptr<MSOLAPRowset> Store(const std::string &key, unique_ptr<MSOLAPRowset> source);
+
+    MSOLAPCacheStats GetStats();
+    // Remove all entries, returns their number
+    idx_t Clear();
+
+private:
+    friend class MSOLAPCachingRowset;
+
+    MSOLAPResultCache();
+
+    // Last refresh of the model the session is connected to, empty if the server does not tell
+    static std::string QueryModelVersion(MSOLAPSession &session);
+    // Make a completely written temporary file the entry of key
+    void Commit(const std::string &key, const std::string &temp_path, idx_t size);
+    // Remove a temporary file that does not become an entry, if it is still there
+    void RemoveTempFile(const std::string &temp_path);
+    // Path of the entry file of key, lock must be held
+    std::string GetPath(const std::string &key);
+    // Pick up the entries already in the directory, lock must be held
+    void LoadEntries();
+    // Remove least recently used entries until the cache fits its size limit, lock must be held
+    void EvictEntries();
+
+    struct CacheEntry {
+        idx_t size = 0;
+        // Value of use_count when the entry was last read or written, entries found on disk start at 0
+        idx_t last_used = 0;
+    };
+
+    using EntryMap = std::unordered_map<std::string, CacheEntry>;
+    // Remove the file of an entry and the entry, lock must be held
+    void RemoveEntry(EntryMap::iterator entry);
+
+    struct ModelVersion {
+        std::string version;
+        std::chrono::steady_clock::time_point checked;
+    };
+
+    std::mutex lock;
+    unique_ptr<FileSystem> fs;
+    std::string directory;
+    idx_t max_size;
+    bool loaded;
+    // Keyed by file name
+    EntryMap entries;
+    // Keyed by normalized connection string
+    std::unordered_map<std::string, ModelVersion> model_versions;
+    idx_t total_size;
+    idx_t use_count;
+    idx_t temp_count;
+    idx_t hits;
+    idx_t misses;
+    idx_t writes;
+    idx_t evictions;
+};
+
+// msolap_cache_stats(): a single row describing the result cache
+class MSOLAPCacheStatsFunction : public TableFunction {
+public:
+    MSOLAPCacheStatsFunction();
+};
+
+// msolap_cache_clear(): remove all cached results, returns the number of entries removed
+class MSOLAPCacheClearFunction : public TableFunction {
+public:
+    MSOLAPCacheClearFunction();
+};
+
+} // namespace duckdb
@@ -0,0 +1,150 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_catalog.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/catalog/catalog.hpp"
+#include "duckdb/catalog/catalog_entry/schema_catalog_entry.hpp"
+#include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
+#include "duckdb/transaction/transaction_manager.hpp"
+#include "msolap_pool.hpp"
+#include "msolap_session.hpp"
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace duckdb {
+
+class MSOLAPSchemaEntry;
+
+// A table of the model as described by the TMSCHEMA rowsets
+struct MSOLAPModelTable {
+    std::string name;
+    // Column names without the table prefix, in the order EVALUATE 'Table' returns them
+    std::vector<std::string> columns;
+    std::vector<LogicalType> types;
+
+    // Tables and their columns of the model the session is connected to
+    static std::vector<MSOLAPModelTable> Load(MSOLAPSession &session);
+};
+
+// A model table, scanned with msolap over EVALUATE 'Table' without asking the server for its columns
+class MSOLAPTableEntry : public TableCatalogEntry {
+public:
+    MSOLAPTableEntry(Catalog &catalog, SchemaCatalogEntry &schema, CreateTableInfo &info,
+                     const MSOLAPModelTable &table);
+
+    unique_ptr<BaseStatistics> GetStatistics(ClientContext &context, column_t column_id) override;
+    TableFunction GetScanFunction(ClientContext &context, unique_ptr<FunctionData> &bind_data) override;
+    TableStorageInfo GetStorageInfo(ClientContext &context) override;
+
+private:
+    MSOLAPModelTable table;
+};
+
+// The only schema of an attached model, holding its tables. Read-only.
+class MSOLAPSchemaEntry : public SchemaCatalogEntry {
+public:
+    MSOLAPSchemaEntry(Catalog &catalog, CreateSchemaInfo &info);
+
+    // Replace the tables by those of the model
+    void SetTables(const std::vector<MSOLAPModelTable> &tables);
+
+    void Scan(ClientContext &context, CatalogType type, const std::function<void(CatalogEntry &)> &callback) override;
+    void Scan(CatalogType type, const std::function<void(CatalogEntry &)> &callback) override;
+    optional_ptr<CatalogEntry> LookupEntry(CatalogTransaction transaction, const EntryLookupInfo &lookup_info) override;
+
+    optional_ptr<CatalogEntry> CreateIndex(CatalogTransaction transaction, CreateIndexInfo &info,
+                                           TableCatalogEntry &table) override;
+    optional_ptr<CatalogEntry> CreateFunction(CatalogTransaction transaction, CreateFunctionInfo &info) override;
+    optional_ptr<CatalogEntry> CreateTable(CatalogTransaction transaction, BoundCreateTableInfo &info) override;
+    optional_ptr<CatalogEntry> CreateView(CatalogTransaction transaction, CreateViewInfo &info) override;
+    optional_ptr<CatalogEntry> CreateSequence(CatalogTransaction transaction, CreateSequenceInfo &info) override;
+    optional_ptr<CatalogEntry> CreateTableFunction(CatalogTransaction transaction,
+                                                   CreateTableFunctionInfo &info) override;
+    optional_ptr<CatalogEntry> CreateCopyFunction(CatalogTransaction transaction,
+                                                  CreateCopyFunctionInfo &info) override;
+    optional_ptr<CatalogEntry> CreatePragmaFunction(CatalogTransaction transaction,
+                                                    CreatePragmaFunctionInfo &info) override;
+    optional_ptr<CatalogEntry> CreateCollation(CatalogTransaction transaction, CreateCollationInfo &info) override;
+    optional_ptr<CatalogEntry> CreateType(CatalogTransaction transaction, CreateTypeInfo &info) override;
+    void DropEntry(ClientContext &context, DropInfo &info) override;
+    void Alter(CatalogTransaction transaction, AlterInfo &info) override;
+
+private:
+    std::mutex lock;
+    case_insensitive_map_t<unique_ptr<MSOLAPTableEntry>> tables;
+    // Entries replaced by a refresh, queries bound before it may still refer to them
+    std::vector<unique_ptr<MSOLAPTableEntry>> retired;
+};
+
+// Catalog of an attached model: ATTACH 'Data Source=...;Catalog=...' AS m (TYPE msolap). The tables are read
+// from the server when attaching and kept until msolap_catalog_refresh(), so binding a query needs no round trip.
+class MSOLAPCatalog : public Catalog {
+public:
+    MSOLAPCatalog(AttachedDatabase &db, const std::string &connection_string);
+
+    const std::string &GetConnectionString() const {
+        return connection_string;
+    }
+
+    // Read the tables of the model again, returns their number
+    idx_t Refresh();
+
+    void Initialize(bool load_builtin) override;
+    std::string GetCatalogType() override {
+        return "msolap";
+    }
+
+    optional_ptr<CatalogEntry> CreateSchema(CatalogTransaction transaction, CreateSchemaInfo &info) override;
+    void ScanSchemas(ClientContext &context, std::function<void(SchemaCatalogEntry &)> callback) override;
+    optional_ptr<SchemaCatalogEntry> LookupSchema(CatalogTransaction transaction, const EntryLookupInfo &schema_lookup,
+                                                  OnEntryNotFound if_not_found) override;
+
+    PhysicalOperator &PlanCreateTableAs(ClientContext &context, PhysicalPlanGenerator &planner, LogicalCreateTable &op,
+                                        PhysicalOperator &plan) override;
+    PhysicalOperator &PlanInsert(ClientContext &context, PhysicalPlanGenerator &planner, LogicalInsert &op,
+                                 optional_ptr<PhysicalOperator> plan) override;
+    PhysicalOperator &PlanDelete(ClientContext &context, PhysicalPlanGenerator &planner, LogicalDelete &op,
+                                 PhysicalOperator &plan) override;
+    PhysicalOperator &PlanUpdate(ClientContext &context, PhysicalPlanGenerator &planner, LogicalUpdate &op,
+                                 PhysicalOperator &plan) override;
+
+    DatabaseSize GetDatabaseSize(ClientContext &context) override;
+    bool InMemory() override {
+        return false;
+    }
+    // Shown by duckdb_databases(), without the password of the connection string
+    std::string GetDBPath() override {
+        return MSOLAPConnectionPool::MaskConnectionString(connection_string);
+    }
+
+private:
+    void DropSchema(ClientContext &context, DropInfo &info) override;
+
+    std::string connection_string;
+    unique_ptr<MSOLAPSchemaEntry> main_schema;
+};
+
+// Attached models cannot be written, transactions only keep DuckDB's bookkeeping
+class MSOLAPTransactionManager : public TransactionManager {
+public:
+    explicit MSOLAPTransactionManager(AttachedDatabase &db);
+
+    Transaction &StartTransaction(ClientContext &context) override;
+    ErrorData CommitTransaction(ClientContext &context, Transaction &transaction) override;
+    void RollbackTransaction(Transaction &transaction) override;
+    void Checkpoint(ClientContext &context, bool force = false) override;
+
+private:
+    std::mutex lock;
+    reference_map_t<Transaction, unique_ptr<Transaction>> transactions;
+};
+
+} // namespace duckdb
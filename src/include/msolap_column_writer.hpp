@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_column_writer.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include <string>
+
+namespace duckdb {
+
+// Writes the cells of one rowset column straight into a flat output vector. Transports convert their wire
+// representation (lexical text, native values, UTF-16 strings) through it, so no Value is created per cell.
+class MSOLAPColumnWriter {
+public:
+    explicit MSOLAPColumnWriter(const LogicalType &type);
+
+    const LogicalType &GetType() const {
+        return type;
+    }
+
+    // Parse the lexical form of a value (XSD / DuckDB cast syntax) into row of the vector
+    void WriteText(Vector &vector, idx_t row, const char *data, idx_t length) const {
+        text_writer(vector, row, data, length);
+    }
+
+    // Store a value of the vector's physical type
+    template <class T>
+    static void WriteValue(Vector &vector, idx_t row, T value) {
+        FlatVector::GetData<T>(vector)[row] = value;
+    }
+
+    // Store a decimal with the scale of the vector's type, in its physical type
+    static void WriteDecimal(Vector &vector, idx_t row, hugeint_t value);
+
+    // Store a UTF-8 string
+    static void WriteString(Vector &vector, idx_t row, const char *data, idx_t length) {
+        FlatVector::GetData<string_t>(vector)[row] = StringVector::AddString(vector, data, length);
+    }
+
+    // Store UTF-16LE text as UTF-8, transcoded straight into the vector's string heap
+    static void WriteUTF16(Vector &vector, idx_t row, const uint8_t *data, idx_t length);
+
+    static void WriteNull(Vector &vector, idx_t row) {
+        FlatVector::SetNull(vector, row, true);
+    }
+
+private:
+    typedef void (*text_writer_t)(Vector &vector, idx_t row, const char *data, idx_t length);
+
+    LogicalType type;
+    // Conversion for the type, resolved once instead of per cell
+    text_writer_t text_writer;
+};
+
+} // namespace duckdb
@@ -8,12 +8,19 @@
 
 #pragma once
 
+#ifdef _WIN32
+
 #include "duckdb.hpp"
+#include "msolap_session.hpp"
+#include "msolap_bindings.hpp"
+#include "msolap_utils.hpp"
 #include <windows.h>
 #include <oledb.h>
 #include <oledberr.h>
+#include <atomic>
 #include <string>
 #include <memory>
+#include <mutex>
 
 namespace duckdb {
 
@@ -21,10 +28,10 @@ namespace duckdb {
 const CLSID CLSID_MSOLAP =
 { 0xDBC724B0, 0xDD86, 0x4772, { 0xBB, 0x5A, 0xFC, 0xC6, 0xCA, 0xB2, 0xFC, 0x1A } };
 
-class MSOLAPConnection {
+class MSOLAPConnection : public MSOLAPSession {
 public:
     MSOLAPConnection();
-    ~MSOLAPConnection();
+    ~MSOLAPConnection() override;
     
     // Disable copy constructors
     MSOLAPConnection(const MSOLAPConnection &other) = delete;
@@ -37,41 +44,73 @@ public:
     // Connect to MSOLAP using a connection string
     static MSOLAPConnection Connect(const std::string &connection_string);
     
-    // Execute a DAX query and return an interface to process results
-    IRowset* ExecuteQuery(const std::string &dax_query);
-    
-    // Get column information from a rowset
-    bool GetColumnInfo(IRowset *rowset, std::vector<std::string> &names, std::vector<LogicalType> &types);
+    // Execute a DAX query and return its rowset
+    unique_ptr<MSOLAPRowset> ExecuteQuery(const std::string &dax_query) override;
+
+    // Prepare a DAX query and read its result columns without executing it
+    void DescribeQuery(const std::string &dax_query, std::vector<std::string> &names,
+                       std::vector<LogicalType> &types) override;
     
     // Check if connection is open
-    bool IsOpen() const;
+    bool IsOpen() const override;
+
+    // Execute a trivial DAX query
+    void Ping() override;
+
+    // Cancel the last command executed, through ICommand::Cancel
+    void Cancel() override;
+
+    // Sessions opened in a single-threaded apartment can't be handed to other threads
+    bool IsPoolable() const override {
+        return multithreaded;
+    }
     
     // Close connection
-    void Close();
+    void Close() override;
 
-    // Initialize COM if needed
-    static void InitializeCOM();
+    // Initialize COM for the calling thread if needed, returns false if its apartment is single-threaded
+    static bool InitializeCOM();
 private:
     // Parse connection string and set properties
     void ParseConnectionString(const std::string &connection_string);
     
+    // Execute a DAX query and return the raw OLE DB rowset
+    IRowset* ExecuteCommand(const std::string &dax_query);
+
+    // Create a command for a DAX query, with its text and rowset properties set
+    ICommand* CreateCommand(const std::string &dax_query);
     
     // COM interfaces
     IDBInitialize* pIDBInitialize;
     IDBCreateCommand* pIDBCreateCommand;
+    // Last command executed, kept while its rowset is read so it can be cancelled. Guarded by command_lock,
+    // which is not moved with the connection.
+    ICommand* pIActiveCommand;
+    std::mutex command_lock;
+    std::atomic<bool> cancelled;
     
     // Connection properties
     std::wstring server_name;
     std::wstring database_name;
+
+    // Opened in the multithreaded apartment
+    bool multithreaded;
     
     // COM initialization flag
     static bool com_initialized;
 };
 class ComInitializer {
     public:
-        ComInitializer() {
-            HRESULT hr = CoInitialize(NULL);
-            if (FAILED(hr) && hr != S_FALSE) {
+        ComInitializer() : initialized(false), multithreaded(true) {
+            // Join the multithreaded apartment, so the interfaces of a session can be called from any thread
+            // (the pool hands sessions to whichever thread runs the next query)
+            HRESULT hr = CoInitializeEx(NULL, COINIT_MULTITHREADED);
+            if (hr == RPC_E_CHANGED_MODE) {
+                // The host made this thread single-threaded, sessions opened on it stay on it
+                multithreaded = false;
+                return;
+            }
+            if (FAILED(hr)) {
                 throw std::runtime_error("COM initialization failed");
             }
             initialized = (hr == S_OK); // Only track if we actually initialized
@@ -82,6 +121,10 @@ class ComInitializer {
                 CoUninitialize();
             }
         }
+
+        bool IsMultithreaded() const {
+            return multithreaded;
+        }
         
         // Explicit "no copy" policy to prevent accidental copying
         // ComInitializer(const ComInitializer&) = delete;
@@ -89,6 +132,38 @@ class ComInitializer {
         
     private:
         bool initialized;
+        bool multithreaded;
     };
 
-} // namespace duckdb
\ No newline at end of file
+// OLE DB rowset returned by the MSOLAP provider. Every column is bound with the native DBTYPE matching its
+// DuckDB type, so the provider converts into the row buffer and cells are copied straight into the output vectors.
+class MSOLAPOLEDBRowset : public MSOLAPRowset {
+public:
+    explicit MSOLAPOLEDBRowset(IRowset *rowset);
+    ~MSOLAPOLEDBRowset() override;
+
+    // Read the column info and create the accessor binding every column
+    void CreateAccessor();
+
+    void GetColumnInfo(std::vector<std::string> &names, std::vector<LogicalType> &types) override;
+    idx_t Fetch(DataChunk &output) override;
+
+private:
+    IRowset* rowset;
+    IAccessor* accessor;
+    HACCESSOR haccessor;
+    DBBINDING* bindings;
+    // The bindings as MSOLAPBindings decodes the row buffer with them
+    std::vector<MSOLAPColumnBinding> columns;
+    DBORDINAL column_count;
+    BYTE* row_data;
+    DWORD row_size;
+    bool done;
+
+    std::vector<std::string> names;
+    std::vector<LogicalType> types;
+};
+
+} // namespace duckdb
+
+#endif // _WIN32
\ No newline at end of file
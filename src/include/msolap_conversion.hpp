@@ -0,0 +1,42 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_conversion.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+
+namespace duckdb {
+
+// Exact conversions of the fixed point and date values providers return, into the physical value of the DuckDB
+// type. They take the plain fields of the OLE DB structures, so they do not depend on the Windows headers.
+class MSOLAPConversion {
+public:
+    // Currency (CY, xsd:decimal) is a 64-bit integer scaled by 10,000
+    static constexpr uint8_t CURRENCY_WIDTH = 19;
+    static constexpr uint8_t CURRENCY_SCALE = 4;
+
+    static LogicalType GetCurrencyType() {
+        return LogicalType::DECIMAL(CURRENCY_WIDTH, CURRENCY_SCALE);
+    }
+
+    // Rescale the magnitude of a DECIMAL (96 bits) or NUMERIC (128 bits) with scale digits to target_scale digits,
+    // rounding half away from zero. False if it does not fit width digits.
+    static bool TryConvertDecimal(hugeint_t magnitude, bool negative, uint8_t scale, uint8_t width,
+                                  uint8_t target_scale, hugeint_t &result);
+
+    // Parse decimal text (e.g. "-12.3456") with target_scale digits, false if it is not plain decimal notation or
+    // does not fit width digits
+    static bool TryParseDecimal(const char *data, idx_t length, uint8_t width, uint8_t target_scale,
+                                hugeint_t &result);
+
+    // OLE automation date: days since 1899-12-30, with the time of day as fraction (-1.25 is 1899-12-29 06:00).
+    // Rounded to milliseconds, the precision the value carries.
+    static bool TryConvertOADate(double value, timestamp_t &result);
+};
+
+} // namespace duckdb
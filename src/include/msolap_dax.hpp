@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_dax.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/planner/table_filter.hpp"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace duckdb {
+
+// A DAX query split into its statements: [DEFINE ...] EVALUATE <table> [ORDER BY ... [START AT ...]].
+// Used to wrap the table expression of a user query (partitioning, pushdown) while keeping its definitions.
+struct MSOLAPDaxQuery {
+    // "DEFINE ..." block including the keyword, empty if the query has none
+    std::string define;
+    // Table expression of the EVALUATE statement, comments removed
+    std::string table;
+    // "ORDER BY ..." (and "START AT ...") clause including the keywords, empty if the query has none
+    std::string order_by;
+
+    // Split a query with a single EVALUATE statement, returns false for anything else
+    static bool TryParse(const std::string &query, MSOLAPDaxQuery &result);
+
+    // Query text evaluating table_expression with the definitions of this query, optionally keeping its ORDER BY
+    std::string Build(const std::string &table_expression, bool keep_order_by = true) const;
+
+    // Name of the model table evaluated if the table expression is a plain table reference, empty otherwise
+    std::string GetModelTable() const;
+};
+
+class MSOLAPDax {
+public:
+    // "text" with embedded quotes doubled
+    static std::string QuoteString(const std::string &text);
+
+    // 'Table' with embedded quotes doubled
+    static std::string QuoteTable(const std::string &name);
+
+    // [Column] with embedded closing brackets doubled
+    static std::string QuoteColumn(const std::string &name);
+
+    // Reference to a result column given its name as reported by the server: Sales[Year] -> 'Sales'[Year],
+    // [Total] -> [Total]
+    static std::string ColumnReference(const std::string &column_name);
+
+    // Check if a result column is a column of the model table, its name as reported by the server is Table[Column]
+    static bool IsModelColumn(const std::string &column_name, const std::string &model_table);
+
+    // DAX literal of a constant: 42, "text", TRUE(), DATE(2024, 1, 31) + TIME(12, 0, 0).
+    // Returns false for values without an exact DAX representation.
+    static bool TryLiteral(const Value &value, std::string &result);
+
+    // Query text with every @Name parameter reference outside of literals, quoted names and comments replaced by
+    // what replace sets for Name. Throws for references replace returns false for.
+    static std::string
+    ReplaceParameters(const std::string &query,
+                      const std::function<bool(const std::string &name, std::string &result)> &replace);
+
+    // Query text with the @Name references replaced by the literals of the fields of the parameters struct with the
+    // same name (case-insensitive), NULL as BLANK()
+    static std::string BindParameters(const std::string &query, const Value &parameters);
+
+    // DATATABLE column type of a DuckDB type (INTEGER, STRING, ...), empty if there is none. Decimals are
+    // CURRENCY, those it cannot hold exactly have none.
+    static std::string GetDataTableType(const LogicalType &type);
+
+    // DATATABLE value of a constant, which has to be a literal: dates are written as text, NULL as BLANK().
+    // Returns false for values without an exact DATATABLE representation.
+    static bool TryDataTableValue(const Value &value, std::string &result);
+
+    // DAX predicate on column_reference selecting at least the rows the filter keeps, empty if there is none.
+    // DAX compares BLANK like 0 and text case-insensitively, so the predicate may keep more rows than the filter
+    // and the filter still has to be applied to the result.
+    static std::string TranslateFilter(const TableFilter &filter, const std::string &column_reference,
+                                       const LogicalType &type);
+
+    // Filter arguments of CALCULATETABLE for the lists of values the filter keeps, on a column of the model table
+    // being evaluated: KEEPFILTERS(TREATAS({1, 2}, 'Sales'[Key])). Covers IN lists, optional ones too (the
+    // values of a join key DuckDB pushes into the scan) and those combined with others by AND. predicate is set
+    // to the translation of the rest of the filter, as by TranslateFilter. Values match as in a filter context,
+    // text case-insensitively, so the arguments may keep more rows than the filter as well.
+    static std::string TranslateValueFilters(const TableFilter &filter, const std::string &column_reference,
+                                             const LogicalType &type, std::string &predicate);
+
+    // DAX predicate on column_reference keeping exactly the rows the filter keeps, for results that are not
+    // checked by DuckDB afterwards (aggregates). Returns false if there is no such predicate, result is left
+    // empty for filters that do not change the result (optional and dynamic filters).
+    static bool TryTranslateExactFilter(const TableFilter &filter, const std::string &column_reference,
+                                        const LogicalType &type, std::string &result);
+
+    // DAX measure computing a DuckDB aggregate function (count_star, count, sum, min, max) over the rows of the
+    // current group of table, on column_reference (unused by count_star). Empty if there is none. never_blank is
+    // set for measures returning a value for every group, counts are 0 instead of BLANK.
+    static std::string TranslateAggregate(const std::string &function_name, bool distinct, const std::string &table,
+                                          const std::string &column_reference, const LogicalType &type,
+                                          bool &never_blank);
+
+    // SUMMARIZECOLUMNS table expression evaluating the named measures for every combination of the group columns
+    // of table with rows, there is at least one group column. Only rows matching predicate count if it is not
+    // empty. Unless never_blank, SUMMARIZECOLUMNS would leave out groups where every measure is BLANK, so a
+    // "Rows" count is added as last column and rows_column is set.
+    static std::string Summarize(const std::string &table, const std::vector<std::string> &groups,
+                                 const std::vector<std::pair<std::string, std::string>> &measures,
+                                 const std::string &predicate, bool never_blank, bool &rows_column);
+};
+
+} // namespace duckdb
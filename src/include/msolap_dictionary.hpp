@@ -0,0 +1,48 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_dictionary.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/string_map_set.hpp"
+#include <vector>
+
+namespace duckdb {
+
+// Adaptive dictionary of one text column of a scan. Models are dictionary encoded and their attributes repeat a
+// few hundred values over millions of rows: every distinct string is stored once for the whole scan and chunks are
+// emitted as dictionary vectors over them, which downstream hashing and comparisons benefit from. Columns whose
+// values hardly repeat are left flat.
+class MSOLAPStringDictionary {
+public:
+    // Entries beyond which a column is considered high cardinality
+    static constexpr idx_t MAX_SIZE = 4096;
+
+    MSOLAPStringDictionary();
+
+    // Turn a flat vector of count rows into a dictionary vector. Leaves it flat, and stops trying for the
+    // rest of the scan, once the column turns out not to repeat enough.
+    void Encode(Vector &vector, idx_t count);
+
+private:
+    void Disable();
+
+    bool enabled;
+    // Owns the strings of the entries, every dictionary handed out keeps a reference to it
+    unique_ptr<Vector> heap;
+    std::vector<string_t> entries;
+    string_map_t<sel_t> index;
+    // Entry of NULL, INVALID_INDEX until the column had one
+    idx_t null_index;
+    // Dictionary last handed out, chunks share it until entries are added. Dictionaries are never modified
+    // once handed out, so chunks that are still in use keep seeing the entries they refer to.
+    unique_ptr<Vector> dictionary;
+    idx_t dictionary_size;
+};
+
+} // namespace duckdb
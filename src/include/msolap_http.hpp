@@ -0,0 +1,128 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_http.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/case_insensitive_map.hpp"
+#include "msolap_stream.hpp"
+#include <mutex>
+#include <string>
+
+namespace duckdb {
+
+struct MSOLAPHTTPResponse {
+    int status = 0;
+    std::string reason;
+    case_insensitive_map_t<std::string> headers;
+};
+
+// Minimal blocking HTTP/1.1 client used by the XMLA transport.
+// The response body is read incrementally, so callers never need to hold a full response in memory.
+class MSOLAPHTTPConnection {
+public:
+    MSOLAPHTTPConnection();
+    ~MSOLAPHTTPConnection();
+
+    // Disable copy constructors
+    MSOLAPHTTPConnection(const MSOLAPHTTPConnection &other) = delete;
+    MSOLAPHTTPConnection &operator=(const MSOLAPHTTPConnection &) = delete;
+
+    // Enable move constructors
+    MSOLAPHTTPConnection(MSOLAPHTTPConnection &&other) noexcept;
+    MSOLAPHTTPConnection &operator=(MSOLAPHTTPConnection &&) noexcept;
+
+    // Open a TCP connection to the host of an http:// URL. The connection fails after connect_timeout seconds,
+    // sending and receiving after timeout seconds without progress, 0 waits as long as the system does.
+    static MSOLAPHTTPConnection Connect(const std::string &url, idx_t connect_timeout = 0, idx_t timeout = 0);
+
+    // Send a request for the path of the connected URL
+    void SendRequest(const std::string &method, const std::vector<std::pair<std::string, std::string>> &headers,
+                     const std::string &body);
+
+    // Read the status line and headers of the response to the last request
+    MSOLAPHTTPResponse ReadResponseHeader();
+
+    // Read up to length bytes of the response body, returns 0 at the end of the body
+    idx_t ReadBody(char *buffer, idx_t length);
+
+    // Read the whole response body into a string
+    std::string ReadFullBody();
+
+    // Check if the body of the last response has been read completely
+    bool ResponseComplete() const {
+        return body_done;
+    }
+
+    // Check if connection is open
+    bool IsOpen() const;
+
+    // Close connection
+    void Close();
+
+    // Shut the socket down from another thread, the send or receive blocked on it fails. A connection opened
+    // afterwards (assigned to this one) is shut down as well.
+    void Abort();
+    bool IsAborted() const;
+
+    const std::string &Host() const {
+        return host;
+    }
+
+private:
+    // Receive raw bytes from the socket into the receive buffer, returns false on EOF
+    bool FillBuffer();
+    // Read one CRLF terminated line from the receive buffer
+    std::string ReadLine();
+    // Send all bytes to the socket
+    void SendAll(const char *data, idx_t length);
+
+    int64_t socket_fd;
+    // Guards socket_fd against Abort, which is called from other threads. Not moved with the connection.
+    unique_ptr<std::mutex> socket_lock;
+    bool aborted;
+    std::string host;
+    std::string port;
+    std::string path;
+
+    // Receive buffer
+    std::unique_ptr<char[]> buffer;
+    idx_t buffer_pos;
+    idx_t buffer_end;
+
+    // State of the response body
+    bool chunked;
+    bool read_until_close;
+    idx_t body_remaining;
+    bool body_done;
+    bool keep_alive;
+};
+
+// Input stream over the body of the current response of a connection
+class MSOLAPHTTPBodyStream : public MSOLAPInputStream {
+public:
+    explicit MSOLAPHTTPBodyStream(MSOLAPHTTPConnection &http_p) : http(http_p), bytes_read(0) {
+    }
+
+    idx_t Read(char *buffer, idx_t length) override {
+        auto result = http.ReadBody(buffer, length);
+        bytes_read += result;
+        return result;
+    }
+
+    // Body bytes received, before decompression
+    idx_t GetBytesRead() const {
+        return bytes_read;
+    }
+
+private:
+    MSOLAPHTTPConnection &http;
+    idx_t bytes_read;
+};
+
+} // namespace duckdb
@@ -0,0 +1,26 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_optimizer.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/optimizer/optimizer_extension.hpp"
+
+namespace duckdb {
+
+// Rewrites parts of the plan around msolap scans the table function interface cannot push down:
+// LIMIT and ORDER BY ... LIMIT directly above a scan are evaluated by the server with TOPN,
+// GROUP BY with SUM/MIN/MAX/COUNT over a model table with SUMMARIZECOLUMNS.
+class MSOLAPOptimizerExtension : public OptimizerExtension {
+public:
+    MSOLAPOptimizerExtension();
+
+    static void Optimize(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan);
+};
+
+} // namespace duckdb
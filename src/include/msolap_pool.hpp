@@ -0,0 +1,182 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_pool.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "msolap_session.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace duckdb {
+
+class MSOLAPConnectionPool;
+
+// Session borrowed from the connection pool, returned to it when the handle is destroyed
+class MSOLAPPooledSession {
+public:
+    MSOLAPPooledSession();
+    MSOLAPPooledSession(MSOLAPConnectionPool &pool, std::string key, unique_ptr<MSOLAPSession> session);
+    ~MSOLAPPooledSession();
+
+    // Disable copy constructors
+    MSOLAPPooledSession(const MSOLAPPooledSession &other) = delete;
+    MSOLAPPooledSession &operator=(const MSOLAPPooledSession &) = delete;
+
+    // Enable move constructors
+    MSOLAPPooledSession(MSOLAPPooledSession &&other) noexcept;
+    MSOLAPPooledSession &operator=(MSOLAPPooledSession &&) noexcept;
+
+    MSOLAPSession *operator->() const {
+        return session.get();
+    }
+    MSOLAPSession &operator*() const {
+        return *session;
+    }
+    explicit operator bool() const {
+        return session != nullptr;
+    }
+
+    // Return the session to the pool
+    void Release();
+
+    // Close the session instead of returning it, e.g. after an error left it in an unknown state
+    void Invalidate();
+
+private:
+    MSOLAPConnectionPool *pool;
+    std::string key;
+    unique_ptr<MSOLAPSession> session;
+};
+
+struct MSOLAPPoolStats {
+    // Normalized connection string, passwords masked
+    std::string connection_string;
+    idx_t idle = 0;
+    // Sessions handed out and not returned yet, and the limit on them (0 for none)
+    idx_t active = 0;
+    idx_t max_active = 0;
+    // Sessions opened, handed out again from the pool and closed by the pool
+    idx_t opened = 0;
+    idx_t reused = 0;
+    idx_t evicted = 0;
+    // Idle sessions checked with a round trip before reuse, and those that failed the check
+    idx_t pinged = 0;
+    idx_t ping_failures = 0;
+    // Acquires that had to wait for an active session to be returned
+    idx_t waits = 0;
+};
+
+// Process-wide pool of open sessions keyed by normalized connection string. Opening a session against
+// Power BI / Azure Analysis Services costs a full provider initialization or authentication round trip,
+// so sessions are kept open after a query and handed out to the next query on the same data source. The number
+// of sessions handed out at the same time per data source is limited, further acquires wait for one to come back.
+class MSOLAPConnectionPool {
+public:
+    // Defaults of the msolap_pool_size, msolap_pool_max_active, msolap_pool_idle_timeout and
+    // msolap_pool_ping_interval settings
+    static constexpr idx_t DEFAULT_MAX_IDLE = 8;
+    static constexpr idx_t DEFAULT_MAX_ACTIVE = 32;
+    static constexpr idx_t DEFAULT_IDLE_TIMEOUT = 300;
+    static constexpr idx_t DEFAULT_PING_INTERVAL = 30;
+    // Seconds an acquire waits for an active session to be returned before it fails
+    static constexpr idx_t ACQUIRE_TIMEOUT = 60;
+
+    static MSOLAPConnectionPool &Get();
+
+    // Take an idle session for the connection string or open a new one, waiting while the maximum number of
+    // sessions is in use. Throws if none is returned within ACQUIRE_TIMEOUT.
+    MSOLAPPooledSession Acquire(const std::string &connection_string);
+    // Acquire without waiting, for threads that must not block: false while the maximum number of sessions is in
+    // use, ready is then called (on the thread returning a session) once the acquire is worth trying again. Throws
+    // like Acquire if there is still no room once deadline has passed.
+    bool TryAcquire(const std::string &connection_string, const std::function<void()> &ready,
+                    std::chrono::steady_clock::time_point deadline, MSOLAPPooledSession &session);
+
+    // Maximum number of idle sessions kept per connection string (0 disables pooling)
+    void SetMaxIdle(idx_t max_idle);
+    // Maximum number of sessions handed out at the same time per connection string (0 for no limit)
+    void SetMaxActive(idx_t max_active);
+    idx_t GetMaxActive();
+    // Idle sessions older than this are closed
+    void SetIdleTimeout(idx_t seconds);
+    // Sessions idle for at least this long are pinged before they are handed out again
+    void SetPingInterval(idx_t seconds);
+
+    std::vector<MSOLAPPoolStats> GetStats();
+
+    // Key of a connection string: properties trimmed, keys lower case and sorted
+    static std::string NormalizeConnectionString(const std::string &connection_string);
+    // Normalized connection string with passwords masked, for display
+    static std::string MaskConnectionString(const std::string &connection_string);
+
+private:
+    friend class MSOLAPPooledSession;
+
+    MSOLAPConnectionPool();
+
+    struct PoolEntry;
+
+    void Release(const std::string &key, unique_ptr<MSOLAPSession> session, bool reusable);
+    // Count a session of key as active, waiting for one to be returned until deadline while the maximum is in use.
+    // With ready set it does not wait, it registers ready and returns false instead until deadline has passed.
+    bool Reserve(const std::string &key, const std::string &connection_string, const std::function<void()> *ready,
+                 std::chrono::steady_clock::time_point deadline);
+    // Hand out an idle session of key or open one, for a reserved session
+    MSOLAPPooledSession TakeSession(std::string key, const std::string &connection_string);
+    // An active session of entry is gone, its waiters are moved to ready, lock must be held
+    void Unreserve(PoolEntry &entry, std::vector<std::function<void()>> &ready);
+    // Wake up the acquires waiting for a session, outside the lock
+    void NotifyReleased(std::vector<std::function<void()>> &ready);
+    // Move idle sessions past the timeout (or beyond the size limit) to expired, lock must be held
+    void EvictIdle(std::vector<unique_ptr<MSOLAPSession>> &expired);
+    // Take the most recently released idle session of key, needs_ping tells if it was idle for the ping interval
+    unique_ptr<MSOLAPSession> TakeIdle(const std::string &key, bool &needs_ping);
+
+    struct IdleSession {
+        unique_ptr<MSOLAPSession> session;
+        std::chrono::steady_clock::time_point idle_since;
+    };
+
+    struct PoolEntry {
+        std::string display_name;
+        // Most recently released last
+        std::vector<IdleSession> idle;
+        idx_t active = 0;
+        idx_t opened = 0;
+        idx_t reused = 0;
+        idx_t evicted = 0;
+        idx_t pinged = 0;
+        idx_t ping_failures = 0;
+        idx_t waits = 0;
+        // Called when a session of the key is returned, for the acquires that do not wait
+        std::vector<std::function<void()>> waiters;
+    };
+
+    std::mutex lock;
+    // Signalled whenever an active session is returned or closed
+    std::condition_variable released;
+    std::map<std::string, PoolEntry> entries;
+    idx_t max_idle;
+    idx_t max_active;
+    std::chrono::seconds idle_timeout;
+    std::chrono::seconds ping_interval;
+};
+
+// msolap_pool_stats(): one row per pooled connection string
+class MSOLAPPoolStatsFunction : public TableFunction {
+public:
+    MSOLAPPoolStatsFunction();
+};
+
+} // namespace duckdb
@@ -0,0 +1,41 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_prefetch.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "msolap_session.hpp"
+#include "msolap_scheduler.hpp"
+
+namespace duckdb {
+
+// Rowset executed and read by the I/O scheduler, up to a number of chunks ahead of the scan, so waiting for the
+// server and decoding its response overlap with DuckDB processing the rows already read. Errors are raised by
+// the scan after the rows read before. Fetch blocks the scan thread while the next chunk is not there yet, DuckDB
+// 1.4 table functions cannot return a blocked result to be rescheduled once it arrives.
+class MSOLAPPrefetchRowset : public MSOLAPRowset {
+public:
+    // Default of the msolap_prefetch_chunks setting
+    static constexpr idx_t DEFAULT_CHUNKS = 4;
+
+    MSOLAPPrefetchRowset(MSOLAPIOScheduler &scheduler, MSOLAPIOStream::OpenFunction open, idx_t chunk_count);
+    // Stops reading ahead, the I/O thread closes the rowset
+    ~MSOLAPPrefetchRowset() override;
+
+    void GetColumnInfo(std::vector<std::string> &names, std::vector<LogicalType> &types) override;
+    // Output references the chunk read ahead, it stays valid until the next call
+    idx_t Fetch(DataChunk &output) override;
+    idx_t GetBytesRead() const override {
+        return stream->GetBytesRead();
+    }
+
+private:
+    shared_ptr<MSOLAPIOStream> stream;
+};
+
+} // namespace duckdb
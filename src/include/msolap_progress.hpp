@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_progress.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace duckdb {
+
+// Progress of a running msolap scan, updated by its threads and read by the progress bar and msolap_scans()
+struct MSOLAPScanProgress {
+    MSOLAPScanProgress(std::string connection_string, std::string query, idx_t partitions, idx_t estimated_rows);
+
+    // Connection string with passwords masked and the query of the first partition
+    std::string connection_string;
+    std::string query;
+    idx_t partitions;
+    // Rows the scan is expected to return, 0 if unknown
+    idx_t estimated_rows;
+    std::chrono::steady_clock::time_point started;
+
+    std::atomic<idx_t> partitions_done;
+    std::atomic<idx_t> rows;
+    // Response bytes received, as sent by the server (compressed)
+    std::atomic<idx_t> bytes;
+
+    // Percentage of the scan done, from the rows read against the estimate or the partitions completed,
+    // -1 if neither is known
+    double GetPercentage() const;
+    double GetElapsedSeconds() const;
+};
+
+// Process-wide list of the msolap scans in progress
+class MSOLAPScanRegistry {
+public:
+    static MSOLAPScanRegistry &Get();
+
+    void Register(const shared_ptr<MSOLAPScanProgress> &scan);
+    void Unregister(const MSOLAPScanProgress &scan);
+    std::vector<shared_ptr<MSOLAPScanProgress>> GetScans();
+
+private:
+    MSOLAPScanRegistry() = default;
+
+    std::mutex lock;
+    std::vector<shared_ptr<MSOLAPScanProgress>> scans;
+};
+
+// msolap_scans(): one row per msolap scan in progress, with its throughput
+class MSOLAPScansFunction : public TableFunction {
+public:
+    MSOLAPScansFunction();
+};
+
+} // namespace duckdb
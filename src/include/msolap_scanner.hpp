@@ -10,63 +10,113 @@
 
 #include "duckdb.hpp"
 #include "msolap_utils.hpp"
-#include "msolap_connection.hpp"
+#include "msolap_session.hpp"
+#include "msolap_pool.hpp"
+#include "msolap_dax.hpp"
+#include "msolap_progress.hpp"
+#include "msolap_dictionary.hpp"
+#include "msolap_single_flight.hpp"
+#include "duckdb/execution/expression_executor.hpp"
+#include <atomic>
 #include <memory>
 
 namespace duckdb {
 
+// Sort key of an ORDER BY pushed down into the query
+struct MSOLAPOrder {
+    column_t column_id;
+    bool descending;
+    bool nulls_first;
+};
+
 struct MSOLAPBindData : public TableFunctionData {
     std::string connection_string;
     std::string dax_query;
     
+    // Column names as reported by the server (e.g. "Sales[Year]"), names holds their sanitized form
+    std::vector<std::string> dax_names;
     std::vector<std::string> names;
     std::vector<LogicalType> types;
+
+    // The query split into its statements, only valid if it could be parsed. Partitioning and pushdown
+    // wrap its table expression.
+    MSOLAPDaxQuery query;
+    bool rewritable = false;
+    // Rewritten queries select the columns by reference even if all of them are scanned in order, set for the
+    // tables of attached models whose table expression does not fix the column order
+    bool always_project = false;
+
+    // Number of disjoint partitions the scan is split into and the DAX reference of the column they are split on
+    idx_t partitions = 1;
+    std::string partition_reference;
+    idx_t max_threads = 1;
+
+    // Number of rows (LIMIT plus OFFSET) and their order the optimizer pushed down as TOPN, 0 if none.
+    // Without top_order any top_count rows will do.
+    idx_t top_count = 0;
+    std::vector<MSOLAPOrder> top_order;
 };
 
 struct MSOLAPLocalState : public LocalTableFunctionState {
-    MSOLAPConnection connection;
-    IRowset* rowset;
-    IAccessor* accessor;
-    HACCESSOR haccessor;
-    DBBINDING* bindings;
-    BYTE* row_data;
-    DWORD row_size;
+    // Session the partitions are read on by the scan thread, taken for the first partition that is not cached.
+    // Unused while the I/O scheduler reads them ahead.
+    MSOLAPPooledSession session;
+    // Rowset of the partition being read, null between partitions
+    unique_ptr<MSOLAPRowset> rowset;
+    // Bytes of the rowset already added to the scan progress
+    idx_t rowset_bytes;
+    // Whether the rowset returns exactly the output columns with the output types, so it is read straight into
+    // the output. Otherwise its rows are read into chunk, with the types the server reports, and cast.
+    bool direct;
+    // Columns of the rowset: all columns of the query if it could not be rewritten to return the projected ones
+    // only, or the projected columns of other types than the bound ones (the model changed since the bind,
+    // variant columns of an attached model). Set up again for every rowset whose types differ.
+    DataChunk chunk;
+    // Pushed down filters, applied to the rows the server returned
+    unique_ptr<Expression> filter_expression;
+    unique_ptr<ExpressionExecutor> filter_executor;
+    SelectionVector filter_sel;
+    // Dictionary of every text column of the output, null for other columns
+    std::vector<unique_ptr<MSOLAPStringDictionary>> dictionaries;
     bool done;
     
-    MSOLAPLocalState() : rowset(nullptr), accessor(nullptr), haccessor(NULL), 
-                        bindings(nullptr), row_data(nullptr), row_size(0), done(false) {}
+    MSOLAPLocalState() : rowset_bytes(0), direct(false), filter_sel(STANDARD_VECTOR_SIZE), done(false) {}
     
     ~MSOLAPLocalState() {
-        // Clean up resources
-        if (row_data) {
-            delete[] row_data;
-            row_data = nullptr;
-        }
-        
-        if (bindings) {
-            CoTaskMemFree(bindings);
-            bindings = nullptr;
-        }
-        
-        if (accessor && haccessor) {
-            accessor->ReleaseAccessor(haccessor, NULL);
-            haccessor = NULL;
-        }
-        
-        if (accessor) {
-            MSOLAPUtils::SafeRelease(&accessor);
-        }
-        
-        if (rowset) {
-            MSOLAPUtils::SafeRelease(&rowset);
-        }
+        // Release the rowset before the session it was read from goes back to the pool
+        rowset.reset();
+        session.Release();
     }
 };
 
 struct MSOLAPGlobalState : public GlobalTableFunctionState {
     idx_t max_threads;
+    // Query of every partition
+    std::vector<std::string> queries;
+    // Columns requested by DuckDB and whether the queries return exactly those (projection pushdown)
+    std::vector<column_t> column_ids;
+    bool projected;
+    // Result cache key of every partition query, empty while the cache is disabled
+    std::vector<std::string> cache_keys;
+    // Chunks read ahead of the scan by the I/O scheduler, 0 reads on the scan thread
+    idx_t prefetch_chunks;
+    // Rowset of every partition, shared with the scans of the same queries in progress, and the results they
+    // read. Empty if not shared.
+    std::vector<unique_ptr<MSOLAPRowset>> shared_rowsets;
+    std::vector<shared_ptr<MSOLAPSharedResult>> shared_results;
+    // Next partition to be picked up by a thread
+    std::atomic<idx_t> next_partition;
+    // Rows and bytes read so far, listed by msolap_scans() while the scan runs
+    shared_ptr<MSOLAPScanProgress> progress;
     
-    explicit MSOLAPGlobalState(idx_t max_threads) : max_threads(max_threads) {}
+    explicit MSOLAPGlobalState(idx_t max_threads)
+        : max_threads(max_threads), projected(false), prefetch_chunks(0), next_partition(0) {}
+
+    ~MSOLAPGlobalState() override {
+        if (progress) {
+            MSOLAPScanRegistry::Get().Unregister(*progress);
+        }
+    }
     
     idx_t MaxThreads() const override {
         return max_threads;
@@ -78,4 +128,4 @@ public:
     MSOLAPScanFunction();
 };
 
-} // namespace duckdb
\ No newline at end of file
+} // namespace duckdb
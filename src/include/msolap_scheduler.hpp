@@ -0,0 +1,198 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_scheduler.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "msolap_session.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace duckdb {
+
+class MSOLAPIOScheduler;
+
+// Marks the DuckDB query the current thread scans for while the scope lives. Scan threads waiting for the I/O
+// threads or for another scan wake up every WAIT_POLL_INTERVAL milliseconds to check whether it was interrupted,
+// so an interrupted query does not wait for the server.
+class MSOLAPInterruptScope {
+public:
+    static constexpr idx_t WAIT_POLL_INTERVAL = 100;
+
+    explicit MSOLAPInterruptScope(ClientContext &context);
+    ~MSOLAPInterruptScope();
+
+    MSOLAPInterruptScope(const MSOLAPInterruptScope &) = delete;
+    MSOLAPInterruptScope &operator=(const MSOLAPInterruptScope &) = delete;
+
+    // Throws if the query of the current thread was interrupted, does nothing outside a scope
+    static void Check();
+    // Wait for changed to be notified, for WAIT_POLL_INTERVAL at most, then check for an interrupt
+    static void Wait(std::unique_lock<std::mutex> &guard, std::condition_variable &changed);
+
+private:
+    ClientContext *previous;
+};
+
+// Cancels a query from another thread than the one running it. That thread registers the session it executes the
+// query on, and unregisters it before the session is released.
+class MSOLAPCancellation {
+public:
+    // Cancel the query of the registered session, or of the session registered next
+    void Cancel();
+
+    // Register the session running the query, null unregisters it. Throws if the query was already cancelled.
+    void SetSession(MSOLAPSession *session);
+
+private:
+    std::mutex lock;
+    MSOLAPSession *session = nullptr;
+    bool cancelled = false;
+};
+
+// Ring of chunks handed from one producer thread to one consumer thread without locks. The consumer keeps the
+// chunk at the front until it pops it, the producer fills the others.
+class MSOLAPChunkQueue {
+public:
+    explicit MSOLAPChunkQueue(idx_t capacity);
+
+    // Set up the chunks, by the producer before the first push
+    void Initialize(Allocator &allocator, const vector<LogicalType> &types);
+
+    // Producer: chunk to fill next, null while the queue is full
+    DataChunk *Back();
+    void Push();
+
+    // Consumer: oldest chunk pushed, null while the queue is empty
+    DataChunk *Front();
+    void Pop();
+
+private:
+    std::vector<unique_ptr<DataChunk>> chunks;
+    // Chunks pushed and popped so far, each written by one side only
+    std::atomic<idx_t> pushed;
+    std::atomic<idx_t> popped;
+};
+
+// A rowset read by the I/O scheduler on behalf of a scan. The query is executed and its chunks are fetched on
+// I/O threads, up to a number of chunks ahead of the scan, which takes them from a queue.
+class MSOLAPIOStream : public enable_shared_from_this<MSOLAPIOStream> {
+public:
+    // Executes the query, called on an I/O thread. The rowset owns whatever it is read from (e.g. its session),
+    // which is registered with the cancellation while the query runs. Returns null if it cannot start yet (all
+    // sessions of the data source are in use), retry is then to be called once it is worth calling open again.
+    // While the scan waits for the query, open is also called again every OPEN_RETRY_INTERVAL milliseconds, so it
+    // can give up after a while.
+    using OpenFunction = std::function<unique_ptr<MSOLAPRowset>(MSOLAPCancellation &cancellation,
+                                                                const std::function<void()> &retry)>;
+
+    static constexpr idx_t OPEN_RETRY_INTERVAL = 1000;
+
+    MSOLAPIOStream(OpenFunction open, idx_t chunk_count);
+
+    // Wait until the query has been executed. The waits block the scan thread, a DuckDB 1.4 table function cannot
+    // yield it to the pipeline and an empty chunk would end the scan, but they stop once the query is interrupted.
+    void GetColumnInfo(std::vector<std::string> &names, std::vector<LogicalType> &types);
+    // Wait for the next chunk, null once the rowset is exhausted. The chunk stays valid until the next call.
+    DataChunk *Next();
+    idx_t GetBytesRead() const {
+        return bytes_read;
+    }
+    // The scan is done with the stream: a query still running on the server is cancelled, the I/O thread closes
+    // the rowset
+    void Cancel();
+
+private:
+    friend class MSOLAPIOScheduler;
+
+    // Open the rowset, read one chunk or close the rowset, on an I/O thread
+    void Step();
+    // Whether Step has something to do now
+    bool IsRunnable();
+    bool IsDone() const {
+        return done;
+    }
+    // Let the I/O threads go on after the scan made room in the queue or cancelled
+    void Resume();
+    // Wake up the scan waiting for the stream
+    void Notify();
+
+    OpenFunction open;
+    MSOLAPCancellation cancellation;
+    unique_ptr<MSOLAPRowset> source;
+    MSOLAPChunkQueue queue;
+    std::vector<std::string> names;
+    std::vector<LogicalType> types;
+    // Consumer only: the front chunk of the queue was handed out
+    bool holding;
+    // Open has to be called again once it calls back
+    std::atomic<bool> waiting;
+    // Query executed, result exhausted or failed, scan done with the stream, rowset closed
+    std::atomic<bool> opened;
+    std::atomic<bool> finished;
+    std::atomic<bool> cancelled;
+    std::atomic<bool> done;
+    std::exception_ptr error;
+    std::atomic<idx_t> bytes_read;
+    // Only used to sleep while the queue is empty
+    std::mutex lock;
+    std::condition_variable changed;
+
+    // Set by the scheduler: whether the stream waits for room in the queue
+    MSOLAPIOScheduler *scheduler;
+    std::atomic<bool> parked;
+};
+
+// Process-wide pool of I/O threads executing the DAX queries of all scans and reading their results. Streams
+// take turns, one step (executing the query or reading one chunk) at a time, on whichever thread is free: a
+// thread waiting for the server only holds up its own stream, and a large extract does not hold up the other
+// scans. Streams whose queue is full wait until the scan takes a chunk. The threads are in the multithreaded COM
+// apartment, so a session can be read on another thread than the one that executed its query.
+class MSOLAPIOScheduler {
+public:
+    // Default of the msolap_io_threads setting
+    static constexpr idx_t DEFAULT_THREADS = 8;
+
+    static MSOLAPIOScheduler &Get();
+
+    explicit MSOLAPIOScheduler(idx_t thread_count);
+    ~MSOLAPIOScheduler();
+
+    // Threads executing steps at the same time, i.e. queries waiting for the server at most. Threads beyond it
+    // finish their step and then idle.
+    void SetThreadCount(idx_t thread_count);
+
+    // Start reading the stream
+    void Schedule(const shared_ptr<MSOLAPIOStream> &stream);
+
+private:
+    friend class MSOLAPIOStream;
+
+    void Work(idx_t index);
+    // Queue a stream for its next turn, starting a thread if none is free, lock must be held
+    void Enqueue(shared_ptr<MSOLAPIOStream> stream);
+    // Queue a parked stream for its next turn
+    void Resume(const shared_ptr<MSOLAPIOStream> &stream);
+
+    std::mutex lock;
+    std::condition_variable wakeup;
+    std::vector<std::thread> threads;
+    // Streams waiting for their turn, a stream that is parked or running is not listed
+    std::deque<shared_ptr<MSOLAPIOStream>> runnable;
+    // Threads waiting for a stream
+    idx_t idle;
+    idx_t thread_count;
+    bool stopped;
+};
+
+} // namespace duckdb
@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_schema_cache.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace duckdb {
+
+// Process-wide cache of the result columns of DAX queries, keyed by normalized connection string and query, so
+// binding a query seen recently (prepared statements, dashboards, DESCRIBE) does not ask the server again.
+// Entries expire after a while and are dropped as soon as the model is seen to have been refreshed: the version of
+// the model is checked whenever a query is described, and by scans while the result cache is enabled.
+class MSOLAPSchemaCache {
+public:
+    // Default of the msolap_schema_ttl setting, in seconds
+    static constexpr idx_t DEFAULT_TTL = 300;
+    // Queries kept per data source, expired ones are dropped first beyond it
+    static constexpr idx_t MAX_ENTRIES = 1024;
+
+    static MSOLAPSchemaCache &Get();
+
+    // Seconds schemas are reused for, 0 disables the cache
+    void SetTTL(idx_t seconds);
+
+    // Column names and types of the result of a query, from the cache or described by the server
+    void DescribeQuery(const std::string &connection_string, const std::string &dax_query,
+                       std::vector<std::string> &names, std::vector<LogicalType> &types);
+
+    // Forget the columns of a query, e.g. after its result turned out to differ
+    void Invalidate(const std::string &connection_string, const std::string &dax_query);
+    // Forget the columns of all queries of a data source
+    void Invalidate(const std::string &connection_string);
+    // Last refresh of the model as reported by the server, a different one invalidates the data source
+    void SetModelVersion(const std::string &connection_string, const std::string &model_version);
+
+private:
+    MSOLAPSchemaCache();
+
+    struct SchemaEntry {
+        std::vector<std::string> names;
+        std::vector<LogicalType> types;
+        std::chrono::steady_clock::time_point loaded;
+    };
+
+    struct DataSource {
+        std::string model_version;
+        // The server failed to tell the model version when it was last asked
+        bool version_unknown = false;
+        std::chrono::steady_clock::time_point version_checked;
+        // Keyed by query text
+        std::unordered_map<std::string, SchemaEntry> queries;
+    };
+
+    // Make room for a new entry, lock must be held
+    void EvictEntries(DataSource &source);
+
+    std::mutex lock;
+    // Keyed by normalized connection string
+    std::map<std::string, DataSource> sources;
+    std::chrono::seconds ttl;
+};
+
+} // namespace duckdb
@@ -0,0 +1,69 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_session.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include <string>
+#include <memory>
+
+namespace duckdb {
+
+// Forward-only result of a DAX query, independent of the transport that produced it
+class MSOLAPRowset {
+public:
+    virtual ~MSOLAPRowset() = default;
+
+    // Get the DAX column names (e.g. "Sales[Year]") and DuckDB types of the result
+    virtual void GetColumnInfo(std::vector<std::string> &names, std::vector<LogicalType> &types) = 0;
+
+    // Fill the output chunk with the next batch of rows, returns 0 once the result is exhausted
+    virtual idx_t Fetch(DataChunk &output) = 0;
+
+    // Bytes of the response received so far, 0 if the transport does not tell
+    virtual idx_t GetBytesRead() const {
+        return 0;
+    }
+};
+
+// An open session against an Analysis Services data source
+class MSOLAPSession {
+public:
+    virtual ~MSOLAPSession() = default;
+
+    // Execute a DAX query and return its result
+    virtual unique_ptr<MSOLAPRowset> ExecuteQuery(const std::string &dax_query) = 0;
+
+    // Get the DAX column names and DuckDB types a DAX query would return, without evaluating it
+    virtual void DescribeQuery(const std::string &dax_query, std::vector<std::string> &names,
+                               std::vector<LogicalType> &types) = 0;
+
+    // Check if session is open
+    virtual bool IsOpen() const = 0;
+
+    // Check the server still accepts requests of the session with a cheap round trip, throws if it doesn't
+    virtual void Ping() = 0;
+
+    // Check if the session can be used by other threads, and therefore be kept in the connection pool
+    virtual bool IsPoolable() const {
+        return true;
+    }
+
+    // Abort the query the session is executing or reading the result of, called from another thread. The blocked
+    // call fails, and the session is closed rather than reused afterwards.
+    virtual void Cancel() = 0;
+
+    // Close session
+    virtual void Close() = 0;
+
+    // Open a session for a connection string. "Data Source=http(s)://..." uses the XMLA transport,
+    // anything else goes through the MSOLAP OLE DB provider (Windows only)
+    static unique_ptr<MSOLAPSession> Open(const std::string &connection_string);
+};
+
+} // namespace duckdb
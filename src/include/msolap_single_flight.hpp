@@ -0,0 +1,184 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_single_flight.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "msolap_session.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+
+namespace duckdb {
+
+class FileHandle;
+class FileSystem;
+
+// Result of a DAX query read once for all the scans running it at the same time. The chunks read are kept in a
+// spool every scan reads at its own pace; whichever scan needs a chunk no one has read yet fetches it.
+// Scans can join while the spool still holds the whole result read so far (up to MAX_SPOOL_CHUNKS chunks), and
+// once it is complete, scans of the client context that started it (the other side of a self join starts after
+// the first side is done). Beyond that, chunks are freed once every scan is past them, and scans that have not
+// started reading yet run the query on their own instead of keeping the spool growing. The spool never holds
+// more than MAX_SPOOL_CHUNKS chunks in memory: a scan that needs the next chunk while it is full moves the oldest
+// one to a file in the DuckDB temporary directory, which the scans furthest behind read it from. Those cannot run
+// the query again and skip what they read, the server may return the rows in another order or the model may have
+// been refreshed, and no scan waits for them. Without a temporary directory (or if the file cannot be written) the
+// chunks stay in memory.
+class MSOLAPSharedResult {
+public:
+    using OpenFunction = std::function<unique_ptr<MSOLAPRowset>()>;
+
+    static constexpr idx_t MAX_SPOOL_CHUNKS = 64;
+
+    MSOLAPSharedResult(ClientContext &context, OpenFunction open);
+    // Removes the spill file
+    ~MSOLAPSharedResult();
+
+    // Add a scan reading from the first chunk, false if the result cannot be joined anymore
+    bool Subscribe(ClientContext &context, idx_t &subscriber);
+    void Unsubscribe(idx_t subscriber);
+
+    // Column info of the result, executing the query if needed. False if the scan has to run the query itself.
+    bool GetColumnInfo(idx_t subscriber, std::vector<std::string> &names, std::vector<LogicalType> &types);
+    // Reference the next chunk of the scan in output, returns 0 once the result is exhausted. Sets detached if
+    // the scan has to run the query itself, which only happens before it read anything. Chunks of the spill file
+    // are read into buffer, which the scan keeps for the next ones.
+    idx_t Fetch(idx_t subscriber, DataChunk &output, std::vector<data_t> &buffer, bool &detached);
+    idx_t GetBytesRead() const {
+        return bytes_read;
+    }
+    const OpenFunction &GetOpenFunction() const {
+        return open;
+    }
+    // Number of chunks moved to the spill file so far
+    idx_t GetSpilledChunks() const {
+        return spilled_chunks;
+    }
+
+private:
+    // Cursor of a scan that left or was detached
+    static constexpr idx_t RELEASED = DConstants::INVALID_INDEX;
+
+    // Position of a chunk in the spill file
+    struct SpilledChunk {
+        idx_t offset;
+        idx_t size;
+    };
+
+    // Execute the query (if not yet) and read the next chunk into the spool, as the only reader of the source.
+    // The lock is released meanwhile.
+    void ReadNext(std::unique_lock<std::mutex> &guard);
+    // Make room for the next chunk in a full spool: the result cannot be joined anymore, the scans that have not
+    // read anything yet are detached. False if the scans furthest behind still need all the chunks, lock must be
+    // held.
+    bool MakeRoom();
+    // Move the oldest chunk of the spool to the spill file, false if it stays in memory. As the only reader of the
+    // source, the lock is released while the chunk is written.
+    bool Spill(std::unique_lock<std::mutex> &guard);
+    // Reference a chunk of the spill file in output, the lock is released while it is read
+    void ReadSpilled(std::unique_lock<std::mutex> &guard, idx_t chunk, std::vector<data_t> &buffer,
+                     DataChunk &output);
+    // Forget the spilled chunks and remove the spill file, once no scan reads or writes it anymore. Lock must be
+    // held.
+    void CloseSpill();
+    // Free the chunks all scans are past once the result cannot be joined anymore, lock must be held
+    void Trim();
+
+    // Only compared, the context may be gone
+    const ClientContext *owner;
+    OpenFunction open;
+    unique_ptr<MSOLAPRowset> source;
+    std::vector<std::string> names;
+    std::vector<LogicalType> types;
+    bool opened;
+    // A scan is executing the query or reading the next chunk
+    bool reading;
+    bool finished;
+    bool joinable;
+    std::exception_ptr error;
+    // Chunk number of the front of the spool, and the next chunk of every scan. The chunk being spilled is
+    // referenced until it is written.
+    std::deque<shared_ptr<DataChunk>> spool;
+    idx_t spool_start;
+    std::vector<idx_t> cursors;
+    std::atomic<idx_t> bytes_read;
+    // Chunks moved out of the spool while a scan still needed them, chunk numbers spill_start up to spool_start.
+    // The file is removed once every scan is past them and no scan reads or writes it (spill_io).
+    std::string spill_directory;
+    unique_ptr<FileSystem> fs;
+    std::string spill_path;
+    unique_ptr<FileHandle> spill_file;
+    std::vector<SpilledChunk> spilled;
+    idx_t spill_start;
+    idx_t spill_size;
+    idx_t spill_io;
+    std::atomic<idx_t> spilled_chunks;
+    std::mutex lock;
+    std::condition_variable changed;
+};
+
+// Scan of a shared result
+class MSOLAPSharedRowset : public MSOLAPRowset {
+public:
+    MSOLAPSharedRowset(shared_ptr<MSOLAPSharedResult> result, idx_t subscriber);
+    ~MSOLAPSharedRowset() override;
+
+    // Null once the scan runs the query on its own
+    shared_ptr<MSOLAPSharedResult> GetResult() const {
+        return result;
+    }
+
+    void GetColumnInfo(std::vector<std::string> &names, std::vector<LogicalType> &types) override;
+    // Output references the chunk in the spool
+    idx_t Fetch(DataChunk &output) override;
+    idx_t GetBytesRead() const override;
+
+private:
+    // Run the query on its own, before reading any row of the shared result
+    void Detach();
+
+    shared_ptr<MSOLAPSharedResult> result;
+    idx_t subscriber;
+    // Chunks read from the spill file
+    std::vector<data_t> spill_buffer;
+    unique_ptr<MSOLAPRowset> own;
+};
+
+// Process-wide registry of the results being read, keyed by normalized connection string and query, so scans
+// of the same query at the same time (a dashboard refreshing on many connections, the same msolap() twice in a
+// query) are evaluated by the server once.
+class MSOLAPSingleFlight {
+public:
+    static MSOLAPSingleFlight &Get();
+
+    // Rowset reading the result of the query, shared with the scans of the same query still in progress. open
+    // executes the query, when the first chunk is read.
+    unique_ptr<MSOLAPSharedRowset> Join(ClientContext &context, const std::string &connection_string,
+                                        const std::string &dax_query, MSOLAPSharedResult::OpenFunction open);
+    // Rowset reading the result of the query if a scan in progress shares it, null otherwise
+    unique_ptr<MSOLAPSharedRowset> TryJoin(ClientContext &context, const std::string &connection_string,
+                                           const std::string &dax_query);
+
+private:
+    MSOLAPSingleFlight() = default;
+
+    static std::string MakeKey(const std::string &connection_string, const std::string &dax_query);
+    // Join the result of key if it is still read, lock must be held
+    unique_ptr<MSOLAPSharedRowset> TryJoinLocked(ClientContext &context, const std::string &key);
+
+    std::mutex lock;
+    // Results nobody reads anymore have expired, they are removed by the next Join
+    std::map<std::string, weak_ptr<MSOLAPSharedResult>> results;
+};
+
+} // namespace duckdb
@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_statistics.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "msolap_scanner.hpp"
+#include <chrono>
+#include <map>
+#include <mutex>
+
+namespace duckdb {
+
+// No ranges: DuckDB treats a min/max as a guarantee and skips filters outside of it, which a model refreshed while
+// the statistics are cached would break. Counts are estimates only, a stale one just gives a worse plan.
+struct MSOLAPColumnStatistics {
+    idx_t distinct_count = 0;
+};
+
+// Statistics of a model table
+struct MSOLAPTableStatistics {
+    idx_t row_count = 0;
+    // Keyed by column name as reported by the server (Table[Column]), empty unless distinct counts are enabled and
+    // the server lets the storage DMVs be read
+    case_insensitive_map_t<MSOLAPColumnStatistics> columns;
+};
+
+// Process-wide cache of model table statistics for the optimizer, keyed by normalized connection string and table.
+// They are read from the storage DMVs, the row count of the table and the size of the dictionary of every column,
+// which the server keeps anyway, and kept for a short while, so planning a query does not cost a round trip for every
+// scan. Without rights to read the DMVs only the row count is read, with a COUNTROWS query.
+class MSOLAPStatisticsCache {
+public:
+    // Defaults of the msolap_statistics_ttl (seconds) and msolap_statistics_distinct_counts settings
+    static constexpr idx_t DEFAULT_TTL = 60;
+    static constexpr bool DEFAULT_DISTINCT_COUNTS = true;
+
+    static MSOLAPStatisticsCache &Get();
+
+    // Statistics of the model table a scan reads, null for other queries or if the server cannot provide them.
+    // The settings are those of the connection planning the query: statistics older than its msolap_statistics_ttl
+    // are read again, and with msolap_statistics_distinct_counts the distinct count of every column too.
+    shared_ptr<MSOLAPTableStatistics> GetStatistics(ClientContext &context, const MSOLAPBindData &bind_data);
+
+private:
+    MSOLAPStatisticsCache();
+
+    // Statistics read for a table, null if the server had none
+    struct CacheEntry {
+        shared_ptr<MSOLAPTableStatistics> statistics;
+        bool distinct_counts = false;
+        std::chrono::steady_clock::time_point loaded;
+    };
+
+    static shared_ptr<MSOLAPTableStatistics> Load(const std::string &connection_string,
+                                                  const std::string &model_table, bool distinct_counts);
+    // From DISCOVER_STORAGE_TABLES and DISCOVER_STORAGE_TABLE_COLUMNS, null if they do not list the table
+    static shared_ptr<MSOLAPTableStatistics> LoadStorage(MSOLAPSession &session, const std::string &model_table,
+                                                         bool distinct_counts);
+    static shared_ptr<MSOLAPTableStatistics> LoadRowCount(MSOLAPSession &session, const std::string &model_table);
+
+    std::mutex lock;
+    std::map<std::string, CacheEntry> entries;
+};
+
+} // namespace duckdb
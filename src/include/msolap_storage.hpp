@@ -0,0 +1,28 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_storage.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/storage/storage_extension.hpp"
+
+namespace duckdb {
+
+// ATTACH 'Data Source=...;Catalog=...' AS m (TYPE msolap): the tables of a model as a read-only catalog
+class MSOLAPStorageExtension : public StorageExtension {
+public:
+    MSOLAPStorageExtension();
+};
+
+// msolap_catalog_refresh(catalog): read the tables of an attached model again, returns their number
+class MSOLAPCatalogRefreshFunction : public TableFunction {
+public:
+    MSOLAPCatalogRefreshFunction();
+};
+
+} // namespace duckdb
@@ -0,0 +1,43 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_stream.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include <string>
+
+namespace duckdb {
+
+// Forward-only source of bytes, e.g. the body of an XMLA response
+class MSOLAPInputStream {
+public:
+    virtual ~MSOLAPInputStream() = default;
+
+    // Read up to length bytes into buffer, returns 0 at the end of the stream
+    virtual idx_t Read(char *buffer, idx_t length) = 0;
+};
+
+// Input stream over an in-memory document
+class MSOLAPStringStream : public MSOLAPInputStream {
+public:
+    explicit MSOLAPStringStream(std::string data_p) : data(std::move(data_p)), position(0) {
+    }
+
+    idx_t Read(char *buffer, idx_t length) override {
+        idx_t count = MinValue<idx_t>(length, data.size() - position);
+        memcpy(buffer, data.c_str() + position, count);
+        position += count;
+        return count;
+    }
+
+private:
+    std::string data;
+    idx_t position;
+};
+
+} // namespace duckdb
@@ -0,0 +1,28 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_utf16.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/common/typedefs.hpp"
+#include <cstdint>
+
+namespace duckdb {
+
+// UTF-16LE to UTF-8 transcoding of the strings servers send. Runs of ASCII, the bulk of model text, are
+// narrowed 8 code units at a time with SSE2 or NEON where available, everything else takes the scalar path.
+// Unpaired surrogates become U+FFFD. Only depends on DuckDB's typedefs, so it can be benchmarked on its own.
+class MSOLAPUTF16 {
+public:
+    // Exact number of UTF-8 bytes length code units convert to
+    static idx_t GetUTF8Length(const uint8_t *data, idx_t length);
+
+    // Convert length code units into target, which must hold GetUTF8Length bytes. Returns the bytes written.
+    static idx_t ToUTF8(const uint8_t *data, idx_t length, char *target);
+};
+
+} // namespace duckdb
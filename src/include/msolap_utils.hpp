@@ -9,11 +9,14 @@
 #pragma once
 
 #include "duckdb.hpp"
+#include "duckdb/common/case_insensitive_map.hpp"
+#ifdef _WIN32
 #include <windows.h>
 #include <oledb.h>
 #include <oledberr.h>
 #include <comdef.h>
 #include "duckdb/common/windows_util.hpp"
+#endif
 
 namespace duckdb {
 
@@ -21,17 +24,31 @@ class MSOLAPUtils {
 public:
 
     // Sanitize column names - replace brackets with underscores
-    static std::string SanitizeColumnName(const std::wstring &name);
-    
-    // Convert VARIANT to DuckDB Value
-    static Value ConvertVariantToValue(VARIANT* pVar);
-    
-    // Get DuckDB LogicalType from DBTYPE
-    static LogicalType GetLogicalTypeFromDBTYPE(DBTYPE type);
-    
+    static std::string SanitizeColumnName(const std::string &name);
+
+    // Parse a "Key=Value;Key=Value" connection string, keys are case insensitive. Values may be quoted with " or ',
+    // throws for an unterminated quote.
+    static case_insensitive_map_t<std::string> ParseConnectionString(const std::string &connection_string);
+
+    // Check if a Data Source points to an XMLA HTTP endpoint (e.g. http://server/olap/msmdpump.dll)
+    static bool IsHTTPDataSource(const std::string &data_source);
+
+    // Get DuckDB LogicalType from the XSD type of an XMLA rowset column (e.g. "xsd:long")
+    static LogicalType GetLogicalTypeFromXSDType(const std::string &type);
+
+    // Append a code point as UTF-8
+    static void AppendUTF8(uint32_t code_point, std::string &target);
+
+    // Append length UTF-16LE code units as UTF-8, unpaired surrogates become U+FFFD
+    static void AppendUTF16(const uint8_t *data, idx_t length, std::string &target);
+
+#ifdef _WIN32
+    // Get DuckDB LogicalType from DBTYPE, with the precision and scale of DECIMAL and NUMERIC columns
+    static LogicalType GetLogicalTypeFromDBTYPE(DBTYPE type, BYTE precision, BYTE scale);
+
     // Get error message from HRESULT
     static std::string GetErrorMessage(HRESULT hr);
-    
+
     // Helper to safely release COM interfaces
     template <class T>
     static void SafeRelease(T** ppT) {
@@ -40,13 +57,7 @@ public:
             *ppT = NULL;
         }
     }
+#endif
 };
 
-// Structure for column data when using variants
-struct ColumnData {
-    DBSTATUS dwStatus;
-    DBLENGTH dwLength;
-    VARIANT var;
-};
-
-} // namespace duckdb
\ No newline at end of file
+} // namespace duckdb
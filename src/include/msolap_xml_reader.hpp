@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_xml_reader.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "msolap_stream.hpp"
+#include <string>
+#include <memory>
+#include <vector>
+
+namespace duckdb {
+
+enum class XMLNodeType : uint8_t { START_ELEMENT, END_ELEMENT, TEXT, END_OF_DOCUMENT };
+
+struct XMLAttribute {
+    // Local name of the attribute, namespace prefix stripped
+    std::string name;
+    std::string value;
+};
+
+// Pull reader over the nodes of an XMLA response document. Element and attribute names are reported
+// without their namespace prefix, empty elements (<a/>) as a start followed by an end element.
+class MSOLAPXMLReader {
+public:
+    virtual ~MSOLAPXMLReader() = default;
+
+    // Advance to the next node
+    virtual XMLNodeType Next() = 0;
+
+    // Local name of the current start/end element
+    const std::string &Name() const {
+        return name;
+    }
+
+    // Decoded text of the current text node
+    const std::string &Text() const {
+        return text;
+    }
+
+    // Attribute of the current start element, nullptr if it is not present
+    const std::string *GetAttribute(const std::string &attribute_name) const;
+
+    // Read the text content of the current start element and advance past its end element
+    std::string ReadElementText();
+    // Same as above, reusing the storage of result
+    void ReadElementText(std::string &result);
+
+    // Skip the current start element including all of its children
+    void SkipElement();
+
+    // Decode XML entities (&lt; &#x41; ...) and append the result to target
+    static void DecodeEntities(const char *data, idx_t length, std::string &target);
+
+    // Decode XMLA encoded names (_x005B_ -> '[')
+    static std::string DecodeName(const std::string &encoded);
+
+protected:
+    MSOLAPXMLReader() : attribute_count(0) {
+    }
+
+    // Start collecting the attributes of a new start element
+    void ClearAttributes() {
+        attribute_count = 0;
+    }
+    // Add an attribute to the current start element, reusing the storage of previous elements
+    XMLAttribute &AddAttribute();
+
+    std::string name;
+    std::string text;
+    std::vector<XMLAttribute> attributes;
+    idx_t attribute_count;
+};
+
+// Incremental parser for the subset of textual XML produced by XMLA servers (no DTDs, no external entities).
+// Bytes are pulled from the input stream only as far as needed to produce the next node, so memory
+// stays bounded by the largest single tag or text node.
+class MSOLAPTextXMLReader : public MSOLAPXMLReader {
+public:
+    explicit MSOLAPTextXMLReader(MSOLAPInputStream &stream);
+
+    XMLNodeType Next() override;
+
+private:
+    // Pull more bytes from the stream into the buffer, returns false at the end of the stream
+    bool Fill();
+    // Position of the next occurrence of needle at or after offset, pulling bytes as needed
+    idx_t Find(const char *needle, idx_t offset);
+    // Make sure at least count bytes are buffered after pos, returns false if the stream ends first
+    bool Ensure(idx_t count);
+    bool StartsWith(const char *prefix);
+
+    void ParseStartElement();
+    void ParseEndElement();
+    void SkipUntil(const char *terminator);
+    // Parse a name at pos into target, without its namespace prefix
+    void ParseName(std::string &target);
+    void SkipWhitespace();
+
+    MSOLAPInputStream &stream;
+    // Window of the document, bytes before pos have been consumed
+    std::unique_ptr<char[]> buffer;
+    idx_t buffer_capacity;
+    idx_t buffer_end;
+    idx_t pos;
+    bool eof;
+    bool pending_end;
+};
+
+} // namespace duckdb
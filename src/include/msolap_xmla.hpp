@@ -0,0 +1,139 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_xmla.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "msolap_session.hpp"
+#include "msolap_http.hpp"
+#include "msolap_xml_reader.hpp"
+#include "msolap_xpress.hpp"
+#include "msolap_column_writer.hpp"
+#include <string>
+#include <memory>
+#include <unordered_map>
+
+namespace duckdb {
+
+class XMLARowset;
+
+// Portable XMLA (SOAP over HTTP) session, e.g. against msmdpump.dll or any XMLA 1.1 endpoint
+class XMLAConnection : public MSOLAPSession {
+public:
+    // Defaults of the Connect Timeout and Timeout connection properties, in seconds
+    static constexpr idx_t DEFAULT_CONNECT_TIMEOUT = 60;
+    static constexpr idx_t DEFAULT_TIMEOUT = 3600;
+
+    XMLAConnection();
+    ~XMLAConnection() override;
+
+    // Disable copy constructors
+    XMLAConnection(const XMLAConnection &other) = delete;
+    XMLAConnection &operator=(const XMLAConnection &) = delete;
+
+    // Enable move constructors
+    XMLAConnection(XMLAConnection &&other) noexcept;
+    XMLAConnection &operator=(XMLAConnection &&) noexcept;
+
+    // Connect to an XMLA endpoint using a connection string
+    static XMLAConnection Connect(const std::string &connection_string);
+
+    // Execute a DAX query and return its rowset
+    unique_ptr<MSOLAPRowset> ExecuteQuery(const std::string &dax_query) override;
+
+    // Get the result columns of a DAX query without evaluating it
+    void DescribeQuery(const std::string &dax_query, std::vector<std::string> &names,
+                       std::vector<LogicalType> &types) override;
+
+    // Check if connection is open
+    bool IsOpen() const override;
+
+    // Send a Discover request for a single property
+    void Ping() override;
+
+    // Drop the HTTP connection, the server cancels the request once it sees the client is gone
+    void Cancel() override;
+
+    // Close connection
+    void Close() override;
+
+    // Escape text for use inside an XML element or attribute
+    static std::string EscapeXML(const std::string &text);
+
+private:
+    // Parse connection string and set properties
+    void ParseConnectionString(const std::string &connection_string);
+
+    // Send an Execute request for a DAX query, content is the XMLA Content property (Schema or SchemaData)
+    unique_ptr<XMLARowset> Execute(const std::string &dax_query, const std::string &content);
+
+    // POST a SOAP envelope and read the response header, the body is left on the connection
+    MSOLAPHTTPResponse SendRequest(const std::string &soap_action, const std::string &body);
+
+    MSOLAPHTTPConnection http;
+
+    // Connection properties
+    std::string url;
+    std::string catalog;
+    std::string user;
+    std::string password;
+    // Response encodings requested from the server (Protocol Format=Binary, Transport Compression=Compressed)
+    bool binary_xml;
+    bool compression;
+    // Seconds to establish the TCP connection, and to wait for the server to accept or send data (0: no limit)
+    idx_t connect_timeout;
+    idx_t timeout;
+};
+
+// Rowset of an XMLA Execute response in the tabular (urn:schemas-microsoft-com:xml-analysis:rowset) format.
+// The response is decoded while it is received: rows are parsed straight from the HTTP body into the output
+// vectors, so at most one chunk of rows is held in memory. The rowset reads from the connection of its
+// session and has to be destroyed before the session executes the next query.
+class XMLARowset : public MSOLAPRowset {
+public:
+    // Reads the response up to the first row, content_type selects the binary and/or compressed decoding
+    XMLARowset(MSOLAPHTTPConnection &http, const std::string &content_type);
+    ~XMLARowset() override;
+
+    void GetColumnInfo(std::vector<std::string> &names, std::vector<LogicalType> &types) override;
+    idx_t Fetch(DataChunk &output) override;
+    idx_t GetBytesRead() const override {
+        return stream.GetBytesRead();
+    }
+
+private:
+    // Parse the inline XSD schema describing the row element
+    void ParseSchema();
+    // Advance to the next <row> element, returns false at the end of the rowset
+    bool NextRow();
+    // Parse the current <row> element into row of the output chunk
+    void ParseRow(DataChunk &output, idx_t row);
+    // Throw the error contained in a SOAP Fault or an XMLA Exception/Messages element
+    void ThrowError();
+
+    MSOLAPHTTPConnection &http;
+    MSOLAPHTTPBodyStream stream;
+    unique_ptr<MSOLAPXpressStream> decompressor;
+    unique_ptr<MSOLAPXMLReader> reader;
+
+    std::vector<std::string> names;
+    std::vector<LogicalType> types;
+    // XML element name of every column
+    std::vector<std::string> element_names;
+    std::unordered_map<std::string, idx_t> element_index;
+    std::vector<MSOLAPColumnWriter> writers;
+
+    // The reader is positioned inside a <row> element that has not been parsed yet
+    bool pending_row;
+    bool finished;
+    // Columns present in the row being parsed, missing elements are NULL
+    std::vector<bool> present;
+    std::string value_text;
+};
+
+} // namespace duckdb
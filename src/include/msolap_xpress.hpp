@@ -0,0 +1,43 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_xpress.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "msolap_stream.hpp"
+#include <vector>
+
+namespace duckdb {
+
+// Decompresses an XPRESS compressed XMLA response (Transport Compression=Compressed).
+// The payload is a sequence of blocks, each preceded by an 8 byte header holding the uncompressed and the
+// compressed size of the block as 32-bit little endian integers. Blocks are compressed with the plain LZ77
+// variant of [MS-XCA], a block whose compressed size equals its uncompressed size is stored as is.
+class MSOLAPXpressStream : public MSOLAPInputStream {
+public:
+    explicit MSOLAPXpressStream(MSOLAPInputStream &source);
+
+    idx_t Read(char *buffer, idx_t length) override;
+
+    // Decompress one plain LZ77 block, the output has to be filled exactly
+    static void Decompress(const uint8_t *input, idx_t input_size, uint8_t *output, idx_t output_size);
+
+private:
+    // Read exactly length bytes from the source, returns false if the source ends before the first byte
+    bool ReadExact(char *target, idx_t length);
+    // Decompress the next block, returns false at the end of the stream
+    bool NextBlock();
+
+    MSOLAPInputStream &source;
+    std::vector<uint8_t> compressed;
+    std::vector<uint8_t> block;
+    idx_t block_pos;
+    idx_t block_size;
+};
+
+} // namespace duckdb
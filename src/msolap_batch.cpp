@@ -0,0 +1,216 @@
+#include "msolap_batch.hpp"
+#include "msolap_schema_cache.hpp"
+#include "msolap_utils.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
+#include <stdexcept>
+
+namespace duckdb {
+
+static unique_ptr<FunctionData> MSOLAPBatchBind(ClientContext &context, TableFunctionBindInput &input,
+                                              vector<LogicalType> &return_types, vector<string> &names) {
+    auto result = make_uniq<MSOLAPBatchBindData>();
+    result->connection_string = input.inputs[0].GetValue<string>();
+    auto dax_query = input.inputs[1].GetValue<string>();
+    if (!MSOLAPDaxQuery::TryParse(dax_query, result->query)) {
+        throw std::runtime_error("msolap_batch needs a DAX query with a single EVALUATE statement");
+    }
+
+    for (idx_t i = 0; i < input.input_table_types.size(); i++) {
+        auto &name = input.input_table_names[i];
+        auto &type = input.input_table_types[i];
+        auto dax_type = MSOLAPDax::GetDataTableType(type);
+        if (dax_type.empty()) {
+            throw std::runtime_error("Parameter column \"" + name + "\" has type " + type.ToString() +
+                                     ", which DAX has no column type for");
+        }
+        result->parameter_columns +=
+            (i == 0 ? "" : ", ") + MSOLAPDax::QuoteString("@" + name) + ", " + dax_type;
+        result->parameter_types.push_back(type);
+    }
+
+    // Every row of the parameter table is a row context of the table expression, definitions are outside of it
+    MSOLAPDax::ReplaceParameters(result->query.define, [](const std::string &name, std::string &) -> bool {
+        throw std::runtime_error("DAX query parameter @" + name +
+                                 " is used in DEFINE, msolap_batch parameters can only be used after EVALUATE");
+    });
+    auto find_parameter = [&](const std::string &name) {
+        for (idx_t i = 0; i < input.input_table_names.size(); i++) {
+            if (StringUtil::CIEquals(input.input_table_names[i], name)) {
+                return i;
+            }
+        }
+        return DConstants::INVALID_INDEX;
+    };
+    auto table = result->query.table;
+    result->query.table = MSOLAPDax::ReplaceParameters(table, [&](const std::string &name, std::string &column) {
+        auto index = find_parameter(name);
+        if (index == DConstants::INVALID_INDEX) {
+            return false;
+        }
+        column = MSOLAPDax::QuoteColumn("@" + input.input_table_names[index]);
+        return true;
+    });
+
+    try {
+        // Described for BLANK parameters, the columns do not depend on their values
+        auto blank_query = result->query.Build(MSOLAPDax::ReplaceParameters(
+            table, [](const std::string &, std::string &blank) {
+                blank = "BLANK()";
+                return true;
+            }));
+        MSOLAPSchemaCache::Get().DescribeQuery(result->connection_string, blank_query, result->dax_names,
+                                               result->types);
+    } catch (std::exception &e) {
+        throw std::runtime_error("MSOLAP connection failed: " + string(e.what()));
+    }
+    if (result->dax_names.empty()) {
+        throw std::runtime_error("No columns found in DAX query result");
+    }
+
+    // The parameter values come first, followed by the rows of the query they produced
+    names = input.input_table_names;
+    return_types = input.input_table_types;
+    for (idx_t i = 0; i < result->dax_names.size(); i++) {
+        names.push_back(MSOLAPUtils::SanitizeColumnName(result->dax_names[i]));
+        return_types.push_back(result->types[i]);
+    }
+    return std::move(result);
+}
+
+static unique_ptr<LocalTableFunctionState>
+MSOLAPBatchInitLocal(ExecutionContext &context, TableFunctionInitInput &input, GlobalTableFunctionState *) {
+    auto result = make_uniq<MSOLAPBatchLocalState>();
+    Value batch_size;
+    result->batch_size = MSOLAPBatchFunction::DEFAULT_BATCH_SIZE;
+    if (context.client.TryGetCurrentSetting("msolap_batch_size", batch_size)) {
+        result->batch_size = MaxValue<idx_t>(batch_size.GetValue<uint64_t>(), 1);
+    }
+    return std::move(result);
+}
+
+// Add the next rows of the input to the batch, until it is full
+static void CollectRows(const MSOLAPBatchBindData &bind_data, MSOLAPBatchLocalState &state, DataChunk &input) {
+    while (state.input_offset < input.size() && state.row_count < state.batch_size) {
+        std::string row;
+        for (idx_t column = 0; column < bind_data.parameter_types.size(); column++) {
+            auto value = input.GetValue(column, state.input_offset);
+            std::string literal;
+            if (!MSOLAPDax::TryDataTableValue(value, literal)) {
+                throw std::runtime_error("Parameter value " + value.ToString() + " has no DAX representation");
+            }
+            row += (column == 0 ? "" : ", ") + literal;
+        }
+        state.rows += std::string(state.row_count == 0 ? "" : ", ") + "{" + row + "}";
+        state.row_count++;
+        state.input_offset++;
+    }
+}
+
+// Evaluate the query for the rows of the batch, which starts over
+static void SendBatch(ClientContext &context, const MSOLAPBatchBindData &bind_data, MSOLAPBatchLocalState &state) {
+    auto query = bind_data.query.Build("GENERATE(DATATABLE(" + bind_data.parameter_columns + ", {" + state.rows +
+                                       "}), " + bind_data.query.table + ")");
+    state.rows.clear();
+    state.row_count = 0;
+    try {
+        if (!state.session) {
+            state.session = MSOLAPConnectionPool::Get().Acquire(bind_data.connection_string);
+        }
+        state.rowset = state.session->ExecuteQuery(query);
+        if (state.chunk.ColumnCount() == 0) {
+            // The rows are read with the types the server reports and cast where they differ from the bound ones
+            std::vector<std::string> names;
+            std::vector<LogicalType> types;
+            state.rowset->GetColumnInfo(names, types);
+            if (types.size() != bind_data.parameter_types.size() + bind_data.types.size()) {
+                MSOLAPSchemaCache::Get().Invalidate(bind_data.connection_string);
+                throw std::runtime_error("The DAX query returned " +
+                                         std::to_string(types.size() - bind_data.parameter_types.size()) +
+                                         " columns, expected " + std::to_string(bind_data.types.size()));
+            }
+            state.chunk.Initialize(Allocator::Get(context), types);
+        }
+    } catch (std::exception &e) {
+        state.rowset.reset();
+        state.session.Invalidate();
+        throw std::runtime_error("MSOLAP batch query failed: " + string(e.what()));
+    }
+}
+
+// Fetch the next rows of the batch result into output, returns 0 once it is exhausted
+static idx_t FetchRows(ClientContext &context, MSOLAPBatchLocalState &state, DataChunk &output) {
+    state.chunk.Reset();
+    idx_t count;
+    try {
+        count = state.rowset->Fetch(state.chunk);
+    } catch (std::exception &) {
+        // The rest of the response is still pending on the session
+        state.rowset.reset();
+        state.session.Invalidate();
+        throw;
+    }
+    for (idx_t i = 0; i < output.ColumnCount(); i++) {
+        if (state.chunk.data[i].GetType() != output.data[i].GetType()) {
+            VectorOperations::Cast(context, state.chunk.data[i], output.data[i], count);
+        } else {
+            output.data[i].Reference(state.chunk.data[i]);
+        }
+    }
+    output.SetCardinality(count);
+    if (count == 0) {
+        state.rowset.reset();
+    }
+    return count;
+}
+
+static OperatorResultType MSOLAPBatchInOut(ExecutionContext &context, TableFunctionInput &data, DataChunk &input,
+                                           DataChunk &output) {
+    auto &bind_data = data.bind_data->Cast<MSOLAPBatchBindData>();
+    auto &state = data.local_state->Cast<MSOLAPBatchLocalState>();
+    while (true) {
+        // Called with the same input until it has been added to batches completely
+        if (state.rowset && FetchRows(context.client, state, output) > 0) {
+            return OperatorResultType::HAVE_MORE_OUTPUT;
+        }
+        if (state.input_offset == input.size()) {
+            state.input_offset = 0;
+            return OperatorResultType::NEED_MORE_INPUT;
+        }
+        CollectRows(bind_data, state, input);
+        if (state.row_count == state.batch_size) {
+            SendBatch(context.client, bind_data, state);
+        }
+    }
+}
+
+static OperatorFinalizeResultType MSOLAPBatchFinal(ExecutionContext &context, TableFunctionInput &data,
+                                                   DataChunk &output) {
+    auto &bind_data = data.bind_data->Cast<MSOLAPBatchBindData>();
+    auto &state = data.local_state->Cast<MSOLAPBatchLocalState>();
+    if (!state.rowset && state.row_count > 0) {
+        // The last rows of the input
+        SendBatch(context.client, bind_data, state);
+    }
+    if (state.rowset && FetchRows(context.client, state, output) > 0) {
+        return OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+    }
+    return OperatorFinalizeResultType::FINISHED;
+}
+
+static InsertionOrderPreservingMap<string> MSOLAPBatchToString(TableFunctionToStringInput &input) {
+    InsertionOrderPreservingMap<string> result;
+    auto &bind_data = input.bind_data->Cast<MSOLAPBatchBindData>();
+    result["Connection"] = MSOLAPConnectionPool::MaskConnectionString(bind_data.connection_string);
+    result["Query"] = bind_data.query.Build(bind_data.query.table);
+    return result;
+}
+
+MSOLAPBatchFunction::MSOLAPBatchFunction()
+    : TableFunction("msolap_batch", {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::TABLE}, nullptr,
+                    MSOLAPBatchBind, nullptr, MSOLAPBatchInitLocal) {
+    in_out_function = MSOLAPBatchInOut;
+    in_out_function_final = MSOLAPBatchFinal;
+    to_string = MSOLAPBatchToString;
+}
+
+} // namespace duckdb
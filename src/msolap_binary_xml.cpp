@@ -0,0 +1,452 @@
+#include "msolap_binary_xml.hpp"
+#include "msolap_utils.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <cstdio>
+
+namespace duckdb {
+
+static constexpr idx_t BINXML_READ_SIZE = 64 * 1024;
+
+// Markup tokens
+static constexpr uint8_t BINXML_XMLDECL = 0xFE;
+static constexpr uint8_t BINXML_ENCODING = 0xFD;
+static constexpr uint8_t BINXML_ELEMENT = 0xF8;
+static constexpr uint8_t BINXML_END_ELEMENT = 0xF7;
+static constexpr uint8_t BINXML_ATTRIBUTE = 0xF6;
+static constexpr uint8_t BINXML_END_ATTRIBUTES = 0xF5;
+static constexpr uint8_t BINXML_PI = 0xF4;
+static constexpr uint8_t BINXML_COMMENT = 0xF3;
+static constexpr uint8_t BINXML_CDATA = 0xF2;
+static constexpr uint8_t BINXML_CDATA_END = 0xF1;
+static constexpr uint8_t BINXML_NAMEDEF = 0xF0;
+static constexpr uint8_t BINXML_QNAMEDEF = 0xEF;
+static constexpr uint8_t BINXML_END_NEST = 0xED;
+static constexpr uint8_t BINXML_NEST = 0xEC;
+static constexpr uint8_t BINXML_EXTENSION = 0xEA;
+static constexpr uint8_t BINXML_FLUSH_NAMES = 0xE9;
+
+// Atom tokens
+static constexpr uint8_t BINXML_SQL_SMALLINT = 0x01;
+static constexpr uint8_t BINXML_SQL_INT = 0x02;
+static constexpr uint8_t BINXML_SQL_REAL = 0x03;
+static constexpr uint8_t BINXML_SQL_FLOAT = 0x04;
+static constexpr uint8_t BINXML_SQL_MONEY = 0x05;
+static constexpr uint8_t BINXML_SQL_BIT = 0x06;
+static constexpr uint8_t BINXML_SQL_TINYINT = 0x07;
+static constexpr uint8_t BINXML_SQL_BIGINT = 0x08;
+static constexpr uint8_t BINXML_SQL_UUID = 0x09;
+static constexpr uint8_t BINXML_SQL_NCHAR = 0x0E;
+static constexpr uint8_t BINXML_SQL_NVARCHAR = 0x11;
+static constexpr uint8_t BINXML_SQL_DATETIME = 0x12;
+static constexpr uint8_t BINXML_SQL_SMALLDATETIME = 0x13;
+static constexpr uint8_t BINXML_SQL_SMALLMONEY = 0x14;
+static constexpr uint8_t BINXML_SQL_NTEXT = 0x18;
+static constexpr uint8_t BINXML_XSD_BOOLEAN = 0x86;
+static constexpr uint8_t BINXML_XSD_BYTE = 0x88;
+static constexpr uint8_t BINXML_XSD_UNSIGNEDSHORT = 0x89;
+static constexpr uint8_t BINXML_XSD_UNSIGNEDINT = 0x8A;
+static constexpr uint8_t BINXML_XSD_UNSIGNEDLONG = 0x8B;
+
+// Days between 1900-01-01, the epoch of SQL datetime values, and 1970-01-01
+static constexpr int32_t SQL_DATETIME_EPOCH_OFFSET = 25567;
+
+template <class T>
+static T LoadLE(const uint8_t *data) {
+    T result = 0;
+    for (idx_t i = 0; i < sizeof(T); i++) {
+        result |= (T)data[i] << (8 * i);
+    }
+    return result;
+}
+
+static std::runtime_error UnsupportedToken(uint8_t token) {
+    char hex[8];
+    snprintf(hex, sizeof(hex), "0x%02X", token);
+    return std::runtime_error("Unsupported token " + std::string(hex) + " in binary XMLA response");
+}
+
+static void ThrowUnexpectedEnd() {
+    throw std::runtime_error("Unexpected end of binary XMLA response");
+}
+
+// Format a fixed point value with 4 decimals (money)
+static void AppendMoney(int64_t value, std::string &target) {
+    uint64_t magnitude = value < 0 ? uint64_t(0) - (uint64_t)value : (uint64_t)value;
+    char fraction[8];
+    snprintf(fraction, sizeof(fraction), ".%04u", (unsigned)(magnitude % 10000));
+    if (value < 0) {
+        target += '-';
+    }
+    target += std::to_string(magnitude / 10000);
+    target += fraction;
+}
+
+static void AppendSQLDateTime(int32_t days, int64_t micros, std::string &target) {
+    auto date = date_t(days - SQL_DATETIME_EPOCH_OFFSET);
+    target += Timestamp::ToString(Timestamp::FromDatetime(date, dtime_t(micros)));
+}
+
+MSOLAPBinaryXMLReader::MSOLAPBinaryXMLReader(MSOLAPInputStream &stream_p)
+    : stream(stream_p), buffer(new char[BINXML_READ_SIZE]), buffer_pos(0), buffer_end(0), header_read(false) {
+    names.emplace_back();
+    qualified_names.push_back(0);
+}
+
+bool MSOLAPBinaryXMLReader::Ensure(idx_t count) {
+    if (buffer_end - buffer_pos >= count) {
+        return true;
+    }
+    // Move unread bytes to the front of the buffer
+    memmove(buffer.get(), buffer.get() + buffer_pos, buffer_end - buffer_pos);
+    buffer_end -= buffer_pos;
+    buffer_pos = 0;
+    while (buffer_end < count) {
+        auto read = stream.Read(buffer.get() + buffer_end, BINXML_READ_SIZE - buffer_end);
+        if (read == 0) {
+            return false;
+        }
+        buffer_end += read;
+    }
+    return true;
+}
+
+uint8_t MSOLAPBinaryXMLReader::ReadByte() {
+    if (!Ensure(1)) {
+        ThrowUnexpectedEnd();
+    }
+    return (uint8_t)buffer[buffer_pos++];
+}
+
+void MSOLAPBinaryXMLReader::ReadBytes(void *target, idx_t length) {
+    auto out = (char *)target;
+    while (length > 0) {
+        if (!Ensure(1)) {
+            ThrowUnexpectedEnd();
+        }
+        auto count = MinValue<idx_t>(length, buffer_end - buffer_pos);
+        memcpy(out, buffer.get() + buffer_pos, count);
+        buffer_pos += count;
+        out += count;
+        length -= count;
+    }
+}
+
+uint32_t MSOLAPBinaryXMLReader::ReadMultiByte32() {
+    uint32_t result = 0;
+    for (idx_t shift = 0; shift < 35; shift += 7) {
+        auto byte = ReadByte();
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return result;
+        }
+    }
+    throw std::runtime_error("Invalid length in binary XMLA response");
+}
+
+void MSOLAPBinaryXMLReader::ReadTextData(std::string &target) {
+    idx_t remaining = ReadMultiByte32();
+    while (remaining > 0) {
+        // Convert whatever is buffered, at least two code units so a surrogate pair is never split
+        if (!Ensure(MinValue<idx_t>(remaining, 2) * 2)) {
+            ThrowUnexpectedEnd();
+        }
+        auto units = MinValue<idx_t>(remaining, (buffer_end - buffer_pos) / 2);
+        auto data = (const uint8_t *)buffer.get() + buffer_pos;
+        if (units < remaining && (data[2 * units - 1] & 0xFC) == 0xD8) {
+            units--;
+        }
+        MSOLAPUtils::AppendUTF16(data, units, target);
+        buffer_pos += units * 2;
+        remaining -= units;
+    }
+}
+
+void MSOLAPBinaryXMLReader::ReadHeader() {
+    // Signature 0xDF 0xFF, version 1 or 2, encoding 0x04B0 (UTF-16LE)
+    uint8_t header[5];
+    ReadBytes(header, sizeof(header));
+    if (header[0] != 0xDF || header[1] != 0xFF) {
+        throw std::runtime_error("Invalid binary XMLA response signature");
+    }
+    if (header[2] != 1 && header[2] != 2) {
+        throw std::runtime_error("Unsupported binary XML version " + std::to_string(header[2]));
+    }
+    if (header[3] != 0xB0 || header[4] != 0x04) {
+        throw std::runtime_error("Unsupported binary XML encoding");
+    }
+    header_read = true;
+}
+
+const std::string &MSOLAPBinaryXMLReader::GetQualifiedName(idx_t index) const {
+    if (index == 0 || index >= qualified_names.size()) {
+        throw std::runtime_error("Undefined name in binary XMLA response");
+    }
+    return names[qualified_names[index]];
+}
+
+bool MSOLAPBinaryXMLReader::IsAtomToken(uint8_t token) {
+    switch (token) {
+    case BINXML_SQL_SMALLINT:
+    case BINXML_SQL_INT:
+    case BINXML_SQL_REAL:
+    case BINXML_SQL_FLOAT:
+    case BINXML_SQL_MONEY:
+    case BINXML_SQL_BIT:
+    case BINXML_SQL_TINYINT:
+    case BINXML_SQL_BIGINT:
+    case BINXML_SQL_UUID:
+    case BINXML_SQL_NCHAR:
+    case BINXML_SQL_NVARCHAR:
+    case BINXML_SQL_DATETIME:
+    case BINXML_SQL_SMALLDATETIME:
+    case BINXML_SQL_SMALLMONEY:
+    case BINXML_SQL_NTEXT:
+    case BINXML_XSD_BOOLEAN:
+    case BINXML_XSD_BYTE:
+    case BINXML_XSD_UNSIGNEDSHORT:
+    case BINXML_XSD_UNSIGNEDINT:
+    case BINXML_XSD_UNSIGNEDLONG:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void MSOLAPBinaryXMLReader::ReadAtom(uint8_t token, std::string &target) {
+    uint8_t data[16];
+    char formatted[32];
+    switch (token) {
+    case BINXML_SQL_SMALLINT:
+        ReadBytes(data, 2);
+        target += std::to_string((int16_t)LoadLE<uint16_t>(data));
+        break;
+    case BINXML_SQL_INT:
+        ReadBytes(data, 4);
+        target += std::to_string((int32_t)LoadLE<uint32_t>(data));
+        break;
+    case BINXML_SQL_BIGINT:
+        ReadBytes(data, 8);
+        target += std::to_string((int64_t)LoadLE<uint64_t>(data));
+        break;
+    case BINXML_SQL_TINYINT:
+        target += std::to_string(ReadByte());
+        break;
+    case BINXML_XSD_BYTE:
+        target += std::to_string((int8_t)ReadByte());
+        break;
+    case BINXML_XSD_UNSIGNEDSHORT:
+        ReadBytes(data, 2);
+        target += std::to_string(LoadLE<uint16_t>(data));
+        break;
+    case BINXML_XSD_UNSIGNEDINT:
+        ReadBytes(data, 4);
+        target += std::to_string(LoadLE<uint32_t>(data));
+        break;
+    case BINXML_XSD_UNSIGNEDLONG:
+        ReadBytes(data, 8);
+        target += std::to_string(LoadLE<uint64_t>(data));
+        break;
+    case BINXML_SQL_REAL: {
+        ReadBytes(data, 4);
+        auto bits = LoadLE<uint32_t>(data);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        // Enough digits to round trip
+        snprintf(formatted, sizeof(formatted), "%.9g", value);
+        target += formatted;
+        break;
+    }
+    case BINXML_SQL_FLOAT: {
+        ReadBytes(data, 8);
+        auto bits = LoadLE<uint64_t>(data);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        snprintf(formatted, sizeof(formatted), "%.17g", value);
+        target += formatted;
+        break;
+    }
+    case BINXML_SQL_BIT:
+    case BINXML_XSD_BOOLEAN:
+        target += ReadByte() ? "true" : "false";
+        break;
+    case BINXML_SQL_MONEY: {
+        // High 32 bits first, then the low 32 bits, in 1/10000 units
+        ReadBytes(data, 8);
+        auto high = (uint64_t)LoadLE<uint32_t>(data);
+        auto low = (uint64_t)LoadLE<uint32_t>(data + 4);
+        AppendMoney((int64_t)((high << 32) | low), target);
+        break;
+    }
+    case BINXML_SQL_SMALLMONEY:
+        ReadBytes(data, 4);
+        AppendMoney((int32_t)LoadLE<uint32_t>(data), target);
+        break;
+    case BINXML_SQL_DATETIME: {
+        // Days since 1900-01-01 and 1/300 second ticks since midnight
+        ReadBytes(data, 8);
+        auto days = (int32_t)LoadLE<uint32_t>(data);
+        auto ticks = (int64_t)LoadLE<uint32_t>(data + 4);
+        AppendSQLDateTime(days, (ticks * 10000 + 1) / 3, target);
+        break;
+    }
+    case BINXML_SQL_SMALLDATETIME: {
+        // Days since 1900-01-01 and minutes since midnight
+        ReadBytes(data, 4);
+        auto days = (int32_t)LoadLE<uint16_t>(data);
+        auto minutes = (int64_t)LoadLE<uint16_t>(data + 2);
+        AppendSQLDateTime(days, minutes * 60 * 1000000, target);
+        break;
+    }
+    case BINXML_SQL_UUID: {
+        // The first three groups are stored little endian
+        ReadBytes(data, 16);
+        snprintf(formatted, sizeof(formatted), "%08x-%04x-%04x-", LoadLE<uint32_t>(data), LoadLE<uint16_t>(data + 4),
+                 LoadLE<uint16_t>(data + 6));
+        target += formatted;
+        for (idx_t i = 8; i < 16; i++) {
+            if (i == 10) {
+                target += '-';
+            }
+            snprintf(formatted, sizeof(formatted), "%02x", data[i]);
+            target += formatted;
+        }
+        break;
+    }
+    case BINXML_SQL_NCHAR:
+    case BINXML_SQL_NVARCHAR:
+    case BINXML_SQL_NTEXT:
+        ReadTextData(target);
+        break;
+    default:
+        throw UnsupportedToken(token);
+    }
+}
+
+bool MSOLAPBinaryXMLReader::ReadNameDefinition(uint8_t token) {
+    switch (token) {
+    case BINXML_NAMEDEF:
+        names.emplace_back();
+        ReadTextData(names.back());
+        return true;
+    case BINXML_QNAMEDEF: {
+        // Namespace URI and prefix are not needed, only the local name is reported
+        ReadMultiByte32();
+        ReadMultiByte32();
+        auto local_name = ReadMultiByte32();
+        if (local_name >= names.size()) {
+            throw std::runtime_error("Undefined name in binary XMLA response");
+        }
+        qualified_names.push_back(local_name);
+        return true;
+    }
+    case BINXML_FLUSH_NAMES:
+        names.resize(1);
+        qualified_names.resize(1);
+        return true;
+    default:
+        return false;
+    }
+}
+
+void MSOLAPBinaryXMLReader::ReadStartElement() {
+    name = GetQualifiedName(ReadMultiByte32());
+    ClearAttributes();
+    while (Ensure(1)) {
+        auto token = (uint8_t)buffer[buffer_pos];
+        if (token == BINXML_END_ATTRIBUTES) {
+            buffer_pos++;
+            break;
+        }
+        // Names can be defined between the attributes that use them
+        if (token == BINXML_NAMEDEF || token == BINXML_QNAMEDEF || token == BINXML_FLUSH_NAMES) {
+            buffer_pos++;
+            ReadNameDefinition(token);
+            continue;
+        }
+        if (token != BINXML_ATTRIBUTE) {
+            break;
+        }
+        buffer_pos++;
+        auto &attribute = AddAttribute();
+        attribute.name = GetQualifiedName(ReadMultiByte32());
+        attribute.value.clear();
+        // The value of an attribute is a sequence of atoms
+        while (Ensure(1) && IsAtomToken((uint8_t)buffer[buffer_pos])) {
+            ReadAtom(ReadByte(), attribute.value);
+        }
+    }
+    element_stack.push_back(name);
+}
+
+XMLNodeType MSOLAPBinaryXMLReader::Next() {
+    if (!header_read) {
+        ReadHeader();
+    }
+    while (Ensure(1)) {
+        auto token = ReadByte();
+        switch (token) {
+        case BINXML_NAMEDEF:
+        case BINXML_QNAMEDEF:
+        case BINXML_FLUSH_NAMES:
+            ReadNameDefinition(token);
+            break;
+        case BINXML_ELEMENT:
+            ReadStartElement();
+            return XMLNodeType::START_ELEMENT;
+        case BINXML_END_ELEMENT:
+            if (element_stack.empty()) {
+                throw std::runtime_error("Unbalanced end element in binary XMLA response");
+            }
+            name = std::move(element_stack.back());
+            element_stack.pop_back();
+            return XMLNodeType::END_ELEMENT;
+        case BINXML_CDATA:
+            text.clear();
+            ReadTextData(text);
+            return XMLNodeType::TEXT;
+        case BINXML_CDATA_END:
+        case BINXML_NEST:
+        case BINXML_END_NEST:
+            break;
+        case BINXML_COMMENT:
+            text.clear();
+            ReadTextData(text);
+            break;
+        case BINXML_PI:
+            // Target name index and data
+            ReadMultiByte32();
+            text.clear();
+            ReadTextData(text);
+            break;
+        case BINXML_XMLDECL:
+            // Version, optional encoding and the standalone flag
+            text.clear();
+            ReadTextData(text);
+            if (Ensure(1) && (uint8_t)buffer[buffer_pos] == BINXML_ENCODING) {
+                buffer_pos++;
+                ReadTextData(text);
+            }
+            ReadByte();
+            break;
+        case BINXML_EXTENSION: {
+            auto length = ReadMultiByte32();
+            for (idx_t i = 0; i < length; i++) {
+                ReadByte();
+            }
+            break;
+        }
+        default:
+            if (!IsAtomToken(token)) {
+                throw UnsupportedToken(token);
+            }
+            text.clear();
+            ReadAtom(token, text);
+            return XMLNodeType::TEXT;
+        }
+    }
+    return XMLNodeType::END_OF_DOCUMENT;
+}
+
+} // namespace duckdb
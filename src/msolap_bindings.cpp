@@ -0,0 +1,263 @@
+#include "msolap_bindings.hpp"
+#include "msolap_column_writer.hpp"
+#include "msolap_conversion.hpp"
+#ifdef _WIN32
+#include "duckdb/common/windows_util.hpp"
+#endif
+#include <cstring>
+#include <stdexcept>
+
+namespace duckdb {
+
+// Value of a type at a position of the row buffer, which the accessor does not necessarily align for it
+template <class T>
+static T ReadBuffer(const uint8_t *data) {
+    T result;
+    memcpy(&result, data, sizeof(T));
+    return result;
+}
+
+template <class T>
+static void StoreValue(Vector &vector, idx_t row, const uint8_t *value) {
+    MSOLAPColumnWriter::WriteValue<T>(vector, row, ReadBuffer<T>(value));
+}
+
+// Store a DECIMAL or NUMERIC value rescaled to the scale of the vector's type
+static void WriteDecimal(Vector &vector, idx_t row, hugeint_t magnitude, bool negative, uint8_t scale) {
+    auto &type = vector.GetType();
+    hugeint_t result;
+    if (!MSOLAPConversion::TryConvertDecimal(magnitude, negative, scale, DecimalType::GetWidth(type),
+                                             DecimalType::GetScale(type), result)) {
+        throw std::runtime_error("Decimal value out of range for " + type.ToString());
+    }
+    MSOLAPColumnWriter::WriteDecimal(vector, row, result);
+}
+
+void MSOLAPBindings::WriteValue(const MSOLAPColumnBinding &binding, const uint8_t *row_data, Vector &vector,
+                                idx_t row) {
+    const uint8_t *value = row_data + binding.value_offset;
+    switch (binding.type) {
+    case TYPE_BOOL:
+        // VARIANT_BOOL, VARIANT_FALSE is 0
+        MSOLAPColumnWriter::WriteValue<bool>(vector, row, ReadBuffer<int16_t>(value) != 0);
+        break;
+    case TYPE_I1:
+        StoreValue<int8_t>(vector, row, value);
+        break;
+    case TYPE_I2:
+        StoreValue<int16_t>(vector, row, value);
+        break;
+    case TYPE_I4:
+        StoreValue<int32_t>(vector, row, value);
+        break;
+    case TYPE_I8:
+        StoreValue<int64_t>(vector, row, value);
+        break;
+    case TYPE_UI1:
+        StoreValue<uint8_t>(vector, row, value);
+        break;
+    case TYPE_UI2:
+        StoreValue<uint16_t>(vector, row, value);
+        break;
+    case TYPE_UI4:
+        StoreValue<uint32_t>(vector, row, value);
+        break;
+    case TYPE_UI8:
+        StoreValue<uint64_t>(vector, row, value);
+        break;
+    case TYPE_R4:
+        StoreValue<float>(vector, row, value);
+        break;
+    case TYPE_R8:
+        StoreValue<double>(vector, row, value);
+        break;
+    case TYPE_CY:
+        // Currency is a 64-bit integer scaled by 10,000, the representation of DECIMAL(19,4)
+        MSOLAPColumnWriter::WriteDecimal(vector, row, hugeint_t(ReadBuffer<int64_t>(value)));
+        break;
+    case TYPE_DECIMAL: {
+        // 96-bit magnitude with its own scale
+        auto decimal = ReadBuffer<DBDecimal>(value);
+        WriteDecimal(vector, row, hugeint_t((int64_t)decimal.hi32, decimal.lo64), decimal.sign == 0x80,
+                     decimal.scale);
+        break;
+    }
+    case TYPE_NUMERIC: {
+        // 128-bit little endian magnitude, sign 1 is positive
+        auto numeric = ReadBuffer<DBNumeric>(value);
+        uint64_t lower, upper;
+        memcpy(&lower, numeric.val, sizeof(uint64_t));
+        memcpy(&upper, numeric.val + sizeof(uint64_t), sizeof(uint64_t));
+        WriteDecimal(vector, row, hugeint_t((int64_t)upper, lower), numeric.sign == 0, numeric.scale);
+        break;
+    }
+    case TYPE_DATE: {
+        auto date = ReadBuffer<double>(value);
+        timestamp_t timestamp;
+        if (!MSOLAPConversion::TryConvertOADate(date, timestamp)) {
+            throw std::runtime_error("Could not convert date " + std::to_string(date));
+        }
+        MSOLAPColumnWriter::WriteValue<timestamp_t>(vector, row, timestamp);
+        break;
+    }
+    case TYPE_DBDATE: {
+        auto date = ReadBuffer<DBDate>(value);
+        MSOLAPColumnWriter::WriteValue<date_t>(vector, row, Date::FromDate(date.year, date.month, date.day));
+        break;
+    }
+    case TYPE_DBTIMESTAMP: {
+        auto timestamp = ReadBuffer<DBTimestamp>(value);
+        // fraction is in nanoseconds
+        auto date = Date::FromDate(timestamp.year, timestamp.month, timestamp.day);
+        auto time =
+            Time::FromTime(timestamp.hour, timestamp.minute, timestamp.second, (int32_t)(timestamp.fraction / 1000));
+        MSOLAPColumnWriter::WriteValue<timestamp_t>(vector, row, Timestamp::FromDatetime(date, time));
+        break;
+    }
+    case TYPE_WSTR | TYPE_BYREF: {
+        // The length part is in bytes, without the terminator
+        auto data = ReadBuffer<const uint8_t *>(value);
+        auto length = ReadBuffer<size_t>(row_data + binding.length_offset) / sizeof(uint16_t);
+        MSOLAPColumnWriter::WriteUTF16(vector, row, data, length);
+        break;
+    }
+    case TYPE_VARIANT:
+        WriteVariant(ReadBuffer<DBVariant>(value), vector, row);
+        break;
+    default:
+        throw std::runtime_error("Unsupported column binding type " + std::to_string(binding.type));
+    }
+}
+
+void MSOLAPBindings::WriteRow(const std::vector<MSOLAPColumnBinding> &bindings, const uint8_t *row_data,
+                              const std::vector<std::string> &names, DataChunk &output, idx_t row) {
+    for (idx_t col = 0; col < output.ColumnCount(); col++) {
+        auto &binding = bindings[col];
+        auto status = ReadBuffer<uint32_t>(row_data + binding.status_offset);
+        if (status == STATUS_OK) {
+            WriteValue(binding, row_data, output.data[col], row);
+        } else if (status == STATUS_TRUNCATED) {
+            // Only strings could be truncated, and they are bound by reference
+            throw std::runtime_error("Value of column " + names[col] + " was truncated by the provider");
+        } else {
+            // NULL or conversion error
+            MSOLAPColumnWriter::WriteNull(output.data[col], row);
+        }
+    }
+}
+
+#ifndef _WIN32
+// UTF-8 encoding of a UTF-16 string one code unit at a time, unpaired surrogates become U+FFFD, like
+// WideCharToMultiByte. Without target it only counts the bytes.
+static idx_t EncodeUTF8(const std::u16string &text, char *target) {
+    idx_t size = 0;
+    auto put = [&](uint8_t byte) {
+        if (target) {
+            target[size] = char(byte);
+        }
+        size++;
+    };
+    for (idx_t i = 0; i < text.size(); i++) {
+        uint32_t code_point = text[i];
+        if (code_point >= 0xD800 && code_point <= 0xDFFF) {
+            if (code_point <= 0xDBFF && i + 1 < text.size() && text[i + 1] >= 0xDC00 && text[i + 1] <= 0xDFFF) {
+                code_point = 0x10000 + ((code_point - 0xD800) << 10) + (text[i + 1] - 0xDC00);
+                i++;
+            } else {
+                code_point = 0xFFFD;
+            }
+        }
+        if (code_point < 0x80) {
+            put(uint8_t(code_point));
+        } else if (code_point < 0x800) {
+            put(uint8_t(0xC0 | (code_point >> 6)));
+            put(uint8_t(0x80 | (code_point & 0x3F)));
+        } else if (code_point < 0x10000) {
+            put(uint8_t(0xE0 | (code_point >> 12)));
+            put(uint8_t(0x80 | ((code_point >> 6) & 0x3F)));
+            put(uint8_t(0x80 | (code_point & 0x3F)));
+        } else {
+            put(uint8_t(0xF0 | (code_point >> 18)));
+            put(uint8_t(0x80 | ((code_point >> 12) & 0x3F)));
+            put(uint8_t(0x80 | ((code_point >> 6) & 0x3F)));
+            put(uint8_t(0x80 | (code_point & 0x3F)));
+        }
+    }
+    return size;
+}
+#endif
+
+// A BSTR as the rowset converted it before the typed bindings: copied into a wide string, then converted by
+// WindowsUtil::UnicodeToUTF8, which asks WideCharToMultiByte for the length first. The same two passes elsewhere.
+static std::string ConvertBSTR(const uint16_t *bstr) {
+#ifdef _WIN32
+    std::wstring text((const wchar_t *)bstr);
+    return WindowsUtil::UnicodeToUTF8(text.c_str());
+#else
+    std::u16string text((const char16_t *)bstr);
+    std::string result(EncodeUTF8(text, nullptr), '\0');
+    EncodeUTF8(text, &result[0]);
+    return result;
+#endif
+}
+
+void MSOLAPBindings::WriteVariant(const DBVariant &variant, Vector &vector, idx_t row) {
+    Value value;
+    switch (variant.vt) {
+    case TYPE_EMPTY:
+    case TYPE_NULL:
+        break;
+    case TYPE_BOOL:
+        value = Value::BOOLEAN(variant.boolVal != 0);
+        break;
+    case TYPE_I1:
+        value = Value::TINYINT(variant.cVal);
+        break;
+    case TYPE_I2:
+        value = Value::SMALLINT(variant.iVal);
+        break;
+    case TYPE_I4:
+        value = Value::INTEGER(variant.lVal);
+        break;
+    case TYPE_I8:
+        value = Value::BIGINT(variant.llVal);
+        break;
+    case TYPE_UI1:
+        value = Value::UTINYINT(variant.bVal);
+        break;
+    case TYPE_UI2:
+        value = Value::USMALLINT(variant.uiVal);
+        break;
+    case TYPE_UI4:
+        value = Value::UINTEGER(variant.ulVal);
+        break;
+    case TYPE_UI8:
+        value = Value::UBIGINT(variant.ullVal);
+        break;
+    case TYPE_R4:
+        value = Value::FLOAT(variant.fltVal);
+        break;
+    case TYPE_R8:
+        value = Value::DOUBLE(variant.dblVal);
+        break;
+    case TYPE_CY:
+        value = Value::DECIMAL(variant.cyVal, MSOLAPConversion::CURRENCY_WIDTH, MSOLAPConversion::CURRENCY_SCALE);
+        break;
+    case TYPE_DATE: {
+        timestamp_t timestamp;
+        if (!MSOLAPConversion::TryConvertOADate(variant.date, timestamp)) {
+            throw std::runtime_error("Could not convert date " + std::to_string(variant.date));
+        }
+        value = Value::TIMESTAMP(timestamp);
+        break;
+    }
+    case TYPE_BSTR:
+        value = variant.bstrVal ? Value(ConvertBSTR(variant.bstrVal)) : Value("");
+        break;
+    default:
+        throw std::runtime_error("Unsupported VARIANT type " + std::to_string(variant.vt));
+    }
+    vector.SetValue(row, value.DefaultCastAs(vector.GetType()));
+}
+
+} // namespace duckdb
@@ -0,0 +1,586 @@
+#include "msolap_cache.hpp"
+#include "msolap_pool.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/serializer/binary_deserializer.hpp"
+#include "duckdb/common/serializer/binary_serializer.hpp"
+#include "duckdb/common/serializer/buffered_file_reader.hpp"
+#include "duckdb/common/serializer/buffered_file_writer.hpp"
+#include "mbedtls_wrapper.hpp"
+
+namespace duckdb {
+
+// Files of version 1 stored the connection string of the key in plain text, files of version 2 did not record the
+// DuckDB version that wrote them, they are removed
+static constexpr uint32_t CACHE_FILE_MAGIC = 0x4D534333; // "MSC3"
+static constexpr const char *CACHE_FILE_EXTENSION = ".msolapcache";
+
+// DuckDB build the chunks of a file were serialized by, other builds do not read them
+static std::string GetWriterVersion() {
+    return std::string(DuckDB::LibraryVersion()) + "-" + DuckDB::SourceID();
+}
+
+static void WriteString(WriteStream &stream, const std::string &value) {
+    stream.Write<uint32_t>(NumericCast<uint32_t>(value.size()));
+    stream.WriteData(const_data_ptr_cast(value.data()), value.size());
+}
+
+static std::string ReadString(ReadStream &stream) {
+    std::string value(stream.Read<uint32_t>(), '\0');
+    stream.ReadData(data_ptr_cast(&value[0]), value.size());
+    return value;
+}
+
+// Cache file layout: magic, DuckDB version, key (a SHA-256 digest), names and types, then every chunk preceded by 1
+// and a final 0
+static void WriteHeader(WriteStream &stream, const std::string &key, const std::vector<std::string> &names,
+                        const std::vector<LogicalType> &types) {
+    stream.Write<uint32_t>(CACHE_FILE_MAGIC);
+    WriteString(stream, GetWriterVersion());
+    WriteString(stream, key);
+    BinarySerializer serializer(stream);
+    serializer.Begin();
+    serializer.WriteProperty(100, "names", vector<string>(names.begin(), names.end()));
+    serializer.WriteProperty(101, "types", vector<LogicalType>(types.begin(), types.end()));
+    serializer.End();
+}
+
+// Reads a cached result. The first chunk is read when the entry is opened, so a file that cannot be read is a
+// cache miss; a file that fails later fails the scan, some of its rows have been returned already.
+class MSOLAPCachedRowset : public MSOLAPRowset {
+public:
+    MSOLAPCachedRowset(MSOLAPResultCache &cache, std::string key, unique_ptr<BufferedFileReader> reader,
+                       std::vector<std::string> names, std::vector<LogicalType> types)
+        : cache(cache), key(std::move(key)), reader(std::move(reader)), names(std::move(names)),
+          types(std::move(types)), buffered(false), finished(false) {
+    }
+
+    void GetColumnInfo(std::vector<std::string> &names_p, std::vector<LogicalType> &types_p) override {
+        names_p = names;
+        types_p = types;
+    }
+
+    // Read the next chunk into the buffer, false at the end of the result. Throws if the file is damaged.
+    bool ReadChunk() {
+        if (finished || reader->Read<uint8_t>() == 0) {
+            finished = true;
+            return false;
+        }
+        buffer.Destroy();
+        BinaryDeserializer deserializer(*reader);
+        deserializer.Begin();
+        buffer.Deserialize(deserializer);
+        deserializer.End();
+        // Copied into vectors of the header types
+        if (buffer.GetTypes() != vector<LogicalType>(types.begin(), types.end())) {
+            throw std::runtime_error("chunk types do not match the header");
+        }
+        return true;
+    }
+
+    // Read the first chunk ahead
+    void Start() {
+        buffered = ReadChunk();
+    }
+
+    idx_t Fetch(DataChunk &output) override {
+        if (!buffered && !finished) {
+            try {
+                buffered = ReadChunk();
+            } catch (std::exception &e) {
+                finished = true;
+                reader.reset();
+                cache.Remove(key);
+                throw std::runtime_error("The cached result of the DAX query could not be read (" +
+                                         std::string(e.what()) +
+                                         "), it was removed from the cache and the query is evaluated again the "
+                                         "next time it runs");
+            }
+        }
+        if (!buffered) {
+            output.SetCardinality(0);
+            return 0;
+        }
+        buffered = false;
+        buffer.Copy(output);
+        return output.size();
+    }
+
+private:
+    MSOLAPResultCache &cache;
+    std::string key;
+    unique_ptr<BufferedFileReader> reader;
+    std::vector<std::string> names;
+    std::vector<LogicalType> types;
+    DataChunk buffer;
+    // The buffer holds a chunk not returned yet
+    bool buffered;
+    bool finished;
+};
+
+// Passes the rows of a rowset through and writes them to a temporary file, which becomes the cache entry once
+// the rowset has been read to the end. Results that are read partially or exceed the cache size are dropped.
+class MSOLAPCachingRowset : public MSOLAPRowset {
+public:
+    MSOLAPCachingRowset(MSOLAPResultCache &cache, std::string key, std::string temp_path, idx_t max_size,
+                        unique_ptr<BufferedFileWriter> writer, unique_ptr<MSOLAPRowset> source)
+        : cache(cache), key(std::move(key)), temp_path(std::move(temp_path)), max_size(max_size),
+          writer(std::move(writer)), source(std::move(source)) {
+    }
+
+    ~MSOLAPCachingRowset() override {
+        Abandon();
+    }
+
+    void GetColumnInfo(std::vector<std::string> &names, std::vector<LogicalType> &types) override {
+        source->GetColumnInfo(names, types);
+    }
+
+    idx_t GetBytesRead() const override {
+        return source->GetBytesRead();
+    }
+
+    idx_t Fetch(DataChunk &output) override {
+        auto count = source->Fetch(output);
+        if (!writer) {
+            return count;
+        }
+        try {
+            if (count > 0) {
+                writer->Write<uint8_t>(1);
+                BinarySerializer serializer(*writer);
+                serializer.Begin();
+                output.Serialize(serializer);
+                serializer.End();
+                if (writer->GetTotalWritten() > max_size) {
+                    Abandon();
+                }
+            } else {
+                writer->Write<uint8_t>(0);
+                writer->Sync();
+                auto size = writer->GetTotalWritten();
+                writer.reset();
+                cache.Commit(key, temp_path, size);
+            }
+        } catch (std::exception &) {
+            // The result is still returned, it is just not cached
+            Abandon();
+        }
+        return count;
+    }
+
+private:
+    void Abandon() {
+        if (!writer) {
+            return;
+        }
+        writer.reset();
+        cache.RemoveTempFile(temp_path);
+    }
+
+    MSOLAPResultCache &cache;
+    std::string key;
+    std::string temp_path;
+    // Size limit of the cache when the scan started
+    idx_t max_size;
+    unique_ptr<BufferedFileWriter> writer;
+    unique_ptr<MSOLAPRowset> source;
+};
+
+MSOLAPResultCache::MSOLAPResultCache()
+    : fs(FileSystem::CreateLocal()), max_size(DBConfig::ParseMemoryLimit(DEFAULT_MAX_SIZE)), loaded(false),
+      total_size(0), use_count(0), temp_count(0), hits(0), misses(0), writes(0), evictions(0) {
+}
+
+MSOLAPResultCache &MSOLAPResultCache::Get() {
+    // Never destroyed, like the connection pool
+    static auto cache = new MSOLAPResultCache();
+    return *cache;
+}
+
+void MSOLAPResultCache::SetDirectory(const std::string &directory_p) {
+    std::lock_guard<std::mutex> guard(lock);
+    directory = directory_p;
+    entries.clear();
+    total_size = 0;
+    loaded = false;
+}
+
+void MSOLAPResultCache::SetMaxSize(idx_t max_size_p) {
+    std::lock_guard<std::mutex> guard(lock);
+    max_size = max_size_p;
+    if (!directory.empty()) {
+        LoadEntries();
+        EvictEntries();
+    }
+}
+
+bool MSOLAPResultCache::IsEnabled() {
+    std::lock_guard<std::mutex> guard(lock);
+    return !directory.empty();
+}
+
+std::string MSOLAPResultCache::QueryModelVersion(MSOLAPSession &session) {
+    try {
+        auto rowset = session.ExecuteQuery("SELECT [CUBE_NAME], [LAST_DATA_UPDATE] FROM $SYSTEM.MDSCHEMA_CUBES");
+        std::vector<std::string> names;
+        std::vector<LogicalType> types;
+        rowset->GetColumnInfo(names, types);
+        if (types.size() != 2) {
+            return "";
+        }
+        DataChunk chunk;
+        chunk.Initialize(Allocator::DefaultAllocator(), types);
+        // Every cube (model and perspectives) with its last update
+        std::string version;
+        while (rowset->Fetch(chunk) > 0) {
+            for (idx_t row = 0; row < chunk.size(); row++) {
+                version += chunk.GetValue(0, row).ToString() + "=" + chunk.GetValue(1, row).ToString() + ";";
+            }
+            chunk.Reset();
+        }
+        return version;
+    } catch (std::exception &) {
+        return "";
+    }
+}
+
+std::string MSOLAPResultCache::GetModelVersion(const std::string &connection_string) {
+    auto key = MSOLAPConnectionPool::NormalizeConnectionString(connection_string);
+    auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        auto entry = model_versions.find(key);
+        if (entry != model_versions.end() &&
+            now - entry->second.checked < std::chrono::seconds(MODEL_VERSION_TTL)) {
+            return entry->second.version;
+        }
+    }
+    // Outside the lock, the round trip would hold up the scans of other data sources
+    auto session = MSOLAPConnectionPool::Get().Acquire(connection_string);
+    auto version = QueryModelVersion(*session);
+    std::lock_guard<std::mutex> guard(lock);
+    model_versions[key] = ModelVersion {version, now};
+    return version;
+}
+
+bool MSOLAPResultCache::IsVolatile(const std::string &dax_query) {
+    static const char *const VOLATILE_FUNCTIONS[] = {"NOW", "TODAY", "UTCNOW", "UTCTODAY", "RAND", "RANDBETWEEN"};
+    auto upper = StringUtil::Upper(dax_query);
+    auto is_name_char = [](char c) {
+        return isalnum((unsigned char)c) || c == '_' || c == '.';
+    };
+    for (auto function : VOLATILE_FUNCTIONS) {
+        std::string name = function;
+        for (auto pos = upper.find(name); pos != std::string::npos; pos = upper.find(name, pos + 1)) {
+            if (pos > 0 && is_name_char(upper[pos - 1])) {
+                continue;
+            }
+            // Called, i.e. followed by an opening parenthesis
+            auto next = pos + name.size();
+            while (next < upper.size() && isspace((unsigned char)upper[next])) {
+                next++;
+            }
+            if (next < upper.size() && upper[next] == '(') {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+std::string MSOLAPResultCache::MakeKey(const std::string &connection_string, const std::string &dax_query,
+                                       const std::string &model_version) {
+    // The connection string includes the password, only a digest of it is kept in memory and written to the files
+    auto text = MSOLAPConnectionPool::NormalizeConnectionString(connection_string) + "\n" + model_version + "\n" +
+                dax_query;
+    auto digest = duckdb_mbedtls::MbedTlsWrapper::ComputeSha256Hash(text);
+    std::string result;
+    for (auto byte : digest) {
+        char hex[3];
+        snprintf(hex, sizeof(hex), "%02x", (unsigned char)byte);
+        result += hex;
+    }
+    return result;
+}
+
+std::string MSOLAPResultCache::GetPath(const std::string &key) {
+    return fs->JoinPath(directory, key.substr(0, 16) + CACHE_FILE_EXTENSION);
+}
+
+void MSOLAPResultCache::LoadEntries() {
+    if (loaded) {
+        return;
+    }
+    loaded = true;
+    if (!fs->DirectoryExists(directory)) {
+        return;
+    }
+    fs->ListFiles(directory, [&](const std::string &name, bool is_directory) {
+        if (is_directory || !StringUtil::EndsWith(name, CACHE_FILE_EXTENSION) || entries.count(name)) {
+            return;
+        }
+        try {
+            auto path = fs->JoinPath(directory, name);
+            auto handle = fs->OpenFile(path, FileFlags::FILE_FLAGS_READ);
+            auto size = NumericCast<idx_t>(handle->GetFileSize());
+            uint32_t magic = 0;
+            if (size < sizeof(magic) || handle->Read(&magic, sizeof(magic)) != sizeof(magic) ||
+                magic != CACHE_FILE_MAGIC) {
+                // Written by an older version or truncated
+                handle.reset();
+                fs->RemoveFile(path);
+                return;
+            }
+            entries[name] = CacheEntry {size, 0};
+            total_size += size;
+        } catch (std::exception &) {
+            // Removed in the meantime
+        }
+    });
+}
+
+void MSOLAPResultCache::EvictEntries() {
+    while (total_size > max_size && !entries.empty()) {
+        auto oldest = entries.begin();
+        for (auto it = entries.begin(); it != entries.end(); it++) {
+            if (it->second.last_used < oldest->second.last_used) {
+                oldest = it;
+            }
+        }
+        RemoveEntry(oldest);
+    }
+}
+
+unique_ptr<MSOLAPRowset> MSOLAPResultCache::Open(const std::string &key) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (directory.empty()) {
+        return nullptr;
+    }
+    LoadEntries();
+    auto path = GetPath(key);
+    auto entry = entries.find(fs->ExtractName(path));
+    if (entry == entries.end()) {
+        misses++;
+        return nullptr;
+    }
+    try {
+        auto reader = make_uniq<BufferedFileReader>(*fs, path.c_str());
+        if (reader->Read<uint32_t>() != CACHE_FILE_MAGIC || ReadString(*reader) != GetWriterVersion()) {
+            // Written by another version of the extension or of DuckDB
+            reader.reset();
+            RemoveEntry(entry);
+            misses++;
+            return nullptr;
+        }
+        // The file name is a prefix of the key, a different key means a collision. The entry of the other key
+        // makes room for the result of this one.
+        if (ReadString(*reader) != key) {
+            reader.reset();
+            RemoveEntry(entry);
+            misses++;
+            return nullptr;
+        }
+        BinaryDeserializer deserializer(*reader);
+        deserializer.Begin();
+        auto names = deserializer.ReadProperty<vector<string>>(100, "names");
+        auto types = deserializer.ReadProperty<vector<LogicalType>>(101, "types");
+        deserializer.End();
+
+        auto rowset = make_uniq<MSOLAPCachedRowset>(*this, key, std::move(reader), std::move(names), std::move(types));
+        rowset->Start();
+        entry->second.last_used = ++use_count;
+        hits++;
+        return std::move(rowset);
+    } catch (std::exception &) {
+        // Damaged (e.g. truncated), the query is evaluated instead and its result stored again
+        RemoveEntry(entry);
+        misses++;
+        return nullptr;
+    }
+}
+
+void MSOLAPResultCache::RemoveEntry(EntryMap::iterator entry) {
+    try {
+        fs->RemoveFile(fs->JoinPath(directory, entry->first));
+    } catch (std::exception &) {
+        // Removed in the meantime
+    }
+    total_size -= entry->second.size;
+    entries.erase(entry);
+    evictions++;
+}
+
+void MSOLAPResultCache::Remove(const std::string &key) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (directory.empty()) {
+        return;
+    }
+    auto entry = entries.find(fs->ExtractName(GetPath(key)));
+    if (entry != entries.end()) {
+        RemoveEntry(entry);
+    }
+}
+
+unique_ptr<MSOLAPRowset> MSOLAPResultCache::Store(const std::string &key, unique_ptr<MSOLAPRowset> source) {
+    std::string temp_path;
+    idx_t max_size_p;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (directory.empty()) {
+            return source;
+        }
+        max_size_p = max_size;
+        // Every write goes to a file of its own, concurrent scans of the same query do not interfere
+        temp_path = GetPath(key) + ".tmp" + std::to_string(++temp_count);
+    }
+    try {
+        auto temp_directory = temp_path.substr(0, temp_path.size() - fs->ExtractName(temp_path).size());
+        if (!fs->DirectoryExists(temp_directory)) {
+            fs->CreateDirectory(temp_directory);
+        }
+        auto writer = make_uniq<BufferedFileWriter>(*fs, temp_path);
+        std::vector<std::string> names;
+        std::vector<LogicalType> types;
+        source->GetColumnInfo(names, types);
+        WriteHeader(*writer, key, names, types);
+        return make_uniq<MSOLAPCachingRowset>(*this, key, temp_path, max_size_p, std::move(writer),
+                                                std::move(source));
+    } catch (std::exception &) {
+        // Caching is best effort, the query result is returned either way
+        return source;
+    }
+}
+
+void MSOLAPResultCache::RemoveTempFile(const std::string &temp_path) {
+    try {
+        fs->RemoveFile(temp_path);
+    } catch (std::exception &) {
+        // Removed with its directory, or never written
+    }
+}
+
+void MSOLAPResultCache::Commit(const std::string &key, const std::string &temp_path, idx_t size) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto path = GetPath(key);
+    if (directory.empty() || !StringUtil::StartsWith(temp_path, path)) {
+        // The directory changed while the result was read
+        RemoveTempFile(temp_path);
+        return;
+    }
+    LoadEntries();
+    try {
+        if (fs->FileExists(path)) {
+            fs->RemoveFile(path);
+        }
+        fs->MoveFile(temp_path, path);
+    } catch (std::exception &) {
+        RemoveTempFile(temp_path);
+        return;
+    }
+    auto &entry = entries[fs->ExtractName(path)];
+    total_size = total_size - entry.size + size;
+    entry = CacheEntry {size, ++use_count};
+    writes++;
+    EvictEntries();
+}
+
+MSOLAPCacheStats MSOLAPResultCache::GetStats() {
+    std::lock_guard<std::mutex> guard(lock);
+    MSOLAPCacheStats stats;
+    if (!directory.empty()) {
+        LoadEntries();
+    }
+    stats.directory = directory;
+    stats.entries = entries.size();
+    stats.size = total_size;
+    stats.max_size = max_size;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.writes = writes;
+    stats.evictions = evictions;
+    return stats;
+}
+
+idx_t MSOLAPResultCache::Clear() {
+    std::lock_guard<std::mutex> guard(lock);
+    if (directory.empty()) {
+        return 0;
+    }
+    LoadEntries();
+    idx_t removed = 0;
+    for (auto &entry : entries) {
+        try {
+            fs->RemoveFile(fs->JoinPath(directory, entry.first));
+            removed++;
+        } catch (std::exception &) {
+            // Removed in the meantime
+        }
+    }
+    entries.clear();
+    total_size = 0;
+    return removed;
+}
+
+struct MSOLAPCacheFunctionState : public GlobalTableFunctionState {
+    std::vector<Value> row;
+    bool done = false;
+};
+
+static void MSOLAPCacheFunctionScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+    auto &state = data.global_state->Cast<MSOLAPCacheFunctionState>();
+    if (state.done) {
+        return;
+    }
+    for (idx_t col = 0; col < state.row.size(); col++) {
+        output.SetValue(col, 0, state.row[col]);
+    }
+    output.SetCardinality(1);
+    state.done = true;
+}
+
+static unique_ptr<FunctionData> MSOLAPCacheStatsBind(ClientContext &context, TableFunctionBindInput &input,
+                                                     vector<LogicalType> &return_types, vector<string> &names) {
+    names = {"directory", "entries", "size", "max_size", "hits", "misses", "writes", "evictions"};
+    return_types = {LogicalType::VARCHAR, LogicalType::BIGINT, LogicalType::BIGINT, LogicalType::BIGINT,
+                    LogicalType::BIGINT,  LogicalType::BIGINT, LogicalType::BIGINT, LogicalType::BIGINT};
+    return make_uniq<TableFunctionData>();
+}
+
+static unique_ptr<GlobalTableFunctionState> MSOLAPCacheStatsInit(ClientContext &context,
+                                                                 TableFunctionInitInput &input) {
+    auto result = make_uniq<MSOLAPCacheFunctionState>();
+    auto stats = MSOLAPResultCache::Get().GetStats();
+    result->row = {Value(stats.directory),
+                   Value::BIGINT(int64_t(stats.entries)),
+                   Value::BIGINT(int64_t(stats.size)),
+                   Value::BIGINT(int64_t(stats.max_size)),
+                   Value::BIGINT(int64_t(stats.hits)),
+                   Value::BIGINT(int64_t(stats.misses)),
+                   Value::BIGINT(int64_t(stats.writes)),
+                   Value::BIGINT(int64_t(stats.evictions))};
+    return std::move(result);
+}
+
+MSOLAPCacheStatsFunction::MSOLAPCacheStatsFunction()
+    : TableFunction("msolap_cache_stats", {}, MSOLAPCacheFunctionScan, MSOLAPCacheStatsBind, MSOLAPCacheStatsInit) {
+}
+
+static unique_ptr<FunctionData> MSOLAPCacheClearBind(ClientContext &context, TableFunctionBindInput &input,
+                                                     vector<LogicalType> &return_types, vector<string> &names) {
+    names = {"removed"};
+    return_types = {LogicalType::BIGINT};
+    return make_uniq<TableFunctionData>();
+}
+
+static unique_ptr<GlobalTableFunctionState> MSOLAPCacheClearInit(ClientContext &context,
+                                                                 TableFunctionInitInput &input) {
+    auto result = make_uniq<MSOLAPCacheFunctionState>();
+    result->row = {Value::BIGINT(int64_t(MSOLAPResultCache::Get().Clear()))};
+    return std::move(result);
+}
+
+MSOLAPCacheClearFunction::MSOLAPCacheClearFunction()
+    : TableFunction("msolap_cache_clear", {}, MSOLAPCacheFunctionScan, MSOLAPCacheClearBind, MSOLAPCacheClearInit) {
+}
+
+} // namespace duckdb
@@ -0,0 +1,390 @@
+#include "msolap_catalog.hpp"
+#include "msolap_scanner.hpp"
+#include "msolap_pool.hpp"
+#include "msolap_dax.hpp"
+#include "msolap_conversion.hpp"
+#include "msolap_schema_cache.hpp"
+#include "duckdb/main/attached_database.hpp"
+#include "duckdb/parser/parsed_data/create_schema_info.hpp"
+#include "duckdb/parser/parsed_data/create_table_info.hpp"
+#include "duckdb/storage/database_size.hpp"
+#include "duckdb/storage/table_storage_info.hpp"
+#include "duckdb/transaction/transaction.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace duckdb {
+
+// Values of the DataType column of TMSCHEMA_COLUMNS
+enum class MSOLAPDataType : int64_t {
+    AUTOMATIC = 1,
+    STRING = 2,
+    INT64 = 6,
+    DOUBLE = 8,
+    DATETIME = 9,
+    DECIMAL = 10,
+    BOOLEAN = 11,
+    BINARY = 17,
+    VARIANT = 20
+};
+
+// Values of the Type column of TMSCHEMA_COLUMNS, row number columns are internal and never returned by queries
+static constexpr int64_t COLUMN_TYPE_ROW_NUMBER = 3;
+
+// Type a column is read as, matching the XSD type the server reports for it in a query result. Variant columns
+// hold values of any type and binary columns are returned as base64 text, both are VARCHAR like unknown types. The
+// server may still report other types in a result (a variant column of numbers), scans check the types of every
+// rowset and cast.
+static LogicalType GetLogicalTypeFromDataType(int64_t data_type) {
+    switch (MSOLAPDataType(data_type)) {
+    case MSOLAPDataType::INT64:
+        return LogicalType::BIGINT;
+    case MSOLAPDataType::DOUBLE:
+        return LogicalType::DOUBLE;
+    case MSOLAPDataType::DECIMAL:
+        return MSOLAPConversion::GetCurrencyType();
+    case MSOLAPDataType::DATETIME:
+        return LogicalType::TIMESTAMP;
+    case MSOLAPDataType::BOOLEAN:
+        return LogicalType::BOOLEAN;
+    case MSOLAPDataType::STRING:
+    case MSOLAPDataType::BINARY:
+    case MSOLAPDataType::VARIANT:
+    default:
+        return LogicalType::VARCHAR;
+    }
+}
+
+// Run a DMV query and pass every row to callback
+static void ReadSchemaRowset(MSOLAPSession &session, const std::string &query,
+                             const std::function<void(const std::vector<Value> &)> &callback) {
+    auto rowset = session.ExecuteQuery(query);
+    std::vector<std::string> names;
+    std::vector<LogicalType> types;
+    rowset->GetColumnInfo(names, types);
+    DataChunk chunk;
+    chunk.Initialize(Allocator::DefaultAllocator(), types);
+    std::vector<Value> row(types.size());
+    while (rowset->Fetch(chunk) > 0) {
+        for (idx_t i = 0; i < chunk.size(); i++) {
+            for (idx_t col = 0; col < types.size(); col++) {
+                row[col] = chunk.GetValue(col, i);
+            }
+            callback(row);
+        }
+        chunk.Reset();
+    }
+}
+
+static int64_t GetInteger(const Value &value) {
+    return value.IsNull() ? 0 : value.DefaultCastAs(LogicalType::BIGINT).GetValue<int64_t>();
+}
+
+std::vector<MSOLAPModelTable> MSOLAPModelTable::Load(MSOLAPSession &session) {
+    std::vector<MSOLAPModelTable> tables;
+    std::unordered_map<int64_t, idx_t> table_index;
+    ReadSchemaRowset(session, "SELECT [ID], [Name] FROM $SYSTEM.TMSCHEMA_TABLES", [&](const std::vector<Value> &row) {
+        if (row.size() != 2) {
+            throw std::runtime_error("Unexpected TMSCHEMA_TABLES result");
+        }
+        table_index[GetInteger(row[0])] = tables.size();
+        MSOLAPModelTable table;
+        table.name = row[1].ToString();
+        tables.push_back(std::move(table));
+    });
+
+    struct ModelColumn {
+        int64_t id;
+        std::string name;
+        LogicalType type;
+    };
+    std::vector<std::vector<ModelColumn>> columns(tables.size());
+    ReadSchemaRowset(session,
+                     "SELECT [ID], [TableID], [ExplicitName], [InferredName], [ExplicitDataType], "
+                     "[InferredDataType], [Type] FROM $SYSTEM.TMSCHEMA_COLUMNS",
+                     [&](const std::vector<Value> &row) {
+                         if (row.size() != 7) {
+                             throw std::runtime_error("Unexpected TMSCHEMA_COLUMNS result");
+                         }
+                         auto table = table_index.find(GetInteger(row[1]));
+                         if (table == table_index.end() || GetInteger(row[6]) == COLUMN_TYPE_ROW_NUMBER) {
+                             return;
+                         }
+                         // Columns of calculated tables only have an inferred name, calculated columns an
+                         // inferred type unless one was set
+                         ModelColumn column;
+                         column.id = GetInteger(row[0]);
+                         column.name = row[2].IsNull() || row[2].ToString().empty() ? row[3].ToString()
+                                                                                    : row[2].ToString();
+                         auto data_type = GetInteger(row[4]);
+                         if (data_type == int64_t(MSOLAPDataType::AUTOMATIC) || data_type == 0) {
+                             data_type = GetInteger(row[5]);
+                         }
+                         column.type = GetLogicalTypeFromDataType(data_type);
+                         columns[table->second].push_back(std::move(column));
+                     });
+
+    for (idx_t i = 0; i < tables.size(); i++) {
+        // In the order they were added to the table, as client tools list them. Scans select the columns by
+        // reference, the server does not guarantee this order for a plain 'Table'.
+        std::sort(columns[i].begin(), columns[i].end(),
+                  [](const ModelColumn &a, const ModelColumn &b) { return a.id < b.id; });
+        for (auto &column : columns[i]) {
+            tables[i].columns.push_back(column.name);
+            tables[i].types.push_back(column.type);
+        }
+    }
+    // Tables without columns (e.g. measure tables) cannot be queried
+    tables.erase(std::remove_if(tables.begin(), tables.end(),
+                                [](const MSOLAPModelTable &table) { return table.columns.empty(); }),
+                 tables.end());
+    return tables;
+}
+
+MSOLAPTableEntry::MSOLAPTableEntry(Catalog &catalog, SchemaCatalogEntry &schema, CreateTableInfo &info,
+                                   const MSOLAPModelTable &table)
+    : TableCatalogEntry(catalog, schema, info), table(table) {
+}
+
+unique_ptr<BaseStatistics> MSOLAPTableEntry::GetStatistics(ClientContext &context, column_t column_id) {
+    return nullptr;
+}
+
+TableFunction MSOLAPTableEntry::GetScanFunction(ClientContext &context, unique_ptr<FunctionData> &bind_data) {
+    // The scan msolap(connection_string, 'EVALUATE ''Table''') binds, with the columns known from the catalog. They
+    // are selected by reference: the catalog knows their names and types, not the position the server returns them at.
+    auto result = make_uniq<MSOLAPBindData>();
+    result->connection_string = catalog.Cast<MSOLAPCatalog>().GetConnectionString();
+    auto quoted_table = MSOLAPDax::QuoteTable(table.name);
+    std::string columns;
+    for (auto &column : table.columns) {
+        result->dax_names.push_back(table.name + "[" + column + "]");
+        result->names.push_back(column);
+        columns += ", " + MSOLAPDax::QuoteString(column) + ", " + MSOLAPDax::ColumnReference(result->dax_names.back());
+    }
+    result->types = table.types;
+    result->dax_query = "EVALUATE SELECTCOLUMNS(" + quoted_table + columns + ")";
+    // Pushdown wraps the table itself, the rewritten queries select the columns the same way
+    result->rewritable = MSOLAPDaxQuery::TryParse("EVALUATE " + quoted_table, result->query);
+    result->always_project = true;
+    bind_data = std::move(result);
+    return MSOLAPScanFunction();
+}
+
+TableStorageInfo MSOLAPTableEntry::GetStorageInfo(ClientContext &context) {
+    return TableStorageInfo();
+}
+
+[[noreturn]] static void ThrowReadOnly() {
+    throw std::runtime_error("Attached msolap models are read-only");
+}
+
+MSOLAPSchemaEntry::MSOLAPSchemaEntry(Catalog &catalog, CreateSchemaInfo &info) : SchemaCatalogEntry(catalog, info) {
+}
+
+void MSOLAPSchemaEntry::SetTables(const std::vector<MSOLAPModelTable> &model_tables) {
+    case_insensitive_map_t<unique_ptr<MSOLAPTableEntry>> entries;
+    for (auto &table : model_tables) {
+        CreateTableInfo info(*this, table.name);
+        for (idx_t i = 0; i < table.columns.size(); i++) {
+            info.columns.AddColumn(ColumnDefinition(table.columns[i], table.types[i]));
+        }
+        entries[table.name] = make_uniq<MSOLAPTableEntry>(catalog, *this, info, table);
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    for (auto &entry : tables) {
+        retired.push_back(std::move(entry.second));
+    }
+    tables = std::move(entries);
+}
+
+void MSOLAPSchemaEntry::Scan(ClientContext &context, CatalogType type,
+                             const std::function<void(CatalogEntry &)> &callback) {
+    Scan(type, callback);
+}
+
+void MSOLAPSchemaEntry::Scan(CatalogType type, const std::function<void(CatalogEntry &)> &callback) {
+    if (type != CatalogType::TABLE_ENTRY) {
+        return;
+    }
+    std::vector<reference<CatalogEntry>> entries;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        for (auto &entry : tables) {
+            entries.push_back(*entry.second);
+        }
+    }
+    for (auto &entry : entries) {
+        callback(entry.get());
+    }
+}
+
+optional_ptr<CatalogEntry> MSOLAPSchemaEntry::LookupEntry(CatalogTransaction transaction,
+                                                          const EntryLookupInfo &lookup_info) {
+    if (lookup_info.GetCatalogType() != CatalogType::TABLE_ENTRY) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    auto entry = tables.find(lookup_info.GetEntryName());
+    if (entry == tables.end()) {
+        return nullptr;
+    }
+    return entry->second.get();
+}
+
+optional_ptr<CatalogEntry> MSOLAPSchemaEntry::CreateIndex(CatalogTransaction transaction, CreateIndexInfo &info,
+                                                          TableCatalogEntry &table) {
+    ThrowReadOnly();
+}
+
+optional_ptr<CatalogEntry> MSOLAPSchemaEntry::CreateFunction(CatalogTransaction transaction,
+                                                             CreateFunctionInfo &info) {
+    ThrowReadOnly();
+}
+
+optional_ptr<CatalogEntry> MSOLAPSchemaEntry::CreateTable(CatalogTransaction transaction, BoundCreateTableInfo &info) {
+    ThrowReadOnly();
+}
+
+optional_ptr<CatalogEntry> MSOLAPSchemaEntry::CreateView(CatalogTransaction transaction, CreateViewInfo &info) {
+    ThrowReadOnly();
+}
+
+optional_ptr<CatalogEntry> MSOLAPSchemaEntry::CreateSequence(CatalogTransaction transaction,
+                                                             CreateSequenceInfo &info) {
+    ThrowReadOnly();
+}
+
+optional_ptr<CatalogEntry> MSOLAPSchemaEntry::CreateTableFunction(CatalogTransaction transaction,
+                                                                  CreateTableFunctionInfo &info) {
+    ThrowReadOnly();
+}
+
+optional_ptr<CatalogEntry> MSOLAPSchemaEntry::CreateCopyFunction(CatalogTransaction transaction,
+                                                                 CreateCopyFunctionInfo &info) {
+    ThrowReadOnly();
+}
+
+optional_ptr<CatalogEntry> MSOLAPSchemaEntry::CreatePragmaFunction(CatalogTransaction transaction,
+                                                                   CreatePragmaFunctionInfo &info) {
+    ThrowReadOnly();
+}
+
+optional_ptr<CatalogEntry> MSOLAPSchemaEntry::CreateCollation(CatalogTransaction transaction,
+                                                              CreateCollationInfo &info) {
+    ThrowReadOnly();
+}
+
+optional_ptr<CatalogEntry> MSOLAPSchemaEntry::CreateType(CatalogTransaction transaction, CreateTypeInfo &info) {
+    ThrowReadOnly();
+}
+
+void MSOLAPSchemaEntry::DropEntry(ClientContext &context, DropInfo &info) {
+    ThrowReadOnly();
+}
+
+void MSOLAPSchemaEntry::Alter(CatalogTransaction transaction, AlterInfo &info) {
+    ThrowReadOnly();
+}
+
+MSOLAPCatalog::MSOLAPCatalog(AttachedDatabase &db, const std::string &connection_string)
+    : Catalog(db), connection_string(connection_string) {
+}
+
+void MSOLAPCatalog::Initialize(bool load_builtin) {
+    CreateSchemaInfo info;
+    info.schema = DEFAULT_SCHEMA;
+    main_schema = make_uniq<MSOLAPSchemaEntry>(*this, info);
+    Refresh();
+}
+
+idx_t MSOLAPCatalog::Refresh() {
+    std::vector<MSOLAPModelTable> tables;
+    try {
+        auto session = MSOLAPConnectionPool::Get().Acquire(connection_string);
+        tables = MSOLAPModelTable::Load(*session);
+    } catch (std::exception &e) {
+        throw std::runtime_error("MSOLAP connection failed: " + string(e.what()));
+    }
+    main_schema->SetTables(tables);
+    // msolap() scans of the data source may have changed along with the tables
+    MSOLAPSchemaCache::Get().Invalidate(connection_string);
+    return tables.size();
+}
+
+optional_ptr<CatalogEntry> MSOLAPCatalog::CreateSchema(CatalogTransaction transaction, CreateSchemaInfo &info) {
+    ThrowReadOnly();
+}
+
+void MSOLAPCatalog::ScanSchemas(ClientContext &context, std::function<void(SchemaCatalogEntry &)> callback) {
+    callback(*main_schema);
+}
+
+optional_ptr<SchemaCatalogEntry> MSOLAPCatalog::LookupSchema(CatalogTransaction transaction,
+                                                             const EntryLookupInfo &schema_lookup,
+                                                             OnEntryNotFound if_not_found) {
+    auto &schema_name = schema_lookup.GetEntryName();
+    if (schema_name == DEFAULT_SCHEMA) {
+        return main_schema.get();
+    }
+    if (if_not_found == OnEntryNotFound::RETURN_NULL) {
+        return nullptr;
+    }
+    throw CatalogException("Schema with name \"%s\" not found, attached msolap models only have \"%s\"", schema_name,
+                           DEFAULT_SCHEMA);
+}
+
+PhysicalOperator &MSOLAPCatalog::PlanCreateTableAs(ClientContext &context, PhysicalPlanGenerator &planner,
+                                                   LogicalCreateTable &op, PhysicalOperator &plan) {
+    ThrowReadOnly();
+}
+
+PhysicalOperator &MSOLAPCatalog::PlanInsert(ClientContext &context, PhysicalPlanGenerator &planner,
+                                            LogicalInsert &op, optional_ptr<PhysicalOperator> plan) {
+    ThrowReadOnly();
+}
+
+PhysicalOperator &MSOLAPCatalog::PlanDelete(ClientContext &context, PhysicalPlanGenerator &planner,
+                                            LogicalDelete &op, PhysicalOperator &plan) {
+    ThrowReadOnly();
+}
+
+PhysicalOperator &MSOLAPCatalog::PlanUpdate(ClientContext &context, PhysicalPlanGenerator &planner,
+                                            LogicalUpdate &op, PhysicalOperator &plan) {
+    ThrowReadOnly();
+}
+
+DatabaseSize MSOLAPCatalog::GetDatabaseSize(ClientContext &context) {
+    return DatabaseSize();
+}
+
+void MSOLAPCatalog::DropSchema(ClientContext &context, DropInfo &info) {
+    ThrowReadOnly();
+}
+
+MSOLAPTransactionManager::MSOLAPTransactionManager(AttachedDatabase &db) : TransactionManager(db) {
+}
+
+Transaction &MSOLAPTransactionManager::StartTransaction(ClientContext &context) {
+    auto transaction = make_uniq<Transaction>(*this, context);
+    auto &result = *transaction;
+    std::lock_guard<std::mutex> guard(lock);
+    transactions[result] = std::move(transaction);
+    return result;
+}
+
+ErrorData MSOLAPTransactionManager::CommitTransaction(ClientContext &context, Transaction &transaction) {
+    std::lock_guard<std::mutex> guard(lock);
+    transactions.erase(transaction);
+    return ErrorData();
+}
+
+void MSOLAPTransactionManager::RollbackTransaction(Transaction &transaction) {
+    std::lock_guard<std::mutex> guard(lock);
+    transactions.erase(transaction);
+}
+
+void MSOLAPTransactionManager::Checkpoint(ClientContext &context, bool force) {
+}
+
+} // namespace duckdb
@@ -0,0 +1,122 @@
+#include "msolap_column_writer.hpp"
+#include "msolap_conversion.hpp"
+#include "msolap_utf16.hpp"
+#include "duckdb/common/operator/cast_operators.hpp"
+#include <stdexcept>
+
+namespace duckdb {
+
+template <class T>
+static void WriteCastText(Vector &vector, idx_t row, const char *data, idx_t length) {
+    T result;
+    if (!TryCast::Operation<string_t, T>(string_t(data, (uint32_t)length), result, false)) {
+        throw std::runtime_error("Could not convert value \"" + std::string(data, length) + "\" to " +
+                                 vector.GetType().ToString());
+    }
+    FlatVector::GetData<T>(vector)[row] = result;
+}
+
+static void WriteStringText(Vector &vector, idx_t row, const char *data, idx_t length) {
+    MSOLAPColumnWriter::WriteString(vector, row, data, length);
+}
+
+// Types without a dedicated conversion go through a Value cast
+static void WriteGenericText(Vector &vector, idx_t row, const char *data, idx_t length) {
+    vector.SetValue(row, Value(std::string(data, length)).DefaultCastAs(vector.GetType()));
+}
+
+// Plain decimal notation is converted directly, anything else (e.g. an exponent) is cast
+static void WriteDecimalText(Vector &vector, idx_t row, const char *data, idx_t length) {
+    auto &type = vector.GetType();
+    hugeint_t result;
+    if (!MSOLAPConversion::TryParseDecimal(data, length, DecimalType::GetWidth(type), DecimalType::GetScale(type),
+                                           result)) {
+        WriteGenericText(vector, row, data, length);
+        return;
+    }
+    MSOLAPColumnWriter::WriteDecimal(vector, row, result);
+}
+
+MSOLAPColumnWriter::MSOLAPColumnWriter(const LogicalType &type_p) : type(type_p) {
+    switch (type.id()) {
+    case LogicalTypeId::VARCHAR:
+        text_writer = WriteStringText;
+        break;
+    case LogicalTypeId::BOOLEAN:
+        text_writer = WriteCastText<bool>;
+        break;
+    case LogicalTypeId::TINYINT:
+        text_writer = WriteCastText<int8_t>;
+        break;
+    case LogicalTypeId::SMALLINT:
+        text_writer = WriteCastText<int16_t>;
+        break;
+    case LogicalTypeId::INTEGER:
+        text_writer = WriteCastText<int32_t>;
+        break;
+    case LogicalTypeId::BIGINT:
+        text_writer = WriteCastText<int64_t>;
+        break;
+    case LogicalTypeId::UTINYINT:
+        text_writer = WriteCastText<uint8_t>;
+        break;
+    case LogicalTypeId::USMALLINT:
+        text_writer = WriteCastText<uint16_t>;
+        break;
+    case LogicalTypeId::UINTEGER:
+        text_writer = WriteCastText<uint32_t>;
+        break;
+    case LogicalTypeId::UBIGINT:
+        text_writer = WriteCastText<uint64_t>;
+        break;
+    case LogicalTypeId::FLOAT:
+        text_writer = WriteCastText<float>;
+        break;
+    case LogicalTypeId::DOUBLE:
+        text_writer = WriteCastText<double>;
+        break;
+    case LogicalTypeId::DECIMAL:
+        text_writer = WriteDecimalText;
+        break;
+    case LogicalTypeId::DATE:
+        text_writer = WriteCastText<date_t>;
+        break;
+    case LogicalTypeId::TIME:
+        text_writer = WriteCastText<dtime_t>;
+        break;
+    case LogicalTypeId::TIMESTAMP:
+        text_writer = WriteCastText<timestamp_t>;
+        break;
+    default:
+        text_writer = WriteGenericText;
+        break;
+    }
+}
+
+void MSOLAPColumnWriter::WriteDecimal(Vector &vector, idx_t row, hugeint_t value) {
+    // The value was checked against the width of the type, it fits its physical type
+    switch (vector.GetType().InternalType()) {
+    case PhysicalType::INT16:
+        WriteValue<int16_t>(vector, row, Hugeint::Cast<int16_t>(value));
+        break;
+    case PhysicalType::INT32:
+        WriteValue<int32_t>(vector, row, Hugeint::Cast<int32_t>(value));
+        break;
+    case PhysicalType::INT64:
+        WriteValue<int64_t>(vector, row, Hugeint::Cast<int64_t>(value));
+        break;
+    default:
+        WriteValue<hugeint_t>(vector, row, value);
+        break;
+    }
+}
+
+void MSOLAPColumnWriter::WriteUTF16(Vector &vector, idx_t row, const uint8_t *data, idx_t length) {
+    // Size the string first so it is converted in place, without an intermediate copy
+    auto result = StringVector::EmptyString(vector, MSOLAPUTF16::GetUTF8Length(data, length));
+    MSOLAPUTF16::ToUTF8(data, length, result.GetDataWriteable());
+    result.Finalize();
+    FlatVector::GetData<string_t>(vector)[row] = result;
+}
+
+} // namespace duckdb
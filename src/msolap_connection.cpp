@@ -1,5 +1,9 @@
+#ifdef _WIN32
+
 #include "msolap_connection.hpp"
 #include "msolap_utils.hpp"
+#include "msolap_bindings.hpp"
+#include "msolap_column_writer.hpp"
 #include <stdexcept>
 
 namespace duckdb {
@@ -8,7 +12,8 @@ namespace duckdb {
 bool MSOLAPConnection::com_initialized = false;
 
 MSOLAPConnection::MSOLAPConnection() 
-    : pIDBInitialize(nullptr), pIDBCreateCommand(nullptr) {
+    : pIDBInitialize(nullptr), pIDBCreateCommand(nullptr), pIActiveCommand(nullptr), cancelled(false),
+      multithreaded(true) {
 }
 
 MSOLAPConnection::~MSOLAPConnection() {
@@ -16,58 +21,38 @@ MSOLAPConnection::~MSOLAPConnection() {
 }
 
 MSOLAPConnection::MSOLAPConnection(MSOLAPConnection &&other) noexcept
-    : pIDBInitialize(nullptr), pIDBCreateCommand(nullptr) {
+    : pIDBInitialize(nullptr), pIDBCreateCommand(nullptr), pIActiveCommand(nullptr), cancelled(false),
+      multithreaded(true) {
     std::swap(pIDBInitialize, other.pIDBInitialize);
     std::swap(pIDBCreateCommand, other.pIDBCreateCommand);
+    std::swap(pIActiveCommand, other.pIActiveCommand);
+    cancelled = other.cancelled.exchange(cancelled);
     std::swap(server_name, other.server_name);
     std::swap(database_name, other.database_name);
+    std::swap(multithreaded, other.multithreaded);
 }
 
 MSOLAPConnection &MSOLAPConnection::operator=(MSOLAPConnection &&other) noexcept {
     std::swap(pIDBInitialize, other.pIDBInitialize);
     std::swap(pIDBCreateCommand, other.pIDBCreateCommand);
+    {
+        std::lock_guard<std::mutex> guard(command_lock);
+        std::swap(pIActiveCommand, other.pIActiveCommand);
+    }
+    cancelled = other.cancelled.exchange(cancelled);
     std::swap(server_name, other.server_name);
     std::swap(database_name, other.database_name);
+    std::swap(multithreaded, other.multithreaded);
     return *this;
 }
 
-void MSOLAPConnection::InitializeCOM() {
+bool MSOLAPConnection::InitializeCOM() {
     static thread_local ComInitializer initializer;
+    return initializer.IsMultithreaded();
 }
 
 void MSOLAPConnection::ParseConnectionString(const std::string &connection_string) {
-    // Simple parsing of connection string
-    // Format expected: "Data Source=localhost:61324;Catalog=0ec50266-bdf5-4582-bc8c-82584866bcb7"
-    
-    std::map<std::string, std::string> properties;
-    
-    size_t pos = 0;
-    std::string token;
-    std::string str = connection_string;
-    
-    while ((pos = str.find(';')) != std::string::npos) {
-        token = str.substr(0, pos);
-        
-        // Find key-value separator
-        size_t sep_pos = token.find('=');
-        if (sep_pos != std::string::npos) {
-            std::string key = token.substr(0, sep_pos);
-            std::string value = token.substr(sep_pos + 1);
-            properties[key] = value;
-        }
-        
-        str.erase(0, pos + 1);
-    }
-    
-    // Handle the last token after the last semicolon
-    if (!str.empty()) {
-        size_t sep_pos = str.find('=');
-        if (sep_pos != std::string::npos) {
-            std::string key = str.substr(0, sep_pos);
-            std::string value = str.substr(sep_pos + 1);
-            properties[key] = value;
-        }
-    }
+    auto properties = MSOLAPUtils::ParseConnectionString(connection_string);
     
     // Extract server and database
     auto server_it = properties.find("Data Source");
@@ -89,7 +74,7 @@ MSOLAPConnection MSOLAPConnection::Connect(const std::string &connection_string)
     MSOLAPConnection connection;
     
     // Initialize COM
-    InitializeCOM();
+    connection.multithreaded = InitializeCOM();
     
     // Parse connection string
     connection.ParseConnectionString(connection_string);
@@ -180,7 +165,96 @@ MSOLAPConnection MSOLAPConnection::Connect(const std::string &connection_string)
     return connection;
 }
 
-IRowset* MSOLAPConnection::ExecuteQuery(const std::string &dax_query) {
+unique_ptr<MSOLAPRowset> MSOLAPConnection::ExecuteQuery(const std::string &dax_query) {
+    auto result = make_uniq<MSOLAPOLEDBRowset>(ExecuteCommand(dax_query));
+    result->CreateAccessor();
+    return std::move(result);
+}
+
+// Append the DAX name (e.g. Table[Column]) and DuckDB type of an OLE DB column
+static void AddColumn(const DBCOLUMNINFO &column, DBORDINAL index, std::vector<std::string> &names,
+                      std::vector<LogicalType> &types) {
+    if (column.pwszName) {
+        std::string name;
+        MSOLAPUtils::AppendUTF16((const uint8_t *)column.pwszName, wcslen(column.pwszName), name);
+        names.push_back(std::move(name));
+    } else {
+        names.push_back("Column" + std::to_string(index));
+    }
+    types.push_back(MSOLAPUtils::GetLogicalTypeFromDBTYPE(column.wType, column.bPrecision, column.bScale));
+}
+
+void MSOLAPConnection::DescribeQuery(const std::string &dax_query, std::vector<std::string> &names,
+                                     std::vector<LogicalType> &types) {
+    ICommand* pICommand = CreateCommand(dax_query);
+
+    // Preparing the command makes the provider validate the query and describe its columns without
+    // evaluating it. Providers that cannot describe a prepared command fall back to executing it.
+    ICommandPrepare* pICommandPrepare = NULL;
+    IColumnsInfo* pIColumnsInfo = NULL;
+    HRESULT hr = pICommand->QueryInterface(IID_ICommandPrepare, (void**)&pICommandPrepare);
+    if (SUCCEEDED(hr)) {
+        hr = pICommandPrepare->Prepare(0);
+        MSOLAPUtils::SafeRelease(&pICommandPrepare);
+        if (FAILED(hr)) {
+            MSOLAPUtils::SafeRelease(&pICommand);
+            throw std::runtime_error("Query preparation failed: " + MSOLAPUtils::GetErrorMessage(hr));
+        }
+        hr = pICommand->QueryInterface(IID_IColumnsInfo, (void**)&pIColumnsInfo);
+    }
+
+    DBORDINAL column_count = 0;
+    DBCOLUMNINFO* pColumnInfo = NULL;
+    WCHAR* pStringsBuffer = NULL;
+    if (SUCCEEDED(hr)) {
+        hr = pIColumnsInfo->GetColumnInfo(&column_count, &pColumnInfo, &pStringsBuffer);
+        MSOLAPUtils::SafeRelease(&pIColumnsInfo);
+    }
+    MSOLAPUtils::SafeRelease(&pICommand);
+
+    if (FAILED(hr) || column_count == 0) {
+        CoTaskMemFree(pColumnInfo);
+        CoTaskMemFree(pStringsBuffer);
+        auto rowset = ExecuteQuery(dax_query);
+        rowset->GetColumnInfo(names, types);
+        return;
+    }
+
+    for (DBORDINAL i = 0; i < column_count; i++) {
+        // Skip the bookmark column, it is not part of the result
+        if (pColumnInfo[i].iOrdinal == 0) {
+            continue;
+        }
+        AddColumn(pColumnInfo[i], i, names, types);
+    }
+    CoTaskMemFree(pColumnInfo);
+    CoTaskMemFree(pStringsBuffer);
+}
+
+IRowset* MSOLAPConnection::ExecuteCommand(const std::string &dax_query) {
+    ICommand* pICommand = CreateCommand(dax_query);
+    {
+        std::lock_guard<std::mutex> guard(command_lock);
+        if (cancelled) {
+            MSOLAPUtils::SafeRelease(&pICommand);
+            throw std::runtime_error("The query was cancelled");
+        }
+        MSOLAPUtils::SafeRelease(&pIActiveCommand);
+        pIActiveCommand = pICommand;
+    }
+
+    // Execute the command
+    IRowset* pIRowset = NULL;
+    HRESULT hr = pICommand->Execute(NULL, IID_IRowset, NULL, NULL, (IUnknown**)&pIRowset);
+
+    if (FAILED(hr)) {
+        throw std::runtime_error("Query execution failed: " + MSOLAPUtils::GetErrorMessage(hr));
+    }
+    
+    return pIRowset;
+}
+
+ICommand* MSOLAPConnection::CreateCommand(const std::string &dax_query) {
     if (!IsOpen()) {
         throw std::runtime_error("Connection is not open");
     }
@@ -237,80 +311,354 @@ IRowset* MSOLAPConnection::ExecuteQuery(const std::string &dax_query) {
         MSOLAPUtils::SafeRelease(&pICommandProperties);
     }
 
-    // Execute the command
-    IRowset* pIRowset = NULL;
-    hr = pICommand->Execute(NULL, IID_IRowset, NULL, NULL, (IUnknown**)&pIRowset);
     MSOLAPUtils::SafeRelease(&pICommandText);
-    MSOLAPUtils::SafeRelease(&pICommand);
+    return pICommand;
+}
 
-    if (FAILED(hr)) {
-        throw std::runtime_error("Query execution failed: " + MSOLAPUtils::GetErrorMessage(hr));
+bool MSOLAPConnection::IsOpen() const {
+    return pIDBInitialize != nullptr && pIDBCreateCommand != nullptr && !cancelled;
+}
+
+void MSOLAPConnection::Ping() {
+    // Evaluated by the formula engine without touching the model
+    IRowset* pIRowset = ExecuteCommand("EVALUATE {1}");
+    MSOLAPUtils::SafeRelease(&pIRowset);
+}
+
+void MSOLAPConnection::Cancel() {
+    // ICommand::Cancel may be called from another thread than the one executing the command or reading its rowset
+    std::lock_guard<std::mutex> guard(command_lock);
+    cancelled = true;
+    if (pIActiveCommand) {
+        pIActiveCommand->Cancel();
+    }
+}
+
+void MSOLAPConnection::Close() {
+    {
+        std::lock_guard<std::mutex> guard(command_lock);
+        MSOLAPUtils::SafeRelease(&pIActiveCommand);
+    }
+    if (pIDBCreateCommand) {
+        MSOLAPUtils::SafeRelease(&pIDBCreateCommand);
     }
     
-    return pIRowset;
+    if (pIDBInitialize) {
+        pIDBInitialize->Uninitialize();
+        MSOLAPUtils::SafeRelease(&pIDBInitialize);
+    }
 }
 
-bool MSOLAPConnection::GetColumnInfo(IRowset *rowset, std::vector<std::string> &names, std::vector<LogicalType> &types) {
-    if (!rowset) {
-        return false;
+MSOLAPOLEDBRowset::MSOLAPOLEDBRowset(IRowset *rowset)
+    : rowset(rowset), accessor(nullptr), haccessor(NULL), bindings(nullptr), column_count(0),
+      row_data(nullptr), row_size(0), done(false) {
+}
+
+MSOLAPOLEDBRowset::~MSOLAPOLEDBRowset() {
+    // Clean up resources
+    if (row_data) {
+        delete[] row_data;
+        row_data = nullptr;
+    }
+    
+    if (bindings) {
+        CoTaskMemFree(bindings);
+        bindings = nullptr;
+    }
+    
+    if (accessor && haccessor) {
+        accessor->ReleaseAccessor(haccessor, NULL);
+        haccessor = NULL;
+    }
+    
+    if (accessor) {
+        MSOLAPUtils::SafeRelease(&accessor);
     }
     
+    if (rowset) {
+        MSOLAPUtils::SafeRelease(&rowset);
+    }
+}
+
+void MSOLAPOLEDBRowset::GetColumnInfo(std::vector<std::string> &names_p, std::vector<LogicalType> &types_p) {
+    names_p = names;
+    types_p = types;
+}
+
+// DBTYPE the provider converts a column to, given its own type and the DuckDB type of the column
+static DBTYPE GetBindingType(DBTYPE column_type, const LogicalType &type) {
+    switch (type.id()) {
+    case LogicalTypeId::BOOLEAN:
+        return DBTYPE_BOOL;
+    case LogicalTypeId::TINYINT:
+        return DBTYPE_I1;
+    case LogicalTypeId::SMALLINT:
+        return DBTYPE_I2;
+    case LogicalTypeId::INTEGER:
+        return DBTYPE_I4;
+    case LogicalTypeId::BIGINT:
+        return DBTYPE_I8;
+    case LogicalTypeId::UTINYINT:
+        return DBTYPE_UI1;
+    case LogicalTypeId::USMALLINT:
+        return DBTYPE_UI2;
+    case LogicalTypeId::UINTEGER:
+        return DBTYPE_UI4;
+    case LogicalTypeId::UBIGINT:
+        return DBTYPE_UI8;
+    case LogicalTypeId::FLOAT:
+        return DBTYPE_R4;
+    case LogicalTypeId::DOUBLE:
+        return DBTYPE_R8;
+    case LogicalTypeId::DECIMAL:
+        // Bound in their own representation, currency as its scaled 64-bit integer
+        if (column_type == DBTYPE_CY || column_type == DBTYPE_NUMERIC) {
+            return column_type;
+        }
+        return DBTYPE_DECIMAL;
+    case LogicalTypeId::DATE:
+        return DBTYPE_DBDATE;
+    case LogicalTypeId::TIMESTAMP:
+        return column_type == DBTYPE_DATE ? DBTYPE_DATE : DBTYPE_DBTIMESTAMP;
+    default:
+        return DBTYPE_WSTR;
+    }
+}
+
+static DBLENGTH GetBindingSize(DBTYPE type) {
+    switch (type) {
+    case DBTYPE_BOOL:
+        return sizeof(VARIANT_BOOL);
+    case DBTYPE_I1:
+        return sizeof(int8_t);
+    case DBTYPE_I2:
+        return sizeof(int16_t);
+    case DBTYPE_I4:
+        return sizeof(int32_t);
+    case DBTYPE_I8:
+        return sizeof(int64_t);
+    case DBTYPE_UI1:
+        return sizeof(uint8_t);
+    case DBTYPE_UI2:
+        return sizeof(uint16_t);
+    case DBTYPE_UI4:
+        return sizeof(uint32_t);
+    case DBTYPE_UI8:
+        return sizeof(uint64_t);
+    case DBTYPE_R4:
+        return sizeof(float);
+    case DBTYPE_R8:
+        return sizeof(double);
+    case DBTYPE_CY:
+        return sizeof(CY);
+    case DBTYPE_DECIMAL:
+        return sizeof(DECIMAL);
+    case DBTYPE_NUMERIC:
+        return sizeof(DB_NUMERIC);
+    case DBTYPE_DATE:
+        return sizeof(DATE);
+    case DBTYPE_DBDATE:
+        return sizeof(DBDATE);
+    case DBTYPE_DBTIMESTAMP:
+        return sizeof(DBTIMESTAMP);
+    default:
+        return sizeof(WCHAR *);
+    }
+}
+
+static DWORD AlignOffset(DWORD offset) {
+    return (offset + 7) & ~DWORD(7);
+}
+
+void MSOLAPOLEDBRowset::CreateAccessor() {
+    // Get the IAccessor interface
+    HRESULT hr = rowset->QueryInterface(IID_IAccessor, (void**)&accessor);
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to get IAccessor: " + MSOLAPUtils::GetErrorMessage(hr));
+    }
+
     // Get column information using IColumnsInfo
     IColumnsInfo* pIColumnsInfo = NULL;
-    HRESULT hr = rowset->QueryInterface(IID_IColumnsInfo, (void**)&pIColumnsInfo);
+    hr = rowset->QueryInterface(IID_IColumnsInfo, (void**)&pIColumnsInfo);
     if (FAILED(hr)) {
-        return false;
+        throw std::runtime_error("Failed to get IColumnsInfo: " + MSOLAPUtils::GetErrorMessage(hr));
     }
 
     // Get column information
-    DBORDINAL cColumns;
     WCHAR* pStringsBuffer = NULL;
     DBCOLUMNINFO* pColumnInfo = NULL;
 
-    hr = pIColumnsInfo->GetColumnInfo(&cColumns, &pColumnInfo, &pStringsBuffer);
+    hr = pIColumnsInfo->GetColumnInfo(&column_count, &pColumnInfo, &pStringsBuffer);
     if (FAILED(hr)) {
         MSOLAPUtils::SafeRelease(&pIColumnsInfo);
-        return false;
+        throw std::runtime_error("Failed to get column info: " + MSOLAPUtils::GetErrorMessage(hr));
     }
 
-    // Process column information
-    names.clear();
-    types.clear();
+    // Create bindings for all columns
+    bindings = (DBBINDING*)CoTaskMemAlloc(column_count * sizeof(DBBINDING));
+    if (!bindings) {
+        CoTaskMemFree(pColumnInfo);
+        CoTaskMemFree(pStringsBuffer);
+        MSOLAPUtils::SafeRelease(&pIColumnsInfo);
+        throw std::runtime_error("Failed to allocate memory for bindings");
+    }
     
-    for (DBORDINAL i = 0; i < cColumns; i++) {
-        std::string column_name;
-        if (pColumnInfo[i].pwszName) {
-            // Sanitize column name (replace [] with _)
-            column_name = MSOLAPUtils::SanitizeColumnName(pColumnInfo[i].pwszName);
-        } else {
-            column_name = "Column" + std::to_string(i);
+    // Lay out status, length and value of every column in the row buffer
+    DWORD dwOffset = 0;
+    for (DBORDINAL i = 0; i < column_count; i++) {
+        AddColumn(pColumnInfo[i], i, names, types);
+
+        DBTYPE binding_type = GetBindingType(pColumnInfo[i].wType, types.back());
+        DBLENGTH max_length = GetBindingSize(binding_type);
+        if (binding_type == DBTYPE_WSTR) {
+            // The provider allocates every string, so a value longer than the declared column size is never
+            // truncated to a buffer in the row
+            binding_type |= DBTYPE_BYREF;
         }
+
+        bindings[i].iOrdinal = pColumnInfo[i].iOrdinal; // 1-based ordinals
+        bindings[i].obStatus = dwOffset;
+        bindings[i].obLength = AlignOffset(dwOffset + sizeof(DBSTATUS));
+        bindings[i].obValue = AlignOffset(bindings[i].obLength + sizeof(DBLENGTH));
+        bindings[i].pTypeInfo = NULL;
+        bindings[i].pObject = NULL;
+        bindings[i].pBindExt = NULL;
+        bindings[i].cbMaxLen = max_length;
+        bindings[i].dwFlags = 0;
+        bindings[i].eParamIO = DBPARAMIO_NOTPARAM;
+        bindings[i].dwPart = DBPART_VALUE | DBPART_LENGTH | DBPART_STATUS;
+        bindings[i].dwMemOwner = DBMEMOWNER_CLIENTOWNED;
+        bindings[i].wType = binding_type;
+        // Only used by DECIMAL and NUMERIC bindings, which keep the declared precision and scale
+        bindings[i].bPrecision = pColumnInfo[i].bPrecision;
+        bindings[i].bScale = pColumnInfo[i].bScale;
         
-        names.push_back(column_name);
-        types.push_back(MSOLAPUtils::GetLogicalTypeFromDBTYPE(pColumnInfo[i].wType));
+        MSOLAPColumnBinding column;
+        column.status_offset = bindings[i].obStatus;
+        column.length_offset = bindings[i].obLength;
+        column.value_offset = bindings[i].obValue;
+        column.type = bindings[i].wType;
+        columns.push_back(column);
+
+        // Increment offset to the next column
+        dwOffset = AlignOffset(DWORD(bindings[i].obValue + max_length));
     }
-    
+
     // Clean up
     CoTaskMemFree(pColumnInfo);
     CoTaskMemFree(pStringsBuffer);
     MSOLAPUtils::SafeRelease(&pIColumnsInfo);
+
+    // Create the accessor
+    hr = accessor->CreateAccessor(
+        DBACCESSOR_ROWDATA,
+        column_count,
+        bindings,
+        dwOffset,
+        &haccessor,
+        NULL
+    );
     
-    return true;
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to create accessor: " + MSOLAPUtils::GetErrorMessage(hr));
+    }
+    
+    // Allocate buffer for row data
+    row_size = dwOffset;
+    // Zeroed, no BYREF binding holds a string before the first row is read
+    row_data = new BYTE[row_size]();
 }
 
-bool MSOLAPConnection::IsOpen() const {
-    return pIDBInitialize != nullptr && pIDBCreateCommand != nullptr;
-}
+// The row buffer is decoded by MSOLAPBindings, on the layouts of these structures
+static_assert(sizeof(DBSTATUS) == sizeof(uint32_t), "DBSTATUS layout");
+static_assert(sizeof(DBLENGTH) == sizeof(size_t), "DBLENGTH layout");
+static_assert(sizeof(DECIMAL) == sizeof(MSOLAPBindings::DBDecimal), "DECIMAL layout");
+static_assert(sizeof(DB_NUMERIC) == sizeof(MSOLAPBindings::DBNumeric), "DB_NUMERIC layout");
+static_assert(sizeof(DBDATE) == sizeof(MSOLAPBindings::DBDate), "DBDATE layout");
+static_assert(sizeof(DBTIMESTAMP) == sizeof(MSOLAPBindings::DBTimestamp), "DBTIMESTAMP layout");
+static_assert(sizeof(VARIANT) == sizeof(MSOLAPBindings::DBVariant), "VARIANT layout");
+
+// Row handles of a batch, released when the batch is done, also when one of its values fails to convert
+class OLEDBFetchedRows {
+public:
+    OLEDBFetchedRows(IRowset *rowset, DBROWCOUNT capacity) : rowset(rowset), handles(new HROW[capacity]), count(0) {
+    }
+    ~OLEDBFetchedRows() {
+        if (count > 0) {
+            rowset->ReleaseRows(count, handles.get(), NULL, NULL, NULL);
+        }
+    }
 
-void MSOLAPConnection::Close() {
-    if (pIDBCreateCommand) {
-        MSOLAPUtils::SafeRelease(&pIDBCreateCommand);
+    IRowset *rowset;
+    std::unique_ptr<HROW[]> handles;
+    DBCOUNTITEM count;
+};
+
+// Strings the provider allocated for the BYREF bindings of the row in the row buffer, freed once the row is
+// written to the output or failed
+class OLEDBRowStrings {
+public:
+    OLEDBRowStrings(const DBBINDING *bindings, DBORDINAL column_count, BYTE *row_data)
+        : bindings(bindings), column_count(column_count), row_data(row_data) {
     }
-    
-    if (pIDBInitialize) {
-        pIDBInitialize->Uninitialize();
-        MSOLAPUtils::SafeRelease(&pIDBInitialize);
+    ~OLEDBRowStrings() {
+        for (DBORDINAL i = 0; i < column_count; i++) {
+            auto &binding = bindings[i];
+            auto status = *(const DBSTATUS *)(row_data + binding.obStatus);
+            if ((binding.wType & DBTYPE_BYREF) == 0 || (status != DBSTATUS_S_OK && status != DBSTATUS_S_TRUNCATED)) {
+                continue;
+            }
+            auto &value = *(void **)(row_data + binding.obValue);
+            CoTaskMemFree(value);
+            value = NULL;
+        }
+    }
+
+private:
+    const DBBINDING *bindings;
+    DBORDINAL column_count;
+    BYTE *row_data;
+};
+
+idx_t MSOLAPOLEDBRowset::Fetch(DataChunk &output) {
+    if (done) {
+        return 0;
+    }
+
+    // Process rows in batches
+    const DBROWCOUNT batch_size = STANDARD_VECTOR_SIZE;
+    OLEDBFetchedRows rows(rowset, batch_size);
+    HROW *handles = rows.handles.get();
+    HRESULT hr = rowset->GetNextRows(0, 0, batch_size, &rows.count, &handles);
+    if (FAILED(hr)) {
+        rows.count = 0;
+        throw std::runtime_error("Failed to get rows: " + MSOLAPUtils::GetErrorMessage(hr));
+    }
+    if (rows.count == 0) {
+        done = true;
+        return 0;
+    }
+
+    const idx_t col_count = output.ColumnCount();
+    for (DBCOUNTITEM i = 0; i < rows.count; i++) {
+        // Get the row data
+        hr = rowset->GetData(handles[i], haccessor, row_data);
+        OLEDBRowStrings strings(bindings, column_count, row_data);
+        if (FAILED(hr)) {
+            // On error, add NULL values for all columns
+            for (idx_t col = 0; col < col_count; col++) {
+                MSOLAPColumnWriter::WriteNull(output.data[col], i);
+            }
+            continue;
+        }
+        // Copy every column straight into its vector
+        MSOLAPBindings::WriteRow(columns, row_data, names, output, i);
     }
+
+    output.SetCardinality(rows.count);
+    return rows.count;
 }
 
-} // namespace duckdb
\ No newline at end of file
+} // namespace duckdb
+
+#endif // _WIN32
@@ -0,0 +1,128 @@
+#include "msolap_conversion.hpp"
+#include <cmath>
+
+namespace duckdb {
+
+// 1899-12-30 is 25569 days before 1970-01-01
+static constexpr int64_t OA_DATE_EPOCH_OFFSET = 25569;
+// OLE automation dates range from 0100-01-01 to 9999-12-31
+static constexpr double OA_DATE_MIN = -657435.0;
+static constexpr double OA_DATE_MAX = 2958466.0;
+static constexpr uint8_t MAX_DECIMAL_DIGITS = 38;
+
+bool MSOLAPConversion::TryConvertDecimal(hugeint_t magnitude, bool negative, uint8_t scale, uint8_t width,
+                                         uint8_t target_scale, hugeint_t &result) {
+    if (magnitude < hugeint_t(0) || scale > MAX_DECIMAL_DIGITS || width > MAX_DECIMAL_DIGITS ||
+        target_scale > width) {
+        return false;
+    }
+    auto value = magnitude;
+    if (target_scale >= scale) {
+        if (!Hugeint::TryMultiply(value, Hugeint::POWERS_OF_TEN[target_scale - scale], value)) {
+            return false;
+        }
+    } else {
+        auto divisor = Hugeint::POWERS_OF_TEN[scale - target_scale];
+        auto remainder = value % divisor;
+        value = value / divisor;
+        if (remainder >= divisor - remainder) {
+            value += hugeint_t(1);
+        }
+    }
+    if (value >= Hugeint::POWERS_OF_TEN[width]) {
+        return false;
+    }
+    result = negative ? -value : value;
+    return true;
+}
+
+// Append the digits collected in 64 bits to the 128-bit value
+static bool FlushDigits(hugeint_t &value, uint64_t &pending, idx_t &pending_digits) {
+    if (!Hugeint::TryMultiply(value, Hugeint::POWERS_OF_TEN[pending_digits], value)) {
+        return false;
+    }
+    value += hugeint_t((int64_t)pending);
+    pending = 0;
+    pending_digits = 0;
+    return true;
+}
+
+bool MSOLAPConversion::TryParseDecimal(const char *data, idx_t length, uint8_t width, uint8_t target_scale,
+                                       hugeint_t &result) {
+    // Digits are collected in 64 bits, 18 at a time
+    static constexpr idx_t MAX_PENDING_DIGITS = 18;
+    if (width > MAX_DECIMAL_DIGITS || target_scale > width) {
+        return false;
+    }
+    idx_t pos = 0;
+    bool negative = false;
+    if (pos < length && (data[pos] == '-' || data[pos] == '+')) {
+        negative = data[pos] == '-';
+        pos++;
+    }
+    hugeint_t value(0);
+    uint64_t pending = 0;
+    idx_t pending_digits = 0;
+    idx_t digits = 0;
+    idx_t scale = 0;
+    bool fraction = false;
+    bool dropped = false;
+    bool round_up = false;
+    for (; pos < length; pos++) {
+        auto c = data[pos];
+        if (c == '.' && !fraction) {
+            fraction = true;
+            continue;
+        }
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        digits++;
+        if (fraction && scale == target_scale) {
+            // Beyond the scale of the type the first dropped digit rounds half away from zero
+            if (!dropped) {
+                round_up = c >= '5';
+                dropped = true;
+            }
+            continue;
+        }
+        pending = pending * 10 + uint64_t(c - '0');
+        pending_digits++;
+        if (fraction) {
+            scale++;
+        }
+        if (pending_digits == MAX_PENDING_DIGITS && !FlushDigits(value, pending, pending_digits)) {
+            return false;
+        }
+    }
+    if (digits == 0 || !FlushDigits(value, pending, pending_digits)) {
+        return false;
+    }
+    // Pad the fraction to the scale of the type
+    if (!Hugeint::TryMultiply(value, Hugeint::POWERS_OF_TEN[target_scale - scale], value)) {
+        return false;
+    }
+    if (round_up) {
+        value += hugeint_t(1);
+    }
+    if (value >= Hugeint::POWERS_OF_TEN[width]) {
+        return false;
+    }
+    result = negative ? -value : value;
+    return true;
+}
+
+bool MSOLAPConversion::TryConvertOADate(double value, timestamp_t &result) {
+    if (!(value >= OA_DATE_MIN && value < OA_DATE_MAX)) {
+        return false;
+    }
+    // The fraction is the time of day for negative days as well, it is added to the start of the day
+    auto days = std::trunc(value);
+    auto millis = (int64_t)std::llround(std::fabs(value - days) * double(Interval::MSECS_PER_DAY));
+    auto whole_days = (int64_t)days;
+    result = timestamp_t((whole_days - OA_DATE_EPOCH_OFFSET) * Interval::MICROS_PER_DAY +
+                         millis * Interval::MICROS_PER_MSEC);
+    return true;
+}
+
+} // namespace duckdb
@@ -0,0 +1,679 @@
+#include "msolap_dax.hpp"
+#include "msolap_conversion.hpp"
+#include "duckdb/planner/filter/constant_filter.hpp"
+#include "duckdb/planner/filter/conjunction_filter.hpp"
+#include "duckdb/planner/filter/in_filter.hpp"
+#include "duckdb/planner/filter/optional_filter.hpp"
+#include <cmath>
+#include <limits>
+
+namespace duckdb {
+
+static bool IsIdentifierChar(char c) {
+    return isalnum((unsigned char)c) || c == '_' || c == '.';
+}
+
+// End of the string literal, quoted table name or bracketed column name starting at pos
+static idx_t SkipQuoted(const std::string &text, idx_t pos) {
+    char close = text[pos] == '[' ? ']' : text[pos];
+    pos++;
+    while (pos < text.size()) {
+        if (text[pos] == close) {
+            // A doubled closing character is an escaped one
+            if (pos + 1 < text.size() && text[pos + 1] == close) {
+                pos += 2;
+                continue;
+            }
+            return pos + 1;
+        }
+        pos++;
+    }
+    return pos;
+}
+
+// Copy of the query with every comment replaced by a space
+static std::string RemoveComments(const std::string &query) {
+    std::string result;
+    result.reserve(query.size());
+    idx_t pos = 0;
+    while (pos < query.size()) {
+        char c = query[pos];
+        if (c == '"' || c == '\'' || c == '[') {
+            auto end = SkipQuoted(query, pos);
+            result.append(query, pos, end - pos);
+            pos = end;
+        } else if ((c == '/' || c == '-') && pos + 1 < query.size() && query[pos + 1] == c) {
+            pos = query.find('\n', pos);
+            pos = pos == std::string::npos ? query.size() : pos;
+            result += ' ';
+        } else if (c == '/' && pos + 1 < query.size() && query[pos + 1] == '*') {
+            pos = query.find("*/", pos + 2);
+            pos = pos == std::string::npos ? query.size() : pos + 2;
+            result += ' ';
+        } else {
+            result += c;
+            pos++;
+        }
+    }
+    return result;
+}
+
+static std::string Trimmed(const std::string &text, idx_t start, idx_t end) {
+    auto result = text.substr(start, end - start);
+    StringUtil::Trim(result);
+    return result;
+}
+
+bool MSOLAPDaxQuery::TryParse(const std::string &query, MSOLAPDaxQuery &result) {
+    auto text = RemoveComments(query);
+
+    // Find the statement keywords outside of parentheses, literals and names
+    idx_t depth = 0;
+    idx_t evaluate_count = 0;
+    idx_t evaluate_start = 0;
+    idx_t evaluate_end = 0;
+    idx_t order_start = std::string::npos;
+    std::string previous_word;
+    idx_t previous_word_start = 0;
+    idx_t pos = 0;
+    while (pos < text.size()) {
+        char c = text[pos];
+        if (c == '"' || c == '\'' || c == '[') {
+            pos = SkipQuoted(text, pos);
+            previous_word.clear();
+            continue;
+        }
+        if (c == '(' || c == '{') {
+            depth++;
+        } else if ((c == ')' || c == '}') && depth > 0) {
+            depth--;
+        }
+        if (!IsIdentifierChar(c)) {
+            if (!isspace((unsigned char)c)) {
+                previous_word.clear();
+            }
+            pos++;
+            continue;
+        }
+
+        idx_t word_start = pos;
+        while (pos < text.size() && IsIdentifierChar(text[pos])) {
+            pos++;
+        }
+        auto word = StringUtil::Upper(text.substr(word_start, pos - word_start));
+        if (depth == 0) {
+            if (word == "EVALUATE") {
+                evaluate_count++;
+                evaluate_start = word_start;
+                evaluate_end = pos;
+            } else if (word == "BY" && previous_word == "ORDER" && evaluate_count > 0 &&
+                       order_start == std::string::npos) {
+                order_start = previous_word_start;
+            }
+        }
+        previous_word = word;
+        previous_word_start = word_start;
+    }
+
+    if (evaluate_count != 1) {
+        return false;
+    }
+    result.define = Trimmed(text, 0, evaluate_start);
+    if (!result.define.empty() && !StringUtil::StartsWith(StringUtil::Upper(result.define), "DEFINE")) {
+        return false;
+    }
+    if (order_start != std::string::npos && order_start < evaluate_end) {
+        return false;
+    }
+    idx_t table_end = order_start == std::string::npos ? text.size() : order_start;
+    result.table = Trimmed(text, evaluate_end, table_end);
+    result.order_by = order_start == std::string::npos ? "" : Trimmed(text, order_start, text.size());
+    return !result.table.empty();
+}
+
+std::string MSOLAPDaxQuery::Build(const std::string &table_expression, bool keep_order_by) const {
+    std::string result;
+    if (!define.empty()) {
+        result += define + "\n";
+    }
+    result += "EVALUATE " + table_expression;
+    if (keep_order_by && !order_by.empty()) {
+        result += "\n" + order_by;
+    }
+    return result;
+}
+
+std::string MSOLAPDaxQuery::GetModelTable() const {
+    if (table.size() >= 2 && table.front() == '\'' && table.back() == '\'') {
+        return StringUtil::Replace(table.substr(1, table.size() - 2), "''", "'");
+    }
+    for (auto c : table) {
+        if (!isalnum((unsigned char)c) && c != '_') {
+            return "";
+        }
+    }
+    return table;
+}
+
+std::string MSOLAPDax::QuoteString(const std::string &text) {
+    return "\"" + StringUtil::Replace(text, "\"", "\"\"") + "\"";
+}
+
+std::string MSOLAPDax::QuoteTable(const std::string &name) {
+    return "'" + StringUtil::Replace(name, "'", "''") + "'";
+}
+
+std::string MSOLAPDax::QuoteColumn(const std::string &name) {
+    return "[" + StringUtil::Replace(name, "]", "]]") + "]";
+}
+
+bool MSOLAPDax::IsModelColumn(const std::string &column_name, const std::string &model_table) {
+    auto bracket = column_name.find('[');
+    return bracket != std::string::npos && StringUtil::CIEquals(column_name.substr(0, bracket), model_table);
+}
+
+std::string MSOLAPDax::ColumnReference(const std::string &column_name) {
+    auto bracket = column_name.find('[');
+    if (bracket == std::string::npos || column_name.back() != ']') {
+        return QuoteColumn(column_name);
+    }
+    auto table = column_name.substr(0, bracket);
+    auto column = column_name.substr(bracket + 1, column_name.size() - bracket - 2);
+    if (table.empty()) {
+        return QuoteColumn(column);
+    }
+    if (table.size() >= 2 && table.front() == '\'' && table.back() == '\'') {
+        // Already quoted by the server
+        return table + QuoteColumn(column);
+    }
+    return QuoteTable(table) + QuoteColumn(column);
+}
+
+// The number of %g text in fixed notation, as DAX does not parse exponents: 1e-07 is 0.0000001, 1.5e+20 is
+// 150000000000000000000
+static std::string FixedNotation(const std::string &text) {
+    auto exponent_pos = text.find_first_of("eE");
+    if (exponent_pos == std::string::npos) {
+        return text;
+    }
+    idx_t start = text[0] == '-' ? 1 : 0;
+    auto mantissa = text.substr(start, exponent_pos - start);
+    auto exponent = std::stoi(text.substr(exponent_pos + 1));
+    auto dot = mantissa.find('.');
+    auto digits = dot == std::string::npos ? mantissa : mantissa.substr(0, dot) + mantissa.substr(dot + 1);
+    // Digits before the decimal point
+    int64_t integer_digits = int64_t(dot == std::string::npos ? mantissa.size() : dot) + exponent;
+    std::string result = text.substr(0, start);
+    if (integer_digits <= 0) {
+        result += "0." + std::string(-integer_digits, '0') + digits;
+    } else if (idx_t(integer_digits) >= digits.size()) {
+        result += digits + std::string(integer_digits - digits.size(), '0');
+    } else {
+        result += digits.substr(0, integer_digits) + "." + digits.substr(integer_digits);
+    }
+    return result;
+}
+
+bool MSOLAPDax::TryLiteral(const Value &value, std::string &result) {
+    if (value.IsNull()) {
+        return false;
+    }
+    switch (value.type().id()) {
+    case LogicalTypeId::BOOLEAN:
+        result = value.GetValue<bool>() ? "TRUE()" : "FALSE()";
+        return true;
+    case LogicalTypeId::TINYINT:
+    case LogicalTypeId::SMALLINT:
+    case LogicalTypeId::INTEGER:
+    case LogicalTypeId::BIGINT:
+    case LogicalTypeId::UTINYINT:
+    case LogicalTypeId::USMALLINT:
+    case LogicalTypeId::UINTEGER:
+    case LogicalTypeId::DECIMAL:
+        // Exact decimal text, e.g. 12.3400
+        result = value.ToString();
+        return true;
+    case LogicalTypeId::DOUBLE: {
+        auto number = value.GetValue<double>();
+        if (!std::isfinite(number)) {
+            return false;
+        }
+        // Shortest text that reads back as the same double
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.17g", number);
+        for (int precision = 1; precision < 17; precision++) {
+            char shorter[32];
+            snprintf(shorter, sizeof(shorter), "%.*g", precision, number);
+            if (strtod(shorter, nullptr) == number) {
+                memcpy(buffer, shorter, sizeof(buffer));
+                break;
+            }
+        }
+        result = FixedNotation(buffer);
+        return true;
+    }
+    case LogicalTypeId::VARCHAR:
+        result = QuoteString(value.GetValue<string>());
+        return true;
+    case LogicalTypeId::DATE: {
+        int32_t year, month, day;
+        Date::Convert(value.GetValue<date_t>(), year, month, day);
+        result = "DATE(" + std::to_string(year) + ", " + std::to_string(month) + ", " + std::to_string(day) + ")";
+        return year >= 1 && year <= 9999;
+    }
+    case LogicalTypeId::TIMESTAMP: {
+        date_t date;
+        dtime_t time;
+        Timestamp::Convert(value.GetValue<timestamp_t>(), date, time);
+        int32_t year, month, day, hour, minute, second, micros;
+        Date::Convert(date, year, month, day);
+        Time::Convert(time, hour, minute, second, micros);
+        if (micros != 0 || year < 1 || year > 9999) {
+            // TIME() has whole seconds only
+            return false;
+        }
+        result = "DATE(" + std::to_string(year) + ", " + std::to_string(month) + ", " + std::to_string(day) + ")";
+        if (hour != 0 || minute != 0 || second != 0) {
+            result += " + TIME(" + std::to_string(hour) + ", " + std::to_string(minute) + ", " +
+                      std::to_string(second) + ")";
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+std::string
+MSOLAPDax::ReplaceParameters(const std::string &query,
+                             const std::function<bool(const std::string &name, std::string &result)> &replace) {
+    std::string result;
+    result.reserve(query.size());
+    idx_t pos = 0;
+    while (pos < query.size()) {
+        char c = query[pos];
+        idx_t end = pos + 1;
+        if (c == '"' || c == '\'' || c == '[') {
+            end = SkipQuoted(query, pos);
+        } else if ((c == '/' || c == '-') && pos + 1 < query.size() && query[pos + 1] == c) {
+            end = query.find('\n', pos);
+            end = end == std::string::npos ? query.size() : end;
+        } else if (c == '/' && pos + 1 < query.size() && query[pos + 1] == '*') {
+            end = query.find("*/", pos + 2);
+            end = end == std::string::npos ? query.size() : end + 2;
+        } else if (c == '@') {
+            while (end < query.size() && (isalnum((unsigned char)query[end]) || query[end] == '_')) {
+                end++;
+            }
+            auto name = query.substr(pos + 1, end - pos - 1);
+            std::string replacement;
+            if (name.empty() || !replace(name, replacement)) {
+                throw std::runtime_error("DAX query parameter @" + name + " has no value");
+            }
+            result += replacement;
+            pos = end;
+            continue;
+        }
+        result.append(query, pos, end - pos);
+        pos = end;
+    }
+    return result;
+}
+
+std::string MSOLAPDax::BindParameters(const std::string &query, const Value &parameters) {
+    if (parameters.type().id() != LogicalTypeId::STRUCT) {
+        throw std::runtime_error("params must be a struct of parameter values, e.g. {'Year': 2024}");
+    }
+    auto &fields = StructType::GetChildTypes(parameters.type());
+    auto &values = StructValue::GetChildren(parameters);
+    return ReplaceParameters(query, [&](const std::string &name, std::string &result) {
+        for (idx_t i = 0; i < fields.size(); i++) {
+            if (!StringUtil::CIEquals(fields[i].first, name)) {
+                continue;
+            }
+            if (values[i].IsNull()) {
+                result = "BLANK()";
+            } else if (!TryLiteral(values[i], result)) {
+                throw std::runtime_error("DAX query parameter @" + name + " has a value without a DAX literal: " +
+                                         values[i].ToString());
+            }
+            return true;
+        }
+        return false;
+    });
+}
+
+std::string MSOLAPDax::GetDataTableType(const LogicalType &type) {
+    switch (type.id()) {
+    case LogicalTypeId::BOOLEAN:
+        return "BOOLEAN";
+    case LogicalTypeId::TINYINT:
+    case LogicalTypeId::SMALLINT:
+    case LogicalTypeId::INTEGER:
+    case LogicalTypeId::BIGINT:
+    case LogicalTypeId::UTINYINT:
+    case LogicalTypeId::USMALLINT:
+    case LogicalTypeId::UINTEGER:
+        return "INTEGER";
+    case LogicalTypeId::DECIMAL:
+        // CURRENCY keeps 4 digits after the point exactly, DOUBLE would round the value. Decimals with more
+        // digits after the point, or more before it than a currency can hold, have no exact column type.
+        if (DecimalType::GetScale(type) > MSOLAPConversion::CURRENCY_SCALE ||
+            DecimalType::GetWidth(type) - DecimalType::GetScale(type) >
+                MSOLAPConversion::CURRENCY_WIDTH - MSOLAPConversion::CURRENCY_SCALE) {
+            return "";
+        }
+        return "CURRENCY";
+    case LogicalTypeId::DOUBLE:
+        return "DOUBLE";
+    case LogicalTypeId::VARCHAR:
+        return "STRING";
+    case LogicalTypeId::DATE:
+    case LogicalTypeId::TIMESTAMP:
+        return "DATETIME";
+    default:
+        return "";
+    }
+}
+
+bool MSOLAPDax::TryDataTableValue(const Value &value, std::string &result) {
+    if (value.IsNull()) {
+        result = "BLANK()";
+        return true;
+    }
+    switch (value.type().id()) {
+    case LogicalTypeId::BOOLEAN:
+        result = value.GetValue<bool>() ? "TRUE" : "FALSE";
+        return true;
+    case LogicalTypeId::DATE:
+    case LogicalTypeId::TIMESTAMP: {
+        // Same range and precision as the DATE() and TIME() literals
+        std::string literal;
+        if (!TryLiteral(value, literal)) {
+            return false;
+        }
+        result = QuoteString(Timestamp::ToString(value.GetValue<timestamp_t>()));
+        return true;
+    }
+    case LogicalTypeId::DECIMAL: {
+        // A CURRENCY column, whose values are 64-bit integers scaled by 10,000
+        auto scaled = value.DefaultCastAs(LogicalType::DECIMAL(38, MSOLAPConversion::CURRENCY_SCALE))
+                          .GetValueUnsafe<hugeint_t>();
+        if (scaled < hugeint_t(std::numeric_limits<int64_t>::min()) ||
+            scaled > hugeint_t(std::numeric_limits<int64_t>::max())) {
+            return false;
+        }
+        return TryLiteral(value, result);
+    }
+    default:
+        return TryLiteral(value, result);
+    }
+}
+
+static const char *GetComparisonOperator(ExpressionType type) {
+    switch (type) {
+    case ExpressionType::COMPARE_EQUAL:
+        return "=";
+    case ExpressionType::COMPARE_NOTEQUAL:
+        return "<>";
+    case ExpressionType::COMPARE_LESSTHAN:
+        return "<";
+    case ExpressionType::COMPARE_GREATERTHAN:
+        return ">";
+    case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+        return "<=";
+    case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+        return ">=";
+    default:
+        return nullptr;
+    }
+}
+
+std::string MSOLAPDax::TranslateFilter(const TableFilter &filter, const std::string &column_reference,
+                                       const LogicalType &type) {
+    switch (filter.filter_type) {
+    case TableFilterType::CONSTANT_COMPARISON: {
+        auto &constant_filter = filter.Cast<ConstantFilter>();
+        auto op = GetComparisonOperator(constant_filter.comparison_type);
+        // Case-insensitive text ordering in DAX would not select a superset of the rows for anything but =
+        if (!op || (type.id() == LogicalTypeId::VARCHAR &&
+                    constant_filter.comparison_type != ExpressionType::COMPARE_EQUAL)) {
+            return "";
+        }
+        std::string literal;
+        if (!TryLiteral(constant_filter.constant, literal)) {
+            return "";
+        }
+        return column_reference + " " + op + " " + literal;
+    }
+    case TableFilterType::IS_NULL:
+        return "ISBLANK(" + column_reference + ")";
+    case TableFilterType::IS_NOT_NULL:
+        return "NOT ISBLANK(" + column_reference + ")";
+    case TableFilterType::IN_FILTER: {
+        auto &in_filter = filter.Cast<InFilter>();
+        std::string values;
+        for (auto &value : in_filter.values) {
+            std::string literal;
+            if (!TryLiteral(value, literal)) {
+                return "";
+            }
+            values += (values.empty() ? "" : ", ") + literal;
+        }
+        return column_reference + " IN {" + values + "}";
+    }
+    case TableFilterType::CONJUNCTION_AND: {
+        // Children without a translation are left out, the rest still selects a superset
+        auto &conjunction = filter.Cast<ConjunctionAndFilter>();
+        std::string result;
+        for (auto &child : conjunction.child_filters) {
+            auto predicate = TranslateFilter(*child, column_reference, type);
+            if (!predicate.empty()) {
+                result += (result.empty() ? "" : " && ") + predicate;
+            }
+        }
+        return result;
+    }
+    case TableFilterType::CONJUNCTION_OR: {
+        // Every alternative needs a translation
+        auto &conjunction = filter.Cast<ConjunctionOrFilter>();
+        std::string result;
+        for (auto &child : conjunction.child_filters) {
+            auto predicate = TranslateFilter(*child, column_reference, type);
+            if (predicate.empty()) {
+                return "";
+            }
+            if (child->filter_type == TableFilterType::CONJUNCTION_AND) {
+                predicate = "(" + predicate + ")";
+            }
+            result += (result.empty() ? "" : " || ") + predicate;
+        }
+        return "(" + result + ")";
+    }
+    case TableFilterType::OPTIONAL_FILTER: {
+        // Implied by the other filters, but pushing it down lets the server skip more rows
+        auto &optional_filter = filter.Cast<OptionalFilter>();
+        return optional_filter.child_filter ? TranslateFilter(*optional_filter.child_filter, column_reference, type)
+                                            : "";
+    }
+    default:
+        return "";
+    }
+}
+
+std::string MSOLAPDax::TranslateValueFilters(const TableFilter &filter, const std::string &column_reference,
+                                             const LogicalType &type, std::string &predicate) {
+    predicate.clear();
+    switch (filter.filter_type) {
+    case TableFilterType::IN_FILTER: {
+        auto &in_filter = filter.Cast<InFilter>();
+        std::string values;
+        for (auto &value : in_filter.values) {
+            std::string literal;
+            if (!TryLiteral(value, literal)) {
+                return "";
+            }
+            values += (values.empty() ? "" : ", ") + literal;
+        }
+        if (values.empty()) {
+            return "";
+        }
+        // Applied to the model column by the storage engine, rather than row by row like FILTER
+        return "KEEPFILTERS(TREATAS({" + values + "}, " + column_reference + "))";
+    }
+    case TableFilterType::OPTIONAL_FILTER: {
+        auto &optional_filter = filter.Cast<OptionalFilter>();
+        if (!optional_filter.child_filter) {
+            return "";
+        }
+        return TranslateValueFilters(*optional_filter.child_filter, column_reference, type, predicate);
+    }
+    case TableFilterType::CONJUNCTION_AND: {
+        auto &conjunction = filter.Cast<ConjunctionAndFilter>();
+        std::string result;
+        for (auto &child : conjunction.child_filters) {
+            std::string child_predicate;
+            auto arguments = TranslateValueFilters(*child, column_reference, type, child_predicate);
+            if (!arguments.empty()) {
+                result += (result.empty() ? "" : ", ") + arguments;
+            }
+            if (!child_predicate.empty()) {
+                predicate += (predicate.empty() ? "" : " && ") + child_predicate;
+            }
+        }
+        return result;
+    }
+    default:
+        predicate = TranslateFilter(filter, column_reference, type);
+        return "";
+    }
+}
+
+// Value comparison without the DAX conversions: BLANK never matches, text is compared case-sensitively
+static bool TryExactComparison(const std::string &column_reference, const LogicalType &type, ExpressionType comparison,
+                               const Value &constant, std::string &result) {
+    auto op = GetComparisonOperator(comparison);
+    std::string literal;
+    if (!op || !MSOLAPDax::TryLiteral(constant, literal)) {
+        return false;
+    }
+    if (type.id() != LogicalTypeId::VARCHAR) {
+        result = "(NOT ISBLANK(" + column_reference + ") && " + column_reference + " " + op + " " + literal + ")";
+        return true;
+    }
+    if (comparison != ExpressionType::COMPARE_EQUAL && comparison != ExpressionType::COMPARE_NOTEQUAL) {
+        return false;
+    }
+    result = std::string("(NOT ISBLANK(") + column_reference + ") && " +
+             (comparison == ExpressionType::COMPARE_NOTEQUAL ? "NOT " : "") + "EXACT(" + column_reference + ", " +
+             literal + "))";
+    return true;
+}
+
+bool MSOLAPDax::TryTranslateExactFilter(const TableFilter &filter, const std::string &column_reference,
+                                        const LogicalType &type, std::string &result) {
+    result.clear();
+    switch (filter.filter_type) {
+    case TableFilterType::CONSTANT_COMPARISON: {
+        auto &constant_filter = filter.Cast<ConstantFilter>();
+        return TryExactComparison(column_reference, type, constant_filter.comparison_type, constant_filter.constant,
+                                  result);
+    }
+    case TableFilterType::IS_NULL:
+        result = "ISBLANK(" + column_reference + ")";
+        return true;
+    case TableFilterType::IS_NOT_NULL:
+        result = "NOT ISBLANK(" + column_reference + ")";
+        return true;
+    case TableFilterType::IN_FILTER: {
+        auto &in_filter = filter.Cast<InFilter>();
+        std::string values;
+        for (auto &value : in_filter.values) {
+            std::string term;
+            if (!TryExactComparison(column_reference, type, ExpressionType::COMPARE_EQUAL, value, term)) {
+                return false;
+            }
+            values += (values.empty() ? "" : " || ") + term;
+        }
+        result = "(" + values + ")";
+        return true;
+    }
+    case TableFilterType::CONJUNCTION_AND:
+    case TableFilterType::CONJUNCTION_OR: {
+        bool is_and = filter.filter_type == TableFilterType::CONJUNCTION_AND;
+        auto &children = is_and ? filter.Cast<ConjunctionAndFilter>().child_filters
+                                : filter.Cast<ConjunctionOrFilter>().child_filters;
+        for (auto &child : children) {
+            std::string predicate;
+            if (!TryTranslateExactFilter(*child, column_reference, type, predicate)) {
+                return false;
+            }
+            if (predicate.empty()) {
+                if (!is_and) {
+                    // An alternative that keeps every row
+                    result.clear();
+                    return true;
+                }
+                continue;
+            }
+            result += (result.empty() ? "" : is_and ? " && " : " || ") + predicate;
+        }
+        if (!result.empty()) {
+            result = "(" + result + ")";
+        }
+        return true;
+    }
+    case TableFilterType::OPTIONAL_FILTER:
+    case TableFilterType::DYNAMIC_FILTER:
+        return true;
+    default:
+        return false;
+    }
+}
+
+std::string MSOLAPDax::TranslateAggregate(const std::string &function_name, bool distinct, const std::string &table,
+                                          const std::string &column_reference, const LogicalType &type,
+                                          bool &never_blank) {
+    if (function_name == "count_star") {
+        never_blank = true;
+        return "COUNTROWS(" + table + ") + 0";
+    }
+    if (function_name == "count") {
+        // BLANK counts as a value in DISTINCTCOUNT but not as a NULL in DuckDB
+        never_blank = true;
+        return (distinct ? "DISTINCTCOUNTNOBLANK(" : "COUNTA(") + column_reference + ") + 0";
+    }
+    if (function_name == "sum" && !distinct && type.IsNumeric()) {
+        return "SUM(" + column_reference + ")";
+    }
+    // Text is compared case-insensitively by the server
+    if ((function_name == "min" || function_name == "max") &&
+        (type.IsNumeric() || type.id() == LogicalTypeId::DATE || type.id() == LogicalTypeId::TIMESTAMP)) {
+        return StringUtil::Upper(function_name) + "(" + column_reference + ")";
+    }
+    return "";
+}
+
+std::string MSOLAPDax::Summarize(const std::string &table, const std::vector<std::string> &groups,
+                                 const std::vector<std::pair<std::string, std::string>> &measures,
+                                 const std::string &predicate, bool never_blank, bool &rows_column) {
+    rows_column = false;
+    std::string result;
+    for (auto &group : groups) {
+        result += (result.empty() ? "" : ", ") + group;
+    }
+    if (!predicate.empty()) {
+        result += ", FILTER(" + table + ", " + predicate + ")";
+    }
+    for (auto &measure : measures) {
+        result += ", " + QuoteString(measure.first) + ", " + measure.second;
+    }
+    if (!never_blank) {
+        // DuckDB returns those groups with NULLs
+        result += ", \"Rows\", COUNTROWS(" + table + ")";
+        rows_column = true;
+    }
+    return "SUMMARIZECOLUMNS(" + result + ")";
+}
+
+} // namespace duckdb
@@ -0,0 +1,71 @@
+#include "msolap_dictionary.hpp"
+
+namespace duckdb {
+
+// Chunks at least this large adding new entries for more than half of their rows disable the dictionary
+static constexpr idx_t MIN_SAMPLE_ROWS = 128;
+
+MSOLAPStringDictionary::MSOLAPStringDictionary()
+    : enabled(true), heap(make_uniq<Vector>(LogicalType::VARCHAR, 1)), null_index(DConstants::INVALID_INDEX),
+      dictionary_size(0) {
+}
+
+void MSOLAPStringDictionary::Disable() {
+    enabled = false;
+    entries.clear();
+    entries.shrink_to_fit();
+    index.clear();
+    dictionary.reset();
+    heap.reset();
+}
+
+void MSOLAPStringDictionary::Encode(Vector &vector, idx_t count) {
+    if (!enabled || count == 0 || vector.GetVectorType() != VectorType::FLAT_VECTOR) {
+        return;
+    }
+    auto data = FlatVector::GetData<string_t>(vector);
+    auto &validity = FlatVector::Validity(vector);
+    SelectionVector sel(count);
+    auto previous_size = entries.size();
+    for (idx_t row = 0; row < count; row++) {
+        if (!validity.RowIsValid(row)) {
+            if (null_index == DConstants::INVALID_INDEX) {
+                null_index = entries.size();
+                entries.emplace_back();
+            }
+            sel.set_index(row, null_index);
+            continue;
+        }
+        auto entry = index.find(data[row]);
+        if (entry != index.end()) {
+            sel.set_index(row, entry->second);
+            continue;
+        }
+        if (entries.size() >= MAX_SIZE) {
+            Disable();
+            return;
+        }
+        // The vector's strings go away with the chunk, the dictionary keeps its own copy
+        auto value = data[row].IsInlined() ? data[row] : StringVector::AddStringOrBlob(*heap, data[row]);
+        index.emplace(value, (sel_t)entries.size());
+        sel.set_index(row, entries.size());
+        entries.push_back(value);
+    }
+    if (count >= MIN_SAMPLE_ROWS && (entries.size() - previous_size) * 2 > count) {
+        Disable();
+        return;
+    }
+
+    if (!dictionary || dictionary_size != entries.size()) {
+        dictionary = make_uniq<Vector>(LogicalType::VARCHAR, entries.size());
+        memcpy(FlatVector::GetData<string_t>(*dictionary), entries.data(), entries.size() * sizeof(string_t));
+        if (null_index != DConstants::INVALID_INDEX) {
+            FlatVector::SetNull(*dictionary, null_index, true);
+        }
+        StringVector::AddHeapReference(*dictionary, *heap);
+        dictionary_size = entries.size();
+    }
+    vector.Dictionary(*dictionary, dictionary_size, sel, count);
+}
+
+} // namespace duckdb
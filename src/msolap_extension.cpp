@@ -2,15 +2,162 @@
 
 #include "msolap_extension.hpp"
 #include "msolap_scanner.hpp"
+#include "msolap_batch.hpp"
 #include "msolap_utils.hpp"
+#include "msolap_pool.hpp"
+#include "msolap_optimizer.hpp"
+#include "msolap_cache.hpp"
+#include "msolap_storage.hpp"
+#include "msolap_statistics.hpp"
+#include "msolap_progress.hpp"
+#include "msolap_prefetch.hpp"
+#include "msolap_scheduler.hpp"
+#include "msolap_schema_cache.hpp"
 #include "duckdb/parser/parsed_data/create_table_function_info.hpp"
 
 namespace duckdb {
 
+// The settings below configure state shared by the whole process, whichever connection sets them. RESET applies
+// their default again, it may pass the option without a value.
+static uint64_t SettingOrDefault(const Value &parameter, uint64_t default_value) {
+    return parameter.IsNull() ? default_value : parameter.GetValue<uint64_t>();
+}
+
+static void SetPoolSize(ClientContext &context, SetScope scope, Value &parameter) {
+    MSOLAPConnectionPool::Get().SetMaxIdle(SettingOrDefault(parameter, MSOLAPConnectionPool::DEFAULT_MAX_IDLE));
+}
+
+static void SetPoolMaxActive(ClientContext &context, SetScope scope, Value &parameter) {
+    MSOLAPConnectionPool::Get().SetMaxActive(SettingOrDefault(parameter, MSOLAPConnectionPool::DEFAULT_MAX_ACTIVE));
+}
+
+static void SetPoolIdleTimeout(ClientContext &context, SetScope scope, Value &parameter) {
+    MSOLAPConnectionPool::Get().SetIdleTimeout(SettingOrDefault(parameter, MSOLAPConnectionPool::DEFAULT_IDLE_TIMEOUT));
+}
+
+static void SetPoolPingInterval(ClientContext &context, SetScope scope, Value &parameter) {
+    MSOLAPConnectionPool::Get().SetPingInterval(
+        SettingOrDefault(parameter, MSOLAPConnectionPool::DEFAULT_PING_INTERVAL));
+}
+
+static void SetIOThreads(ClientContext &context, SetScope scope, Value &parameter) {
+    MSOLAPIOScheduler::Get().SetThreadCount(SettingOrDefault(parameter, MSOLAPIOScheduler::DEFAULT_THREADS));
+}
+
+static void SetCacheDirectory(ClientContext &context, SetScope scope, Value &parameter) {
+    MSOLAPResultCache::Get().SetDirectory(parameter.IsNull() ? std::string() : parameter.ToString());
+}
+
+static void SetCacheMaxSize(ClientContext &context, SetScope scope, Value &parameter) {
+    auto max_size = parameter.IsNull() ? std::string(MSOLAPResultCache::DEFAULT_MAX_SIZE) : parameter.ToString();
+    MSOLAPResultCache::Get().SetMaxSize(DBConfig::ParseMemoryLimit(max_size));
+}
+
+static void SetSchemaTTL(ClientContext &context, SetScope scope, Value &parameter) {
+    MSOLAPSchemaCache::Get().SetTTL(SettingOrDefault(parameter, MSOLAPSchemaCache::DEFAULT_TTL));
+}
+
 static void LoadInternal(ExtensionLoader &loader) {
     // Register MSOLAP table function
     MSOLAPScanFunction msolap_scan_fun;
     loader.RegisterFunction(msolap_scan_fun);
+
+    // Register the query evaluated for every row of a subquery
+    MSOLAPBatchFunction msolap_batch_fun;
+    loader.RegisterFunction(msolap_batch_fun);
+
+    // Register the connection pool statistics
+    MSOLAPPoolStatsFunction pool_stats_fun;
+    loader.RegisterFunction(pool_stats_fun);
+
+    // Register the list of running scans
+    MSOLAPScansFunction scans_fun;
+    loader.RegisterFunction(scans_fun);
+
+    // Register the result cache functions
+    MSOLAPCacheStatsFunction cache_stats_fun;
+    loader.RegisterFunction(cache_stats_fun);
+    MSOLAPCacheClearFunction cache_clear_fun;
+    loader.RegisterFunction(cache_clear_fun);
+
+    // Register the model catalog refresh
+    MSOLAPCatalogRefreshFunction catalog_refresh_fun;
+    loader.RegisterFunction(catalog_refresh_fun);
+
+    // ATTACH ... (TYPE msolap)
+    auto &config = DBConfig::GetConfig(loader.GetDatabaseInstance());
+    config.storage_extensions["msolap"] = make_uniq<MSOLAPStorageExtension>();
+
+    // Push LIMIT, ORDER BY ... LIMIT and GROUP BY above msolap scans into the DAX query
+    config.optimizer_extensions.push_back(MSOLAPOptimizerExtension());
+    config.AddExtensionOption("msolap_aggregate_pushdown",
+                              "Evaluate aggregates over msolap scans of a model table on the server with "
+                              "SUMMARIZECOLUMNS",
+                              LogicalType::BOOLEAN, Value::BOOLEAN(true));
+
+    config.AddExtensionOption("msolap_prefetch_chunks",
+                              "Chunks of a DAX query result read ahead by the msolap I/O threads while DuckDB "
+                              "processes the current one (0 reads on the scan thread)",
+                              LogicalType::UBIGINT, Value::UBIGINT(MSOLAPPrefetchRowset::DEFAULT_CHUNKS));
+    config.AddExtensionOption("msolap_batch_size",
+                              "Rows of parameter values msolap_batch evaluates its DAX query for in a single request",
+                              LogicalType::UBIGINT, Value::UBIGINT(MSOLAPBatchFunction::DEFAULT_BATCH_SIZE));
+    config.AddExtensionOption("msolap_share_scans",
+                              "Evaluate a DAX query once for all msolap scans running it at the same time (only "
+                              "scans reading ahead are shared)",
+                              LogicalType::BOOLEAN, Value::BOOLEAN(true));
+    // The table statistics are shared by the whole process, each query reads them with the settings of its own
+    // connection
+    config.AddExtensionOption("msolap_statistics_ttl",
+                              "Seconds the row counts and column statistics of model tables are reused for planning "
+                              "(0 disables them)",
+                              LogicalType::UBIGINT, Value::UBIGINT(MSOLAPStatisticsCache::DEFAULT_TTL));
+    config.AddExtensionOption("msolap_statistics_distinct_counts",
+                              "Read the distinct count of the columns of a model table from the storage DMVs when "
+                              "planning",
+                              LogicalType::BOOLEAN, Value::BOOLEAN(MSOLAPStatisticsCache::DEFAULT_DISTINCT_COUNTS));
+
+    // The connection pool is shared by the whole process, so are its settings
+    config.AddExtensionOption("msolap_pool_size",
+                              "Maximum number of idle MSOLAP sessions kept open per connection string (0 disables "
+                              "pooling)",
+                              LogicalType::UBIGINT, Value::UBIGINT(MSOLAPConnectionPool::DEFAULT_MAX_IDLE),
+                              SetPoolSize);
+    config.AddExtensionOption("msolap_pool_max_active",
+                              "Maximum number of MSOLAP sessions in use at the same time per connection string, "
+                              "further queries wait for one (0 for no limit)",
+                              LogicalType::UBIGINT, Value::UBIGINT(MSOLAPConnectionPool::DEFAULT_MAX_ACTIVE),
+                              SetPoolMaxActive);
+    config.AddExtensionOption("msolap_pool_idle_timeout",
+                              "Seconds after which an idle pooled MSOLAP session is closed", LogicalType::UBIGINT,
+                              Value::UBIGINT(MSOLAPConnectionPool::DEFAULT_IDLE_TIMEOUT), SetPoolIdleTimeout);
+    config.AddExtensionOption("msolap_pool_ping_interval",
+                              "Seconds a pooled MSOLAP session can be idle before it is checked with a round trip to "
+                              "the server when it is reused (0 checks it every time)",
+                              LogicalType::UBIGINT, Value::UBIGINT(MSOLAPConnectionPool::DEFAULT_PING_INTERVAL),
+                              SetPoolPingInterval);
+
+    // So are the threads executing the queries of all scans
+    config.AddExtensionOption("msolap_io_threads",
+                              "Threads executing msolap queries and reading their results, shared by all scans of "
+                              "the process",
+                              LogicalType::UBIGINT, Value::UBIGINT(MSOLAPIOScheduler::DEFAULT_THREADS), SetIOThreads);
+
+    // So is the result cache
+    config.AddExtensionOption("msolap_cache_directory",
+                              "Directory msolap query results are cached in until the model is refreshed (empty "
+                              "disables the cache)",
+                              LogicalType::VARCHAR, Value(""), SetCacheDirectory);
+    config.AddExtensionOption("msolap_cache_max_size",
+                              "Maximum size of the msolap result cache, least recently used results are removed "
+                              "beyond it",
+                              LogicalType::VARCHAR, Value(MSOLAPResultCache::DEFAULT_MAX_SIZE), SetCacheMaxSize);
+
+    // And the query schemas used for planning
+    config.AddExtensionOption("msolap_schema_ttl",
+                              "Seconds the result columns of a DAX query are reused when binding it again (0 "
+                              "disables the schema cache)",
+                              LogicalType::UBIGINT, Value::UBIGINT(MSOLAPSchemaCache::DEFAULT_TTL), SetSchemaTTL);
 }
 
 void MsolapExtension::Load(ExtensionLoader &loader) {
@@ -0,0 +1,529 @@
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+#include "msolap_http.hpp"
+#include "duckdb/common/string_util.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <limits>
+
+namespace duckdb {
+
+static constexpr idx_t HTTP_BUFFER_SIZE = 64 * 1024;
+static constexpr int64_t INVALID_SOCKET_FD = -1;
+
+// Don't raise SIGPIPE when the server has already closed the connection
+#ifdef MSG_NOSIGNAL
+static constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+static constexpr int SEND_FLAGS = 0;
+#endif
+
+#ifdef _WIN32
+typedef SOCKET native_socket_t;
+
+struct WinsockInitializer {
+    WinsockInitializer() {
+        WSADATA wsa_data;
+        WSAStartup(MAKEWORD(2, 2), &wsa_data);
+    }
+    ~WinsockInitializer() {
+        WSACleanup();
+    }
+};
+
+static void InitializeSockets() {
+    static WinsockInitializer initializer;
+}
+
+static void CloseSocket(int64_t fd) {
+    closesocket((SOCKET)fd);
+}
+
+static void ShutdownSocket(int64_t fd) {
+    shutdown((SOCKET)fd, SD_BOTH);
+}
+
+static int LastSocketError() {
+    return WSAGetLastError();
+}
+
+static bool IsInterrupted(int error) {
+    return error == WSAEINTR;
+}
+
+static bool IsTimedOut(int error) {
+    return error == WSAETIMEDOUT || error == WSAEWOULDBLOCK;
+}
+
+static void SetBlocking(native_socket_t fd, bool blocking) {
+    u_long non_blocking = blocking ? 0 : 1;
+    ioctlsocket(fd, FIONBIO, &non_blocking);
+}
+
+static bool IsConnectPending(int error) {
+    return error == WSAEWOULDBLOCK;
+}
+
+static int PollSocket(native_socket_t fd, short events, int timeout_ms) {
+    WSAPOLLFD poll_fd;
+    poll_fd.fd = fd;
+    poll_fd.events = events;
+    poll_fd.revents = 0;
+    return WSAPoll(&poll_fd, 1, timeout_ms);
+}
+
+static void SetSocketTimeout(native_socket_t fd, int option, idx_t seconds) {
+    DWORD timeout = (DWORD)(seconds * 1000);
+    setsockopt(fd, SOL_SOCKET, option, (const char *)&timeout, sizeof(timeout));
+}
+#else
+typedef int native_socket_t;
+
+static void InitializeSockets() {
+}
+
+static void CloseSocket(int64_t fd) {
+    close((int)fd);
+}
+
+static void ShutdownSocket(int64_t fd) {
+    shutdown((int)fd, SHUT_RDWR);
+}
+
+static int LastSocketError() {
+    return errno;
+}
+
+static bool IsInterrupted(int error) {
+    return error == EINTR;
+}
+
+static bool IsTimedOut(int error) {
+    return error == EAGAIN || error == EWOULDBLOCK;
+}
+
+static void SetBlocking(native_socket_t fd, bool blocking) {
+    auto flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK));
+}
+
+static bool IsConnectPending(int error) {
+    return error == EINPROGRESS || error == EINTR;
+}
+
+static int PollSocket(native_socket_t fd, short events, int timeout_ms) {
+    struct pollfd poll_fd;
+    poll_fd.fd = fd;
+    poll_fd.events = events;
+    poll_fd.revents = 0;
+    return poll(&poll_fd, 1, timeout_ms);
+}
+
+static void SetSocketTimeout(native_socket_t fd, int option, idx_t seconds) {
+    struct timeval timeout;
+    timeout.tv_sec = (time_t)seconds;
+    timeout.tv_usec = 0;
+    setsockopt(fd, SOL_SOCKET, option, (const char *)&timeout, sizeof(timeout));
+}
+#endif
+
+// Connect within timeout seconds (0 waits as long as the system does), false if the address does not accept
+static bool ConnectSocket(native_socket_t fd, const struct addrinfo &address, idx_t timeout) {
+    if (timeout == 0) {
+        return connect(fd, address.ai_addr, (int)address.ai_addrlen) == 0;
+    }
+    SetBlocking(fd, false);
+    if (connect(fd, address.ai_addr, (int)address.ai_addrlen) != 0) {
+        if (!IsConnectPending(LastSocketError())) {
+            return false;
+        }
+        int ready;
+        do {
+            ready = PollSocket(fd, POLLOUT, (int)MinValue<idx_t>(timeout * 1000, std::numeric_limits<int>::max()));
+        } while (ready < 0 && IsInterrupted(LastSocketError()));
+        if (ready <= 0) {
+            return false;
+        }
+        int error = 0;
+        socklen_t length = sizeof(error);
+        if (getsockopt(fd, SOL_SOCKET, SO_ERROR, (char *)&error, &length) != 0 || error != 0) {
+            return false;
+        }
+    }
+    SetBlocking(fd, true);
+    return true;
+}
+
+MSOLAPHTTPConnection::MSOLAPHTTPConnection()
+    : socket_fd(INVALID_SOCKET_FD), socket_lock(make_uniq<std::mutex>()), aborted(false), buffer_pos(0),
+      buffer_end(0), chunked(false), read_until_close(false), body_remaining(0), body_done(true), keep_alive(true) {
+}
+
+MSOLAPHTTPConnection::~MSOLAPHTTPConnection() {
+    Close();
+}
+
+MSOLAPHTTPConnection::MSOLAPHTTPConnection(MSOLAPHTTPConnection &&other) noexcept
+    : MSOLAPHTTPConnection() {
+    *this = std::move(other);
+}
+
+MSOLAPHTTPConnection &MSOLAPHTTPConnection::operator=(MSOLAPHTTPConnection &&other) noexcept {
+    {
+        std::lock_guard<std::mutex> guard(*socket_lock);
+        std::swap(socket_fd, other.socket_fd);
+        // An abort of either connection applies to the socket taken over, this one's stays for reconnects
+        aborted = aborted || other.aborted;
+        if (aborted && socket_fd != INVALID_SOCKET_FD) {
+            // Reconnected while the request was being cancelled, or moved after it was
+            ShutdownSocket(socket_fd);
+        }
+    }
+    std::swap(host, other.host);
+    std::swap(port, other.port);
+    std::swap(path, other.path);
+    std::swap(buffer, other.buffer);
+    std::swap(buffer_pos, other.buffer_pos);
+    std::swap(buffer_end, other.buffer_end);
+    std::swap(chunked, other.chunked);
+    std::swap(read_until_close, other.read_until_close);
+    std::swap(body_remaining, other.body_remaining);
+    std::swap(body_done, other.body_done);
+    std::swap(keep_alive, other.keep_alive);
+    return *this;
+}
+
+MSOLAPHTTPConnection MSOLAPHTTPConnection::Connect(const std::string &url, idx_t connect_timeout, idx_t timeout) {
+    MSOLAPHTTPConnection connection;
+
+    // Split "http://host[:port][/path]"
+    auto lower_url = StringUtil::Lower(url);
+    if (StringUtil::StartsWith(lower_url, "https://")) {
+        throw std::runtime_error("https:// XMLA endpoints are not supported by the built-in transport, "
+                                 "expose the endpoint over http:// (e.g. behind a TLS terminating proxy)");
+    }
+    if (!StringUtil::StartsWith(lower_url, "http://")) {
+        throw std::runtime_error("Invalid XMLA endpoint URL: " + url);
+    }
+    auto authority = url.substr(strlen("http://"));
+    auto path_pos = authority.find('/');
+    if (path_pos != std::string::npos) {
+        connection.path = authority.substr(path_pos);
+        authority = authority.substr(0, path_pos);
+    } else {
+        connection.path = "/";
+    }
+    // IPv6 addresses are enclosed in brackets: "[::1]:8080"
+    auto host_end = authority.empty() || authority[0] != '[' ? 0 : authority.find(']');
+    if (host_end == std::string::npos) {
+        throw std::runtime_error("Invalid XMLA endpoint URL: " + url);
+    }
+    auto port_pos = authority.find(':', host_end);
+    if (port_pos != std::string::npos) {
+        connection.host = authority.substr(0, port_pos);
+        connection.port = authority.substr(port_pos + 1);
+    } else {
+        connection.host = authority;
+        connection.port = "80";
+    }
+    auto address_host = connection.host;
+    if (host_end > 0) {
+        address_host = connection.host.substr(1, host_end - 1);
+    }
+    if (address_host.empty() || connection.port.empty()) {
+        throw std::runtime_error("Invalid XMLA endpoint URL: " + url);
+    }
+
+    InitializeSockets();
+
+    // Resolve the host and connect to the first address that accepts
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo *addresses = nullptr;
+    int rc = getaddrinfo(address_host.c_str(), connection.port.c_str(), &hints, &addresses);
+    if (rc != 0 || !addresses) {
+        throw std::runtime_error("Failed to resolve XMLA host " + connection.host + ": " + gai_strerror(rc));
+    }
+    for (auto address = addresses; address; address = address->ai_next) {
+        auto fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if ((int64_t)fd == INVALID_SOCKET_FD) {
+            continue;
+        }
+        if (ConnectSocket(fd, *address, connect_timeout)) {
+            connection.socket_fd = (int64_t)fd;
+            break;
+        }
+        CloseSocket((int64_t)fd);
+    }
+    freeaddrinfo(addresses);
+    if (connection.socket_fd == INVALID_SOCKET_FD) {
+        throw std::runtime_error("Failed to connect to XMLA endpoint " + connection.host + ":" + connection.port);
+    }
+
+    // Requests are small, don't let Nagle delay them
+    int flag = 1;
+    setsockopt((native_socket_t)connection.socket_fd, IPPROTO_TCP, TCP_NODELAY, (const char *)&flag, sizeof(flag));
+    if (timeout > 0) {
+        // A server that stops responding fails the request instead of blocking the scan forever
+        SetSocketTimeout((native_socket_t)connection.socket_fd, SO_RCVTIMEO, timeout);
+        SetSocketTimeout((native_socket_t)connection.socket_fd, SO_SNDTIMEO, timeout);
+    }
+
+    connection.buffer = std::unique_ptr<char[]>(new char[HTTP_BUFFER_SIZE]);
+    return connection;
+}
+
+void MSOLAPHTTPConnection::SendAll(const char *data, idx_t length) {
+    while (length > 0) {
+        auto sent = send((native_socket_t)socket_fd, data, (int)MinValue<idx_t>(length, HTTP_BUFFER_SIZE), SEND_FLAGS);
+        if (sent < 0 && IsInterrupted(LastSocketError())) {
+            continue;
+        }
+        if (sent <= 0) {
+            auto timed_out = sent < 0 && IsTimedOut(LastSocketError());
+            Close();
+            throw std::runtime_error((timed_out ? "Timed out sending request to XMLA endpoint " :
+                                                  "Failed to send request to XMLA endpoint ") + host);
+        }
+        data += sent;
+        length -= sent;
+    }
+}
+
+void MSOLAPHTTPConnection::SendRequest(const std::string &method,
+                                       const std::vector<std::pair<std::string, std::string>> &headers,
+                                       const std::string &body) {
+    if (!IsOpen()) {
+        throw std::runtime_error("Connection is not open");
+    }
+    if (!body_done) {
+        throw std::runtime_error("Previous XMLA response has not been fully read");
+    }
+
+    std::string request = method + " " + path + " HTTP/1.1\r\n";
+    request += "Host: " + host + ":" + port + "\r\n";
+    for (auto &header : headers) {
+        request += header.first + ": " + header.second + "\r\n";
+    }
+    request += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+    request += "\r\n";
+
+    SendAll(request.c_str(), request.size());
+    SendAll(body.c_str(), body.size());
+}
+
+bool MSOLAPHTTPConnection::FillBuffer() {
+    if (buffer_pos > 0) {
+        // Move unread bytes to the front of the buffer
+        memmove(buffer.get(), buffer.get() + buffer_pos, buffer_end - buffer_pos);
+        buffer_end -= buffer_pos;
+        buffer_pos = 0;
+    }
+    if (buffer_end == HTTP_BUFFER_SIZE) {
+        throw std::runtime_error("HTTP response line too long");
+    }
+    int64_t received;
+    do {
+        received = recv((native_socket_t)socket_fd, buffer.get() + buffer_end, (int)(HTTP_BUFFER_SIZE - buffer_end), 0);
+    } while (received < 0 && IsInterrupted(LastSocketError()));
+    if (received < 0) {
+        auto timed_out = IsTimedOut(LastSocketError());
+        Close();
+        throw std::runtime_error((timed_out ? "Timed out waiting for the response of XMLA endpoint " :
+                                              "Failed to read response from XMLA endpoint ") + host);
+    }
+    if (received == 0) {
+        return false;
+    }
+    buffer_end += received;
+    return true;
+}
+
+std::string MSOLAPHTTPConnection::ReadLine() {
+    while (true) {
+        auto begin = buffer.get() + buffer_pos;
+        auto end = buffer.get() + buffer_end;
+        auto newline = (char *)memchr(begin, '\n', end - begin);
+        if (newline) {
+            std::string line(begin, newline - begin);
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            buffer_pos += (newline - begin) + 1;
+            return line;
+        }
+        if (!FillBuffer()) {
+            Close();
+            throw std::runtime_error("Connection closed by XMLA endpoint " + host);
+        }
+    }
+}
+
+MSOLAPHTTPResponse MSOLAPHTTPConnection::ReadResponseHeader() {
+    MSOLAPHTTPResponse response;
+
+    // Status line: "HTTP/1.1 200 OK", skipping interim "100 Continue" responses
+    do {
+        auto status_line = ReadLine();
+        auto parts = StringUtil::Split(status_line, ' ');
+        if (parts.size() < 2 || !StringUtil::StartsWith(parts[0], "HTTP/")) {
+            Close();
+            throw std::runtime_error("Invalid HTTP response from XMLA endpoint: " + status_line);
+        }
+        response.status = std::stoi(parts[1]);
+        response.reason = parts.size() > 2 ? status_line.substr(status_line.find(parts[2])) : "";
+        response.headers.clear();
+
+        while (true) {
+            auto line = ReadLine();
+            if (line.empty()) {
+                break;
+            }
+            auto sep = line.find(':');
+            if (sep == std::string::npos) {
+                continue;
+            }
+            auto key = line.substr(0, sep);
+            auto value = line.substr(sep + 1);
+            StringUtil::Trim(key);
+            StringUtil::Trim(value);
+            response.headers[key] = value;
+        }
+    } while (response.status == 100);
+
+    // Figure out how the body is delimited
+    chunked = false;
+    read_until_close = false;
+    body_remaining = 0;
+    body_done = false;
+
+    auto connection_header = response.headers.find("Connection");
+    keep_alive = connection_header == response.headers.end() ||
+                 !StringUtil::CIEquals(connection_header->second, "close");
+
+    auto transfer_encoding = response.headers.find("Transfer-Encoding");
+    auto content_length = response.headers.find("Content-Length");
+    if (transfer_encoding != response.headers.end() &&
+        StringUtil::Contains(StringUtil::Lower(transfer_encoding->second), "chunked")) {
+        chunked = true;
+    } else if (content_length != response.headers.end()) {
+        body_remaining = std::stoull(content_length->second);
+        body_done = body_remaining == 0;
+    } else {
+        read_until_close = true;
+        keep_alive = false;
+    }
+    return response;
+}
+
+idx_t MSOLAPHTTPConnection::ReadBody(char *out, idx_t length) {
+    while (!body_done) {
+        if (chunked && body_remaining == 0) {
+            // Start of the next chunk: "<hex size>[;extensions]"
+            auto size_line = ReadLine();
+            body_remaining = std::stoull(size_line, nullptr, 16);
+            if (body_remaining == 0) {
+                // Last chunk, skip trailers
+                while (!ReadLine().empty()) {
+                }
+                body_done = true;
+                break;
+            }
+        }
+        if (buffer_pos == buffer_end && !FillBuffer()) {
+            if (read_until_close) {
+                body_done = true;
+                Close();
+                break;
+            }
+            Close();
+            throw std::runtime_error("Connection closed by XMLA endpoint " + host +
+                                     " before the response was complete");
+        }
+        idx_t available = buffer_end - buffer_pos;
+        if (!read_until_close) {
+            available = MinValue<idx_t>(available, body_remaining);
+        }
+        idx_t count = MinValue<idx_t>(available, length);
+        memcpy(out, buffer.get() + buffer_pos, count);
+        buffer_pos += count;
+        if (!read_until_close) {
+            body_remaining -= count;
+            if (body_remaining == 0) {
+                if (chunked) {
+                    // Every chunk is followed by a CRLF
+                    ReadLine();
+                } else {
+                    body_done = true;
+                }
+            }
+        }
+        if (count > 0) {
+            if (body_done && !keep_alive) {
+                Close();
+            }
+            return count;
+        }
+    }
+    if (!keep_alive) {
+        Close();
+    }
+    return 0;
+}
+
+std::string MSOLAPHTTPConnection::ReadFullBody() {
+    std::string body;
+    char chunk[8192];
+    while (true) {
+        auto count = ReadBody(chunk, sizeof(chunk));
+        if (count == 0) {
+            break;
+        }
+        body.append(chunk, count);
+    }
+    return body;
+}
+
+bool MSOLAPHTTPConnection::IsOpen() const {
+    return socket_fd != INVALID_SOCKET_FD;
+}
+
+void MSOLAPHTTPConnection::Close() {
+    std::lock_guard<std::mutex> guard(*socket_lock);
+    if (socket_fd != INVALID_SOCKET_FD) {
+        CloseSocket(socket_fd);
+        socket_fd = INVALID_SOCKET_FD;
+    }
+}
+
+void MSOLAPHTTPConnection::Abort() {
+    // Shut down rather than closed: the socket stays valid until the thread using it closes it
+    std::lock_guard<std::mutex> guard(*socket_lock);
+    aborted = true;
+    if (socket_fd != INVALID_SOCKET_FD) {
+        ShutdownSocket(socket_fd);
+    }
+}
+
+bool MSOLAPHTTPConnection::IsAborted() const {
+    std::lock_guard<std::mutex> guard(*socket_lock);
+    return aborted;
+}
+
+} // namespace duckdb
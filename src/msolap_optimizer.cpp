@@ -0,0 +1,331 @@
+#include "msolap_optimizer.hpp"
+#include "msolap_scanner.hpp"
+#include "msolap_dax.hpp"
+#include "duckdb/optimizer/column_binding_replacer.hpp"
+#include "duckdb/optimizer/optimizer.hpp"
+#include "duckdb/planner/binder.hpp"
+#include "duckdb/planner/expression/bound_aggregate_expression.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/operator/logical_aggregate.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+#include "duckdb/planner/operator/logical_limit.hpp"
+#include "duckdb/planner/operator/logical_projection.hpp"
+#include "duckdb/planner/operator/logical_top_n.hpp"
+
+namespace duckdb {
+
+// Larger limits are not worth a TOPN, the scan reads (nearly) everything anyway
+static constexpr idx_t MAX_TOP_COUNT = 1000000;
+
+// The msolap scan below op if only projections are in between, they neither drop nor reorder rows
+static optional_ptr<LogicalGet> FindScan(LogicalOperator &op) {
+    reference<LogicalOperator> child = *op.children[0];
+    while (child.get().type == LogicalOperatorType::LOGICAL_PROJECTION) {
+        child = *child.get().children[0];
+    }
+    if (child.get().type != LogicalOperatorType::LOGICAL_GET) {
+        return nullptr;
+    }
+    auto &get = child.get().Cast<LogicalGet>();
+    if (get.function.name != "msolap" || !get.bind_data) {
+        return nullptr;
+    }
+    return &get;
+}
+
+// Scan column an expression of op refers to, following column references through the projections in between.
+// Returns false for anything but a plain reference to a result column of the query.
+static bool ResolveScanColumn(LogicalOperator &op, const Expression &expression, LogicalGet &get,
+                              column_t &column_id) {
+    if (expression.GetExpressionType() != ExpressionType::BOUND_COLUMN_REF) {
+        return false;
+    }
+    auto binding = expression.Cast<BoundColumnRefExpression>().binding;
+    reference<LogicalOperator> child = *op.children[0];
+    while (child.get().type == LogicalOperatorType::LOGICAL_PROJECTION) {
+        auto &projection = child.get().Cast<LogicalProjection>();
+        if (binding.table_index != projection.table_index) {
+            return false;
+        }
+        auto &projected = *projection.expressions[binding.column_index];
+        if (projected.GetExpressionType() != ExpressionType::BOUND_COLUMN_REF) {
+            return false;
+        }
+        binding = projected.Cast<BoundColumnRefExpression>().binding;
+        child = *child.get().children[0];
+    }
+    if (binding.table_index != get.table_index) {
+        return false;
+    }
+    auto index = binding.column_index;
+    if (!get.projection_ids.empty()) {
+        index = get.projection_ids[index];
+    }
+    auto &column_index = get.GetColumnIds()[index];
+    if (column_index.IsRowIdColumn()) {
+        return false;
+    }
+    column_id = column_index.GetPrimaryIndex();
+    return column_id < get.bind_data->Cast<MSOLAPBindData>().types.size();
+}
+
+// Check if TOPN over the query selects the rows DuckDB would: the query can be wrapped, and no filter has been
+// pushed into the scan, those are re-evaluated on the rows the server returns and could drop some of the top ones.
+// Optional and dynamic filters (e.g. the one DuckDB adds for a TOP N) do not change the result.
+static bool CanPushTop(LogicalGet &get) {
+    auto &bind_data = get.bind_data->Cast<MSOLAPBindData>();
+    if (!bind_data.rewritable || !bind_data.query.order_by.empty() || bind_data.top_count > 0) {
+        return false;
+    }
+    for (auto &entry : get.table_filters.filters) {
+        auto filter_type = entry.second->filter_type;
+        if (filter_type != TableFilterType::OPTIONAL_FILTER && filter_type != TableFilterType::DYNAMIC_FILTER) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Types DAX orders the same way as DuckDB. Text is compared case-insensitively by the server.
+static bool CanOrderOnServer(const LogicalType &type) {
+    switch (type.id()) {
+    case LogicalTypeId::BOOLEAN:
+    case LogicalTypeId::DATE:
+    case LogicalTypeId::TIMESTAMP:
+        return true;
+    default:
+        return type.IsNumeric();
+    }
+}
+
+// The query returns top_count rows in a single request, partitioning it would only split them up
+static void PushTop(MSOLAPBindData &bind_data, idx_t top_count) {
+    bind_data.top_count = top_count;
+    bind_data.partitions = 1;
+    bind_data.max_threads = 1;
+}
+
+static bool TryPushLimit(LogicalLimit &limit) {
+    if (limit.limit_val.Type() != LimitNodeType::CONSTANT_VALUE) {
+        return false;
+    }
+    idx_t offset = 0;
+    if (limit.offset_val.Type() == LimitNodeType::CONSTANT_VALUE) {
+        offset = limit.offset_val.GetConstantValue();
+    } else if (limit.offset_val.Type() != LimitNodeType::UNSET) {
+        return false;
+    }
+    auto top_count = limit.limit_val.GetConstantValue() + offset;
+    auto get = FindScan(limit);
+    if (!get || top_count == 0 || top_count > MAX_TOP_COUNT || !CanPushTop(*get)) {
+        return false;
+    }
+    // LIMIT stays in place, the scan just stops early
+    PushTop(get->bind_data->Cast<MSOLAPBindData>(), top_count);
+    return true;
+}
+
+static bool TryPushTopN(unique_ptr<LogicalOperator> &op) {
+    auto &top_n = op->Cast<LogicalTopN>();
+    auto top_count = top_n.limit + top_n.offset;
+    auto get = FindScan(top_n);
+    if (!get || top_count == 0 || top_count > MAX_TOP_COUNT || !CanPushTop(*get)) {
+        return false;
+    }
+    auto &bind_data = get->bind_data->Cast<MSOLAPBindData>();
+    std::vector<MSOLAPOrder> order;
+    for (auto &node : top_n.orders) {
+        MSOLAPOrder key;
+        if (!ResolveScanColumn(top_n, *node.expression, *get, key.column_id) ||
+            !CanOrderOnServer(bind_data.types[key.column_id])) {
+            return false;
+        }
+        key.descending = node.type == OrderType::DESCENDING;
+        key.nulls_first = node.null_order == OrderByNullType::NULLS_FIRST;
+        order.push_back(key);
+    }
+    PushTop(bind_data, top_count);
+    bind_data.top_order = std::move(order);
+
+    // The server returns the rows sorted, a LIMIT in place of the TOP N keeps the first ones
+    auto limit = make_uniq<LogicalLimit>(BoundLimitNode::ConstantValue(NumericCast<int64_t>(top_n.limit)),
+                                         BoundLimitNode::ConstantValue(NumericCast<int64_t>(top_n.offset)));
+    limit->children = std::move(top_n.children);
+    limit->ResolveOperatorTypes();
+    op = std::move(limit);
+    return true;
+}
+
+// DAX measure computing a DuckDB aggregate over the rows of the current group, empty if there is none
+static std::string TranslateAggregate(LogicalAggregate &aggregate, const BoundAggregateExpression &expression,
+                                      LogicalGet &get, const std::string &model_table, bool &never_blank) {
+    auto &bind_data = get.bind_data->Cast<MSOLAPBindData>();
+    auto &name = expression.function.name;
+    if (expression.filter || expression.order_bys) {
+        return "";
+    }
+    if (name == "count_star") {
+        return MSOLAPDax::TranslateAggregate(name, false, bind_data.query.table, "", LogicalType::BIGINT,
+                                             never_blank);
+    }
+    column_t column_id;
+    if (expression.children.size() != 1 ||
+        !ResolveScanColumn(aggregate, *expression.children[0], get, column_id) ||
+        !MSOLAPDax::IsModelColumn(bind_data.dax_names[column_id], model_table)) {
+        return "";
+    }
+    return MSOLAPDax::TranslateAggregate(name, expression.IsDistinct(), bind_data.query.table,
+                                         MSOLAPDax::ColumnReference(bind_data.dax_names[column_id]),
+                                         bind_data.types[column_id], never_blank);
+}
+
+// Evaluate a GROUP BY directly above an msolap scan of a model table on the server. The scan is replaced by one
+// reading the result of a SUMMARIZECOLUMNS query, a projection in place of the aggregate keeps its bindings.
+static bool TryPushAggregate(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan,
+                             unique_ptr<LogicalOperator> &op) {
+    Value enabled;
+    if (input.context.TryGetCurrentSetting("msolap_aggregate_pushdown", enabled) && !enabled.GetValue<bool>()) {
+        return false;
+    }
+    auto &aggregate = op->Cast<LogicalAggregate>();
+    // Aggregates of a whole scan stay with DuckDB, their filters are pushed into the scan like any other
+    if (aggregate.groups.empty() || aggregate.grouping_sets.size() > 1 || !aggregate.grouping_functions.empty()) {
+        return false;
+    }
+    auto get = FindScan(aggregate);
+    if (!get) {
+        return false;
+    }
+    auto &bind_data = get->bind_data->Cast<MSOLAPBindData>();
+    if (!bind_data.rewritable || bind_data.top_count > 0) {
+        return false;
+    }
+    auto model_table = bind_data.query.GetModelTable();
+    if (model_table.empty()) {
+        return false;
+    }
+
+    // Columns of the summarized result: the group columns, then one measure per aggregate
+    std::vector<std::string> dax_names;
+    std::vector<LogicalType> types;
+    std::vector<std::string> groups;
+    for (auto &group : aggregate.groups) {
+        column_t column_id;
+        if (!ResolveScanColumn(aggregate, *group, *get, column_id) ||
+            !MSOLAPDax::IsModelColumn(bind_data.dax_names[column_id], model_table)) {
+            return false;
+        }
+        groups.push_back(MSOLAPDax::ColumnReference(bind_data.dax_names[column_id]));
+        dax_names.push_back(bind_data.dax_names[column_id]);
+        types.push_back(group->return_type);
+    }
+    std::vector<std::pair<std::string, std::string>> measures;
+    bool never_blank = false;
+    for (auto &expression : aggregate.expressions) {
+        if (expression->GetExpressionType() != ExpressionType::BOUND_AGGREGATE) {
+            return false;
+        }
+        auto measure = TranslateAggregate(aggregate, expression->Cast<BoundAggregateExpression>(), *get,
+                                          model_table, never_blank);
+        if (measure.empty()) {
+            return false;
+        }
+        auto name = "Aggregate" + std::to_string(measures.size() + 1);
+        measures.emplace_back(name, measure);
+        dax_names.push_back("[" + name + "]");
+        types.push_back(expression->return_type);
+    }
+
+    // Filters pushed into the scan are not evaluated by DuckDB once the aggregate is gone, so they have to
+    // translate exactly
+    std::string predicate;
+    for (auto &entry : get->table_filters.filters) {
+        auto &column_index = get->GetColumnIds()[entry.first];
+        if (column_index.IsRowIdColumn()) {
+            return false;
+        }
+        auto column_id = column_index.GetPrimaryIndex();
+        std::string condition;
+        if (!MSOLAPDax::IsModelColumn(bind_data.dax_names[column_id], model_table) ||
+            !MSOLAPDax::TryTranslateExactFilter(*entry.second,
+                                                MSOLAPDax::ColumnReference(bind_data.dax_names[column_id]),
+                                                bind_data.types[column_id], condition)) {
+            return false;
+        }
+        if (!condition.empty()) {
+            predicate += (predicate.empty() ? "" : " && ") + condition;
+        }
+    }
+    bool rows_column;
+    auto table =
+        MSOLAPDax::Summarize(bind_data.query.table, groups, measures, predicate, never_blank, rows_column);
+    if (rows_column) {
+        dax_names.push_back("[Rows]");
+        types.push_back(LogicalType::BIGINT);
+    }
+
+    auto summary = make_uniq<MSOLAPBindData>();
+    summary->connection_string = bind_data.connection_string;
+    summary->dax_query = bind_data.query.Build(table, false);
+    summary->dax_names = dax_names;
+    for (auto &dax_name : dax_names) {
+        summary->names.push_back(MSOLAPUtils::SanitizeColumnName(dax_name));
+    }
+    summary->types = types;
+    auto names = summary->names;
+
+    auto table_index = get->table_index;
+    auto summary_get =
+        make_uniq<LogicalGet>(table_index, get->function, std::move(summary), std::move(types), std::move(names));
+    for (idx_t i = 0; i < dax_names.size(); i++) {
+        summary_get->AddColumnId(i);
+    }
+
+    // Re-expose the group and aggregate columns under a projection, references to the aggregate are redirected
+    auto projection_index = input.optimizer.binder.GenerateTableIndex();
+    auto column_count = aggregate.groups.size() + aggregate.expressions.size();
+    vector<unique_ptr<Expression>> expressions;
+    ColumnBindingReplacer replacer;
+    for (idx_t i = 0; i < column_count; i++) {
+        auto &type = summary_get->returned_types[i];
+        expressions.push_back(make_uniq<BoundColumnRefExpression>(type, ColumnBinding(table_index, i)));
+        auto old_binding = i < aggregate.groups.size()
+                               ? ColumnBinding(aggregate.group_index, i)
+                               : ColumnBinding(aggregate.aggregate_index, i - aggregate.groups.size());
+        replacer.replacement_bindings.emplace_back(old_binding, ColumnBinding(projection_index, i));
+    }
+    auto projection = make_uniq<LogicalProjection>(projection_index, std::move(expressions));
+    projection->children.push_back(std::move(summary_get));
+    projection->ResolveOperatorTypes();
+    replacer.stop_operator = projection.get();
+    op = std::move(projection);
+    replacer.VisitOperator(*plan);
+    return true;
+}
+
+static void OptimizeInternal(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan,
+                             unique_ptr<LogicalOperator> &op) {
+    if (op->type == LogicalOperatorType::LOGICAL_LIMIT) {
+        TryPushLimit(op->Cast<LogicalLimit>());
+    } else if (op->type == LogicalOperatorType::LOGICAL_TOP_N) {
+        TryPushTopN(op);
+    } else if (op->type == LogicalOperatorType::LOGICAL_AGGREGATE_AND_GROUP_BY) {
+        if (TryPushAggregate(input, plan, op)) {
+            // Nothing left to rewrite below
+            return;
+        }
+    }
+    for (auto &child : op->children) {
+        OptimizeInternal(input, plan, child);
+    }
+}
+
+MSOLAPOptimizerExtension::MSOLAPOptimizerExtension() {
+    optimize_function = Optimize;
+}
+
+void MSOLAPOptimizerExtension::Optimize(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan) {
+    OptimizeInternal(input, plan, plan);
+}
+
+} // namespace duckdb
@@ -0,0 +1,397 @@
+#include "msolap_pool.hpp"
+#include "msolap_utils.hpp"
+#include <algorithm>
+
+namespace duckdb {
+
+MSOLAPPooledSession::MSOLAPPooledSession() : pool(nullptr) {
+}
+
+MSOLAPPooledSession::MSOLAPPooledSession(MSOLAPConnectionPool &pool, std::string key, unique_ptr<MSOLAPSession> session)
+    : pool(&pool), key(std::move(key)), session(std::move(session)) {
+}
+
+MSOLAPPooledSession::~MSOLAPPooledSession() {
+    Release();
+}
+
+MSOLAPPooledSession::MSOLAPPooledSession(MSOLAPPooledSession &&other) noexcept
+    : pool(other.pool), key(std::move(other.key)), session(std::move(other.session)) {
+    other.pool = nullptr;
+}
+
+MSOLAPPooledSession &MSOLAPPooledSession::operator=(MSOLAPPooledSession &&other) noexcept {
+    if (this != &other) {
+        Release();
+        pool = other.pool;
+        key = std::move(other.key);
+        session = std::move(other.session);
+        other.pool = nullptr;
+    }
+    return *this;
+}
+
+void MSOLAPPooledSession::Release() {
+    if (pool && session) {
+        pool->Release(key, std::move(session), true);
+    }
+    pool = nullptr;
+}
+
+void MSOLAPPooledSession::Invalidate() {
+    if (pool && session) {
+        pool->Release(key, std::move(session), false);
+    }
+    pool = nullptr;
+}
+
+MSOLAPConnectionPool::MSOLAPConnectionPool()
+    : max_idle(DEFAULT_MAX_IDLE), max_active(DEFAULT_MAX_ACTIVE), idle_timeout(DEFAULT_IDLE_TIMEOUT),
+      ping_interval(DEFAULT_PING_INTERVAL) {
+}
+
+MSOLAPConnectionPool &MSOLAPConnectionPool::Get() {
+    // Never destroyed: closing OLE DB sessions during static destruction would call into an uninitialized
+    // COM apartment, the operating system reclaims the sockets of XMLA sessions
+    static auto pool = new MSOLAPConnectionPool();
+    return *pool;
+}
+
+// Properties trimmed, keys lower case and sorted, optionally with the values of password properties masked
+static std::string NormalizeProperties(const std::string &connection_string, bool mask_secrets) {
+    auto properties = MSOLAPUtils::ParseConnectionString(connection_string);
+    std::vector<std::pair<std::string, std::string>> sorted;
+    for (auto &property : properties) {
+        auto key = StringUtil::Lower(property.first);
+        bool secret = key == "password" || key == "pwd";
+        sorted.emplace_back(key, mask_secrets && secret ? "***" : property.second);
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    std::string result;
+    for (auto &property : sorted) {
+        auto &value = property.second;
+        if (value.find_first_of(";\"'") != std::string::npos) {
+            // Quoted like in the connection string, so values with ';' stay apart
+            result += property.first + "=\"" + StringUtil::Replace(value, "\"", "\"\"") + "\";";
+        } else {
+            result += property.first + "=" + value + ";";
+        }
+    }
+    return result;
+}
+
+std::string MSOLAPConnectionPool::NormalizeConnectionString(const std::string &connection_string) {
+    return NormalizeProperties(connection_string, false);
+}
+
+std::string MSOLAPConnectionPool::MaskConnectionString(const std::string &connection_string) {
+    return NormalizeProperties(connection_string, true);
+}
+
+static void CloseSessions(std::vector<unique_ptr<MSOLAPSession>> &sessions) {
+    for (auto &session : sessions) {
+        try {
+            session->Close();
+        } catch (std::exception &) {
+            // The session is discarded either way
+        }
+    }
+    sessions.clear();
+}
+
+void MSOLAPConnectionPool::EvictIdle(std::vector<unique_ptr<MSOLAPSession>> &expired) {
+    auto now = std::chrono::steady_clock::now();
+    for (auto &it : entries) {
+        auto &entry = it.second;
+        // Sessions are released in order, so the expired ones are at the front
+        idx_t keep_from = 0;
+        while (keep_from < entry.idle.size() &&
+               (now - entry.idle[keep_from].idle_since >= idle_timeout || entry.idle.size() - keep_from > max_idle)) {
+            keep_from++;
+        }
+        for (idx_t i = 0; i < keep_from; i++) {
+            expired.push_back(std::move(entry.idle[i].session));
+        }
+        entry.idle.erase(entry.idle.begin(), entry.idle.begin() + keep_from);
+        entry.evicted += keep_from;
+    }
+}
+
+unique_ptr<MSOLAPSession> MSOLAPConnectionPool::TakeIdle(const std::string &key, bool &needs_ping) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto &entry = entries[key];
+    if (entry.idle.empty()) {
+        return nullptr;
+    }
+    auto idle = std::move(entry.idle.back());
+    entry.idle.pop_back();
+    needs_ping = std::chrono::steady_clock::now() - idle.idle_since >= ping_interval;
+    return std::move(idle.session);
+}
+
+bool MSOLAPConnectionPool::Reserve(const std::string &key, const std::string &connection_string,
+                                   const std::function<void()> *ready, std::chrono::steady_clock::time_point deadline) {
+    std::vector<unique_ptr<MSOLAPSession>> expired;
+    std::string error;
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        EvictIdle(expired);
+        auto &entry = entries[key];
+        if (entry.display_name.empty()) {
+            entry.display_name = MaskConnectionString(connection_string);
+        }
+        auto available = [&]() {
+            return max_active == 0 || entry.active < max_active;
+        };
+        if (!available()) {
+            entry.waits++;
+            if (ready && std::chrono::steady_clock::now() < deadline) {
+                entry.waiters.push_back(*ready);
+                guard.unlock();
+                CloseSessions(expired);
+                return false;
+            }
+            // Wait for a session to come back rather than open yet another one. The sessions may be held by the
+            // query waiting for them (e.g. more scan threads than sessions allowed), which the timeout breaks.
+            if (ready || !released.wait_until(guard, deadline, available)) {
+                error = "All " + std::to_string(max_active) + " MSOLAP sessions allowed for " + entry.display_name +
+                        " are in use, waited " + std::to_string(ACQUIRE_TIMEOUT) +
+                        " seconds for one (SET msolap_pool_max_active raises the limit)";
+            }
+        }
+        if (error.empty()) {
+            entry.active++;
+        }
+    }
+    CloseSessions(expired);
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+    return true;
+}
+
+void MSOLAPConnectionPool::Unreserve(PoolEntry &entry, std::vector<std::function<void()>> &ready) {
+    entry.active--;
+    // Every waiter tries again, those that still find no room wait again
+    for (auto &waiter : entry.waiters) {
+        ready.push_back(std::move(waiter));
+    }
+    entry.waiters.clear();
+}
+
+void MSOLAPConnectionPool::NotifyReleased(std::vector<std::function<void()>> &ready) {
+    released.notify_all();
+    for (auto &waiter : ready) {
+        waiter();
+    }
+    ready.clear();
+}
+
+MSOLAPPooledSession MSOLAPConnectionPool::TakeSession(std::string key, const std::string &connection_string) {
+    // Take the most recently used session, it is the least likely to have been dropped by the server. The server,
+    // a proxy or a load balancer may still have dropped one that was idle for a while, which only a round trip
+    // tells, so it is pinged (outside the lock) before it is handed out.
+    std::vector<unique_ptr<MSOLAPSession>> expired;
+    unique_ptr<MSOLAPSession> session;
+    bool needs_ping = false;
+    while (!session) {
+        auto candidate = TakeIdle(key, needs_ping);
+        if (!candidate) {
+            break;
+        }
+        bool healthy = candidate->IsOpen();
+        if (healthy && needs_ping) {
+            try {
+                candidate->Ping();
+            } catch (std::exception &) {
+                healthy = false;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            auto &entry = entries[key];
+            entry.pinged += needs_ping ? 1 : 0;
+            if (healthy) {
+                session = std::move(candidate);
+                entry.reused++;
+            } else {
+                expired.push_back(std::move(candidate));
+                entry.evicted++;
+                entry.ping_failures += needs_ping ? 1 : 0;
+            }
+        }
+        CloseSessions(expired);
+    }
+
+    if (!session) {
+        try {
+            session = MSOLAPSession::Open(connection_string);
+        } catch (...) {
+            std::vector<std::function<void()>> ready;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                Unreserve(entries[key], ready);
+            }
+            NotifyReleased(ready);
+            throw;
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        entries[key].opened++;
+    }
+    return MSOLAPPooledSession(*this, std::move(key), std::move(session));
+}
+
+MSOLAPPooledSession MSOLAPConnectionPool::Acquire(const std::string &connection_string) {
+    auto key = NormalizeConnectionString(connection_string);
+    Reserve(key, connection_string, nullptr, std::chrono::steady_clock::now() + std::chrono::seconds(ACQUIRE_TIMEOUT));
+    return TakeSession(std::move(key), connection_string);
+}
+
+bool MSOLAPConnectionPool::TryAcquire(const std::string &connection_string, const std::function<void()> &ready,
+                                      std::chrono::steady_clock::time_point deadline, MSOLAPPooledSession &session) {
+    auto key = NormalizeConnectionString(connection_string);
+    if (!Reserve(key, connection_string, &ready, deadline)) {
+        return false;
+    }
+    session = TakeSession(std::move(key), connection_string);
+    return true;
+}
+
+void MSOLAPConnectionPool::Release(const std::string &key, unique_ptr<MSOLAPSession> session, bool reusable) {
+    std::vector<unique_ptr<MSOLAPSession>> expired;
+    std::vector<std::function<void()>> ready;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        auto &entry = entries[key];
+        Unreserve(entry, ready);
+        if (reusable && max_idle > 0 && session->IsOpen() && session->IsPoolable()) {
+            entry.idle.push_back(IdleSession {std::move(session), std::chrono::steady_clock::now()});
+        } else {
+            expired.push_back(std::move(session));
+            entry.evicted++;
+        }
+        EvictIdle(expired);
+    }
+    NotifyReleased(ready);
+    CloseSessions(expired);
+}
+
+void MSOLAPConnectionPool::SetMaxIdle(idx_t max_idle_p) {
+    std::vector<unique_ptr<MSOLAPSession>> expired;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        max_idle = max_idle_p;
+        EvictIdle(expired);
+    }
+    CloseSessions(expired);
+}
+
+void MSOLAPConnectionPool::SetMaxActive(idx_t max_active_p) {
+    std::vector<std::function<void()>> ready;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        max_active = max_active_p;
+        for (auto &it : entries) {
+            for (auto &waiter : it.second.waiters) {
+                ready.push_back(std::move(waiter));
+            }
+            it.second.waiters.clear();
+        }
+    }
+    NotifyReleased(ready);
+}
+
+idx_t MSOLAPConnectionPool::GetMaxActive() {
+    std::lock_guard<std::mutex> guard(lock);
+    return max_active;
+}
+
+void MSOLAPConnectionPool::SetIdleTimeout(idx_t seconds) {
+    std::vector<unique_ptr<MSOLAPSession>> expired;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        idle_timeout = std::chrono::seconds(seconds);
+        EvictIdle(expired);
+    }
+    CloseSessions(expired);
+}
+
+void MSOLAPConnectionPool::SetPingInterval(idx_t seconds) {
+    std::lock_guard<std::mutex> guard(lock);
+    ping_interval = std::chrono::seconds(seconds);
+}
+
+std::vector<MSOLAPPoolStats> MSOLAPConnectionPool::GetStats() {
+    std::vector<unique_ptr<MSOLAPSession>> expired;
+    std::vector<MSOLAPPoolStats> result;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        EvictIdle(expired);
+        for (auto &it : entries) {
+            auto &entry = it.second;
+            MSOLAPPoolStats stats;
+            stats.connection_string = entry.display_name;
+            stats.idle = entry.idle.size();
+            stats.active = entry.active;
+            stats.max_active = max_active;
+            stats.opened = entry.opened;
+            stats.reused = entry.reused;
+            stats.evicted = entry.evicted;
+            stats.pinged = entry.pinged;
+            stats.ping_failures = entry.ping_failures;
+            stats.waits = entry.waits;
+            result.push_back(std::move(stats));
+        }
+    }
+    CloseSessions(expired);
+    return result;
+}
+
+struct MSOLAPPoolStatsState : public GlobalTableFunctionState {
+    std::vector<MSOLAPPoolStats> stats;
+    idx_t offset = 0;
+};
+
+static unique_ptr<FunctionData> MSOLAPPoolStatsBind(ClientContext &context, TableFunctionBindInput &input,
+                                                    vector<LogicalType> &return_types, vector<string> &names) {
+    names = {"connection_string", "idle",   "active", "max_active",    "opened",
+             "reused",            "evicted", "pinged", "ping_failures", "waits"};
+    return_types = {LogicalType::VARCHAR, LogicalType::BIGINT, LogicalType::BIGINT, LogicalType::BIGINT,
+                    LogicalType::BIGINT,  LogicalType::BIGINT, LogicalType::BIGINT, LogicalType::BIGINT,
+                    LogicalType::BIGINT,  LogicalType::BIGINT};
+    return make_uniq<TableFunctionData>();
+}
+
+static unique_ptr<GlobalTableFunctionState> MSOLAPPoolStatsInit(ClientContext &context,
+                                                                TableFunctionInitInput &input) {
+    auto result = make_uniq<MSOLAPPoolStatsState>();
+    result->stats = MSOLAPConnectionPool::Get().GetStats();
+    return std::move(result);
+}
+
+static void MSOLAPPoolStatsScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+    auto &state = data.global_state->Cast<MSOLAPPoolStatsState>();
+    idx_t count = 0;
+    while (state.offset < state.stats.size() && count < STANDARD_VECTOR_SIZE) {
+        auto &stats = state.stats[state.offset++];
+        output.SetValue(0, count, Value(stats.connection_string));
+        output.SetValue(1, count, Value::BIGINT(int64_t(stats.idle)));
+        output.SetValue(2, count, Value::BIGINT(int64_t(stats.active)));
+        output.SetValue(3, count, Value::BIGINT(int64_t(stats.max_active)));
+        output.SetValue(4, count, Value::BIGINT(int64_t(stats.opened)));
+        output.SetValue(5, count, Value::BIGINT(int64_t(stats.reused)));
+        output.SetValue(6, count, Value::BIGINT(int64_t(stats.evicted)));
+        output.SetValue(7, count, Value::BIGINT(int64_t(stats.pinged)));
+        output.SetValue(8, count, Value::BIGINT(int64_t(stats.ping_failures)));
+        output.SetValue(9, count, Value::BIGINT(int64_t(stats.waits)));
+        count++;
+    }
+    output.SetCardinality(count);
+}
+
+MSOLAPPoolStatsFunction::MSOLAPPoolStatsFunction()
+    : TableFunction("msolap_pool_stats", {}, MSOLAPPoolStatsScan, MSOLAPPoolStatsBind, MSOLAPPoolStatsInit) {
+}
+
+} // namespace duckdb
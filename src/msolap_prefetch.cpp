@@ -0,0 +1,29 @@
+#include "msolap_prefetch.hpp"
+
+namespace duckdb {
+
+MSOLAPPrefetchRowset::MSOLAPPrefetchRowset(MSOLAPIOScheduler &scheduler, MSOLAPIOStream::OpenFunction open,
+                                           idx_t chunk_count)
+    : stream(make_shared_ptr<MSOLAPIOStream>(std::move(open), chunk_count)) {
+    scheduler.Schedule(stream);
+}
+
+MSOLAPPrefetchRowset::~MSOLAPPrefetchRowset() {
+    stream->Cancel();
+}
+
+void MSOLAPPrefetchRowset::GetColumnInfo(std::vector<std::string> &names, std::vector<LogicalType> &types) {
+    stream->GetColumnInfo(names, types);
+}
+
+idx_t MSOLAPPrefetchRowset::Fetch(DataChunk &output) {
+    auto chunk = stream->Next();
+    if (!chunk) {
+        output.SetCardinality(0);
+        return 0;
+    }
+    output.Reference(*chunk);
+    return output.size();
+}
+
+} // namespace duckdb
@@ -0,0 +1,107 @@
+#include "msolap_progress.hpp"
+
+namespace duckdb {
+
+MSOLAPScanProgress::MSOLAPScanProgress(std::string connection_string, std::string query, idx_t partitions,
+                                       idx_t estimated_rows)
+    : connection_string(std::move(connection_string)), query(std::move(query)), partitions(partitions),
+      estimated_rows(estimated_rows), started(std::chrono::steady_clock::now()), partitions_done(0), rows(0),
+      bytes(0) {
+}
+
+double MSOLAPScanProgress::GetPercentage() const {
+    double result = -1;
+    if (estimated_rows > 0) {
+        // Filters make the estimate an upper bound, completed partitions catch up with it
+        result = 100.0 * double(rows.load()) / double(estimated_rows);
+    }
+    if (partitions > 1 || estimated_rows > 0) {
+        result = MaxValue<double>(result, 100.0 * double(partitions_done.load()) / double(partitions));
+    }
+    return MinValue<double>(result, 100.0);
+}
+
+double MSOLAPScanProgress::GetElapsedSeconds() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+}
+
+MSOLAPScanRegistry &MSOLAPScanRegistry::Get() {
+    // Never destroyed, like the connection pool
+    static auto registry = new MSOLAPScanRegistry();
+    return *registry;
+}
+
+void MSOLAPScanRegistry::Register(const shared_ptr<MSOLAPScanProgress> &scan) {
+    std::lock_guard<std::mutex> guard(lock);
+    scans.push_back(scan);
+}
+
+void MSOLAPScanRegistry::Unregister(const MSOLAPScanProgress &scan) {
+    std::lock_guard<std::mutex> guard(lock);
+    for (auto it = scans.begin(); it != scans.end(); it++) {
+        if (it->get() == &scan) {
+            scans.erase(it);
+            return;
+        }
+    }
+}
+
+std::vector<shared_ptr<MSOLAPScanProgress>> MSOLAPScanRegistry::GetScans() {
+    std::lock_guard<std::mutex> guard(lock);
+    return scans;
+}
+
+struct MSOLAPScansState : public GlobalTableFunctionState {
+    std::vector<shared_ptr<MSOLAPScanProgress>> scans;
+    idx_t offset = 0;
+};
+
+static unique_ptr<FunctionData> MSOLAPScansBind(ClientContext &context, TableFunctionBindInput &input,
+                                                vector<LogicalType> &return_types, vector<string> &names) {
+    names = {"connection_string", "query",         "partitions", "partitions_done",  "rows",
+             "estimated_rows",    "bytes",         "elapsed",    "rows_per_second", "bytes_per_second",
+             "progress"};
+    return_types = {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::BIGINT, LogicalType::BIGINT,
+                    LogicalType::BIGINT,  LogicalType::BIGINT,  LogicalType::BIGINT, LogicalType::DOUBLE,
+                    LogicalType::DOUBLE,  LogicalType::DOUBLE,  LogicalType::DOUBLE};
+    return make_uniq<TableFunctionData>();
+}
+
+static unique_ptr<GlobalTableFunctionState> MSOLAPScansInit(ClientContext &context, TableFunctionInitInput &input) {
+    auto result = make_uniq<MSOLAPScansState>();
+    result->scans = MSOLAPScanRegistry::Get().GetScans();
+    return std::move(result);
+}
+
+static void MSOLAPScansScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+    auto &state = data.global_state->Cast<MSOLAPScansState>();
+    idx_t count = 0;
+    while (state.offset < state.scans.size() && count < STANDARD_VECTOR_SIZE) {
+        auto &scan = *state.scans[state.offset++];
+        auto rows = scan.rows.load();
+        auto bytes = scan.bytes.load();
+        auto elapsed = scan.GetElapsedSeconds();
+        auto percentage = scan.GetPercentage();
+        output.SetValue(0, count, Value(scan.connection_string));
+        output.SetValue(1, count, Value(scan.query));
+        output.SetValue(2, count, Value::BIGINT(int64_t(scan.partitions)));
+        output.SetValue(3, count, Value::BIGINT(int64_t(scan.partitions_done.load())));
+        output.SetValue(4, count, Value::BIGINT(int64_t(rows)));
+        output.SetValue(5, count,
+                        scan.estimated_rows > 0 ? Value::BIGINT(int64_t(scan.estimated_rows))
+                                                : Value(LogicalType::BIGINT));
+        output.SetValue(6, count, Value::BIGINT(int64_t(bytes)));
+        output.SetValue(7, count, Value::DOUBLE(elapsed));
+        output.SetValue(8, count, Value::DOUBLE(elapsed > 0 ? double(rows) / elapsed : 0));
+        output.SetValue(9, count, Value::DOUBLE(elapsed > 0 ? double(bytes) / elapsed : 0));
+        output.SetValue(10, count, percentage >= 0 ? Value::DOUBLE(percentage) : Value(LogicalType::DOUBLE));
+        count++;
+    }
+    output.SetCardinality(count);
+}
+
+MSOLAPScansFunction::MSOLAPScansFunction()
+    : TableFunction("msolap_scans", {}, MSOLAPScansScan, MSOLAPScansBind, MSOLAPScansInit) {
+}
+
+} // namespace duckdb
@@ -1,258 +1,739 @@
 #include "duckdb.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
 #include "msolap_scanner.hpp"
 #include "msolap_utils.hpp"
+#include "msolap_pool.hpp"
+#include "msolap_dax.hpp"
+#include "msolap_cache.hpp"
+#include "msolap_statistics.hpp"
+#include "msolap_prefetch.hpp"
+#include "msolap_schema_cache.hpp"
+#include "msolap_single_flight.hpp"
+#include "duckdb/planner/expression/bound_conjunction_expression.hpp"
+#include "duckdb/planner/expression/bound_reference_expression.hpp"
+#include "duckdb/storage/statistics/base_statistics.hpp"
+#include "duckdb/storage/statistics/node_statistics.hpp"
+#include "duckdb/storage/statistics/numeric_stats.hpp"
 #include <stdexcept>
 
 namespace duckdb {
 
+// Index of the result column a partition_column parameter refers to, by DuckDB or DAX name
+static idx_t FindPartitionColumn(const MSOLAPBindData &bind_data, const std::string &partition_column) {
+    for (idx_t i = 0; i < bind_data.names.size(); i++) {
+        if (StringUtil::CIEquals(bind_data.names[i], partition_column) ||
+            StringUtil::CIEquals(bind_data.dax_names[i], partition_column)) {
+            return i;
+        }
+    }
+    throw std::runtime_error("Partition column \"" + partition_column + "\" not found in the query result");
+}
+
+// Pick the column to split the query on. Partitions are disjoint on the remainder of an integer column,
+// BLANK values count as 0 so every row lands in exactly one partition.
+static void PlanPartitions(MSOLAPBindData &bind_data, idx_t partitions, const std::string &partition_column) {
+    bind_data.partitions = partitions;
+    if (partitions <= 1) {
+        return;
+    }
+    if (!bind_data.rewritable) {
+        throw std::runtime_error("Partitioned scans need a DAX query with a single EVALUATE statement");
+    }
+
+    idx_t column = DConstants::INVALID_INDEX;
+    if (!partition_column.empty()) {
+        column = FindPartitionColumn(bind_data, partition_column);
+        if (!bind_data.types[column].IsIntegral()) {
+            throw std::runtime_error("Partition column \"" + partition_column + "\" must be an integer column");
+        }
+    } else {
+        for (idx_t i = 0; i < bind_data.types.size(); i++) {
+            if (bind_data.types[i].IsIntegral()) {
+                column = i;
+                break;
+            }
+        }
+        if (column == DConstants::INVALID_INDEX) {
+            throw std::runtime_error("No integer column to partition the DAX query by, set partition_column");
+        }
+    }
+    bind_data.partition_reference = MSOLAPDax::ColumnReference(bind_data.dax_names[column]);
+}
+
 static unique_ptr<FunctionData> MSOLAPBind(ClientContext &context, TableFunctionBindInput &input,
                                          vector<LogicalType> &return_types, vector<string> &names) {
-    MSOLAPConnection::InitializeCOM();
     auto result = make_uniq<MSOLAPBindData>();
-    
+
     // Get connection string and DAX query from input
     result->connection_string = input.inputs[0].GetValue<string>();
     result->dax_query = input.inputs[1].GetValue<string>();
-    
+
+    idx_t partitions = 0;
+    idx_t threads = 0;
+    std::string partition_column;
+    for (auto &kv : input.named_parameters) {
+        if (kv.first == "partitions") {
+            partitions = kv.second.GetValue<uint64_t>();
+            if (partitions == 0) {
+                throw std::runtime_error("partitions must be at least 1");
+            }
+        } else if (kv.first == "threads") {
+            threads = kv.second.GetValue<uint64_t>();
+            if (threads == 0) {
+                throw std::runtime_error("threads must be at least 1");
+            }
+        } else if (kv.first == "partition_column") {
+            partition_column = kv.second.GetValue<string>();
+        } else if (kv.first == "params") {
+            // Bound again with the values of every EXECUTE of a prepared statement
+            result->dax_query = MSOLAPDax::BindParameters(result->dax_query, kv.second);
+        }
+    }
+    if (partitions == 0) {
+        // A partition per thread, naming only the column partitions by the number of DuckDB threads
+        partitions = threads;
+        if (partitions == 0) {
+            partitions = partition_column.empty() ? 1 : TaskScheduler::GetScheduler(context).NumberOfThreads();
+        }
+    }
+    result->max_threads = MinValue<idx_t>(threads == 0 ? partitions : threads, partitions);
+
     try {
-        // Connect to MSOLAP and execute query to get column information
-        MSOLAPConnection connection = MSOLAPConnection::Connect(result->connection_string);
-        IRowset* rowset = connection.ExecuteQuery(result->dax_query);
-        
-        // Get column information
-        if (!connection.GetColumnInfo(rowset, result->names, result->types)) {
-            MSOLAPUtils::SafeRelease(&rowset);
-            throw std::runtime_error("Failed to get column information");
-        }
-        
-        MSOLAPUtils::SafeRelease(&rowset);
-        connection.Close();
-        
-        // Copy output column names and types
-        names.clear();
-        return_types.clear();
-
-        for (auto &name : result->names) {
-            names.push_back(name);
-        }
-
-        for (auto &type : result->types) {
-            return_types.push_back(type);
-        }
-        
+        // Ask for the column information only, the query is evaluated by the scan
+        MSOLAPSchemaCache::Get().DescribeQuery(result->connection_string, result->dax_query, result->dax_names,
+                                               result->types);
     } catch (std::exception &e) {
         throw std::runtime_error("MSOLAP connection failed: " + string(e.what()));
     }
-    
-    if (names.empty()) {
+
+    if (result->dax_names.empty()) {
         throw std::runtime_error("No columns found in DAX query result");
     }
-    
+
+    // Copy output column names and types
+    names.clear();
+    return_types.clear();
+    for (auto &dax_name : result->dax_names) {
+        // Sanitize column name (replace [] with _)
+        result->names.push_back(MSOLAPUtils::SanitizeColumnName(dax_name));
+        names.push_back(result->names.back());
+    }
+    for (auto &type : result->types) {
+        return_types.push_back(type);
+    }
+
+    result->rewritable = MSOLAPDaxQuery::TryParse(result->dax_query, result->query);
+    PlanPartitions(*result, partitions, partition_column);
+
     return std::move(result);
 }
 
+// Check if the query can be narrowed to the projected columns. ORDER BY clauses may refer to any column of
+// the result, so ordered queries always return all of them.
+static bool CanProject(const MSOLAPBindData &bind_data, const vector<column_t> &column_ids) {
+    if (!bind_data.rewritable || !bind_data.query.order_by.empty()) {
+        return false;
+    }
+    if (bind_data.always_project) {
+        return true;
+    }
+    if (column_ids.size() != bind_data.names.size()) {
+        return true;
+    }
+    for (idx_t i = 0; i < column_ids.size(); i++) {
+        if (column_ids[i] != i) {
+            return true;
+        }
+    }
+    // All columns in their original order
+    return false;
+}
+
+// DAX predicate for the filters DuckDB pushed into the scan, empty if none of them can be translated. Lists of
+// values on the columns of a model table evaluated as a whole (IN lists, the keys of a join DuckDB found on the
+// build side) are set as CALCULATETABLE filter arguments instead.
+static std::string TranslateFilters(const MSOLAPBindData &bind_data, const vector<column_t> &column_ids,
+                                    optional_ptr<TableFilterSet> filters, std::string &filter_arguments) {
+    filter_arguments.clear();
+    if (!bind_data.rewritable || !filters) {
+        return "";
+    }
+    auto model_table = bind_data.query.GetModelTable();
+    std::string result;
+    for (auto &entry : filters->filters) {
+        auto column_id = column_ids[entry.first];
+        if (column_id >= bind_data.names.size()) {
+            continue;
+        }
+        auto &dax_name = bind_data.dax_names[column_id];
+        auto reference = MSOLAPDax::ColumnReference(dax_name);
+        std::string predicate;
+        if (!model_table.empty() && MSOLAPDax::IsModelColumn(dax_name, model_table)) {
+            auto arguments =
+                MSOLAPDax::TranslateValueFilters(*entry.second, reference, bind_data.types[column_id], predicate);
+            if (!arguments.empty()) {
+                filter_arguments += (filter_arguments.empty() ? "" : ", ") + arguments;
+            }
+        } else {
+            predicate = MSOLAPDax::TranslateFilter(*entry.second, reference, bind_data.types[column_id]);
+        }
+        if (!predicate.empty()) {
+            result += (result.empty() ? "" : " && ") + predicate;
+        }
+    }
+    return result;
+}
+
+// Query of a partition, returning the projected columns only if project is set
+static std::string BuildQuery(const MSOLAPBindData &bind_data, const vector<column_t> &column_ids, bool project,
+                              const std::string &predicate, const std::string &filter_arguments, idx_t partition) {
+    if (bind_data.partitions <= 1 && !project && predicate.empty() && filter_arguments.empty() &&
+        bind_data.top_count == 0) {
+        return bind_data.dax_query;
+    }
+
+    auto table = bind_data.query.table;
+    if (!filter_arguments.empty()) {
+        table = "CALCULATETABLE(" + table + ", " + filter_arguments + ")";
+    }
+    auto condition = predicate;
+    if (bind_data.partitions > 1) {
+        condition += (condition.empty() ? "" : " && ") + std::string("MOD(") + bind_data.partition_reference + ", " +
+                     std::to_string(bind_data.partitions) + ") = " + std::to_string(partition);
+    }
+    if (!condition.empty()) {
+        table = "FILTER(" + table + ", " + condition + ")";
+    }
+    if (project) {
+        // Columns keep their position, so their names only need to be unique
+        std::string columns;
+        for (auto column_id : column_ids) {
+            if (column_id >= bind_data.names.size()) {
+                // Row id, not fetched
+                columns += ", \"rowid\", BLANK()";
+                continue;
+            }
+            columns += ", " + MSOLAPDax::QuoteString(bind_data.names[column_id]) + ", " +
+                       MSOLAPDax::ColumnReference(bind_data.dax_names[column_id]);
+        }
+        table = "SELECTCOLUMNS(" + table + columns + ")";
+    }
+    if (bind_data.top_count == 0) {
+        return bind_data.query.Build(table);
+    }
+
+    // TOPN returns the first rows in no particular order, ORDER BY sorts them the same way
+    std::string top_keys;
+    std::string order_keys;
+    for (auto &key : bind_data.top_order) {
+        auto reference = project ? MSOLAPDax::QuoteColumn(bind_data.names[key.column_id])
+                                 : MSOLAPDax::ColumnReference(bind_data.dax_names[key.column_id]);
+        // BLANK sorts before any value in DAX, ordering on ISBLANK first puts it where DuckDB puts NULL
+        std::string blank_order = key.nulls_first ? "DESC" : "ASC";
+        std::string value_order = key.descending ? "DESC" : "ASC";
+        top_keys += ", ISBLANK(" + reference + "), " + blank_order + ", " + reference + ", " + value_order;
+        order_keys += std::string(order_keys.empty() ? "ORDER BY " : ", ") + "ISBLANK(" + reference + ") " +
+                      blank_order + ", " + reference + " " + value_order;
+    }
+    auto query = bind_data.query;
+    query.order_by = order_keys;
+    return query.Build("TOPN(" + std::to_string(bind_data.top_count) + ", " + table + top_keys + ")");
+}
+
+// Rowset read together with the session it was executed on, which goes back to the pool once it is closed
+class MSOLAPSessionRowset : public MSOLAPRowset {
+public:
+    MSOLAPSessionRowset(MSOLAPPooledSession session_p, unique_ptr<MSOLAPRowset> rowset_p)
+        : session(std::move(session_p)), rowset(std::move(rowset_p)), failed(false) {
+    }
+
+    ~MSOLAPSessionRowset() override {
+        rowset.reset();
+        if (failed) {
+            session.Invalidate();
+        }
+    }
+
+    void GetColumnInfo(std::vector<std::string> &names, std::vector<LogicalType> &types) override {
+        rowset->GetColumnInfo(names, types);
+    }
+
+    idx_t Fetch(DataChunk &output) override {
+        try {
+            return rowset->Fetch(output);
+        } catch (std::exception &) {
+            // The rest of the response is still pending on the session
+            failed = true;
+            throw;
+        }
+    }
+
+    idx_t GetBytesRead() const override {
+        return rowset->GetBytesRead();
+    }
+
+private:
+    MSOLAPPooledSession session;
+    unique_ptr<MSOLAPRowset> rowset;
+    bool failed;
+};
+
+// Cached result of the query of a partition, null if there is none or the cache is disabled (cache_key is empty)
+static unique_ptr<MSOLAPRowset> OpenCachedPartition(const std::string &cache_key) {
+    if (cache_key.empty()) {
+        return nullptr;
+    }
+    return MSOLAPResultCache::Get().Open(cache_key);
+}
+
+// Execute the query of a partition that is not cached, storing its result while the cache is enabled
+static unique_ptr<MSOLAPRowset> ExecutePartition(MSOLAPSession &session, const std::string &query,
+                                                 const std::string &cache_key) {
+    auto rowset = session.ExecuteQuery(query);
+    if (cache_key.empty()) {
+        return rowset;
+    }
+    return MSOLAPResultCache::Get().Store(cache_key, std::move(rowset));
+}
+
+// Open function of a partition read ahead by the I/O scheduler. The stream may outlive the scan until its I/O
+// thread gets to close it, so may a shared result, they get copies.
+static MSOLAPSharedResult::OpenFunction ScheduledPartition(const MSOLAPBindData &bind_data,
+                                                           const MSOLAPGlobalState &global_state, idx_t partition) {
+    auto connection_string = bind_data.connection_string;
+    auto query = global_state.queries[partition];
+    auto cache_key = global_state.cache_keys.empty() ? std::string() : global_state.cache_keys[partition];
+    auto prefetch_chunks = global_state.prefetch_chunks;
+    return [connection_string, query, cache_key, prefetch_chunks]() -> unique_ptr<MSOLAPRowset> {
+        bool cache_checked = false;
+        std::chrono::steady_clock::time_point deadline;
+        auto open = [connection_string, query, cache_key, cache_checked, deadline](
+                        MSOLAPCancellation &cancellation,
+                        const std::function<void()> &retry) mutable -> unique_ptr<MSOLAPRowset> {
+            // A cached result takes no session, it is looked up once rather than on every retry
+            if (!cache_checked) {
+                cache_checked = true;
+                auto cached = OpenCachedPartition(cache_key);
+                if (cached) {
+                    return cached;
+                }
+                // Waits for a session as long as Acquire does, the sessions may be held by the query itself
+                deadline = std::chrono::steady_clock::now() +
+                           std::chrono::seconds(MSOLAPConnectionPool::ACQUIRE_TIMEOUT);
+            }
+            MSOLAPPooledSession session;
+            if (!MSOLAPConnectionPool::Get().TryAcquire(connection_string, retry, deadline, session)) {
+                // All sessions of the data source are in use, the stream waits for one without holding the thread
+                return nullptr;
+            }
+            try {
+                // A scan that ends early (LIMIT, an error, an interrupted query) cancels the query on the server
+                cancellation.SetSession(&*session);
+                auto rowset = ExecutePartition(*session, query, cache_key);
+                return make_uniq<MSOLAPSessionRowset>(std::move(session), std::move(rowset));
+            } catch (std::exception &) {
+                cancellation.SetSession(nullptr);
+                session.Invalidate();
+                throw;
+            }
+        };
+        return make_uniq<MSOLAPPrefetchRowset>(MSOLAPIOScheduler::Get(), std::move(open), prefetch_chunks);
+    };
+}
+
 static unique_ptr<GlobalTableFunctionState> MSOLAPInitGlobalState(ClientContext &context,
                                                               TableFunctionInitInput &input) {
-    // MSOLAP doesn't support parallel execution
-    return make_uniq<MSOLAPGlobalState>(1);
+    auto &bind_data = input.bind_data->Cast<MSOLAPBindData>();
+    // Every thread reads whole partitions on its own session, one at a time, so the scan never needs more sessions
+    // than the pool hands out for the data source
+    auto max_threads = bind_data.max_threads;
+    auto max_active = MSOLAPConnectionPool::Get().GetMaxActive();
+    if (max_active > 0) {
+        max_threads = MinValue<idx_t>(max_threads, max_active);
+    }
+    auto result = make_uniq<MSOLAPGlobalState>(max_threads);
+    result->column_ids = input.column_ids;
+    result->projected = CanProject(bind_data, input.column_ids);
+    // Built once DuckDB has pushed the filters it derives from the build side of a join into the scan, the
+    // scan is initialized after the build side is done
+    std::string filter_arguments;
+    auto predicate = TranslateFilters(bind_data, input.column_ids, input.filters, filter_arguments);
+    for (idx_t i = 0; i < bind_data.partitions; i++) {
+        result->queries.push_back(
+            BuildQuery(bind_data, input.column_ids, result->projected, predicate, filter_arguments, i));
+    }
+
+    // Rows expected from the statistics the optimizer already read, partitions completed otherwise
+    idx_t estimated_rows = 0;
+    if (bind_data.top_count == 0 && !input.filters) {
+        auto statistics = MSOLAPStatisticsCache::Get().GetStatistics(context, bind_data);
+        if (statistics) {
+            estimated_rows = statistics->row_count;
+        }
+    }
+    result->progress = make_shared_ptr<MSOLAPScanProgress>(
+        MSOLAPConnectionPool::MaskConnectionString(bind_data.connection_string), result->queries[0],
+        result->queries.size(), estimated_rows);
+    MSOLAPScanRegistry::Get().Register(result->progress);
+
+    Value prefetch_chunks;
+    result->prefetch_chunks = MSOLAPPrefetchRowset::DEFAULT_CHUNKS;
+    if (context.TryGetCurrentSetting("msolap_prefetch_chunks", prefetch_chunks)) {
+        result->prefetch_chunks = prefetch_chunks.GetValue<uint64_t>();
+    }
+
+    auto &cache = MSOLAPResultCache::Get();
+    if (cache.IsEnabled() && !MSOLAPResultCache::IsVolatile(bind_data.dax_query)) {
+        // Results are only reused while the model has not been refreshed, without a version they are not cached
+        std::string version;
+        try {
+            version = cache.GetModelVersion(bind_data.connection_string);
+        } catch (std::exception &) {
+            // The scan reports connection errors itself
+        }
+        MSOLAPSchemaCache::Get().SetModelVersion(bind_data.connection_string, version);
+        if (!version.empty()) {
+            for (auto &query : result->queries) {
+                result->cache_keys.push_back(MSOLAPResultCache::MakeKey(bind_data.connection_string, query, version));
+            }
+        }
+    }
+
+    // Scans of the same queries running at the same time read one result. Only results read ahead by the I/O
+    // scheduler are shared, a result read on a scan thread would end with the scan that started it.
+    Value share_scans;
+    bool shared = result->prefetch_chunks > 0;
+    if (shared && context.TryGetCurrentSetting("msolap_share_scans", share_scans)) {
+        shared = share_scans.GetValue<bool>();
+    }
+    if (shared) {
+        // The keys of the build side of a join pushed into the probe side make it a different query, the probe
+        // side of a self join reads the result of the build side instead while it is shared. The filters are
+        // evaluated on the result anyway, or only narrow down what is read. Not with TOPN, which takes the first
+        // rows after the filters.
+        auto &single_flight = MSOLAPSingleFlight::Get();
+        for (idx_t partition = 0; partition < result->queries.size(); partition++) {
+            unique_ptr<MSOLAPSharedRowset> rowset;
+            auto unfiltered_query = BuildQuery(bind_data, input.column_ids, result->projected, "", "", partition);
+            if (bind_data.top_count == 0 && unfiltered_query != result->queries[partition]) {
+                rowset = single_flight.TryJoin(context, bind_data.connection_string, unfiltered_query);
+            }
+            if (!rowset) {
+                auto open = ScheduledPartition(bind_data, *result, partition);
+                rowset = single_flight.Join(context, bind_data.connection_string, result->queries[partition], open);
+            }
+            // Kept until the query ends, the other side of a self join only starts once this scan is done
+            result->shared_results.push_back(rowset->GetResult());
+            result->shared_rowsets.push_back(std::move(rowset));
+        }
+    }
+    return std::move(result);
+}
+
+// Check the columns of a rowset just opened against the bound ones and set up reading it. Rowsets are never
+// trusted to have the bound types: the schema cache keeps the columns of a query for a while and the catalog only
+// knows the declared types of the model columns, and the rowset writes the types it reports into the vectors it
+// is given. Columns of other types are read as reported and cast, other columns fail the scan.
+static void PrepareRowset(ClientContext &context, const MSOLAPBindData &bind_data, MSOLAPGlobalState &global_state,
+                          MSOLAPLocalState &state) {
+    std::vector<std::string> names;
+    std::vector<LogicalType> types;
+    state.rowset->GetColumnInfo(names, types);
+    auto expected = global_state.projected ? global_state.column_ids.size() : bind_data.types.size();
+    if (types.size() != expected) {
+        // The model changed since the query was bound, it is described again next time
+        MSOLAPSchemaCache::Get().Invalidate(bind_data.connection_string, bind_data.dax_query);
+        throw std::runtime_error("The DAX query returned " + std::to_string(types.size()) + " columns, expected " +
+                                 std::to_string(expected));
+    }
+
+    state.direct = global_state.projected;
+    bool changed = false;
+    for (idx_t i = 0; i < types.size(); i++) {
+        auto column_id = global_state.projected ? global_state.column_ids[i] : i;
+        if (column_id >= bind_data.types.size()) {
+            // Row id, returned as NULL
+            state.direct = false;
+            continue;
+        }
+        // Projected columns are selected by reference, a renamed column fails the query on the server
+        if (!global_state.projected && names[i] != bind_data.dax_names[i]) {
+            MSOLAPSchemaCache::Get().Invalidate(bind_data.connection_string, bind_data.dax_query);
+            throw std::runtime_error("The DAX query returned the column \"" + names[i] + "\" where \"" +
+                                     bind_data.dax_names[i] + "\" was expected, the model changed since the query " +
+                                     "was bound");
+        }
+        if (types[i] != bind_data.types[column_id]) {
+            state.direct = false;
+            changed = true;
+        }
+    }
+    if (changed) {
+        // Bound with stale columns, the next bind asks the server again
+        MSOLAPSchemaCache::Get().Invalidate(bind_data.connection_string, bind_data.dax_query);
+    }
+    if (state.direct) {
+        return;
+    }
+    if (state.chunk.ColumnCount() == 0 || state.chunk.GetTypes() != vector<LogicalType>(types.begin(), types.end())) {
+        state.chunk.Destroy();
+        state.chunk.Initialize(Allocator::Get(context), vector<LogicalType>(types.begin(), types.end()));
+    }
+}
+
+// Execute the next unclaimed partition, on the I/O scheduler or on the session of the thread, returns false once
+// all are taken
+static bool StartNextPartition(ClientContext &context, const MSOLAPBindData &bind_data,
+                               MSOLAPGlobalState &global_state, MSOLAPLocalState &state) {
+    auto partition = global_state.next_partition++;
+    if (partition >= global_state.queries.size()) {
+        return false;
+    }
+    state.rowset_bytes = 0;
+    if (!global_state.shared_rowsets.empty()) {
+        state.rowset = std::move(global_state.shared_rowsets[partition]);
+    } else if (global_state.prefetch_chunks == 0) {
+        auto cache_key = global_state.cache_keys.empty() ? std::string() : global_state.cache_keys[partition];
+        state.rowset = OpenCachedPartition(cache_key);
+        if (!state.rowset) {
+            if (!state.session) {
+                // Taken on the first partition that is not cached, usually the session the bind just returned
+                state.session = MSOLAPConnectionPool::Get().Acquire(bind_data.connection_string);
+            }
+            state.rowset = ExecutePartition(*state.session, global_state.queries[partition], cache_key);
+        }
+    } else {
+        state.rowset = ScheduledPartition(bind_data, global_state, partition)();
+    }
+    PrepareRowset(context, bind_data, global_state, state);
+    return true;
+}
+
+// Conjunction of the pushed down filters over the output columns. The DAX predicate may keep more rows than the
+// filters (BLANK, case-insensitive text) or leave some out, so they are always evaluated on the result as well.
+static unique_ptr<Expression> CreateFilterExpression(const MSOLAPBindData &bind_data, TableFunctionInitInput &input) {
+    if (!input.filters) {
+        return nullptr;
+    }
+    auto conjunction = make_uniq<BoundConjunctionExpression>(ExpressionType::CONJUNCTION_AND);
+    for (auto &entry : input.filters->filters) {
+        auto &filter = *entry.second;
+        // Optional and dynamic filters only narrow down what is read, the plan does not depend on them
+        if (filter.filter_type == TableFilterType::OPTIONAL_FILTER ||
+            filter.filter_type == TableFilterType::DYNAMIC_FILTER) {
+            continue;
+        }
+        auto column_id = input.column_ids[entry.first];
+        if (column_id >= bind_data.types.size()) {
+            continue;
+        }
+        BoundReferenceExpression column(bind_data.types[column_id], entry.first);
+        conjunction->children.push_back(filter.ToExpression(column));
+    }
+    if (conjunction->children.empty()) {
+        return nullptr;
+    }
+    if (conjunction->children.size() == 1) {
+        return std::move(conjunction->children[0]);
+    }
+    return std::move(conjunction);
 }
 
 static unique_ptr<LocalTableFunctionState>
 MSOLAPInitLocalState(ExecutionContext &context, TableFunctionInitInput &input, GlobalTableFunctionState *global_state) {
-    MSOLAPConnection::InitializeCOM();
     auto &bind_data = input.bind_data->Cast<MSOLAPBindData>();
+    auto &gstate = global_state->Cast<MSOLAPGlobalState>();
     auto result = make_uniq<MSOLAPLocalState>();
-    
+    MSOLAPInterruptScope interrupt_scope(context.client);
+
     try {
-        // Connect to MSOLAP
-        result->connection = MSOLAPConnection::Connect(bind_data.connection_string);
-        
-        // Execute the DAX query
-        result->rowset = result->connection.ExecuteQuery(bind_data.dax_query);
-        
-        // Get the IAccessor interface
-        HRESULT hr = result->rowset->QueryInterface(IID_IAccessor, (void**)&result->accessor);
-        if (FAILED(hr)) {
-            throw std::runtime_error("Failed to get IAccessor: " + MSOLAPUtils::GetErrorMessage(hr));
-        }
-        
-        // Create bindings for all columns
-        DBORDINAL column_count = bind_data.names.size();
-        result->bindings = (DBBINDING*)CoTaskMemAlloc(column_count * sizeof(DBBINDING));
-        if (!result->bindings) {
-            throw std::runtime_error("Failed to allocate memory for bindings");
-        }
-
-        // Get column information using IColumnsInfo
-        IColumnsInfo* pIColumnsInfo = NULL;
-        hr = result->rowset->QueryInterface(IID_IColumnsInfo, (void**)&pIColumnsInfo);
-        if (FAILED(hr)) {
-            throw std::runtime_error("Failed to get IColumnsInfo: " + MSOLAPUtils::GetErrorMessage(hr));
-        }
-
-        // Get column information
-        DBORDINAL cColumns;
-        WCHAR* pStringsBuffer = NULL;
-        DBCOLUMNINFO* pColumnInfo = NULL;
-
-        hr = pIColumnsInfo->GetColumnInfo(&cColumns, &pColumnInfo, &pStringsBuffer);
-        if (FAILED(hr)) {
-            MSOLAPUtils::SafeRelease(&pIColumnsInfo);
-            throw std::runtime_error("Failed to get column info: " + MSOLAPUtils::GetErrorMessage(hr));
-        }
-        
-        // Set up bindings for all columns
-        DWORD dwOffset = 0;
-        for (DBORDINAL i = 0; i < column_count; i++) {
-            result->bindings[i].iOrdinal = pColumnInfo[i].iOrdinal; // 1-based ordinals
-            result->bindings[i].obValue = dwOffset + offsetof(ColumnData, var);
-            result->bindings[i].obLength = dwOffset + offsetof(ColumnData, dwLength);
-            result->bindings[i].obStatus = dwOffset + offsetof(ColumnData, dwStatus);
-            result->bindings[i].pTypeInfo = NULL;
-            result->bindings[i].pObject = NULL;
-            result->bindings[i].pBindExt = NULL;
-            result->bindings[i].cbMaxLen = sizeof(VARIANT);
-            result->bindings[i].dwFlags = 0;
-            result->bindings[i].eParamIO = DBPARAMIO_NOTPARAM;
-            result->bindings[i].dwPart = DBPART_VALUE | DBPART_LENGTH | DBPART_STATUS;
-            result->bindings[i].dwMemOwner = DBMEMOWNER_CLIENTOWNED;
-            result->bindings[i].wType = DBTYPE_VARIANT;
-            result->bindings[i].bPrecision = 0;
-            result->bindings[i].bScale = 0;
-            
-            // Increment offset to next structure
-            dwOffset += sizeof(ColumnData);
-        }
-
-        // Clean up
-        CoTaskMemFree(pColumnInfo);
-        CoTaskMemFree(pStringsBuffer);
-        MSOLAPUtils::SafeRelease(&pIColumnsInfo);
-
-        // Create the accessor
-        hr = result->accessor->CreateAccessor(
-            DBACCESSOR_ROWDATA,
-            column_count,
-            result->bindings,
-            dwOffset,
-            &result->haccessor,
-            NULL
-        );
-        
-        if (FAILED(hr)) {
-            throw std::runtime_error("Failed to create accessor: " + MSOLAPUtils::GetErrorMessage(hr));
-        }
-        
-        // Allocate buffer for row data
-        result->row_size = dwOffset;
-        result->row_data = new BYTE[result->row_size];
-        
-        result->done = false;
-        
+        for (auto column_id : gstate.column_ids) {
+            bool text =
+                column_id < bind_data.types.size() && bind_data.types[column_id].id() == LogicalTypeId::VARCHAR;
+            result->dictionaries.push_back(text ? make_uniq<MSOLAPStringDictionary>() : nullptr);
+        }
+
+        result->filter_expression = CreateFilterExpression(bind_data, input);
+        if (result->filter_expression) {
+            result->filter_executor = make_uniq<ExpressionExecutor>(context.client, *result->filter_expression);
+        }
+
+        // Execute the DAX query of the first partition
+        if (!StartNextPartition(context.client, bind_data, gstate, *result)) {
+            result->session.Release();
+            result->done = true;
+        }
+
+    } catch (InterruptException &) {
+        result->session.Invalidate();
+        throw;
     } catch (std::exception &e) {
+        result->session.Invalidate();
         throw std::runtime_error("MSOLAP scan initialization failed: " + string(e.what()));
     }
-    
+
     return std::move(result);
 }
 
-static void MSOLAPScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
-    auto &state = data.local_state->Cast<MSOLAPLocalState>();
-    auto &bind_data = data.bind_data->Cast<MSOLAPBindData>();
-    
-    if (state.done) {
-        return;
-    }
-    
-    // Process rows in batches
-    const DBROWCOUNT batch_size = STANDARD_VECTOR_SIZE;
-    HROW* pRows = new HROW[batch_size];
-    DBCOUNTITEM cRowsObtained = 0;
-    
-    HRESULT hr = state.rowset->GetNextRows(0, 0, batch_size, &cRowsObtained, &pRows);
-    if (FAILED(hr)) {
-        delete[] pRows;
-        throw std::runtime_error("Failed to get rows: " + MSOLAPUtils::GetErrorMessage(hr));
-    }
-    
-    if (cRowsObtained == 0) {
-        state.done = true;
-        delete[] pRows;
-        return;
+// Fetch the next rows of the current rowset into output, returns 0 once it is exhausted
+static idx_t FetchRowset(ClientContext &context, const MSOLAPBindData &bind_data, MSOLAPGlobalState &gstate,
+                         MSOLAPLocalState &state, DataChunk &output) {
+    if (state.direct) {
+        return state.rowset->Fetch(output);
     }
-    
-    // Prepare vectors for each column type
-    const idx_t col_count = output.ColumnCount();
-    std::vector<std::vector<Value>> column_values(col_count);
-    for (idx_t col = 0; col < col_count; col++) {
-        column_values[col].reserve(cRowsObtained);
-    }
-    
-    // Get data for all rows
-    for (DBCOUNTITEM i = 0; i < cRowsObtained; i++) {
-        // Clear the buffer before getting new data
-        memset(state.row_data, 0, state.row_size);
-        
-        // Get the row data
-        hr = state.rowset->GetData(pRows[i], state.haccessor, state.row_data);
-        if (FAILED(hr)) {
-            // On error, add NULL values for all columns
-            for (idx_t col = 0; col < col_count; col++) {
-                column_values[col].push_back(Value());
-            }
+    state.chunk.Reset();
+    auto count = state.rowset->Fetch(state.chunk);
+    for (idx_t i = 0; i < gstate.column_ids.size(); i++) {
+        auto column_id = gstate.column_ids[i];
+        if (column_id >= bind_data.types.size()) {
+            // Row id, not fetched
+            output.data[i].SetVectorType(VectorType::CONSTANT_VECTOR);
+            ConstantVector::SetNull(output.data[i], true);
             continue;
         }
-        
-        // Extract values for each column
-        for (idx_t col = 0; col < col_count; col++) {
-            // Get the COLUMNDATA structure for this column
-            ColumnData* pColData = (ColumnData*)(state.row_data + (col * sizeof(ColumnData)));
-            
-            if (pColData->dwStatus == DBSTATUS_S_OK) {
-                // Convert VARIANT to DuckDB value
-                Value val = MSOLAPUtils::ConvertVariantToValue(&(pColData->var));
-                column_values[col].push_back(val);
-                
-                // Clear variant to avoid memory leaks
-                VariantClear(&(pColData->var));
-            } else {
-                // Add NULL for NULL or error values
-                column_values[col].push_back(Value());
-            }
+        auto &source = state.chunk.data[gstate.projected ? i : column_id];
+        if (source.GetType() != output.data[i].GetType()) {
+            VectorOperations::Cast(context, source, output.data[i], count);
+        } else {
+            output.data[i].Reference(source);
         }
     }
-    
-    // Release the row handles
-    state.rowset->ReleaseRows(cRowsObtained, pRows, NULL, NULL, NULL);
-    delete[] pRows;
-    
-    // Now use bulk operations to populate the output vectors
-    for (idx_t col = 0; col < col_count; col++) {
-        auto &out_vec = output.data[col];
-        
-        // For each column, set all values at once
-        for (idx_t row = 0; row < column_values[col].size(); row++) {
-            out_vec.SetValue(row, column_values[col][row]);
+    output.SetCardinality(count);
+    return count;
+}
+
+// FetchRowset, keeping track of the progress of the scan
+static idx_t FetchRows(ClientContext &context, const MSOLAPBindData &bind_data, MSOLAPGlobalState &gstate,
+                       MSOLAPLocalState &state, DataChunk &output) {
+    auto count = FetchRowset(context, bind_data, gstate, state, output);
+    auto &progress = *gstate.progress;
+    progress.rows += count;
+    auto bytes = state.rowset->GetBytesRead();
+    progress.bytes += bytes - state.rowset_bytes;
+    state.rowset_bytes = bytes;
+    if (count == 0) {
+        progress.partitions_done++;
+    }
+    return count;
+}
+
+// Emit repeated strings as dictionary vectors, before the filters so filtered chunks stay dictionary vectors
+static void EncodeDictionaries(MSOLAPLocalState &state, DataChunk &output, idx_t count) {
+    for (idx_t i = 0; i < state.dictionaries.size(); i++) {
+        if (state.dictionaries[i]) {
+            state.dictionaries[i]->Encode(output.data[i], count);
         }
     }
-    
-    output.SetCardinality(cRowsObtained);
+}
+
+static void MSOLAPScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+    auto &bind_data = data.bind_data->Cast<MSOLAPBindData>();
+    auto &gstate = data.global_state->Cast<MSOLAPGlobalState>();
+    auto &state = data.local_state->Cast<MSOLAPLocalState>();
+    // Waits for the I/O threads stop when the query is interrupted
+    MSOLAPInterruptScope interrupt_scope(context);
+
+    while (!state.done) {
+        if (!state.rowset && !StartNextPartition(context, bind_data, gstate, state)) {
+            // Other scan threads may be waiting for a session
+            state.session.Release();
+            state.done = true;
+            return;
+        }
+        auto count = FetchRows(context, bind_data, gstate, state, output);
+        if (count == 0) {
+            // Partition exhausted, its rowset has to go before the session executes the next one
+            state.rowset.reset();
+            continue;
+        }
+        EncodeDictionaries(state, output, count);
+        if (!state.filter_executor) {
+            return;
+        }
+        auto selected = state.filter_executor->SelectExpression(output, state.filter_sel);
+        if (selected == count) {
+            return;
+        }
+        if (selected > 0) {
+            output.Slice(state.filter_sel, selected);
+            return;
+        }
+        // No row of this chunk passed the filters, read on
+        output.Reset();
+    }
 }
 
 static InsertionOrderPreservingMap<string> MSOLAPToString(TableFunctionToStringInput &input) {
     InsertionOrderPreservingMap<string> result;
     auto &bind_data = input.bind_data->Cast<MSOLAPBindData>();
-    
-    result["Connection"] = bind_data.connection_string;
+
+    result["Connection"] = MSOLAPConnectionPool::MaskConnectionString(bind_data.connection_string);
     result["Query"] = bind_data.dax_query;
-    
+    if (bind_data.partitions > 1) {
+        result["Partitions"] = std::to_string(bind_data.partitions);
+    }
+    if (bind_data.top_count > 0) {
+        result["Top"] = std::to_string(bind_data.top_count);
+    }
+
     return result;
 }
 
+// Row count of the model table, so joins with local tables build on the right side
+static unique_ptr<NodeStatistics> MSOLAPCardinality(ClientContext &context, const FunctionData *bind_data_p) {
+    auto &bind_data = bind_data_p->Cast<MSOLAPBindData>();
+    auto statistics = MSOLAPStatisticsCache::Get().GetStatistics(context, bind_data);
+    if (!statistics) {
+        if (bind_data.top_count > 0) {
+            return make_uniq<NodeStatistics>(bind_data.top_count, bind_data.top_count);
+        }
+        return nullptr;
+    }
+    auto count = statistics->row_count;
+    if (bind_data.top_count > 0) {
+        count = MinValue<idx_t>(count, bind_data.top_count);
+    }
+    return make_uniq<NodeStatistics>(count, count);
+}
+
+static unique_ptr<BaseStatistics> MSOLAPStatistics(ClientContext &context, const FunctionData *bind_data_p,
+                                                   column_t column_id) {
+    auto &bind_data = bind_data_p->Cast<MSOLAPBindData>();
+    if (column_id >= bind_data.dax_names.size()) {
+        return nullptr;
+    }
+    auto statistics = MSOLAPStatisticsCache::Get().GetStatistics(context, bind_data);
+    if (!statistics) {
+        return nullptr;
+    }
+    auto entry = statistics->columns.find(bind_data.dax_names[column_id]);
+    if (entry == statistics->columns.end()) {
+        return nullptr;
+    }
+    auto result = BaseStatistics::CreateUnknown(bind_data.types[column_id]);
+    result.SetDistinctCount(entry->second.distinct_count);
+    return result.ToUnique();
+}
+
+static double MSOLAPProgress(ClientContext &context, const FunctionData *bind_data,
+                             const GlobalTableFunctionState *global_state) {
+    return global_state->Cast<MSOLAPGlobalState>().progress->GetPercentage();
+}
+
 MSOLAPScanFunction::MSOLAPScanFunction()
     : TableFunction("msolap", {LogicalType::VARCHAR, LogicalType::VARCHAR}, MSOLAPScan, MSOLAPBind,
                     MSOLAPInitGlobalState, MSOLAPInitLocalState) {
     to_string = MSOLAPToString;
+    cardinality = MSOLAPCardinality;
+    statistics = MSOLAPStatistics;
+    table_scan_progress = MSOLAPProgress;
+    projection_pushdown = true;
+    filter_pushdown = true;
+    named_parameters["partitions"] = LogicalType::UBIGINT;
+    named_parameters["threads"] = LogicalType::UBIGINT;
+    named_parameters["partition_column"] = LogicalType::VARCHAR;
+    named_parameters["params"] = LogicalType::ANY;
 }
 
-} // namespace duckdb
\ No newline at end of file
+} // namespace duckdb
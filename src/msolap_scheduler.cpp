@@ -0,0 +1,320 @@
+#include "msolap_scheduler.hpp"
+#include "duckdb/main/client_context.hpp"
+#include <chrono>
+#ifdef _WIN32
+#include "msolap_connection.hpp"
+#endif
+
+namespace duckdb {
+
+// Context of the query the current thread scans for, null outside a scan
+static thread_local ClientContext *interrupt_context = nullptr;
+
+MSOLAPInterruptScope::MSOLAPInterruptScope(ClientContext &context) : previous(interrupt_context) {
+    interrupt_context = &context;
+}
+
+MSOLAPInterruptScope::~MSOLAPInterruptScope() {
+    interrupt_context = previous;
+}
+
+void MSOLAPInterruptScope::Check() {
+    if (interrupt_context && interrupt_context->interrupted) {
+        throw InterruptException();
+    }
+}
+
+void MSOLAPInterruptScope::Wait(std::unique_lock<std::mutex> &guard, std::condition_variable &changed) {
+    changed.wait_for(guard, std::chrono::milliseconds(WAIT_POLL_INTERVAL));
+    Check();
+}
+
+void MSOLAPCancellation::Cancel() {
+    // Under the lock, the session is not released while it is being cancelled
+    std::lock_guard<std::mutex> guard(lock);
+    cancelled = true;
+    if (session) {
+        session->Cancel();
+    }
+}
+
+void MSOLAPCancellation::SetSession(MSOLAPSession *session_p) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (session_p && cancelled) {
+        throw std::runtime_error("The query was cancelled");
+    }
+    session = session_p;
+}
+
+MSOLAPChunkQueue::MSOLAPChunkQueue(idx_t capacity) : chunks(capacity), pushed(0), popped(0) {
+}
+
+void MSOLAPChunkQueue::Initialize(Allocator &allocator, const vector<LogicalType> &types) {
+    for (auto &chunk : chunks) {
+        chunk = make_uniq<DataChunk>();
+        chunk->Initialize(allocator, types);
+    }
+}
+
+DataChunk *MSOLAPChunkQueue::Back() {
+    auto count = pushed.load(std::memory_order_relaxed);
+    // Acquire: the consumer is done with a chunk it popped
+    if (count - popped.load(std::memory_order_acquire) >= chunks.size()) {
+        return nullptr;
+    }
+    return chunks[count % chunks.size()].get();
+}
+
+void MSOLAPChunkQueue::Push() {
+    // Release: the chunk is filled before the consumer sees it
+    pushed.store(pushed.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+DataChunk *MSOLAPChunkQueue::Front() {
+    auto count = popped.load(std::memory_order_relaxed);
+    if (count == pushed.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    return chunks[count % chunks.size()].get();
+}
+
+void MSOLAPChunkQueue::Pop() {
+    popped.store(popped.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+MSOLAPIOStream::MSOLAPIOStream(OpenFunction open_p, idx_t chunk_count)
+    // One more than read ahead, for the chunk the scan is processing
+    : open(std::move(open_p)), queue(chunk_count + 1), holding(false), waiting(false), opened(false),
+      finished(false), cancelled(false), done(false), bytes_read(0), scheduler(nullptr), parked(false) {
+}
+
+void MSOLAPIOStream::GetColumnInfo(std::vector<std::string> &names_p, std::vector<LogicalType> &types_p) {
+    {
+        auto retry_at = std::chrono::steady_clock::now() + std::chrono::milliseconds(OPEN_RETRY_INTERVAL);
+        std::unique_lock<std::mutex> guard(lock);
+        while (!opened && !finished) {
+            MSOLAPInterruptScope::Wait(guard, changed);
+            if (std::chrono::steady_clock::now() >= retry_at) {
+                retry_at += std::chrono::milliseconds(OPEN_RETRY_INTERVAL);
+                if (parked && waiting) {
+                    // Open has not called back yet, it is called again in case it gives up
+                    waiting = false;
+                    Resume();
+                }
+            }
+        }
+    }
+    if (!opened) {
+        std::rethrow_exception(error);
+    }
+    names_p = names;
+    types_p = types;
+}
+
+DataChunk *MSOLAPIOStream::Next() {
+    if (holding) {
+        // The chunk returned by the previous call is no longer used
+        queue.Pop();
+        holding = false;
+        Resume();
+    }
+    auto chunk = queue.Front();
+    if (!chunk) {
+        std::unique_lock<std::mutex> guard(lock);
+        while (!chunk) {
+            if (finished) {
+                // Chunks are pushed before the stream finishes, they are all taken before the end is reported
+                chunk = queue.Front();
+                break;
+            }
+            MSOLAPInterruptScope::Wait(guard, changed);
+            chunk = queue.Front();
+        }
+    }
+    if (!chunk) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return nullptr;
+    }
+    holding = true;
+    return chunk;
+}
+
+void MSOLAPIOStream::Cancel() {
+    cancelled = true;
+    // An I/O thread may be waiting for the server to execute the query or send the next rows
+    cancellation.Cancel();
+    Resume();
+}
+
+void MSOLAPIOStream::Resume() {
+    if (parked.exchange(false)) {
+        scheduler->Resume(shared_from_this());
+    }
+}
+
+void MSOLAPIOStream::Notify() {
+    {
+        // The scan checks the stream under the lock before it sleeps
+        std::lock_guard<std::mutex> guard(lock);
+    }
+    changed.notify_all();
+}
+
+bool MSOLAPIOStream::IsRunnable() {
+    return !done && (cancelled || (!opened && !waiting) || queue.Back() != nullptr);
+}
+
+void MSOLAPIOStream::Step() {
+    if (cancelled) {
+        // Closed here rather than by the scan, which does not wait for a cancelled query to fail
+        cancellation.SetSession(nullptr);
+        source.reset();
+        done = true;
+        return;
+    }
+    try {
+        if (!opened) {
+            // Set first, open may call back right away from another thread
+            waiting = true;
+            weak_ptr<MSOLAPIOStream> weak = shared_from_this();
+            source = open(cancellation, [weak]() {
+                auto stream = weak.lock();
+                if (stream) {
+                    stream->waiting = false;
+                    stream->Resume();
+                }
+            });
+            if (!source) {
+                // Parked without holding the thread until open calls back
+                return;
+            }
+            waiting = false;
+            source->GetColumnInfo(names, types);
+            queue.Initialize(Allocator::DefaultAllocator(), vector<LogicalType>(types.begin(), types.end()));
+            opened = true;
+            Notify();
+            return;
+        }
+        // Only called while the queue has room, the scan does not touch the chunk until it is pushed
+        auto chunk = queue.Back();
+        chunk->Reset();
+        auto count = source->Fetch(*chunk);
+        bytes_read = source->GetBytesRead();
+        if (count > 0) {
+            queue.Push();
+            Notify();
+            return;
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+    // Exhausted or failed, the session goes back to the pool while the scan takes the remaining chunks
+    cancellation.SetSession(nullptr);
+    source.reset();
+    finished = true;
+    done = true;
+    Notify();
+}
+
+MSOLAPIOScheduler &MSOLAPIOScheduler::Get() {
+    // Never destroyed, like the connection pool
+    static auto scheduler = new MSOLAPIOScheduler(DEFAULT_THREADS);
+    return *scheduler;
+}
+
+MSOLAPIOScheduler::MSOLAPIOScheduler(idx_t thread_count)
+    : idle(0), thread_count(MaxValue<idx_t>(thread_count, 1)), stopped(false) {
+}
+
+MSOLAPIOScheduler::~MSOLAPIOScheduler() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopped = true;
+    }
+    wakeup.notify_all();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+void MSOLAPIOScheduler::SetThreadCount(idx_t thread_count_p) {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        thread_count = MaxValue<idx_t>(thread_count_p, 1);
+    }
+    // Threads that became usable pick up waiting streams
+    wakeup.notify_all();
+}
+
+void MSOLAPIOScheduler::Schedule(const shared_ptr<MSOLAPIOStream> &stream) {
+    std::lock_guard<std::mutex> guard(lock);
+    stream->scheduler = this;
+    Enqueue(stream);
+}
+
+void MSOLAPIOScheduler::Enqueue(shared_ptr<MSOLAPIOStream> stream) {
+    runnable.push_back(std::move(stream));
+    // Threads are started once the ones running are all busy
+    if (idle < runnable.size() && threads.size() < thread_count) {
+        threads.emplace_back(&MSOLAPIOScheduler::Work, this, threads.size());
+        return;
+    }
+    if (threads.size() > thread_count) {
+        // The thread woken up could be one beyond the thread count, which leaves the stream to the others
+        wakeup.notify_all();
+    } else {
+        wakeup.notify_one();
+    }
+}
+
+void MSOLAPIOScheduler::Resume(const shared_ptr<MSOLAPIOStream> &stream) {
+    std::lock_guard<std::mutex> guard(lock);
+    Enqueue(stream);
+}
+
+void MSOLAPIOScheduler::Work(idx_t index) {
+#ifdef _WIN32
+    try {
+        // Sessions execute their queries and are read on these threads
+        MSOLAPConnection::InitializeCOM();
+    } catch (std::exception &) {
+        // Reported by the sessions opened on the thread
+    }
+#endif
+    while (true) {
+        shared_ptr<MSOLAPIOStream> stream;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            idle++;
+            wakeup.wait(guard, [&]() { return stopped || (!runnable.empty() && index < thread_count); });
+            idle--;
+            if (stopped) {
+                return;
+            }
+            stream = std::move(runnable.front());
+            runnable.pop_front();
+        }
+
+        // Only this thread runs the stream until it is queued again
+        stream->Step();
+
+        std::lock_guard<std::mutex> guard(lock);
+        if (stream->IsDone()) {
+            continue;
+        }
+        if (stream->IsRunnable()) {
+            // Behind the other streams
+            Enqueue(std::move(stream));
+        } else {
+            // The queue is full until the scan takes a chunk, which resumes the stream. It may have already.
+            stream->parked = true;
+            if (stream->IsRunnable() && stream->parked.exchange(false)) {
+                Enqueue(std::move(stream));
+            }
+        }
+    }
+}
+
+} // namespace duckdb
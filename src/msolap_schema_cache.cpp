@@ -0,0 +1,133 @@
+#include "msolap_schema_cache.hpp"
+#include "msolap_cache.hpp"
+#include "msolap_pool.hpp"
+
+namespace duckdb {
+
+MSOLAPSchemaCache::MSOLAPSchemaCache() : ttl(DEFAULT_TTL) {
+}
+
+MSOLAPSchemaCache &MSOLAPSchemaCache::Get() {
+    // Never destroyed, like the connection pool
+    static auto cache = new MSOLAPSchemaCache();
+    return *cache;
+}
+
+void MSOLAPSchemaCache::SetTTL(idx_t seconds) {
+    std::lock_guard<std::mutex> guard(lock);
+    ttl = std::chrono::seconds(seconds);
+    if (seconds == 0) {
+        sources.clear();
+    }
+}
+
+void MSOLAPSchemaCache::DescribeQuery(const std::string &connection_string, const std::string &dax_query,
+                                      std::vector<std::string> &names, std::vector<LogicalType> &types) {
+    auto key = MSOLAPConnectionPool::NormalizeConnectionString(connection_string);
+    bool check_version;
+    {
+        // A cached schema is served from memory until it expires, without asking the server anything
+        std::lock_guard<std::mutex> guard(lock);
+        auto now = std::chrono::steady_clock::now();
+        auto source = sources.find(key);
+        if (ttl.count() > 0 && source != sources.end()) {
+            auto entry = source->second.queries.find(dax_query);
+            if (entry != source->second.queries.end() && now - entry->second.loaded < ttl) {
+                names = entry->second.names;
+                types = entry->second.types;
+                return;
+            }
+        }
+        // A server that did not tell the version is not asked again until the TTL has passed
+        check_version = ttl.count() > 0 && (source == sources.end() || !source->second.version_unknown ||
+                                            now - source->second.version_checked >= ttl);
+    }
+    if (check_version) {
+        // The schema is about to be described anyway, a refresh since the version was last seen drops the other
+        // cached columns of the data source
+        std::string version;
+        try {
+            version = MSOLAPResultCache::Get().GetModelVersion(connection_string);
+        } catch (std::exception &) {
+            // Describing the query reports connection errors itself
+        }
+        if (version.empty()) {
+            std::lock_guard<std::mutex> guard(lock);
+            auto &source = sources[key];
+            source.version_unknown = true;
+            source.version_checked = std::chrono::steady_clock::now();
+        } else {
+            SetModelVersion(connection_string, version);
+        }
+    }
+
+    // Described outside the lock, binding other queries does not wait for the server
+    {
+        auto session = MSOLAPConnectionPool::Get().Acquire(connection_string);
+        session->DescribeQuery(dax_query, names, types);
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    if (ttl.count() == 0 || names.empty()) {
+        return;
+    }
+    auto &source = sources[key];
+    EvictEntries(source);
+    auto &entry = source.queries[dax_query];
+    entry.names = names;
+    entry.types = types;
+    entry.loaded = std::chrono::steady_clock::now();
+}
+
+void MSOLAPSchemaCache::EvictEntries(DataSource &source) {
+    if (source.queries.size() < MAX_ENTRIES) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    for (auto entry = source.queries.begin(); entry != source.queries.end();) {
+        if (now - entry->second.loaded >= ttl) {
+            entry = source.queries.erase(entry);
+        } else {
+            entry++;
+        }
+    }
+    // Still full of fresh entries: any one will do, it is described again when needed
+    if (source.queries.size() >= MAX_ENTRIES) {
+        source.queries.erase(source.queries.begin());
+    }
+}
+
+void MSOLAPSchemaCache::Invalidate(const std::string &connection_string, const std::string &dax_query) {
+    auto key = MSOLAPConnectionPool::NormalizeConnectionString(connection_string);
+    std::lock_guard<std::mutex> guard(lock);
+    auto source = sources.find(key);
+    if (source != sources.end()) {
+        source->second.queries.erase(dax_query);
+    }
+}
+
+void MSOLAPSchemaCache::Invalidate(const std::string &connection_string) {
+    auto key = MSOLAPConnectionPool::NormalizeConnectionString(connection_string);
+    std::lock_guard<std::mutex> guard(lock);
+    auto source = sources.find(key);
+    if (source != sources.end()) {
+        source->second.queries.clear();
+    }
+}
+
+void MSOLAPSchemaCache::SetModelVersion(const std::string &connection_string, const std::string &model_version) {
+    if (model_version.empty()) {
+        return;
+    }
+    auto key = MSOLAPConnectionPool::NormalizeConnectionString(connection_string);
+    std::lock_guard<std::mutex> guard(lock);
+    auto &source = sources[key];
+    if (!source.model_version.empty() && source.model_version != model_version) {
+        // Columns may have been added, removed or changed type by the refresh
+        source.queries.clear();
+    }
+    source.model_version = model_version;
+    source.version_unknown = false;
+}
+
+} // namespace duckdb
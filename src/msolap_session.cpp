@@ -0,0 +1,25 @@
+#include "msolap_session.hpp"
+#include "msolap_utils.hpp"
+#include "msolap_xmla.hpp"
+#ifdef _WIN32
+#include "msolap_connection.hpp"
+#endif
+#include <stdexcept>
+
+namespace duckdb {
+
+unique_ptr<MSOLAPSession> MSOLAPSession::Open(const std::string &connection_string) {
+    auto properties = MSOLAPUtils::ParseConnectionString(connection_string);
+    auto data_source = properties.find("Data Source");
+    if (data_source != properties.end() && MSOLAPUtils::IsHTTPDataSource(data_source->second)) {
+        return make_uniq<XMLAConnection>(XMLAConnection::Connect(connection_string));
+    }
+#ifdef _WIN32
+    return make_uniq<MSOLAPConnection>(MSOLAPConnection::Connect(connection_string));
+#else
+    throw std::runtime_error("The MSOLAP OLE DB provider is only available on Windows, use an XMLA HTTP endpoint "
+                             "(\"Data Source=http://server/olap/msmdpump.dll\") on this platform");
+#endif
+}
+
+} // namespace duckdb
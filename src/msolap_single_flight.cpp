@@ -0,0 +1,393 @@
+#include "msolap_single_flight.hpp"
+#include "msolap_pool.hpp"
+#include "msolap_scheduler.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/serializer/binary_deserializer.hpp"
+#include "duckdb/common/serializer/binary_serializer.hpp"
+#include "duckdb/common/serializer/memory_stream.hpp"
+#include "duckdb/common/types/uuid.hpp"
+#include "duckdb/main/config.hpp"
+
+namespace duckdb {
+
+MSOLAPSharedResult::MSOLAPSharedResult(ClientContext &context, OpenFunction open_p)
+    : owner(&context), open(std::move(open_p)), opened(false), reading(false), finished(false), joinable(true),
+      spool_start(0), bytes_read(0), spill_directory(DBConfig::GetConfig(context).options.temporary_directory),
+      fs(FileSystem::CreateLocal()), spill_start(0), spill_size(0), spill_io(0), spilled_chunks(0) {
+}
+
+MSOLAPSharedResult::~MSOLAPSharedResult() {
+    CloseSpill();
+}
+
+bool MSOLAPSharedResult::Subscribe(ClientContext &context, idx_t &subscriber) {
+    std::lock_guard<std::mutex> guard(lock);
+    // A complete result is only reused within the query that read it, other queries evaluate it again
+    if (!joinable || (finished && &context != owner)) {
+        return false;
+    }
+    subscriber = cursors.size();
+    cursors.push_back(0);
+    return true;
+}
+
+void MSOLAPSharedResult::Unsubscribe(idx_t subscriber) {
+    std::lock_guard<std::mutex> guard(lock);
+    cursors[subscriber] = RELEASED;
+    Trim();
+}
+
+bool MSOLAPSharedResult::GetColumnInfo(idx_t subscriber, std::vector<std::string> &names_p,
+                                       std::vector<LogicalType> &types_p) {
+    std::unique_lock<std::mutex> guard(lock);
+    while (!opened) {
+        if (cursors[subscriber] == RELEASED) {
+            return false;
+        }
+        if (finished) {
+            std::rethrow_exception(error);
+        }
+        if (reading) {
+            MSOLAPInterruptScope::Wait(guard, changed);
+        } else {
+            ReadNext(guard);
+        }
+    }
+    names_p = names;
+    types_p = types;
+    return true;
+}
+
+idx_t MSOLAPSharedResult::Fetch(idx_t subscriber, DataChunk &output, std::vector<data_t> &buffer, bool &detached) {
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        auto &cursor = cursors[subscriber];
+        if (cursor == RELEASED) {
+            detached = true;
+            return 0;
+        }
+        if (cursor < spool_start) {
+            ReadSpilled(guard, cursor, buffer, output);
+            cursors[subscriber]++;
+            Trim();
+            return output.size();
+        }
+        if (cursor < spool_start + spool.size()) {
+            // Spooled chunks are never written again, the output shares their buffers
+            output.Reference(*spool[cursor - spool_start]);
+            cursor++;
+            Trim();
+            return output.size();
+        }
+        if (finished) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+            output.SetCardinality(0);
+            return 0;
+        }
+        if (reading) {
+            MSOLAPInterruptScope::Wait(guard, changed);
+        } else {
+            if (spool.size() >= MAX_SPOOL_CHUNKS && !MakeRoom()) {
+                // The scans furthest behind still need every chunk, they read the oldest one from disk
+                Spill(guard);
+            }
+            ReadNext(guard);
+        }
+    }
+}
+
+void MSOLAPSharedResult::ReadNext(std::unique_lock<std::mutex> &guard) {
+    reading = true;
+    bool was_opened = opened;
+    guard.unlock();
+
+    shared_ptr<DataChunk> chunk;
+    std::exception_ptr read_error;
+    try {
+        if (!was_opened) {
+            source = open();
+            source->GetColumnInfo(names, types);
+        } else {
+            // The source may reuse its output buffers, the spool keeps a copy
+            DataChunk read;
+            read.Initialize(Allocator::DefaultAllocator(), vector<LogicalType>(types.begin(), types.end()));
+            if (source->Fetch(read) > 0) {
+                chunk = make_shared_ptr<DataChunk>();
+                chunk->Initialize(Allocator::DefaultAllocator(), vector<LogicalType>(types.begin(), types.end()));
+                read.Copy(*chunk);
+            }
+            bytes_read = source->GetBytesRead();
+        }
+    } catch (...) {
+        read_error = std::current_exception();
+    }
+    if (read_error || (was_opened && !chunk)) {
+        // Exhausted or failed, the session goes back to the pool while the scans take the spooled chunks
+        source.reset();
+    }
+
+    guard.lock();
+    reading = false;
+    if (read_error) {
+        error = read_error;
+        finished = true;
+    } else if (!was_opened) {
+        opened = true;
+    } else if (!chunk) {
+        finished = true;
+    } else {
+        spool.push_back(std::move(chunk));
+        Trim();
+    }
+    changed.notify_all();
+}
+
+bool MSOLAPSharedResult::MakeRoom() {
+    if (joinable) {
+        // Scans that have not read anything yet would keep the whole result in memory, they run the query
+        // themselves. The ones reading already go on with the spool.
+        joinable = false;
+        for (auto &cursor : cursors) {
+            if (cursor == 0) {
+                cursor = RELEASED;
+            }
+        }
+        changed.notify_all();
+        Trim();
+    }
+    return spool.size() < MAX_SPOOL_CHUNKS;
+}
+
+bool MSOLAPSharedResult::Spill(std::unique_lock<std::mutex> &guard) {
+    if (spill_directory.empty()) {
+        return false;
+    }
+    // The chunk stays in the spool until it is written, the scans behind go on reading it from there. No other
+    // scan reads the source or spills meanwhile, so the end of the file is this chunk's.
+    auto chunk = spool.front();
+    auto chunk_number = spool_start;
+    auto file = spill_file.get();
+    auto offset = spill_size;
+    reading = true;
+    spill_io++;
+    guard.unlock();
+
+    unique_ptr<FileHandle> created;
+    std::string created_path;
+    idx_t size = 0;
+    bool written = false;
+    try {
+        if (!file) {
+            if (!fs->DirectoryExists(spill_directory)) {
+                fs->CreateDirectory(spill_directory);
+            }
+            created_path = fs->JoinPath(spill_directory,
+                                        "msolap_spool_" + UUID::ToString(UUID::GenerateRandomUUID()) + ".tmp");
+            created = fs->OpenFile(created_path, FileFlags::FILE_FLAGS_READ | FileFlags::FILE_FLAGS_WRITE |
+                                                     FileFlags::FILE_FLAGS_FILE_CREATE_NEW);
+            file = created.get();
+            offset = 0;
+        }
+        MemoryStream stream;
+        BinarySerializer serializer(stream);
+        serializer.Begin();
+        chunk->Serialize(serializer);
+        serializer.End();
+        file->Write(stream.GetData(), stream.GetPosition(), offset);
+        size = stream.GetPosition();
+        written = true;
+    } catch (std::exception &) {
+        // The chunk stays in memory, the spool grows beyond its limit rather than hold up or fail a scan
+    }
+
+    guard.lock();
+    reading = false;
+    spill_io--;
+    if (created) {
+        spill_file = std::move(created);
+        spill_path = created_path;
+    }
+    if (written) {
+        spill_size = offset + size;
+    }
+    // Unless every scan went past the chunk meanwhile
+    bool spilled_chunk = written && spool_start == chunk_number;
+    if (spilled_chunk) {
+        if (spilled.empty()) {
+            spill_start = chunk_number;
+        }
+        spilled.push_back(SpilledChunk {offset, size});
+        spool.pop_front();
+        spool_start++;
+        spilled_chunks++;
+    }
+    // Removes the file if no scan needs it anymore
+    Trim();
+    return spilled_chunk;
+}
+
+void MSOLAPSharedResult::ReadSpilled(std::unique_lock<std::mutex> &guard, idx_t chunk, std::vector<data_t> &buffer,
+                                     DataChunk &output) {
+    // The file stays open until the chunk is read
+    auto spilled_chunk = spilled[chunk - spill_start];
+    auto file = spill_file.get();
+    spill_io++;
+    guard.unlock();
+
+    DataChunk read;
+    std::exception_ptr read_error;
+    try {
+        buffer.resize(spilled_chunk.size);
+        file->Read(buffer.data(), spilled_chunk.size, spilled_chunk.offset);
+        MemoryStream stream(buffer.data(), spilled_chunk.size);
+        BinaryDeserializer deserializer(stream);
+        deserializer.Begin();
+        read.Deserialize(deserializer);
+        deserializer.End();
+    } catch (...) {
+        read_error = std::current_exception();
+    }
+
+    guard.lock();
+    spill_io--;
+    if (read_error) {
+        std::rethrow_exception(read_error);
+    }
+    // The output shares the buffers of the chunk read
+    output.Reference(read);
+}
+
+void MSOLAPSharedResult::CloseSpill() {
+    spilled.clear();
+    if (!spill_file || spill_io > 0) {
+        // The last scan reading or writing the file removes it
+        return;
+    }
+    spill_file.reset();
+    spill_size = 0;
+    try {
+        fs->RemoveFile(spill_path);
+    } catch (std::exception &) {
+        // Removed in the meantime
+    }
+}
+
+void MSOLAPSharedResult::Trim() {
+    if (joinable) {
+        return;
+    }
+    idx_t first_needed = spool_start + spool.size();
+    for (auto cursor : cursors) {
+        if (cursor != RELEASED) {
+            first_needed = MinValue<idx_t>(first_needed, cursor);
+        }
+    }
+    if (first_needed < spool_start) {
+        // A scan still reads the spill file, which only ever grows
+        return;
+    }
+    CloseSpill();
+    while (spool_start < first_needed) {
+        spool.pop_front();
+        spool_start++;
+    }
+}
+
+MSOLAPSharedRowset::MSOLAPSharedRowset(shared_ptr<MSOLAPSharedResult> result_p, idx_t subscriber)
+    : result(std::move(result_p)), subscriber(subscriber) {
+}
+
+MSOLAPSharedRowset::~MSOLAPSharedRowset() {
+    if (result) {
+        // The query is closed once no scan reads it anymore
+        result->Unsubscribe(subscriber);
+    }
+}
+
+void MSOLAPSharedRowset::Detach() {
+    own = result->GetOpenFunction()();
+    result.reset();
+}
+
+void MSOLAPSharedRowset::GetColumnInfo(std::vector<std::string> &names, std::vector<LogicalType> &types) {
+    if (!own && !result->GetColumnInfo(subscriber, names, types)) {
+        Detach();
+    }
+    if (own) {
+        own->GetColumnInfo(names, types);
+    }
+}
+
+idx_t MSOLAPSharedRowset::Fetch(DataChunk &output) {
+    if (!own) {
+        bool detached = false;
+        auto count = result->Fetch(subscriber, output, spill_buffer, detached);
+        if (!detached) {
+            return count;
+        }
+        Detach();
+    }
+    return own->Fetch(output);
+}
+
+idx_t MSOLAPSharedRowset::GetBytesRead() const {
+    return own ? own->GetBytesRead() : result->GetBytesRead();
+}
+
+MSOLAPSingleFlight &MSOLAPSingleFlight::Get() {
+    // Never destroyed, like the connection pool
+    static auto single_flight = new MSOLAPSingleFlight();
+    return *single_flight;
+}
+
+std::string MSOLAPSingleFlight::MakeKey(const std::string &connection_string, const std::string &dax_query) {
+    return MSOLAPConnectionPool::NormalizeConnectionString(connection_string) + "\n" + dax_query;
+}
+
+unique_ptr<MSOLAPSharedRowset> MSOLAPSingleFlight::TryJoinLocked(ClientContext &context, const std::string &key) {
+    for (auto entry = results.begin(); entry != results.end();) {
+        if (entry->second.expired()) {
+            entry = results.erase(entry);
+        } else {
+            entry++;
+        }
+    }
+
+    idx_t subscriber;
+    auto entry = results.find(key);
+    if (entry != results.end()) {
+        auto result = entry->second.lock();
+        if (result && result->Subscribe(context, subscriber)) {
+            return make_uniq<MSOLAPSharedRowset>(std::move(result), subscriber);
+        }
+    }
+    return nullptr;
+}
+
+unique_ptr<MSOLAPSharedRowset> MSOLAPSingleFlight::TryJoin(ClientContext &context,
+                                                           const std::string &connection_string,
+                                                           const std::string &dax_query) {
+    std::lock_guard<std::mutex> guard(lock);
+    return TryJoinLocked(context, MakeKey(connection_string, dax_query));
+}
+
+unique_ptr<MSOLAPSharedRowset> MSOLAPSingleFlight::Join(ClientContext &context, const std::string &connection_string,
+                                                        const std::string &dax_query,
+                                                        MSOLAPSharedResult::OpenFunction open) {
+    auto key = MakeKey(connection_string, dax_query);
+    std::lock_guard<std::mutex> guard(lock);
+    auto rowset = TryJoinLocked(context, key);
+    if (rowset) {
+        return rowset;
+    }
+    // Nobody reads the query at the moment, or too far already
+    idx_t subscriber;
+    auto result = make_shared_ptr<MSOLAPSharedResult>(context, std::move(open));
+    result->Subscribe(context, subscriber);
+    results[key] = result;
+    return make_uniq<MSOLAPSharedRowset>(std::move(result), subscriber);
+}
+
+} // namespace duckdb
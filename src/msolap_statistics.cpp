@@ -0,0 +1,165 @@
+#include "msolap_statistics.hpp"
+#include "msolap_pool.hpp"
+#include "msolap_dax.hpp"
+
+namespace duckdb {
+
+MSOLAPStatisticsCache::MSOLAPStatisticsCache() {
+}
+
+MSOLAPStatisticsCache &MSOLAPStatisticsCache::Get() {
+    // Never destroyed, like the connection pool
+    static auto cache = new MSOLAPStatisticsCache();
+    return *cache;
+}
+
+shared_ptr<MSOLAPTableStatistics> MSOLAPStatisticsCache::GetStatistics(ClientContext &context,
+                                                                      const MSOLAPBindData &bind_data) {
+    if (!bind_data.rewritable) {
+        return nullptr;
+    }
+    Value setting;
+    auto ttl = std::chrono::seconds(DEFAULT_TTL);
+    if (context.TryGetCurrentSetting("msolap_statistics_ttl", setting)) {
+        ttl = std::chrono::seconds(setting.GetValue<uint64_t>());
+    }
+    if (ttl.count() == 0) {
+        return nullptr;
+    }
+    bool with_distinct_counts = DEFAULT_DISTINCT_COUNTS;
+    if (context.TryGetCurrentSetting("msolap_statistics_distinct_counts", setting)) {
+        with_distinct_counts = setting.GetValue<bool>();
+    }
+    auto model_table = bind_data.query.GetModelTable();
+    if (model_table.empty()) {
+        return nullptr;
+    }
+    auto key = MSOLAPConnectionPool::NormalizeConnectionString(bind_data.connection_string) + "\n" +
+               StringUtil::Lower(model_table);
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        auto entry = entries.find(key);
+        // Without distinct counts the row count is all there is. A table the server had no statistics for is not
+        // asked for again until the TTL has passed either.
+        if (entry != entries.end() && std::chrono::steady_clock::now() - entry->second.loaded < ttl &&
+            (entry->second.distinct_counts || !with_distinct_counts)) {
+            return entry->second.statistics;
+        }
+    }
+
+    // Read outside the lock, planning of other queries does not wait for the server
+    CacheEntry entry;
+    entry.statistics = Load(bind_data.connection_string, model_table, with_distinct_counts);
+    entry.distinct_counts = with_distinct_counts;
+    entry.loaded = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> guard(lock);
+    entries[key] = entry;
+    return entry.statistics;
+}
+
+// Rows of a DMV query, the columns in the order they are selected
+static std::vector<std::vector<Value>> QueryRows(MSOLAPSession &session, const std::string &query) {
+    auto rowset = session.ExecuteQuery(query);
+    std::vector<std::string> names;
+    std::vector<LogicalType> types;
+    rowset->GetColumnInfo(names, types);
+    DataChunk chunk;
+    chunk.Initialize(Allocator::DefaultAllocator(), types);
+    std::vector<std::vector<Value>> rows;
+    while (rowset->Fetch(chunk) > 0) {
+        for (idx_t row = 0; row < chunk.size(); row++) {
+            std::vector<Value> values;
+            for (idx_t col = 0; col < chunk.ColumnCount(); col++) {
+                values.push_back(chunk.GetValue(col, row));
+            }
+            rows.push_back(std::move(values));
+        }
+        chunk.Reset();
+    }
+    return rows;
+}
+
+static idx_t GetCount(const Value &value) {
+    return value.IsNull() ? 0 : value.DefaultCastAs(LogicalType::UBIGINT).GetValue<uint64_t>();
+}
+
+shared_ptr<MSOLAPTableStatistics> MSOLAPStatisticsCache::LoadStorage(MSOLAPSession &session,
+                                                                    const std::string &model_table,
+                                                                    bool distinct_counts) {
+    // The storage tables of a model table are the table itself, holding its row count, an attribute hierarchy per
+    // column (H$Table (1)$Column (2)) and relationship and user hierarchy tables (R$..., U$...)
+    auto restriction = " WHERE [DIMENSION_NAME] = '" + StringUtil::Replace(model_table, "'", "''") + "'";
+    auto tables = QueryRows(session, "SELECT [DIMENSION_NAME], [TABLE_ID], [ROWS_COUNT] "
+                                     "FROM $SYSTEM.DISCOVER_STORAGE_TABLES" + restriction);
+    auto result = make_shared_ptr<MSOLAPTableStatistics>();
+    bool found = false;
+    case_insensitive_map_t<idx_t> hierarchies;
+    for (auto &row : tables) {
+        if (row.size() != 3 || !StringUtil::CIEquals(row[0].ToString(), model_table)) {
+            continue;
+        }
+        auto table_id = row[1].ToString();
+        if (StringUtil::StartsWith(table_id, "H$")) {
+            hierarchies[table_id] = GetCount(row[2]);
+        } else if (table_id.size() < 2 || table_id[1] != '$') {
+            result->row_count = MaxValue<idx_t>(result->row_count, GetCount(row[2]));
+            found = true;
+        }
+    }
+    if (!found) {
+        return nullptr;
+    }
+    if (!distinct_counts) {
+        return result;
+    }
+
+    auto columns = QueryRows(session, "SELECT [DIMENSION_NAME], [ATTRIBUTE_NAME], [TABLE_ID], [COLUMN_ID], "
+                                      "[COLUMN_TYPE] FROM $SYSTEM.DISCOVER_STORAGE_TABLE_COLUMNS" + restriction);
+    for (auto &row : columns) {
+        if (row.size() != 5 || !StringUtil::CIEquals(row[0].ToString(), model_table) ||
+            row[4].ToString() != "BASIC_DATA") {
+            continue;
+        }
+        auto hierarchy = hierarchies.find("H$" + row[2].ToString() + "$" + row[3].ToString());
+        if (hierarchy == hierarchies.end()) {
+            continue;
+        }
+        // The attribute hierarchy holds three rows more than the dictionary of the column has values
+        MSOLAPColumnStatistics column;
+        column.distinct_count = hierarchy->second > 3 ? hierarchy->second - 3 : 0;
+        result->columns[model_table + "[" + row[1].ToString() + "]"] = std::move(column);
+    }
+    return result;
+}
+
+shared_ptr<MSOLAPTableStatistics> MSOLAPStatisticsCache::LoadRowCount(MSOLAPSession &session,
+                                                                     const std::string &model_table) {
+    auto rows = QueryRows(session, "EVALUATE ROW(\"Rows\", COUNTROWS(" + MSOLAPDax::QuoteTable(model_table) + "))");
+    if (rows.empty() || rows[0].empty()) {
+        return nullptr;
+    }
+    auto result = make_shared_ptr<MSOLAPTableStatistics>();
+    result->row_count = GetCount(rows[0][0]);
+    return result;
+}
+
+shared_ptr<MSOLAPTableStatistics> MSOLAPStatisticsCache::Load(const std::string &connection_string,
+                                                             const std::string &model_table, bool distinct_counts) {
+    try {
+        auto session = MSOLAPConnectionPool::Get().Acquire(connection_string);
+        try {
+            auto result = LoadStorage(*session, model_table, distinct_counts);
+            if (result) {
+                return result;
+            }
+        } catch (std::exception &) {
+            // The storage DMVs need administrator rights on the database
+        }
+        return LoadRowCount(*session, model_table);
+    } catch (std::exception &) {
+        // Statistics are optional, the query is planned without them
+        return nullptr;
+    }
+}
+
+} // namespace duckdb
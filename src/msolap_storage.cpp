@@ -0,0 +1,71 @@
+#include "msolap_storage.hpp"
+#include "msolap_catalog.hpp"
+#include "duckdb/main/attached_database.hpp"
+#include "duckdb/parser/parsed_data/attach_info.hpp"
+#include <stdexcept>
+
+namespace duckdb {
+
+static unique_ptr<Catalog> MSOLAPAttach(optional_ptr<StorageExtensionInfo> storage_info, ClientContext &context,
+                                        AttachedDatabase &db, const string &name, AttachInfo &info,
+                                        AttachOptions &options) {
+    // The path is the connection string, the tables are read when the catalog is initialized
+    return make_uniq<MSOLAPCatalog>(db, info.path);
+}
+
+static unique_ptr<TransactionManager> MSOLAPCreateTransactionManager(optional_ptr<StorageExtensionInfo> storage_info,
+                                                                     AttachedDatabase &db, Catalog &catalog) {
+    return make_uniq<MSOLAPTransactionManager>(db);
+}
+
+MSOLAPStorageExtension::MSOLAPStorageExtension() {
+    attach = MSOLAPAttach;
+    create_transaction_manager = MSOLAPCreateTransactionManager;
+}
+
+struct MSOLAPCatalogRefreshBindData : public TableFunctionData {
+    std::string catalog_name;
+};
+
+struct MSOLAPCatalogRefreshState : public GlobalTableFunctionState {
+    idx_t tables = 0;
+    bool done = false;
+};
+
+static unique_ptr<FunctionData> MSOLAPCatalogRefreshBind(ClientContext &context, TableFunctionBindInput &input,
+                                                         vector<LogicalType> &return_types, vector<string> &names) {
+    auto result = make_uniq<MSOLAPCatalogRefreshBindData>();
+    result->catalog_name = input.inputs[0].GetValue<string>();
+    names = {"tables"};
+    return_types = {LogicalType::BIGINT};
+    return std::move(result);
+}
+
+static unique_ptr<GlobalTableFunctionState> MSOLAPCatalogRefreshInit(ClientContext &context,
+                                                                     TableFunctionInitInput &input) {
+    auto &bind_data = input.bind_data->Cast<MSOLAPCatalogRefreshBindData>();
+    auto &catalog = Catalog::GetCatalog(context, bind_data.catalog_name);
+    if (catalog.GetCatalogType() != "msolap") {
+        throw std::runtime_error("\"" + bind_data.catalog_name + "\" is not an attached msolap model");
+    }
+    auto result = make_uniq<MSOLAPCatalogRefreshState>();
+    result->tables = catalog.Cast<MSOLAPCatalog>().Refresh();
+    return std::move(result);
+}
+
+static void MSOLAPCatalogRefreshScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+    auto &state = data.global_state->Cast<MSOLAPCatalogRefreshState>();
+    if (state.done) {
+        return;
+    }
+    output.SetValue(0, 0, Value::BIGINT(int64_t(state.tables)));
+    output.SetCardinality(1);
+    state.done = true;
+}
+
+MSOLAPCatalogRefreshFunction::MSOLAPCatalogRefreshFunction()
+    : TableFunction("msolap_catalog_refresh", {LogicalType::VARCHAR}, MSOLAPCatalogRefreshScan,
+                    MSOLAPCatalogRefreshBind, MSOLAPCatalogRefreshInit) {
+}
+
+} // namespace duckdb
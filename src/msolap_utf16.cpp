@@ -0,0 +1,187 @@
+#include "msolap_utf16.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define MSOLAP_UTF16_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON) && defined(__BYTE_ORDER__) &&                                      \
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define MSOLAP_UTF16_NEON
+#include <arm_neon.h>
+#endif
+#if defined(_MSC_VER) && defined(MSOLAP_UTF16_SSE2)
+#include <intrin.h>
+#endif
+
+namespace duckdb {
+
+static constexpr uint32_t REPLACEMENT_CHARACTER = 0xFFFD;
+// Code units checked at once by the fast paths (16 bytes)
+static constexpr idx_t BLOCK_UNITS = 8;
+
+#if defined(MSOLAP_UTF16_SSE2) || defined(MSOLAP_UTF16_NEON)
+static inline idx_t CountTrailingZeros(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return index;
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+#endif
+
+// Narrow a block of code units to 8 bytes, returns how many leading units are ASCII. Bytes after those are
+// garbage, the caller overwrites them: the units they came from still have to be written as at least one byte each.
+static inline idx_t NarrowASCIIPrefix(const uint8_t *data, char *target) {
+#if defined(MSOLAP_UTF16_SSE2)
+    auto units = _mm_loadu_si128((const __m128i *)data);
+    _mm_storel_epi64((__m128i *)target, _mm_packus_epi16(units, units));
+    auto ascii = _mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16((short)0xFF80)), _mm_setzero_si128());
+    auto other = ~(uint32_t)_mm_movemask_epi8(ascii) & 0xFFFF;
+    return other == 0 ? BLOCK_UNITS : CountTrailingZeros(other) / 2;
+#elif defined(MSOLAP_UTF16_NEON)
+    auto units = vreinterpretq_u16_u8(vld1q_u8(data));
+    vst1_u8((uint8_t *)target, vqmovn_u16(units));
+    auto ascii = vmovn_u16(vceqq_u16(vandq_u16(units, vdupq_n_u16(0xFF80)), vdupq_n_u16(0)));
+    auto other = ~vget_lane_u64(vreinterpret_u64_u8(ascii), 0);
+    return other == 0 ? BLOCK_UNITS : CountTrailingZeros(other) / 8;
+#else
+    for (idx_t i = 0; i < BLOCK_UNITS; i++) {
+        if (data[2 * i + 1] != 0 || data[2 * i] >= 0x80) {
+            return i;
+        }
+        target[i] = (char)data[2 * i];
+    }
+    return BLOCK_UNITS;
+#endif
+}
+
+// UTF-8 length of a block without surrogates: one byte per unit, one more from 0x80 and another from 0x800.
+// Returns false if the block has surrogates, their pairing is left to the scalar path.
+static inline bool GetBlockUTF8Length(const uint8_t *data, idx_t &result) {
+#if defined(MSOLAP_UTF16_SSE2)
+    auto units = _mm_loadu_si128((const __m128i *)data);
+    auto surrogates =
+        _mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16((short)0xF800)), _mm_set1_epi16((short)0xD800));
+    if (_mm_movemask_epi8(surrogates) != 0) {
+        return false;
+    }
+    // SSE2 only compares signed, flip the sign bit to compare unsigned
+    auto biased = _mm_xor_si128(units, _mm_set1_epi16((short)0x8000));
+    auto two_bytes = _mm_cmpgt_epi16(biased, _mm_set1_epi16((short)(0x7F ^ 0x8000)));
+    auto three_bytes = _mm_cmpgt_epi16(biased, _mm_set1_epi16((short)(0x7FF ^ 0x8000)));
+    // Each matching unit sets two mask bits, the sum has them once
+    auto extra = _mm_sub_epi16(_mm_setzero_si128(), _mm_add_epi16(two_bytes, three_bytes));
+    extra = _mm_add_epi16(extra, _mm_srli_si128(extra, 8));
+    extra = _mm_add_epi16(extra, _mm_srli_si128(extra, 4));
+    extra = _mm_add_epi16(extra, _mm_srli_si128(extra, 2));
+    result = BLOCK_UNITS + (idx_t)(_mm_cvtsi128_si32(extra) & 0xFFFF);
+    return true;
+#elif defined(MSOLAP_UTF16_NEON)
+    auto units = vreinterpretq_u16_u8(vld1q_u8(data));
+    if (vmaxvq_u16(vceqq_u16(vandq_u16(units, vdupq_n_u16(0xF800)), vdupq_n_u16(0xD800))) != 0) {
+        return false;
+    }
+    auto two_bytes = vshrq_n_u16(vcgtq_u16(units, vdupq_n_u16(0x7F)), 15);
+    auto three_bytes = vshrq_n_u16(vcgtq_u16(units, vdupq_n_u16(0x7FF)), 15);
+    result = BLOCK_UNITS + vaddvq_u16(vaddq_u16(two_bytes, three_bytes));
+    return true;
+#else
+    result = BLOCK_UNITS;
+    for (idx_t i = 0; i < BLOCK_UNITS; i++) {
+        uint32_t unit = data[2 * i] | (data[2 * i + 1] << 8);
+        if ((unit & 0xF800) == 0xD800) {
+            return false;
+        }
+        result += (unit >= 0x80) + (unit >= 0x800);
+    }
+    return true;
+#endif
+}
+
+// Decode the code point at unit i, returns the number of units it takes (2 for a surrogate pair)
+static inline idx_t DecodeCodePoint(const uint8_t *data, idx_t length, idx_t i, uint32_t &code_point) {
+    uint32_t unit = data[2 * i] | (data[2 * i + 1] << 8);
+    if (unit < 0xD800 || unit > 0xDFFF) {
+        code_point = unit;
+        return 1;
+    }
+    if (unit <= 0xDBFF && i + 1 < length) {
+        uint32_t low = data[2 * i + 2] | (data[2 * i + 3] << 8);
+        if (low >= 0xDC00 && low <= 0xDFFF) {
+            code_point = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+            return 2;
+        }
+    }
+    code_point = REPLACEMENT_CHARACTER;
+    return 1;
+}
+
+static inline idx_t GetEncodedLength(uint32_t code_point) {
+    return code_point < 0x80 ? 1 : code_point < 0x800 ? 2 : code_point < 0x10000 ? 3 : 4;
+}
+
+static inline idx_t EncodeCodePoint(uint32_t code_point, char *target) {
+    if (code_point < 0x80) {
+        target[0] = (char)code_point;
+        return 1;
+    } else if (code_point < 0x800) {
+        target[0] = (char)(0xC0 | (code_point >> 6));
+        target[1] = (char)(0x80 | (code_point & 0x3F));
+        return 2;
+    } else if (code_point < 0x10000) {
+        target[0] = (char)(0xE0 | (code_point >> 12));
+        target[1] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+        target[2] = (char)(0x80 | (code_point & 0x3F));
+        return 3;
+    } else {
+        target[0] = (char)(0xF0 | (code_point >> 18));
+        target[1] = (char)(0x80 | ((code_point >> 12) & 0x3F));
+        target[2] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+        target[3] = (char)(0x80 | (code_point & 0x3F));
+        return 4;
+    }
+}
+
+idx_t MSOLAPUTF16::GetUTF8Length(const uint8_t *data, idx_t length) {
+    idx_t result = 0;
+    idx_t i = 0;
+    while (i < length) {
+        idx_t block_length;
+        if (i + BLOCK_UNITS <= length && GetBlockUTF8Length(data + 2 * i, block_length)) {
+            result += block_length;
+            i += BLOCK_UNITS;
+            continue;
+        }
+        // Blocks with surrogates are measured one code point at a time
+        auto block_end = i + BLOCK_UNITS;
+        while (i < length && i < block_end) {
+            uint32_t code_point;
+            i += DecodeCodePoint(data, length, i, code_point);
+            result += GetEncodedLength(code_point);
+        }
+    }
+    return result;
+}
+
+idx_t MSOLAPUTF16::ToUTF8(const uint8_t *data, idx_t length, char *target) {
+    auto out = target;
+    idx_t i = 0;
+    while (i < length) {
+        if (i + BLOCK_UNITS <= length) {
+            auto ascii = NarrowASCIIPrefix(data + 2 * i, out);
+            out += ascii;
+            i += ascii;
+            if (ascii == BLOCK_UNITS) {
+                continue;
+            }
+        }
+        // The code point that stopped the fast path, or the tail of the string
+        uint32_t code_point;
+        i += DecodeCodePoint(data, length, i, code_point);
+        out += EncodeCodePoint(code_point, out);
+    }
+    return out - target;
+}
+
+} // namespace duckdb
@@ -1,122 +1,187 @@
 #include "msolap_utils.hpp"
+#include "msolap_conversion.hpp"
+#include "duckdb/common/types/decimal.hpp"
+#include "msolap_utf16.hpp"
 
 namespace duckdb {
 
-std::string MSOLAPUtils::SanitizeColumnName(const std::wstring &name) {
-    std::wstring sanitized = name;
+std::string MSOLAPUtils::SanitizeColumnName(const std::string &name) {
+    std::string sanitized = name;
     for (size_t i = 0; i < sanitized.size(); i++) {
-        if (sanitized[i] == L'[' || sanitized[i] == L']') {
-            sanitized[i] = L'_';
+        if (sanitized[i] == '[' || sanitized[i] == ']') {
+            sanitized[i] = '_';
         }
     }
-    
-    // Convert the entire string to UTF-8 properly
-    return WindowsUtil::UnicodeToUTF8(sanitized.c_str());
+    return sanitized;
 }
 
-Value MSOLAPUtils::ConvertVariantToValue(VARIANT* pVar) {
-    if (!pVar) {
-        return Value();
-    }
-    
-    switch (pVar->vt) {
-    case VT_NULL:
-    case VT_EMPTY:
-        return Value();
-    case VT_I2:
-        return Value::SMALLINT(pVar->iVal);
-    case VT_I4:
-        return Value::INTEGER(pVar->lVal);
-    case VT_I8:
-        return Value::BIGINT(pVar->llVal);
-    case VT_R4:
-        return Value::FLOAT(pVar->fltVal);
-    case VT_R8:
-        return Value::DOUBLE(pVar->dblVal);
-    case VT_BOOL:
-        return Value::BOOLEAN(pVar->boolVal != 0);
-    case VT_BSTR:
-        if (pVar->bstrVal) {
-            // Convert wide string to UTF8
-            std::wstring wstr(pVar->bstrVal);
-            std::string utf8_str;
-            try {
-                utf8_str = WindowsUtil::UnicodeToUTF8(wstr.c_str());
-            } catch (...) {
-                // Fallback to direct conversion on error
-                utf8_str = std::string(wstr.begin(), wstr.end());
+case_insensitive_map_t<std::string> MSOLAPUtils::ParseConnectionString(const std::string &connection_string) {
+    // Format expected: "Data Source=localhost:61324;Catalog=0ec50266-bdf5-4582-bc8c-82584866bcb7". As in OLE DB
+    // connection strings, values containing ';' are enclosed in double or single quotes, a quote inside them is
+    // doubled: Password="a;b""c" is a;b"c.
+    case_insensitive_map_t<std::string> properties;
+    auto &text = connection_string;
+    idx_t i = 0;
+    while (i < text.size()) {
+        auto separator = text.find_first_of("=;", i);
+        if (separator == std::string::npos) {
+            break;
+        }
+        if (text[separator] == ';') {
+            // No value
+            i = separator + 1;
+            continue;
+        }
+        std::string key = text.substr(i, separator - i);
+        StringUtil::Trim(key);
+        i = separator + 1;
+        while (i < text.size() && StringUtil::CharacterIsSpace(text[i])) {
+            i++;
+        }
+        std::string value;
+        if (i < text.size() && (text[i] == '"' || text[i] == '\'')) {
+            auto quote = text[i++];
+            while (true) {
+                if (i >= text.size()) {
+                    throw std::runtime_error("Unterminated quoted value of \"" + key + "\" in the connection string");
+                }
+                if (text[i] == quote) {
+                    if (i + 1 < text.size() && text[i + 1] == quote) {
+                        value += quote;
+                        i += 2;
+                        continue;
+                    }
+                    i++;
+                    break;
+                }
+                value += text[i++];
             }
-            return Value(utf8_str);
+            // Up to the next property
+            auto end = text.find(';', i);
+            i = end == std::string::npos ? text.size() : end + 1;
         } else {
-            return Value("");
+            auto end = text.find(';', i);
+            if (end == std::string::npos) {
+                end = text.size();
+            }
+            value = text.substr(i, end - i);
+            StringUtil::Trim(value);
+            i = end + 1;
         }
-    case VT_DATE: {
-        date_t date_val = date_t(0); // Initialize with epoch
-        try {
-            // Convert OLE automation date to DuckDB date
-            time_t epoch_seconds = (time_t)((pVar->date - 25569) * 86400); // 25569 is days between 1899-12-30 and 1970-01-01
-            date_val = Date::EpochToDate(epoch_seconds);
-        } catch (...) {
-            // Return default date on error
+        if (!key.empty()) {
+            properties[key] = value;
         }
-        return Value::DATE(date_val);
     }
-    case VT_CY: {
-        // Currency is a 64-bit integer scaled by 10,000
-        int64_t scaled_value = ((int64_t)pVar->cyVal.Hi) << 32 | pVar->cyVal.Lo;
-        double value = scaled_value / 10000.0;
-        return Value::DOUBLE(value);
+    return properties;
+}
+
+bool MSOLAPUtils::IsHTTPDataSource(const std::string &data_source) {
+    return StringUtil::StartsWith(StringUtil::Lower(data_source), "http://") ||
+           StringUtil::StartsWith(StringUtil::Lower(data_source), "https://");
+}
+
+LogicalType MSOLAPUtils::GetLogicalTypeFromXSDType(const std::string &type) {
+    auto sep = type.find(':');
+    auto local_type = sep == std::string::npos ? type : type.substr(sep + 1);
+    if (local_type == "boolean") {
+        return LogicalType::BOOLEAN;
+    } else if (local_type == "byte") {
+        return LogicalType::TINYINT;
+    } else if (local_type == "short") {
+        return LogicalType::SMALLINT;
+    } else if (local_type == "int") {
+        return LogicalType::INTEGER;
+    } else if (local_type == "long" || local_type == "integer") {
+        return LogicalType::BIGINT;
+    } else if (local_type == "unsignedByte") {
+        return LogicalType::UTINYINT;
+    } else if (local_type == "unsignedShort") {
+        return LogicalType::USMALLINT;
+    } else if (local_type == "unsignedInt") {
+        return LogicalType::UINTEGER;
+    } else if (local_type == "unsignedLong") {
+        return LogicalType::UBIGINT;
+    } else if (local_type == "float") {
+        return LogicalType::FLOAT;
+    } else if (local_type == "double") {
+        return LogicalType::DOUBLE;
+    } else if (local_type == "decimal") {
+        // Currency (fixed decimal) columns
+        return MSOLAPConversion::GetCurrencyType();
+    } else if (local_type == "dateTime") {
+        return LogicalType::TIMESTAMP;
+    } else if (local_type == "date") {
+        return LogicalType::DATE;
+    } else if (local_type == "time") {
+        return LogicalType::TIME;
+    } else {
+        return LogicalType::VARCHAR;
     }
-    default:
-        // For types we can't handle well, convert to string
-        try {
-            VARIANT varStr;
-            VariantInit(&varStr);
-            if (SUCCEEDED(VariantChangeType(&varStr, pVar, 0, VT_BSTR))) {
-                std::wstring wstr(varStr.bstrVal ? varStr.bstrVal : L"");
-                std::string str;
-                try {
-                    str = WindowsUtil::UnicodeToUTF8(wstr.c_str());
-                } catch (...) {
-                    str = std::string(wstr.begin(), wstr.end());
-                }
-                VariantClear(&varStr);
-                return Value(str);
-            }
-            VariantClear(&varStr);
-        } catch (...) {
-            // Fallback to empty string on conversion error
-        }
-        return Value("");
+}
+
+void MSOLAPUtils::AppendUTF8(uint32_t code_point, std::string &target) {
+    if (code_point < 0x80) {
+        target += (char)code_point;
+    } else if (code_point < 0x800) {
+        target += (char)(0xC0 | (code_point >> 6));
+        target += (char)(0x80 | (code_point & 0x3F));
+    } else if (code_point < 0x10000) {
+        target += (char)(0xE0 | (code_point >> 12));
+        target += (char)(0x80 | ((code_point >> 6) & 0x3F));
+        target += (char)(0x80 | (code_point & 0x3F));
+    } else {
+        target += (char)(0xF0 | (code_point >> 18));
+        target += (char)(0x80 | ((code_point >> 12) & 0x3F));
+        target += (char)(0x80 | ((code_point >> 6) & 0x3F));
+        target += (char)(0x80 | (code_point & 0x3F));
     }
 }
 
-LogicalType MSOLAPUtils::GetLogicalTypeFromDBTYPE(DBTYPE type) {
+void MSOLAPUtils::AppendUTF16(const uint8_t *data, idx_t length, std::string &target) {
+    auto offset = target.size();
+    target.resize(offset + MSOLAPUTF16::GetUTF8Length(data, length));
+    MSOLAPUTF16::ToUTF8(data, length, &target[offset]);
+}
+
+#ifdef _WIN32
+
+LogicalType MSOLAPUtils::GetLogicalTypeFromDBTYPE(DBTYPE type, BYTE precision, BYTE scale) {
     switch (type) {
     case DBTYPE_BOOL:
         return LogicalType::BOOLEAN;
     case DBTYPE_I1:
-    case DBTYPE_UI1:
         return LogicalType::TINYINT;
     case DBTYPE_I2:
-    case DBTYPE_UI2:
         return LogicalType::SMALLINT;
     case DBTYPE_I4:
-    case DBTYPE_UI4:
         return LogicalType::INTEGER;
     case DBTYPE_I8:
-    case DBTYPE_UI8:
         return LogicalType::BIGINT;
+    case DBTYPE_UI1:
+        return LogicalType::UTINYINT;
+    case DBTYPE_UI2:
+        return LogicalType::USMALLINT;
+    case DBTYPE_UI4:
+        return LogicalType::UINTEGER;
+    case DBTYPE_UI8:
+        return LogicalType::UBIGINT;
     case DBTYPE_R4:
         return LogicalType::FLOAT;
     case DBTYPE_R8:
+        return LogicalType::DOUBLE;
+    case DBTYPE_CY:
+        return MSOLAPConversion::GetCurrencyType();
     case DBTYPE_DECIMAL:
     case DBTYPE_NUMERIC:
-    case DBTYPE_CY:
+        // The declared precision and scale, providers that do not report them get a double
+        if (precision >= 1 && precision <= Decimal::MAX_WIDTH_DECIMAL && scale <= precision) {
+            return LogicalType::DECIMAL(precision, scale);
+        }
         return LogicalType::DOUBLE;
-    case DBTYPE_DATE:
     case DBTYPE_DBDATE:
         return LogicalType::DATE;
+    case DBTYPE_DATE:
+        // OLE automation dates carry the time of day
     case DBTYPE_DBTIME:
     case DBTYPE_DBTIMESTAMP:
         return LogicalType::TIMESTAMP;
@@ -147,5 +212,6 @@ std::string MSOLAPUtils::GetErrorMessage(HRESULT hr) {
     #endif
 }
 
+#endif // _WIN32
 
 } // namespace duckdb
\ No newline at end of file
@@ -0,0 +1,374 @@
+#include "msolap_xml_reader.hpp"
+#include "msolap_utils.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <algorithm>
+
+namespace duckdb {
+
+static bool IsXMLWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static bool IsNameTerminator(char c) {
+    return IsXMLWhitespace(c) || c == '=' || c == '>' || c == '/' || c == '?';
+}
+
+static constexpr idx_t XML_READ_SIZE = 64 * 1024;
+
+XMLAttribute &MSOLAPXMLReader::AddAttribute() {
+    if (attribute_count == attributes.size()) {
+        attributes.emplace_back();
+    }
+    return attributes[attribute_count++];
+}
+
+MSOLAPTextXMLReader::MSOLAPTextXMLReader(MSOLAPInputStream &stream_p)
+    : stream(stream_p), buffer(new char[XML_READ_SIZE * 2]), buffer_capacity(XML_READ_SIZE * 2), buffer_end(0),
+      pos(0), eof(false), pending_end(false) {
+}
+
+bool MSOLAPTextXMLReader::Fill() {
+    if (eof) {
+        return false;
+    }
+    if (buffer_end + XML_READ_SIZE > buffer_capacity) {
+        // A single tag or text node spans more than the buffer, grow it
+        auto new_capacity = MaxValue<idx_t>(buffer_capacity * 2, buffer_end + XML_READ_SIZE);
+        auto new_buffer = std::unique_ptr<char[]>(new char[new_capacity]);
+        memcpy(new_buffer.get(), buffer.get(), buffer_end);
+        buffer = std::move(new_buffer);
+        buffer_capacity = new_capacity;
+    }
+    auto count = stream.Read(buffer.get() + buffer_end, XML_READ_SIZE);
+    if (count == 0) {
+        eof = true;
+        return false;
+    }
+    buffer_end += count;
+    return true;
+}
+
+bool MSOLAPTextXMLReader::Ensure(idx_t count) {
+    while (buffer_end - pos < count) {
+        if (!Fill()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+idx_t MSOLAPTextXMLReader::Find(const char *needle, idx_t offset) {
+    auto needle_length = strlen(needle);
+    while (true) {
+        auto begin = buffer.get() + offset;
+        auto end = buffer.get() + buffer_end;
+        auto found = std::search(begin, end, needle, needle + needle_length);
+        if (found != end) {
+            return found - buffer.get();
+        }
+        // Keep a possible partial match at the end of the buffer in the next search
+        offset = MaxValue<idx_t>(offset, buffer_end >= needle_length ? buffer_end - needle_length + 1 : 0);
+        if (!Fill()) {
+            return DConstants::INVALID_INDEX;
+        }
+    }
+}
+
+bool MSOLAPTextXMLReader::StartsWith(const char *prefix) {
+    auto length = strlen(prefix);
+    return Ensure(length) && memcmp(buffer.get() + pos, prefix, length) == 0;
+}
+
+void MSOLAPTextXMLReader::SkipWhitespace() {
+    while (Ensure(1) && IsXMLWhitespace(buffer[pos])) {
+        pos++;
+    }
+}
+
+void MSOLAPTextXMLReader::SkipUntil(const char *terminator) {
+    auto found = Find(terminator, pos);
+    if (found == DConstants::INVALID_INDEX) {
+        throw std::runtime_error("Unexpected end of XMLA response");
+    }
+    pos = found + strlen(terminator);
+}
+
+void MSOLAPTextXMLReader::ParseName(std::string &target) {
+    auto start = pos;
+    idx_t local_start = pos;
+    while (Ensure(1) && !IsNameTerminator(buffer[pos])) {
+        if (buffer[pos] == ':') {
+            // Strip the namespace prefix
+            local_start = pos + 1;
+        }
+        pos++;
+    }
+    if (pos == start) {
+        throw std::runtime_error("Malformed XMLA response");
+    }
+    target.assign(buffer.get() + local_start, pos - local_start);
+}
+
+void MSOLAPTextXMLReader::ParseStartElement() {
+    // pos is just after '<'
+    ParseName(name);
+    ClearAttributes();
+    while (true) {
+        SkipWhitespace();
+        if (!Ensure(1)) {
+            throw std::runtime_error("Unexpected end of XMLA response");
+        }
+        char c = buffer[pos];
+        if (c == '>') {
+            pos++;
+            return;
+        }
+        if (c == '/') {
+            // Empty element, report the matching end element on the next call
+            SkipUntil(">");
+            pending_end = true;
+            return;
+        }
+        auto &attribute = AddAttribute();
+        ParseName(attribute.name);
+        SkipWhitespace();
+        if (!Ensure(1) || buffer[pos] != '=') {
+            throw std::runtime_error("Malformed attribute in XMLA response");
+        }
+        pos++;
+        SkipWhitespace();
+        if (!Ensure(1) || (buffer[pos] != '"' && buffer[pos] != '\'')) {
+            throw std::runtime_error("Malformed attribute in XMLA response");
+        }
+        char quote[2] = {buffer[pos++], '\0'};
+        auto end = Find(quote, pos);
+        if (end == DConstants::INVALID_INDEX) {
+            throw std::runtime_error("Unexpected end of XMLA response");
+        }
+        attribute.value.clear();
+        DecodeEntities(buffer.get() + pos, end - pos, attribute.value);
+        pos = end + 1;
+    }
+}
+
+void MSOLAPTextXMLReader::ParseEndElement() {
+    // pos is just after "</"
+    ParseName(name);
+    SkipUntil(">");
+}
+
+XMLNodeType MSOLAPTextXMLReader::Next() {
+    if (pending_end) {
+        pending_end = false;
+        return XMLNodeType::END_ELEMENT;
+    }
+    // Drop consumed bytes, nothing before pos is referenced anymore
+    if (pos == buffer_end) {
+        pos = buffer_end = 0;
+    } else if (pos >= XML_READ_SIZE) {
+        memmove(buffer.get(), buffer.get() + pos, buffer_end - pos);
+        buffer_end -= pos;
+        pos = 0;
+    }
+    while (Ensure(1)) {
+        if (buffer[pos] != '<') {
+            // Text up to the next markup
+            auto end = Find("<", pos);
+            if (end == DConstants::INVALID_INDEX) {
+                end = buffer_end;
+            }
+            text.clear();
+            DecodeEntities(buffer.get() + pos, end - pos, text);
+            pos = end;
+            return XMLNodeType::TEXT;
+        }
+        if (StartsWith("<!--")) {
+            SkipUntil("-->");
+            continue;
+        }
+        if (StartsWith("<![CDATA[")) {
+            auto start = pos + 9;
+            SkipUntil("]]>");
+            text.assign(buffer.get() + start, pos - 3 - start);
+            return XMLNodeType::TEXT;
+        }
+        if (StartsWith("<?") || StartsWith("<!")) {
+            // XML declaration, processing instruction or DOCTYPE
+            SkipUntil(">");
+            continue;
+        }
+        if (StartsWith("</")) {
+            pos += 2;
+            ParseEndElement();
+            return XMLNodeType::END_ELEMENT;
+        }
+        pos++;
+        ParseStartElement();
+        return XMLNodeType::START_ELEMENT;
+    }
+    return XMLNodeType::END_OF_DOCUMENT;
+}
+
+const std::string *MSOLAPXMLReader::GetAttribute(const std::string &attribute_name) const {
+    for (idx_t i = 0; i < attribute_count; i++) {
+        if (attributes[i].name == attribute_name) {
+            return &attributes[i].value;
+        }
+    }
+    return nullptr;
+}
+
+std::string MSOLAPXMLReader::ReadElementText() {
+    std::string result;
+    ReadElementText(result);
+    return result;
+}
+
+void MSOLAPXMLReader::ReadElementText(std::string &result) {
+    result.clear();
+    idx_t depth = 1;
+    while (depth > 0) {
+        switch (Next()) {
+        case XMLNodeType::START_ELEMENT:
+            depth++;
+            break;
+        case XMLNodeType::END_ELEMENT:
+            depth--;
+            break;
+        case XMLNodeType::TEXT:
+            result += text;
+            break;
+        case XMLNodeType::END_OF_DOCUMENT:
+            throw std::runtime_error("Unexpected end of XMLA response");
+        }
+    }
+}
+
+void MSOLAPXMLReader::SkipElement() {
+    idx_t depth = 1;
+    while (depth > 0) {
+        switch (Next()) {
+        case XMLNodeType::START_ELEMENT:
+            depth++;
+            break;
+        case XMLNodeType::END_ELEMENT:
+            depth--;
+            break;
+        case XMLNodeType::TEXT:
+            break;
+        case XMLNodeType::END_OF_DOCUMENT:
+            throw std::runtime_error("Unexpected end of XMLA response");
+        }
+    }
+}
+
+// Code point of a character reference (#65 or #x41, without & and ;), false unless it has digits and is a
+// Unicode scalar value
+static bool ParseCharacterReference(const std::string &entity, uint32_t &code_point) {
+    bool hex = entity.size() > 1 && (entity[1] == 'x' || entity[1] == 'X');
+    idx_t start = hex ? 2 : 1;
+    if (start == entity.size()) {
+        return false;
+    }
+    code_point = 0;
+    for (idx_t i = start; i < entity.size(); i++) {
+        auto c = entity[i];
+        uint32_t digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if (hex && c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else if (hex && c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        } else {
+            return false;
+        }
+        code_point = code_point * (hex ? 16 : 10) + digit;
+        if (code_point > 0x10FFFF) {
+            return false;
+        }
+    }
+    return code_point < 0xD800 || code_point > 0xDFFF;
+}
+
+void MSOLAPXMLReader::DecodeEntities(const char *data, idx_t length, std::string &target) {
+    auto amp = (const char *)memchr(data, '&', length);
+    if (!amp) {
+        // Fast path: nothing to decode
+        target.append(data, length);
+        return;
+    }
+    idx_t i = 0;
+    while (i < length) {
+        if (data[i] != '&') {
+            target += data[i++];
+            continue;
+        }
+        auto semicolon = (const char *)memchr(data + i, ';', length - i);
+        if (!semicolon) {
+            target.append(data + i, length - i);
+            return;
+        }
+        std::string entity(data + i + 1, semicolon - (data + i + 1));
+        if (entity == "lt") {
+            target += '<';
+        } else if (entity == "gt") {
+            target += '>';
+        } else if (entity == "amp") {
+            target += '&';
+        } else if (entity == "quot") {
+            target += '"';
+        } else if (entity == "apos") {
+            target += '\'';
+        } else if (!entity.empty() && entity[0] == '#') {
+            uint32_t code_point;
+            if (!ParseCharacterReference(entity, code_point)) {
+                throw std::runtime_error("Malformed character reference &" + entity + "; in XMLA response");
+            }
+            MSOLAPUtils::AppendUTF8(code_point, target);
+        } else {
+            // Unknown entity, keep it verbatim
+            target.append(data + i, semicolon - (data + i) + 1);
+        }
+        i = (semicolon - data) + 1;
+    }
+}
+
+std::string MSOLAPXMLReader::DecodeName(const std::string &encoded) {
+    std::string result;
+    idx_t i = 0;
+    uint32_t high_surrogate = 0;
+    while (i < encoded.size()) {
+        // Escaped characters have the form _xHHHH_, characters outside the BMP _xHHHHHHHH_
+        if (encoded[i] == '_' && i + 1 < encoded.size() && encoded[i + 1] == 'x') {
+            idx_t digits = 0;
+            if (i + 6 < encoded.size() && encoded[i + 6] == '_') {
+                digits = 4;
+            } else if (i + 10 < encoded.size() && encoded[i + 10] == '_') {
+                digits = 8;
+            }
+            auto hex = encoded.substr(i + 2, digits);
+            bool valid = digits > 0 && hex.find_first_not_of("0123456789abcdefABCDEF") == std::string::npos;
+            // At most 8 hex digits, which an unsigned long holds. Beyond the last code point it is not an escape.
+            auto code_point = valid ? (uint32_t)std::stoul(hex, nullptr, 16) : 0;
+            if (valid && code_point <= 0x10FFFF) {
+                if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+                    high_surrogate = code_point;
+                } else if (code_point >= 0xDC00 && code_point <= 0xDFFF && high_surrogate) {
+                    MSOLAPUtils::AppendUTF8(0x10000 + ((high_surrogate - 0xD800) << 10) + (code_point - 0xDC00),
+                                            result);
+                    high_surrogate = 0;
+                } else {
+                    MSOLAPUtils::AppendUTF8(code_point, result);
+                }
+                i += digits + 3;
+                continue;
+            }
+        }
+        result += encoded[i++];
+    }
+    return result;
+}
+
+} // namespace duckdb
@@ -0,0 +1,488 @@
+#include "msolap_xmla.hpp"
+#include "msolap_utils.hpp"
+#include "msolap_binary_xml.hpp"
+#include "duckdb/common/types/blob.hpp"
+#include "duckdb/common/string_util.hpp"
+#include <stdexcept>
+#include <algorithm>
+
+namespace duckdb {
+
+static constexpr const char *XMLA_NAMESPACE = "urn:schemas-microsoft-com:xml-analysis";
+
+// Content types of the XMLA response encodings
+static constexpr const char *CONTENT_TYPE_XML = "text/xml";
+static constexpr const char *CONTENT_TYPE_BINARY = "application/sx";
+static constexpr const char *CONTENT_TYPE_XML_XPRESS = "application/xml+xpress";
+static constexpr const char *CONTENT_TYPE_BINARY_XPRESS = "application/sx+xpress";
+
+XMLAConnection::XMLAConnection()
+    : binary_xml(false), compression(false), connect_timeout(DEFAULT_CONNECT_TIMEOUT), timeout(DEFAULT_TIMEOUT) {
+}
+
+XMLAConnection::~XMLAConnection() {
+    Close();
+}
+
+XMLAConnection::XMLAConnection(XMLAConnection &&other) noexcept : XMLAConnection() {
+    std::swap(http, other.http);
+    std::swap(url, other.url);
+    std::swap(catalog, other.catalog);
+    std::swap(user, other.user);
+    std::swap(password, other.password);
+    std::swap(binary_xml, other.binary_xml);
+    std::swap(compression, other.compression);
+    std::swap(connect_timeout, other.connect_timeout);
+    std::swap(timeout, other.timeout);
+}
+
+XMLAConnection &XMLAConnection::operator=(XMLAConnection &&other) noexcept {
+    std::swap(http, other.http);
+    std::swap(url, other.url);
+    std::swap(catalog, other.catalog);
+    std::swap(user, other.user);
+    std::swap(password, other.password);
+    std::swap(binary_xml, other.binary_xml);
+    std::swap(compression, other.compression);
+    std::swap(connect_timeout, other.connect_timeout);
+    std::swap(timeout, other.timeout);
+    return *this;
+}
+
+void XMLAConnection::ParseConnectionString(const std::string &connection_string) {
+    auto properties = MSOLAPUtils::ParseConnectionString(connection_string);
+
+    auto server_it = properties.find("Data Source");
+    if (server_it == properties.end()) {
+        throw std::runtime_error("Connection string is missing the Data Source");
+    }
+    url = server_it->second;
+
+    auto db_it = properties.find("Catalog");
+    if (db_it == properties.end()) {
+        db_it = properties.find("Initial Catalog");
+    }
+    catalog = db_it != properties.end() ? db_it->second : "";
+
+    auto user_it = properties.find("User ID");
+    if (user_it == properties.end()) {
+        user_it = properties.find("UID");
+    }
+    user = user_it != properties.end() ? user_it->second : "";
+
+    auto password_it = properties.find("Password");
+    if (password_it == properties.end()) {
+        password_it = properties.find("PWD");
+    }
+    password = password_it != properties.end() ? password_it->second : "";
+
+    // The built-in transport is plain HTTP, Basic authentication would send the credentials in clear text with
+    // every request. Only done when the connection string says so, e.g. for a server on the local machine.
+    if (!user.empty() || !password.empty()) {
+        auto encrypt_it = properties.find("Encrypt Password");
+        if (encrypt_it == properties.end() || !StringUtil::CIEquals(encrypt_it->second, "False")) {
+            throw std::runtime_error("The XMLA endpoint " + url + " is not encrypted, its User ID and Password "
+                                     "would be sent in clear text. Add \"Encrypt Password=False\" to the "
+                                     "connection string to send them anyway.");
+        }
+    }
+
+    auto format_it = properties.find("Protocol Format");
+    if (format_it != properties.end()) {
+        if (StringUtil::CIEquals(format_it->second, "Binary")) {
+            binary_xml = true;
+        } else if (!StringUtil::CIEquals(format_it->second, "XML") &&
+                   !StringUtil::CIEquals(format_it->second, "Default")) {
+            throw std::runtime_error("Invalid Protocol Format: " + format_it->second + " (expected XML or Binary)");
+        }
+    }
+
+    auto compression_it = properties.find("Transport Compression");
+    if (compression_it != properties.end()) {
+        if (StringUtil::CIEquals(compression_it->second, "Compressed")) {
+            compression = true;
+        } else if (!StringUtil::CIEquals(compression_it->second, "None") &&
+                   !StringUtil::CIEquals(compression_it->second, "Default")) {
+            throw std::runtime_error("Invalid Transport Compression: " + compression_it->second +
+                                     " (expected None or Compressed)");
+        }
+    }
+
+    auto parse_seconds = [&](const std::string &name, idx_t &seconds) {
+        auto it = properties.find(name);
+        if (it == properties.end()) {
+            return;
+        }
+        try {
+            size_t end;
+            auto value = std::stoll(it->second, &end);
+            if (end != it->second.size() || value < 0) {
+                throw std::invalid_argument(name);
+            }
+            seconds = idx_t(value);
+        } catch (std::exception &) {
+            throw std::runtime_error("Invalid " + name + ": " + it->second + " (expected seconds)");
+        }
+    };
+    parse_seconds("Connect Timeout", connect_timeout);
+    parse_seconds("Timeout", timeout);
+}
+
+XMLAConnection XMLAConnection::Connect(const std::string &connection_string) {
+    XMLAConnection connection;
+    connection.ParseConnectionString(connection_string);
+    connection.http = MSOLAPHTTPConnection::Connect(connection.url, connection.connect_timeout, connection.timeout);
+    return connection;
+}
+
+std::string XMLAConnection::EscapeXML(const std::string &text) {
+    std::string result;
+    result.reserve(text.size());
+    for (auto c : text) {
+        switch (c) {
+        case '<':
+            result += "&lt;";
+            break;
+        case '>':
+            result += "&gt;";
+            break;
+        case '&':
+            result += "&amp;";
+            break;
+        case '"':
+            result += "&quot;";
+            break;
+        case '\'':
+            result += "&apos;";
+            break;
+        default:
+            result += c;
+        }
+    }
+    return result;
+}
+
+MSOLAPHTTPResponse XMLAConnection::SendRequest(const std::string &soap_action, const std::string &body) {
+    bool reused = true;
+    if (!http.IsOpen() || !http.ResponseComplete()) {
+        // The server closed the previous keep-alive connection or a rowset was abandoned mid-response, reconnect
+        http = MSOLAPHTTPConnection::Connect(url, connect_timeout, timeout);
+        reused = false;
+    }
+
+    std::vector<std::pair<std::string, std::string>> headers;
+    headers.emplace_back("Content-Type", "text/xml; charset=utf-8");
+    // Offer the requested encodings, the Content-Type of the response tells which one the server picked
+    std::string accept;
+    if (binary_xml && compression) {
+        accept += std::string(CONTENT_TYPE_BINARY_XPRESS) + ", ";
+    }
+    if (binary_xml) {
+        accept += std::string(CONTENT_TYPE_BINARY) + ", ";
+    }
+    if (compression) {
+        accept += std::string(CONTENT_TYPE_XML_XPRESS) + ", ";
+    }
+    accept += CONTENT_TYPE_XML;
+    headers.emplace_back("Accept", accept);
+    headers.emplace_back("SOAPAction", "\"" + std::string(XMLA_NAMESPACE) + ":" + soap_action + "\"");
+    if (!user.empty()) {
+        auto credentials = user + ":" + password;
+        auto encoded = Blob::ToBase64(string_t(credentials.c_str(), (uint32_t)credentials.size()));
+        headers.emplace_back("Authorization", "Basic " + encoded);
+    }
+
+    MSOLAPHTTPResponse response;
+    try {
+        http.SendRequest("POST", headers, body);
+        response = http.ReadResponseHeader();
+    } catch (std::exception &) {
+        if (!reused || http.IsAborted()) {
+            throw;
+        }
+        // The server dropped the idle keep-alive connection (e.g. of a pooled session), retry once on a new one.
+        // Execute requests only read data, so sending them again is safe.
+        http = MSOLAPHTTPConnection::Connect(url, connect_timeout, timeout);
+        http.SendRequest("POST", headers, body);
+        response = http.ReadResponseHeader();
+    }
+
+    // SOAP faults are returned with status 500 and are reported by the rowset parser
+    if (response.status != 200 && response.status != 500) {
+        http.ReadFullBody();
+        throw std::runtime_error("XMLA request failed with HTTP status " + std::to_string(response.status) + " " +
+                                 response.reason);
+    }
+    return response;
+}
+
+unique_ptr<MSOLAPRowset> XMLAConnection::ExecuteQuery(const std::string &dax_query) {
+    return Execute(dax_query, "SchemaData");
+}
+
+void XMLAConnection::DescribeQuery(const std::string &dax_query, std::vector<std::string> &names,
+                                   std::vector<LogicalType> &types) {
+    // Content=Schema makes the server prepare the statement and return the row schema without any rows
+    auto rowset = Execute(dax_query, "Schema");
+    rowset->GetColumnInfo(names, types);
+}
+
+unique_ptr<XMLARowset> XMLAConnection::Execute(const std::string &dax_query, const std::string &content) {
+    std::string body;
+    body += "<Envelope xmlns=\"http://schemas.xmlsoap.org/soap/envelope/\"><Body>";
+    body += "<Execute xmlns=\"" + std::string(XMLA_NAMESPACE) + "\">";
+    body += "<Command><Statement>" + EscapeXML(dax_query) + "</Statement></Command>";
+    body += "<Properties><PropertyList>";
+    if (!catalog.empty()) {
+        body += "<Catalog>" + EscapeXML(catalog) + "</Catalog>";
+    }
+    body += "<Format>Tabular</Format><Content>" + content + "</Content>";
+    body += "</PropertyList></Properties>";
+    body += "</Execute></Body></Envelope>";
+
+    auto response = SendRequest("Execute", body);
+    auto content_type = response.headers.find("Content-Type");
+    return make_uniq<XMLARowset>(http, content_type != response.headers.end() ? content_type->second : "");
+}
+
+bool XMLAConnection::IsOpen() const {
+    return !url.empty() && !http.IsAborted();
+}
+
+void XMLAConnection::Ping() {
+    // Authenticated like a query, but answered by the server without evaluating anything
+    std::string body;
+    body += "<Envelope xmlns=\"http://schemas.xmlsoap.org/soap/envelope/\"><Body>";
+    body += "<Discover xmlns=\"" + std::string(XMLA_NAMESPACE) + "\">";
+    body += "<RequestType>DISCOVER_PROPERTIES</RequestType>";
+    body += "<Restrictions><RestrictionList><PropertyName>Catalog</PropertyName></RestrictionList></Restrictions>";
+    body += "<Properties><PropertyList>";
+    if (!catalog.empty()) {
+        body += "<Catalog>" + EscapeXML(catalog) + "</Catalog>";
+    }
+    body += "<Format>Tabular</Format></PropertyList></Properties>";
+    body += "</Discover></Body></Envelope>";
+
+    auto response = SendRequest("Discover", body);
+    auto content_type = response.headers.find("Content-Type");
+    XMLARowset rowset(http, content_type != response.headers.end() ? content_type->second : "");
+    // Read the response to its end, so the connection can be used by the next request
+    std::vector<std::string> names;
+    std::vector<LogicalType> types;
+    rowset.GetColumnInfo(names, types);
+    if (types.empty()) {
+        return;
+    }
+    DataChunk chunk;
+    chunk.Initialize(Allocator::DefaultAllocator(), types);
+    while (rowset.Fetch(chunk) > 0) {
+        chunk.Reset();
+    }
+}
+
+void XMLAConnection::Cancel() {
+    http.Abort();
+}
+
+void XMLAConnection::Close() {
+    http.Close();
+    url.clear();
+}
+
+XMLARowset::XMLARowset(MSOLAPHTTPConnection &http_p, const std::string &content_type)
+    : http(http_p), stream(http_p), pending_row(false), finished(false) {
+    // Strip parameters such as "; charset=utf-8"
+    auto media_type = StringUtil::Lower(content_type.substr(0, content_type.find(';')));
+    StringUtil::Trim(media_type);
+
+    MSOLAPInputStream *source = &stream;
+    if (media_type == CONTENT_TYPE_XML_XPRESS || media_type == CONTENT_TYPE_BINARY_XPRESS) {
+        decompressor = make_uniq<MSOLAPXpressStream>(stream);
+        source = decompressor.get();
+    }
+    if (media_type == CONTENT_TYPE_BINARY || media_type == CONTENT_TYPE_BINARY_XPRESS) {
+        reader = make_uniq<MSOLAPBinaryXMLReader>(*source);
+    } else {
+        reader = make_uniq<MSOLAPTextXMLReader>(*source);
+    }
+
+    while (true) {
+        auto node = reader->Next();
+        if (node == XMLNodeType::END_OF_DOCUMENT) {
+            finished = true;
+            break;
+        }
+        if (node != XMLNodeType::START_ELEMENT) {
+            continue;
+        }
+        auto &name = reader->Name();
+        if (name == "Fault" || name == "Exception") {
+            ThrowError();
+        } else if (name == "schema") {
+            ParseSchema();
+        } else if (name == "row") {
+            pending_row = true;
+            break;
+        }
+    }
+    present.resize(names.size());
+    for (auto &type : types) {
+        writers.emplace_back(type);
+    }
+}
+
+XMLARowset::~XMLARowset() {
+    if (!http.ResponseComplete()) {
+        // Don't download the rest of an abandoned result, drop the connection instead
+        http.Close();
+    }
+}
+
+void XMLARowset::ThrowError() {
+    std::string message;
+    while (true) {
+        auto node = reader->Next();
+        if (node == XMLNodeType::END_OF_DOCUMENT) {
+            break;
+        }
+        if (node != XMLNodeType::START_ELEMENT) {
+            continue;
+        }
+        if (reader->Name() == "Error") {
+            auto description = reader->GetAttribute("Description");
+            if (description) {
+                message += (message.empty() ? "" : "\n") + *description;
+            }
+        } else if (reader->Name() == "faultstring" && message.empty()) {
+            message = reader->ReadElementText();
+        }
+    }
+    throw std::runtime_error("XMLA error: " + (message.empty() ? std::string("unknown error") : message));
+}
+
+void XMLARowset::ParseSchema() {
+    idx_t depth = 1;
+    bool in_row_type = false;
+    while (depth > 0) {
+        auto node = reader->Next();
+        if (node == XMLNodeType::END_OF_DOCUMENT) {
+            throw std::runtime_error("Unexpected end of XMLA response");
+        }
+        if (node == XMLNodeType::END_ELEMENT) {
+            depth--;
+            if (reader->Name() == "complexType") {
+                in_row_type = false;
+            }
+            continue;
+        }
+        if (node != XMLNodeType::START_ELEMENT) {
+            continue;
+        }
+        depth++;
+        if (reader->Name() == "complexType") {
+            auto type_name = reader->GetAttribute("name");
+            in_row_type = type_name && *type_name == "row";
+        } else if (reader->Name() == "element" && in_row_type) {
+            auto element_name = reader->GetAttribute("name");
+            if (!element_name) {
+                continue;
+            }
+            // sql:field carries the original column name, e.g. "Table[Column]"
+            auto field = reader->GetAttribute("field");
+            auto column_name = field ? *field : MSOLAPXMLReader::DecodeName(*element_name);
+            auto type = reader->GetAttribute("type");
+
+            element_index[*element_name] = names.size();
+            element_names.push_back(*element_name);
+            names.push_back(column_name);
+            types.push_back(type ? MSOLAPUtils::GetLogicalTypeFromXSDType(*type) : LogicalType::VARCHAR);
+        }
+    }
+}
+
+bool XMLARowset::NextRow() {
+    if (pending_row) {
+        pending_row = false;
+        return true;
+    }
+    while (!finished) {
+        auto node = reader->Next();
+        if (node == XMLNodeType::END_OF_DOCUMENT) {
+            finished = true;
+            break;
+        }
+        if (node != XMLNodeType::START_ELEMENT) {
+            continue;
+        }
+        auto &name = reader->Name();
+        if (name == "row") {
+            return true;
+        }
+        if (name == "Fault" || name == "Exception") {
+            // Errors raised while the server was streaming the result follow the rows
+            ThrowError();
+        }
+    }
+    return false;
+}
+
+void XMLARowset::ParseRow(DataChunk &output, idx_t row) {
+    std::fill(present.begin(), present.end(), false);
+    idx_t expected_column = 0;
+    while (true) {
+        auto node = reader->Next();
+        if (node == XMLNodeType::END_OF_DOCUMENT) {
+            throw std::runtime_error("Unexpected end of XMLA response");
+        }
+        if (node == XMLNodeType::END_ELEMENT) {
+            break;
+        }
+        if (node != XMLNodeType::START_ELEMENT) {
+            continue;
+        }
+        // Cells are normally in schema order, only fall back to the lookup when they are not
+        idx_t column;
+        if (expected_column < element_names.size() && element_names[expected_column] == reader->Name()) {
+            column = expected_column;
+        } else {
+            auto entry = element_index.find(reader->Name());
+            if (entry == element_index.end()) {
+                reader->SkipElement();
+                continue;
+            }
+            column = entry->second;
+        }
+        expected_column = column + 1;
+
+        auto nil = reader->GetAttribute("nil");
+        bool is_null = nil && *nil == "true";
+        reader->ReadElementText(value_text);
+        if (is_null) {
+            continue;
+        }
+        writers[column].WriteText(output.data[column], row, value_text.c_str(), value_text.size());
+        present[column] = true;
+    }
+    for (idx_t col = 0; col < present.size(); col++) {
+        if (!present[col]) {
+            MSOLAPColumnWriter::WriteNull(output.data[col], row);
+        }
+    }
+}
+
+void XMLARowset::GetColumnInfo(std::vector<std::string> &names_p, std::vector<LogicalType> &types_p) {
+    names_p = names;
+    types_p = types;
+}
+
+idx_t XMLARowset::Fetch(DataChunk &output) {
+    idx_t count = 0;
+    while (count < STANDARD_VECTOR_SIZE && NextRow()) {
+        ParseRow(output, count);
+        count++;
+    }
+    output.SetCardinality(count);
+    return count;
+}
+
+} // namespace duckdb
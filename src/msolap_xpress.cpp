@@ -0,0 +1,170 @@
+#include "msolap_xpress.hpp"
+#include <stdexcept>
+#include <cstring>
+
+namespace duckdb {
+
+static constexpr idx_t XPRESS_HEADER_SIZE = 8;
+// Analysis Services compresses 64KB blocks, anything much larger is a corrupt header
+static constexpr idx_t XPRESS_MAX_BLOCK_SIZE = 1024 * 1024;
+
+static uint32_t LoadLE32(const uint8_t *data) {
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static uint16_t LoadLE16(const uint8_t *data) {
+    return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+static void ThrowCorrupt() {
+    throw std::runtime_error("Corrupt XPRESS block in XMLA response");
+}
+
+MSOLAPXpressStream::MSOLAPXpressStream(MSOLAPInputStream &source_p) : source(source_p), block_pos(0), block_size(0) {
+}
+
+bool MSOLAPXpressStream::ReadExact(char *target, idx_t length) {
+    idx_t total = 0;
+    while (total < length) {
+        auto count = source.Read(target + total, length - total);
+        if (count == 0) {
+            if (total == 0) {
+                return false;
+            }
+            throw std::runtime_error("Unexpected end of compressed XMLA response");
+        }
+        total += count;
+    }
+    return true;
+}
+
+bool MSOLAPXpressStream::NextBlock() {
+    uint8_t header[XPRESS_HEADER_SIZE];
+    if (!ReadExact((char *)header, XPRESS_HEADER_SIZE)) {
+        return false;
+    }
+    idx_t uncompressed_size = LoadLE32(header);
+    idx_t compressed_size = LoadLE32(header + 4);
+    if (uncompressed_size > XPRESS_MAX_BLOCK_SIZE || compressed_size > uncompressed_size) {
+        ThrowCorrupt();
+    }
+    block.resize(uncompressed_size);
+    if (compressed_size == uncompressed_size) {
+        // Stored block
+        if (uncompressed_size > 0 && !ReadExact((char *)block.data(), uncompressed_size)) {
+            ThrowCorrupt();
+        }
+    } else {
+        compressed.resize(compressed_size);
+        if (compressed_size > 0 && !ReadExact((char *)compressed.data(), compressed_size)) {
+            ThrowCorrupt();
+        }
+        Decompress(compressed.data(), compressed_size, block.data(), uncompressed_size);
+    }
+    block_pos = 0;
+    block_size = uncompressed_size;
+    return true;
+}
+
+idx_t MSOLAPXpressStream::Read(char *buffer, idx_t length) {
+    while (block_pos == block_size) {
+        if (!NextBlock()) {
+            return 0;
+        }
+    }
+    auto count = MinValue<idx_t>(length, block_size - block_pos);
+    memcpy(buffer, block.data() + block_pos, count);
+    block_pos += count;
+    return count;
+}
+
+void MSOLAPXpressStream::Decompress(const uint8_t *input, idx_t input_size, uint8_t *output, idx_t output_size) {
+    idx_t in_pos = 0;
+    idx_t out_pos = 0;
+    uint32_t flags = 0;
+    idx_t flag_count = 0;
+    // Match lengths of 7 + [0, 15) share a byte, the second half is used by the next such match
+    idx_t half_byte_pos = 0;
+    bool have_half_byte = false;
+
+    while (out_pos < output_size) {
+        if (flag_count == 0) {
+            if (in_pos + 4 > input_size) {
+                ThrowCorrupt();
+            }
+            flags = LoadLE32(input + in_pos);
+            in_pos += 4;
+            flag_count = 32;
+        }
+        flag_count--;
+        if ((flags & (1u << flag_count)) == 0) {
+            // Literal
+            if (in_pos >= input_size) {
+                ThrowCorrupt();
+            }
+            output[out_pos++] = input[in_pos++];
+            continue;
+        }
+
+        // Match: 13 bits of offset, 3 bits of length with extended lengths following
+        if (in_pos + 2 > input_size) {
+            ThrowCorrupt();
+        }
+        auto match = LoadLE16(input + in_pos);
+        in_pos += 2;
+        idx_t match_length = match & 7;
+        idx_t match_offset = (match >> 3) + 1;
+        if (match_length == 7) {
+            if (!have_half_byte) {
+                if (in_pos >= input_size) {
+                    ThrowCorrupt();
+                }
+                half_byte_pos = in_pos++;
+                match_length = input[half_byte_pos] & 15;
+                have_half_byte = true;
+            } else {
+                match_length = input[half_byte_pos] >> 4;
+                have_half_byte = false;
+            }
+            if (match_length == 15) {
+                if (in_pos >= input_size) {
+                    ThrowCorrupt();
+                }
+                match_length = input[in_pos++];
+                if (match_length == 255) {
+                    if (in_pos + 2 > input_size) {
+                        ThrowCorrupt();
+                    }
+                    match_length = LoadLE16(input + in_pos);
+                    in_pos += 2;
+                    if (match_length == 0) {
+                        if (in_pos + 4 > input_size) {
+                            ThrowCorrupt();
+                        }
+                        match_length = LoadLE32(input + in_pos);
+                        in_pos += 4;
+                    }
+                    if (match_length < 15 + 7) {
+                        ThrowCorrupt();
+                    }
+                    match_length -= 15 + 7;
+                }
+                match_length += 15;
+            }
+            match_length += 7;
+        }
+        match_length += 3;
+
+        if (match_offset > out_pos || match_length > output_size - out_pos) {
+            ThrowCorrupt();
+        }
+        // Matches may overlap their own output, copy byte by byte
+        auto source = output + out_pos - match_offset;
+        for (idx_t i = 0; i < match_length; i++) {
+            output[out_pos + i] = source[i];
+        }
+        out_pos += match_length;
+    }
+}
+
+} // namespace duckdb
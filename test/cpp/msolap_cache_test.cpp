@@ -0,0 +1,167 @@
+// Tests of the result cache with damaged cache files, with a synthetic row source. Checks that a file that cannot
+// be read when it is opened is removed and reported as missing, so the query is evaluated instead, and that a file
+// that fails after some of its rows were returned is removed and fails the scan with a clear error. Runs without a
+// server:
+//
+//   make cpp_test
+
+#include "msolap_cache.hpp"
+#include "msolap_test.hpp"
+#include "duckdb/common/file_system.hpp"
+#include <fstream>
+#include <sstream>
+
+using namespace duckdb;
+
+static const char *const CACHE_DIRECTORY = "msolap_cache_test";
+
+// Rows 0, 1, 2, ... in chunks of 2048
+class CountingRowset : public MSOLAPRowset {
+public:
+    explicit CountingRowset(idx_t chunk_count) : chunk_count(chunk_count), fetched(0) {
+    }
+
+    void GetColumnInfo(std::vector<std::string> &names, std::vector<LogicalType> &types) override {
+        names = {"Fake[Row]"};
+        types = {LogicalType::BIGINT};
+    }
+
+    idx_t Fetch(DataChunk &output) override {
+        if (fetched == chunk_count) {
+            output.SetCardinality(0);
+            return 0;
+        }
+        auto data = FlatVector::GetData<int64_t>(output.data[0]);
+        for (idx_t i = 0; i < STANDARD_VECTOR_SIZE; i++) {
+            data[i] = int64_t(fetched * STANDARD_VECTOR_SIZE + i);
+        }
+        fetched++;
+        output.SetCardinality(STANDARD_VECTOR_SIZE);
+        return STANDARD_VECTOR_SIZE;
+    }
+
+private:
+    idx_t chunk_count;
+    idx_t fetched;
+};
+
+// Read the rowset to the end, returns the number of rows, checking they count up from 0
+static idx_t ReadAll(MSOLAPRowset &rowset) {
+    DataChunk chunk;
+    chunk.Initialize(Allocator::DefaultAllocator(), {LogicalType::BIGINT});
+    idx_t rows = 0;
+    while (true) {
+        chunk.Reset();
+        auto count = rowset.Fetch(chunk);
+        if (count == 0) {
+            return rows;
+        }
+        chunk.Flatten();
+        auto data = FlatVector::GetData<int64_t>(chunk.data[0]);
+        for (idx_t row = 0; row < count; row++) {
+            MSOLAP_CHECK_EQUAL(data[row], int64_t(rows + row));
+        }
+        rows += count;
+    }
+}
+
+static std::string GetPath(const std::string &key) {
+    return std::string(CACHE_DIRECTORY) + "/" + key.substr(0, 16) + ".msolapcache";
+}
+
+static std::string ReadFile(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+static void WriteFile(const std::string &path, const std::string &contents) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << contents;
+}
+
+// Store a result of chunk_count chunks under key, returns the size of its file
+static idx_t StoreResult(const std::string &key, idx_t chunk_count) {
+    auto &cache = MSOLAPResultCache::Get();
+    auto rowset = cache.Store(key, make_uniq<CountingRowset>(chunk_count));
+    MSOLAP_CHECK_EQUAL(ReadAll(*rowset), chunk_count * STANDARD_VECTOR_SIZE);
+    rowset.reset();
+    MSOLAP_CHECK_EQUAL(cache.GetStats().entries, idx_t(1));
+    return ReadFile(GetPath(key)).size();
+}
+
+// An intact file returns the stored rows
+static void TestIntactFileRead(const std::string &key) {
+    auto &cache = MSOLAPResultCache::Get();
+    StoreResult(key, 4);
+    auto hits = cache.GetStats().hits;
+    auto rowset = cache.Open(key);
+    MSOLAP_CHECK(rowset != nullptr);
+    if (rowset) {
+        MSOLAP_CHECK_EQUAL(ReadAll(*rowset), idx_t(4) * STANDARD_VECTOR_SIZE);
+    }
+    MSOLAP_CHECK_EQUAL(cache.GetStats().hits, hits + 1);
+    MSOLAP_CHECK_EQUAL(cache.GetStats().entries, idx_t(1));
+    cache.Clear();
+}
+
+// A file truncated within its first chunk is a miss and removed
+static void TestTruncatedFileMissed(const std::string &key) {
+    auto &cache = MSOLAPResultCache::Get();
+    auto size = StoreResult(key, 1);
+    WriteFile(GetPath(key), ReadFile(GetPath(key)).substr(0, size / 2));
+    auto misses = cache.GetStats().misses;
+    MSOLAP_CHECK(cache.Open(key) == nullptr);
+    MSOLAP_CHECK_EQUAL(cache.GetStats().misses, misses + 1);
+    MSOLAP_CHECK_EQUAL(cache.GetStats().entries, idx_t(0));
+    MSOLAP_CHECK(!FileSystem::CreateLocal()->FileExists(GetPath(key)));
+}
+
+// A file written by another DuckDB version is a miss and removed
+static void TestOtherVersionMissed(const std::string &key) {
+    auto &cache = MSOLAPResultCache::Get();
+    StoreResult(key, 1);
+    // The DuckDB version follows the magic and its length
+    auto contents = ReadFile(GetPath(key));
+    contents[2 * sizeof(uint32_t)] = 'X';
+    WriteFile(GetPath(key), contents);
+    MSOLAP_CHECK(cache.Open(key) == nullptr);
+    MSOLAP_CHECK_EQUAL(cache.GetStats().entries, idx_t(0));
+    MSOLAP_CHECK(!FileSystem::CreateLocal()->FileExists(GetPath(key)));
+}
+
+// A file truncated within a later chunk returns the rows before it, then fails and is removed
+static void TestTruncatedFileFails(const std::string &key) {
+    auto &cache = MSOLAPResultCache::Get();
+    auto size = StoreResult(key, 4);
+    WriteFile(GetPath(key), ReadFile(GetPath(key)).substr(0, size - size / 8));
+    auto rowset = cache.Open(key);
+    MSOLAP_CHECK(rowset != nullptr);
+    if (rowset) {
+        DataChunk chunk;
+        chunk.Initialize(Allocator::DefaultAllocator(), {LogicalType::BIGINT});
+        for (idx_t i = 0; i < 3; i++) {
+            chunk.Reset();
+            MSOLAP_CHECK_EQUAL(rowset->Fetch(chunk), idx_t(STANDARD_VECTOR_SIZE));
+        }
+        chunk.Reset();
+        MSOLAP_CHECK_THROWS(rowset->Fetch(chunk), "could not be read");
+    }
+    MSOLAP_CHECK_EQUAL(cache.GetStats().entries, idx_t(0));
+    MSOLAP_CHECK(!FileSystem::CreateLocal()->FileExists(GetPath(key)));
+}
+
+int main() {
+    auto &cache = MSOLAPResultCache::Get();
+    cache.SetDirectory(CACHE_DIRECTORY);
+    cache.Clear();
+    auto key = MSOLAPResultCache::MakeKey("Data Source=localhost", "EVALUATE 'Fake'", "Model=1;");
+    TestIntactFileRead(key);
+    TestTruncatedFileMissed(key);
+    TestOtherVersionMissed(key);
+    TestTruncatedFileFails(key);
+    cache.Clear();
+    cache.SetDirectory("");
+    return msolap_test::Result("msolap_cache_test");
+}
@@ -0,0 +1,163 @@
+// Tests of the column writer shared by the rowset transports, with cells from a synthetic row source. Runs
+// without a server:
+//
+//   make cpp_test
+
+#include "msolap_column_writer.hpp"
+#include "msolap_test.hpp"
+#include <vector>
+
+using namespace duckdb;
+
+// Write the lexical forms into a vector of the type, and read them back as strings ("NULL" for a NULL)
+static std::vector<std::string> WriteText(const LogicalType &type, const std::vector<const char *> &cells) {
+    MSOLAPColumnWriter writer(type);
+    Vector vector(type);
+    for (idx_t row = 0; row < cells.size(); row++) {
+        if (cells[row]) {
+            writer.WriteText(vector, row, cells[row], strlen(cells[row]));
+        } else {
+            MSOLAPColumnWriter::WriteNull(vector, row);
+        }
+    }
+    std::vector<std::string> result;
+    for (idx_t row = 0; row < cells.size(); row++) {
+        auto value = vector.GetValue(row);
+        result.push_back(value.IsNull() ? "NULL" : value.ToString());
+    }
+    return result;
+}
+
+static std::string WriteText(const LogicalType &type, const char *cell) {
+    return WriteText(type, std::vector<const char *> {cell})[0];
+}
+
+static void TestText() {
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::BOOLEAN, "true"), std::string("true"));
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::BOOLEAN, "0"), std::string("false"));
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::TINYINT, "-128"), std::string("-128"));
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::SMALLINT, "32767"), std::string("32767"));
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::INTEGER, "-2147483648"), std::string("-2147483648"));
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::BIGINT, "9223372036854775807"), std::string("9223372036854775807"));
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::UTINYINT, "255"), std::string("255"));
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::USMALLINT, "65535"), std::string("65535"));
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::UINTEGER, "4294967295"), std::string("4294967295"));
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::UBIGINT, "18446744073709551615"), std::string("18446744073709551615"));
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::FLOAT, "1.5"), std::string("1.5"));
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::DOUBLE, "-2.5E-3"), std::string("-0.0025"));
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::DATE, "2024-02-29"), std::string("2024-02-29"));
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::TIME, "23:59:59.5"), std::string("23:59:59.5"));
+    // XSD dateTime has a T between date and time
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::TIMESTAMP, "2024-02-29T10:20:30"), std::string("2024-02-29 10:20:30"));
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::VARCHAR, "Mountain-200 Black, 38"),
+                       std::string("Mountain-200 Black, 38"));
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::VARCHAR, ""), std::string(""));
+    // Types without a dedicated conversion are cast
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::UUID, "00112233-4455-6677-8899-aabbccddeeff"),
+                       std::string("00112233-4455-6677-8899-aabbccddeeff"));
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::BLOB, "abc"), std::string("abc"));
+
+    MSOLAP_CHECK_THROWS(WriteText(LogicalType::INTEGER, "abc"), "Could not convert value \"abc\" to INTEGER");
+    MSOLAP_CHECK_THROWS(WriteText(LogicalType::TINYINT, "128"), "Could not convert value \"128\" to TINYINT");
+    MSOLAP_CHECK_THROWS(WriteText(LogicalType::DATE, "2023-02-29"), "Could not convert value");
+}
+
+static void TestDecimalText() {
+    // Every physical type of a decimal
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::DECIMAL(4, 2), "-12.34"), std::string("-12.34"));
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::DECIMAL(9, 4), "12345.6789"), std::string("12345.6789"));
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::DECIMAL(19, 4), "922337203685477.5807"),
+                       std::string("922337203685477.5807"));
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::DECIMAL(38, 10), "-1234567890123456789012345678.0123456789"),
+                       std::string("-1234567890123456789012345678.0123456789"));
+    // Rounded to the scale of the type
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::DECIMAL(18, 2), "0.005"), std::string("0.01"));
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::DECIMAL(18, 2), "-0.005"), std::string("-0.01"));
+    // Exponents are cast
+    MSOLAP_CHECK_EQUAL(WriteText(LogicalType::DECIMAL(18, 2), "1.5E2"), std::string("150.00"));
+    MSOLAP_CHECK_THROWS(WriteText(LogicalType::DECIMAL(4, 2), "123.45"), "");
+}
+
+static void TestNulls() {
+    auto result = WriteText(LogicalType::INTEGER, {"1", nullptr, "3", nullptr});
+    MSOLAP_CHECK_EQUAL(result[0], std::string("1"));
+    MSOLAP_CHECK_EQUAL(result[1], std::string("NULL"));
+    MSOLAP_CHECK_EQUAL(result[2], std::string("3"));
+    MSOLAP_CHECK_EQUAL(result[3], std::string("NULL"));
+}
+
+static void TestNativeValues() {
+    Vector integers(LogicalType::BIGINT);
+    MSOLAPColumnWriter::WriteValue<int64_t>(integers, 0, -42);
+    MSOLAPColumnWriter::WriteValue<int64_t>(integers, 1, 5000000000LL);
+    MSOLAP_CHECK_EQUAL(integers.GetValue(0).ToString(), std::string("-42"));
+    MSOLAP_CHECK_EQUAL(integers.GetValue(1).ToString(), std::string("5000000000"));
+
+    // Currency as DECIMAL(19,4), in 1/10000 units
+    Vector currency(LogicalType::DECIMAL(19, 4));
+    MSOLAPColumnWriter::WriteDecimal(currency, 0, hugeint_t(-123456789));
+    MSOLAP_CHECK_EQUAL(currency.GetValue(0).ToString(), std::string("-12345.6789"));
+    Vector small(LogicalType::DECIMAL(4, 1));
+    MSOLAPColumnWriter::WriteDecimal(small, 0, hugeint_t(-999));
+    MSOLAP_CHECK_EQUAL(small.GetValue(0).ToString(), std::string("-99.9"));
+    Vector medium(LogicalType::DECIMAL(9, 0));
+    MSOLAPColumnWriter::WriteDecimal(medium, 0, hugeint_t(999999999));
+    MSOLAP_CHECK_EQUAL(medium.GetValue(0).ToString(), std::string("999999999"));
+}
+
+static void TestUTF16() {
+    Vector strings(LogicalType::VARCHAR);
+    // "hé", an unpaired surrogate and a character outside the BMP, one longer than an inlined string
+    const uint16_t text[] = {'h', 0xE9, 0xD800, 'x', 0xD83D, 0xDE00};
+    MSOLAPColumnWriter::WriteUTF16(strings, 0, (const uint8_t *)text, 6);
+    MSOLAP_CHECK_EQUAL(strings.GetValue(0).ToString(), std::string("h\xC3\xA9\xEF\xBF\xBDx\xF0\x9F\x98\x80"));
+    std::vector<uint16_t> long_text(100, 'a');
+    MSOLAPColumnWriter::WriteUTF16(strings, 1, (const uint8_t *)long_text.data(), long_text.size());
+    MSOLAP_CHECK_EQUAL(strings.GetValue(1).ToString(), std::string(100, 'a'));
+    MSOLAPColumnWriter::WriteUTF16(strings, 2, (const uint8_t *)text, 0);
+    MSOLAP_CHECK_EQUAL(strings.GetValue(2).ToString(), std::string());
+}
+
+// A full chunk from a synthetic row source, the way a transport fills it
+static void TestChunk() {
+    std::vector<LogicalType> types {LogicalType::INTEGER, LogicalType::DECIMAL(18, 2), LogicalType::VARCHAR};
+    std::vector<MSOLAPColumnWriter> writers;
+    for (auto &type : types) {
+        writers.emplace_back(type);
+    }
+    DataChunk chunk;
+    chunk.Initialize(Allocator::DefaultAllocator(), types);
+    for (idx_t row = 0; row < STANDARD_VECTOR_SIZE; row++) {
+        auto key = std::to_string(row);
+        auto amount = std::to_string(row) + ".25";
+        auto name = "Product " + std::to_string(row);
+        writers[0].WriteText(chunk.data[0], row, key.c_str(), key.size());
+        if (row % 3 == 0) {
+            MSOLAPColumnWriter::WriteNull(chunk.data[1], row);
+        } else {
+            writers[1].WriteText(chunk.data[1], row, amount.c_str(), amount.size());
+        }
+        writers[2].WriteText(chunk.data[2], row, name.c_str(), name.size());
+    }
+    chunk.SetCardinality(STANDARD_VECTOR_SIZE);
+    chunk.Verify();
+
+    bool correct = true;
+    for (idx_t row = 0; row < STANDARD_VECTOR_SIZE; row++) {
+        correct = correct && chunk.GetValue(0, row).ToString() == std::to_string(row);
+        correct = correct && (row % 3 == 0 ? chunk.GetValue(1, row).IsNull()
+                                           : chunk.GetValue(1, row).ToString() == std::to_string(row) + ".25");
+        correct = correct && chunk.GetValue(2, row).ToString() == "Product " + std::to_string(row);
+    }
+    MSOLAP_CHECK(correct);
+}
+
+int main() {
+    TestText();
+    TestDecimalText();
+    TestNulls();
+    TestNativeValues();
+    TestUTF16();
+    TestChunk();
+    return msolap_test::Result("msolap_column_writer_test");
+}
@@ -0,0 +1,98 @@
+// Tests of the conversion kernels for fixed point and OLE automation date values, with constructed values. Runs
+// without a server or the Windows headers:
+//
+//   make cpp_test
+
+#include "msolap_conversion.hpp"
+#include "msolap_test.hpp"
+#include <cstring>
+
+using namespace duckdb;
+
+// Fixed point value of the text as a currency (DECIMAL(19,4)), "<none>" if it cannot be parsed
+static std::string ParseCurrency(const char *text) {
+    hugeint_t result;
+    if (!MSOLAPConversion::TryParseDecimal(text, strlen(text), MSOLAPConversion::CURRENCY_WIDTH,
+                                           MSOLAPConversion::CURRENCY_SCALE, result)) {
+        return "<none>";
+    }
+    return result.ToString();
+}
+
+static std::string ConvertDecimal(int64_t magnitude, bool negative, uint8_t scale, uint8_t width,
+                                  uint8_t target_scale) {
+    hugeint_t result;
+    if (!MSOLAPConversion::TryConvertDecimal(hugeint_t(magnitude), negative, scale, width, target_scale, result)) {
+        return "<none>";
+    }
+    return result.ToString();
+}
+
+static std::string ConvertOADate(double value) {
+    timestamp_t result;
+    if (!MSOLAPConversion::TryConvertOADate(value, result)) {
+        return "<none>";
+    }
+    return Timestamp::ToString(result);
+}
+
+static void TestParseDecimal() {
+    MSOLAP_CHECK_EQUAL(ParseCurrency("12.3456"), std::string("123456"));
+    MSOLAP_CHECK_EQUAL(ParseCurrency("-0.5"), std::string("-5000"));
+    MSOLAP_CHECK_EQUAL(ParseCurrency("+7.1"), std::string("71000"));
+    MSOLAP_CHECK_EQUAL(ParseCurrency("0"), std::string("0"));
+    MSOLAP_CHECK_EQUAL(ParseCurrency("1"), std::string("10000"));
+    // The range of the 64-bit CY type
+    MSOLAP_CHECK_EQUAL(ParseCurrency("922337203685477.5807"), std::string("9223372036854775807"));
+    MSOLAP_CHECK_EQUAL(ParseCurrency("-922337203685477.5808"), std::string("-9223372036854775808"));
+    // Digits beyond the scale are rounded half away from zero
+    MSOLAP_CHECK_EQUAL(ParseCurrency("0.00005"), std::string("1"));
+    MSOLAP_CHECK_EQUAL(ParseCurrency("0.00004"), std::string("0"));
+    MSOLAP_CHECK_EQUAL(ParseCurrency("-0.00005"), std::string("-1"));
+    MSOLAP_CHECK_EQUAL(ParseCurrency("1.23455"), std::string("12346"));
+    // Too wide, also once rounded up
+    MSOLAP_CHECK_EQUAL(ParseCurrency("9999999999999999999"), std::string("<none>"));
+    MSOLAP_CHECK_EQUAL(ParseCurrency("999999999999999.99995"), std::string("<none>"));
+    // Not plain decimal notation
+    MSOLAP_CHECK_EQUAL(ParseCurrency(""), std::string("<none>"));
+    MSOLAP_CHECK_EQUAL(ParseCurrency("-"), std::string("<none>"));
+    MSOLAP_CHECK_EQUAL(ParseCurrency("."), std::string("<none>"));
+    MSOLAP_CHECK_EQUAL(ParseCurrency("abc"), std::string("<none>"));
+    MSOLAP_CHECK_EQUAL(ParseCurrency("1.2.3"), std::string("<none>"));
+}
+
+static void TestConvertDecimal() {
+    // 123.456 as DECIMAL(18,2) and DECIMAL(18,5)
+    MSOLAP_CHECK_EQUAL(ConvertDecimal(123456, true, 3, 18, 2), std::string("-12346"));
+    MSOLAP_CHECK_EQUAL(ConvertDecimal(123456, false, 3, 18, 5), std::string("12345600"));
+    MSOLAP_CHECK_EQUAL(ConvertDecimal(125, false, 1, 18, 0), std::string("13"));
+    MSOLAP_CHECK_EQUAL(ConvertDecimal(123456, false, 0, 5, 0), std::string("<none>"));
+    MSOLAP_CHECK_EQUAL(ConvertDecimal(-1, false, 0, 18, 0), std::string("<none>"));
+}
+
+static void TestConvertOADate() {
+    MSOLAP_CHECK_EQUAL(ConvertOADate(0), std::string("1899-12-30 00:00:00"));
+    MSOLAP_CHECK_EQUAL(ConvertOADate(1.5), std::string("1899-12-31 12:00:00"));
+    // The fraction is the time of day also for negative dates
+    MSOLAP_CHECK_EQUAL(ConvertOADate(-1.25), std::string("1899-12-29 06:00:00"));
+    MSOLAP_CHECK_EQUAL(ConvertOADate(25569), std::string("1970-01-01 00:00:00"));
+    MSOLAP_CHECK_EQUAL(ConvertOADate(25569.75), std::string("1970-01-01 18:00:00"));
+    MSOLAP_CHECK_EQUAL(ConvertOADate(45351.57291666667), std::string("2024-02-29 13:45:00"));
+    // Rounded to milliseconds
+    MSOLAP_CHECK_EQUAL(ConvertOADate(0.9999999999), std::string("1899-12-31 00:00:00"));
+    timestamp_t last;
+    MSOLAP_CHECK(MSOLAPConversion::TryConvertOADate(2958465.99999999, last));
+    MSOLAP_CHECK_EQUAL(last.value, int64_t(253402300799999000));
+    // The range of OLE automation dates, in the proleptic Gregorian calendar of DuckDB
+    MSOLAP_CHECK_EQUAL(ConvertOADate(-657435), std::string("0099-12-31 00:00:00"));
+    MSOLAP_CHECK_EQUAL(ConvertOADate(-657436), std::string("<none>"));
+    MSOLAP_CHECK_EQUAL(ConvertOADate(2958466), std::string("<none>"));
+    MSOLAP_CHECK_EQUAL(ConvertOADate(1.0 / 0.0), std::string("<none>"));
+}
+
+int main() {
+    TestParseDecimal();
+    TestConvertDecimal();
+    TestConvertOADate();
+    return msolap_test::Result("msolap_conversion_test");
+}
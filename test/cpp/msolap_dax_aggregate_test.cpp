@@ -0,0 +1,106 @@
+// Golden tests of the DAX generated for aggregates evaluated on the server (msolap_aggregate_pushdown). Runs
+// without a server:
+//
+//   make cpp_test
+
+#include "msolap_dax.hpp"
+#include "msolap_test.hpp"
+#include "duckdb/planner/filter/constant_filter.hpp"
+
+using namespace duckdb;
+
+struct Measure {
+    std::string dax;
+    bool never_blank;
+};
+
+static Measure Translate(const std::string &function_name, bool distinct, const std::string &column_reference,
+                         const LogicalType &type) {
+    Measure result;
+    result.never_blank = false;
+    result.dax =
+        MSOLAPDax::TranslateAggregate(function_name, distinct, "Sales", column_reference, type, result.never_blank);
+    return result;
+}
+
+static void TestTranslateAggregate() {
+    auto count_star = Translate("count_star", false, "", LogicalType::BIGINT);
+    MSOLAP_CHECK_EQUAL(count_star.dax, std::string("COUNTROWS(Sales) + 0"));
+    MSOLAP_CHECK(count_star.never_blank);
+
+    auto count = Translate("count", false, "'Sales'[CustomerKey]", LogicalType::BIGINT);
+    MSOLAP_CHECK_EQUAL(count.dax, std::string("COUNTA('Sales'[CustomerKey]) + 0"));
+    MSOLAP_CHECK(count.never_blank);
+    // BLANK is not a distinct value for DuckDB
+    auto count_distinct = Translate("count", true, "'Sales'[CustomerKey]", LogicalType::BIGINT);
+    MSOLAP_CHECK_EQUAL(count_distinct.dax, std::string("DISTINCTCOUNTNOBLANK('Sales'[CustomerKey]) + 0"));
+
+    auto sum = Translate("sum", false, "'Sales'[Amount]", LogicalType::DECIMAL(18, 4));
+    MSOLAP_CHECK_EQUAL(sum.dax, std::string("SUM('Sales'[Amount])"));
+    MSOLAP_CHECK(!sum.never_blank);
+    MSOLAP_CHECK_EQUAL(Translate("sum", true, "'Sales'[Amount]", LogicalType::DOUBLE).dax, std::string());
+
+    MSOLAP_CHECK_EQUAL(Translate("min", false, "'Sales'[Amount]", LogicalType::DOUBLE).dax,
+                       std::string("MIN('Sales'[Amount])"));
+    MSOLAP_CHECK_EQUAL(Translate("max", false, "'Sales'[OrderDate]", LogicalType::TIMESTAMP).dax,
+                       std::string("MAX('Sales'[OrderDate])"));
+    // Text is compared case-insensitively by the server
+    MSOLAP_CHECK_EQUAL(Translate("max", false, "'Sales'[Name]", LogicalType::VARCHAR).dax, std::string());
+    MSOLAP_CHECK_EQUAL(Translate("sum", false, "'Sales'[Name]", LogicalType::VARCHAR).dax, std::string());
+    MSOLAP_CHECK_EQUAL(Translate("avg", false, "'Sales'[Amount]", LogicalType::DOUBLE).dax, std::string());
+}
+
+static void TestSummarize() {
+    bool rows_column;
+    // GROUP BY with a measure that can be BLANK: groups without values are kept by counting their rows
+    auto table = MSOLAPDax::Summarize("Sales", {"'Sales'[Year]"}, {{"Aggregate1", "MAX('Sales'[OrderDate])"}}, "",
+                                      false, rows_column);
+    MSOLAP_CHECK_EQUAL(table, std::string("SUMMARIZECOLUMNS('Sales'[Year], \"Aggregate1\", MAX('Sales'[OrderDate]), "
+                                          "\"Rows\", COUNTROWS(Sales))"));
+    MSOLAP_CHECK(rows_column);
+
+    table = MSOLAPDax::Summarize("Sales", {"'Sales'[Year]", "'Sales'[Color]"},
+                                 {{"Aggregate1", "COUNTROWS(Sales) + 0"}, {"Aggregate2", "SUM('Sales'[Amount])"}},
+                                 "(NOT ISBLANK('Sales'[Year]) && 'Sales'[Year] > 2020)", true, rows_column);
+    MSOLAP_CHECK_EQUAL(table, std::string("SUMMARIZECOLUMNS('Sales'[Year], 'Sales'[Color], FILTER(Sales, (NOT "
+                                          "ISBLANK('Sales'[Year]) && 'Sales'[Year] > 2020)), \"Aggregate1\", "
+                                          "COUNTROWS(Sales) + 0, \"Aggregate2\", SUM('Sales'[Amount]))"));
+    MSOLAP_CHECK(!rows_column);
+
+    // The filter of an exactly translated predicate comes after the groups
+    std::string predicate;
+    MSOLAP_CHECK(MSOLAPDax::TryTranslateExactFilter(ConstantFilter(ExpressionType::COMPARE_EQUAL, Value::INTEGER(2024)),
+                                                    "'Sales'[Year]", LogicalType::INTEGER, predicate));
+    table = MSOLAPDax::Summarize("Sales", {"'Sales'[Color]"}, {{"Aggregate1", "MIN('Sales'[Amount])"}}, predicate,
+                                 false, rows_column);
+    MSOLAP_CHECK_EQUAL(table, std::string("SUMMARIZECOLUMNS('Sales'[Color], FILTER(Sales, (NOT ISBLANK('Sales'[Year]) "
+                                          "&& 'Sales'[Year] = 2024)), \"Aggregate1\", MIN('Sales'[Amount]), "
+                                          "\"Rows\", COUNTROWS(Sales))"));
+    MSOLAP_CHECK(rows_column);
+}
+
+// The summary replaces the table expression of the query, its ORDER BY refers to columns that are gone
+static void TestQuery() {
+    MSOLAPDaxQuery query;
+    MSOLAP_CHECK(MSOLAPDaxQuery::TryParse("DEFINE MEASURE Sales[Total] = SUM(Sales[Amount])\nEVALUATE Sales\n"
+                                          "ORDER BY Sales[Year]",
+                                          query));
+    MSOLAP_CHECK_EQUAL(query.GetModelTable(), std::string("Sales"));
+    bool never_blank = false;
+    auto measure = MSOLAPDax::TranslateAggregate("count", true, query.table, "'Sales'[CustomerKey]",
+                                                 LogicalType::BIGINT, never_blank);
+    bool rows_column;
+    auto table = MSOLAPDax::Summarize(query.table, {"'Sales'[Year]"}, {{"Aggregate1", measure}}, "", never_blank,
+                                      rows_column);
+    MSOLAP_CHECK_EQUAL(query.Build(table, false),
+                       std::string("DEFINE MEASURE Sales[Total] = SUM(Sales[Amount])\n"
+                                   "EVALUATE SUMMARIZECOLUMNS('Sales'[Year], \"Aggregate1\", "
+                                   "DISTINCTCOUNTNOBLANK('Sales'[CustomerKey]) + 0)"));
+}
+
+int main() {
+    TestTranslateAggregate();
+    TestSummarize();
+    TestQuery();
+    return msolap_test::Result("msolap_dax_aggregate_test");
+}
@@ -0,0 +1,227 @@
+// Golden tests of the DAX generated for the filters DuckDB pushes into msolap scans. Runs without a server:
+//
+//   make cpp_test
+
+#include "msolap_dax.hpp"
+#include "msolap_test.hpp"
+#include "duckdb/planner/filter/conjunction_filter.hpp"
+#include "duckdb/planner/filter/constant_filter.hpp"
+#include "duckdb/planner/filter/dynamic_filter.hpp"
+#include "duckdb/planner/filter/in_filter.hpp"
+#include "duckdb/planner/filter/null_filter.hpp"
+#include "duckdb/planner/filter/optional_filter.hpp"
+#include <limits>
+
+using namespace duckdb;
+
+static const std::string YEAR = "'Sales'[Year]";
+static const std::string NAME = "'Sales'[Name]";
+
+static unique_ptr<TableFilter> Compare(ExpressionType comparison, const Value &constant) {
+    return make_uniq<ConstantFilter>(comparison, constant);
+}
+
+static unique_ptr<TableFilter> In(vector<Value> values) {
+    return make_uniq<InFilter>(std::move(values));
+}
+
+static unique_ptr<TableFilter> Optional(unique_ptr<TableFilter> child) {
+    return make_uniq<OptionalFilter>(std::move(child));
+}
+
+template <class CONJUNCTION>
+static unique_ptr<TableFilter> Conjunction(unique_ptr<TableFilter> left, unique_ptr<TableFilter> right) {
+    auto result = make_uniq<CONJUNCTION>();
+    result->child_filters.push_back(std::move(left));
+    result->child_filters.push_back(std::move(right));
+    return std::move(result);
+}
+
+static unique_ptr<TableFilter> And(unique_ptr<TableFilter> left, unique_ptr<TableFilter> right) {
+    return Conjunction<ConjunctionAndFilter>(std::move(left), std::move(right));
+}
+
+static unique_ptr<TableFilter> Or(unique_ptr<TableFilter> left, unique_ptr<TableFilter> right) {
+    return Conjunction<ConjunctionOrFilter>(std::move(left), std::move(right));
+}
+
+// Exact translation, "<none>" if there is none
+static std::string Exact(const TableFilter &filter, const std::string &reference, const LogicalType &type) {
+    std::string result;
+    if (!MSOLAPDax::TryTranslateExactFilter(filter, reference, type, result)) {
+        return "<none>";
+    }
+    return result;
+}
+
+static void TestLiterals() {
+    auto literal = [](const Value &value) {
+        std::string result;
+        return MSOLAPDax::TryLiteral(value, result) ? result : "<none>";
+    };
+    MSOLAP_CHECK_EQUAL(literal(Value::INTEGER(-42)), std::string("-42"));
+    MSOLAP_CHECK_EQUAL(literal(Value::BOOLEAN(true)), std::string("TRUE()"));
+    MSOLAP_CHECK_EQUAL(literal(Value::DECIMAL(int64_t(123400), 18, 4)), std::string("12.3400"));
+    MSOLAP_CHECK_EQUAL(literal(Value::DOUBLE(0.1)), std::string("0.1"));
+    // Fixed notation where %g would use an exponent
+    MSOLAP_CHECK_EQUAL(literal(Value::DOUBLE(1e20)), std::string("100000000000000000000"));
+    MSOLAP_CHECK_EQUAL(literal(Value::DOUBLE(-1.5e-7)), std::string("-0.00000015"));
+    MSOLAP_CHECK_EQUAL(literal(Value::DOUBLE(123456.75)), std::string("123456.75"));
+    MSOLAP_CHECK_EQUAL(literal(Value::DOUBLE(1.25e5)), std::string("125000"));
+    MSOLAP_CHECK_EQUAL(literal(Value::DOUBLE(std::numeric_limits<double>::infinity())), std::string("<none>"));
+    MSOLAP_CHECK_EQUAL(literal(Value("it's \"red\"")), std::string("\"it's \"\"red\"\"\""));
+    MSOLAP_CHECK_EQUAL(literal(Value::DATE(2024, 1, 31)), std::string("DATE(2024, 1, 31)"));
+    MSOLAP_CHECK_EQUAL(literal(Value::TIMESTAMP(2024, 1, 31, 12, 30, 0, 0)),
+                       std::string("DATE(2024, 1, 31) + TIME(12, 30, 0)"));
+    MSOLAP_CHECK_EQUAL(literal(Value::TIMESTAMP(2024, 1, 31, 0, 0, 0, 0)), std::string("DATE(2024, 1, 31)"));
+    // TIME() has whole seconds only
+    MSOLAP_CHECK_EQUAL(literal(Value::TIMESTAMP(2024, 1, 31, 12, 30, 0, 500)), std::string("<none>"));
+    MSOLAP_CHECK_EQUAL(literal(Value(LogicalType::INTEGER)), std::string("<none>"));
+    MSOLAP_CHECK_EQUAL(literal(Value::UBIGINT(1)), std::string("<none>"));
+}
+
+static void TestTranslateFilter() {
+    auto integer = LogicalType::INTEGER;
+    auto text = LogicalType::VARCHAR;
+    MSOLAP_CHECK_EQUAL(MSOLAPDax::TranslateFilter(*Compare(ExpressionType::COMPARE_EQUAL, Value::INTEGER(2024)), YEAR,
+                                                  integer),
+                       std::string("'Sales'[Year] = 2024"));
+    MSOLAP_CHECK_EQUAL(MSOLAPDax::TranslateFilter(*Compare(ExpressionType::COMPARE_NOTEQUAL, Value::INTEGER(1)), YEAR,
+                                                  integer),
+                       std::string("'Sales'[Year] <> 1"));
+    MSOLAP_CHECK_EQUAL(MSOLAPDax::TranslateFilter(*Compare(ExpressionType::COMPARE_GREATERTHANOREQUALTO,
+                                                           Value::DATE(2024, 1, 31)),
+                                                  "'Sales'[OrderDate]", LogicalType::DATE),
+                       std::string("'Sales'[OrderDate] >= DATE(2024, 1, 31)"));
+    // Text is compared case-insensitively by DAX, only = keeps a superset of the rows
+    MSOLAP_CHECK_EQUAL(MSOLAPDax::TranslateFilter(*Compare(ExpressionType::COMPARE_EQUAL, Value("Red")), NAME, text),
+                       std::string("'Sales'[Name] = \"Red\""));
+    MSOLAP_CHECK_EQUAL(MSOLAPDax::TranslateFilter(*Compare(ExpressionType::COMPARE_LESSTHAN, Value("Red")), NAME, text),
+                       std::string());
+    MSOLAP_CHECK_EQUAL(MSOLAPDax::TranslateFilter(IsNullFilter(), YEAR, integer),
+                       std::string("ISBLANK('Sales'[Year])"));
+    MSOLAP_CHECK_EQUAL(MSOLAPDax::TranslateFilter(IsNotNullFilter(), YEAR, integer),
+                       std::string("NOT ISBLANK('Sales'[Year])"));
+    MSOLAP_CHECK_EQUAL(MSOLAPDax::TranslateFilter(*In({Value::INTEGER(1), Value::INTEGER(2), Value::INTEGER(3)}), YEAR,
+                                                  integer),
+                       std::string("'Sales'[Year] IN {1, 2, 3}"));
+    MSOLAP_CHECK_EQUAL(MSOLAPDax::TranslateFilter(*In({Value::DOUBLE(1), Value::DOUBLE(1e20)}), "'Sales'[Amount]",
+                                                  LogicalType::DOUBLE),
+                       std::string("'Sales'[Amount] IN {1, 100000000000000000000}"));
+
+    // BETWEEN
+    auto between = And(Compare(ExpressionType::COMPARE_GREATERTHANOREQUALTO, Value::INTEGER(2020)),
+                       Compare(ExpressionType::COMPARE_LESSTHANOREQUALTO, Value::INTEGER(2024)));
+    MSOLAP_CHECK_EQUAL(MSOLAPDax::TranslateFilter(*between, YEAR, integer),
+                       std::string("'Sales'[Year] >= 2020 && 'Sales'[Year] <= 2024"));
+    // Children of AND without a translation are left out
+    auto partial = And(Compare(ExpressionType::COMPARE_EQUAL, Value("Red")),
+                       Compare(ExpressionType::COMPARE_GREATERTHAN, Value("Blue")));
+    MSOLAP_CHECK_EQUAL(MSOLAPDax::TranslateFilter(*partial, NAME, text), std::string("'Sales'[Name] = \"Red\""));
+    // OR needs all of them
+    auto alternatives = Or(Compare(ExpressionType::COMPARE_EQUAL, Value::INTEGER(2010)), std::move(between));
+    MSOLAP_CHECK_EQUAL(MSOLAPDax::TranslateFilter(*alternatives, YEAR, integer),
+                       std::string("('Sales'[Year] = 2010 || ('Sales'[Year] >= 2020 && 'Sales'[Year] <= 2024))"));
+    auto untranslatable = Or(Compare(ExpressionType::COMPARE_EQUAL, Value("Red")),
+                             Compare(ExpressionType::COMPARE_GREATERTHAN, Value("Blue")));
+    MSOLAP_CHECK_EQUAL(MSOLAPDax::TranslateFilter(*untranslatable, NAME, text), std::string());
+
+    MSOLAP_CHECK_EQUAL(MSOLAPDax::TranslateFilter(*Optional(In({Value::INTEGER(7)})), YEAR, integer),
+                       std::string("'Sales'[Year] IN {7}"));
+    MSOLAP_CHECK_EQUAL(MSOLAPDax::TranslateFilter(OptionalFilter(), YEAR, integer), std::string());
+    MSOLAP_CHECK_EQUAL(MSOLAPDax::TranslateFilter(DynamicFilter(), YEAR, integer), std::string());
+}
+
+static void TestTranslateValueFilters() {
+    auto integer = LogicalType::INTEGER;
+    std::string predicate;
+    MSOLAP_CHECK_EQUAL(MSOLAPDax::TranslateValueFilters(*In({Value::INTEGER(1), Value::INTEGER(2)}), YEAR, integer,
+                                                        predicate),
+                       std::string("KEEPFILTERS(TREATAS({1, 2}, 'Sales'[Year]))"));
+    MSOLAP_CHECK_EQUAL(predicate, std::string());
+
+    // The keys of a join, with another filter on the same column
+    auto keys = And(Optional(In({Value("a"), Value("b")})), make_uniq<IsNotNullFilter>());
+    MSOLAP_CHECK_EQUAL(MSOLAPDax::TranslateValueFilters(*keys, NAME, LogicalType::VARCHAR, predicate),
+                       std::string("KEEPFILTERS(TREATAS({\"a\", \"b\"}, 'Sales'[Name]))"));
+    MSOLAP_CHECK_EQUAL(predicate, std::string("NOT ISBLANK('Sales'[Name])"));
+
+    // Anything else is a predicate
+    MSOLAP_CHECK_EQUAL(MSOLAPDax::TranslateValueFilters(*Compare(ExpressionType::COMPARE_GREATERTHAN,
+                                                                 Value::INTEGER(3)),
+                                                        YEAR, integer, predicate),
+                       std::string());
+    MSOLAP_CHECK_EQUAL(predicate, std::string("'Sales'[Year] > 3"));
+
+    // A list with a value without a literal is not pushed at all
+    MSOLAP_CHECK_EQUAL(MSOLAPDax::TranslateValueFilters(*In({Value::TIMESTAMP(2024, 1, 31, 12, 30, 0, 500)}),
+                                                        "'Sales'[OrderDate]", LogicalType::TIMESTAMP, predicate),
+                       std::string());
+    MSOLAP_CHECK_EQUAL(predicate, std::string());
+}
+
+static void TestTranslateExactFilter() {
+    auto integer = LogicalType::INTEGER;
+    auto text = LogicalType::VARCHAR;
+    // BLANK never matches a comparison, text is compared case-sensitively
+    MSOLAP_CHECK_EQUAL(Exact(*Compare(ExpressionType::COMPARE_EQUAL, Value::INTEGER(5)), YEAR, integer),
+                       std::string("(NOT ISBLANK('Sales'[Year]) && 'Sales'[Year] = 5)"));
+    MSOLAP_CHECK_EQUAL(Exact(*Compare(ExpressionType::COMPARE_EQUAL, Value("Red")), NAME, text),
+                       std::string("(NOT ISBLANK('Sales'[Name]) && EXACT('Sales'[Name], \"Red\"))"));
+    MSOLAP_CHECK_EQUAL(Exact(*Compare(ExpressionType::COMPARE_NOTEQUAL, Value("Red")), NAME, text),
+                       std::string("(NOT ISBLANK('Sales'[Name]) && NOT EXACT('Sales'[Name], \"Red\"))"));
+    MSOLAP_CHECK_EQUAL(Exact(*Compare(ExpressionType::COMPARE_LESSTHAN, Value("Red")), NAME, text),
+                       std::string("<none>"));
+    MSOLAP_CHECK_EQUAL(Exact(IsNullFilter(), YEAR, integer), std::string("ISBLANK('Sales'[Year])"));
+    MSOLAP_CHECK_EQUAL(Exact(*In({Value::INTEGER(1), Value::INTEGER(2)}), YEAR, integer),
+                       std::string("((NOT ISBLANK('Sales'[Year]) && 'Sales'[Year] = 1) || "
+                                   "(NOT ISBLANK('Sales'[Year]) && 'Sales'[Year] = 2))"));
+    MSOLAP_CHECK_EQUAL(Exact(*In({Value::TIMESTAMP(2024, 1, 31, 12, 30, 0, 500)}), "'Sales'[OrderDate]",
+                             LogicalType::TIMESTAMP),
+                       std::string("<none>"));
+
+    // Optional and dynamic filters do not change the result
+    auto with_optional =
+        And(Compare(ExpressionType::COMPARE_GREATERTHAN, Value::INTEGER(1)), Optional(In({Value::INTEGER(2)})));
+    MSOLAP_CHECK_EQUAL(Exact(*with_optional, YEAR, integer),
+                       std::string("((NOT ISBLANK('Sales'[Year]) && 'Sales'[Year] > 1))"));
+    auto with_dynamic = Or(Compare(ExpressionType::COMPARE_EQUAL, Value::INTEGER(1)), make_uniq<DynamicFilter>());
+    MSOLAP_CHECK_EQUAL(Exact(*with_dynamic, YEAR, integer), std::string());
+    auto alternatives = Or(Compare(ExpressionType::COMPARE_LESSTHAN, Value::INTEGER(2000)),
+                           Compare(ExpressionType::COMPARE_EQUAL, Value::INTEGER(2024)));
+    MSOLAP_CHECK_EQUAL(Exact(*alternatives, YEAR, integer),
+                       std::string("((NOT ISBLANK('Sales'[Year]) && 'Sales'[Year] < 2000) || "
+                                   "(NOT ISBLANK('Sales'[Year]) && 'Sales'[Year] = 2024))"));
+}
+
+// The translated filters wrapped around the table expression of a query, keeping its definitions and order
+static void TestQuery() {
+    MSOLAPDaxQuery query;
+    MSOLAP_CHECK(MSOLAPDaxQuery::TryParse("DEFINE VAR Y = 2024 // current\nEVALUATE 'Sales' ORDER BY 'Sales'[Year]",
+                                          query));
+    MSOLAP_CHECK_EQUAL(query.GetModelTable(), std::string("Sales"));
+    std::string predicate;
+    auto filter = And(In({Value::INTEGER(1), Value::INTEGER(2)}),
+                      Compare(ExpressionType::COMPARE_NOTEQUAL, Value::INTEGER(3)));
+    auto arguments = MSOLAPDax::TranslateValueFilters(*filter, YEAR, LogicalType::INTEGER, predicate);
+    auto table = "FILTER(CALCULATETABLE(" + query.table + ", " + arguments + "), " + predicate + ")";
+    MSOLAP_CHECK_EQUAL(query.Build(table),
+                       std::string("DEFINE VAR Y = 2024\n"
+                                   "EVALUATE FILTER(CALCULATETABLE('Sales', KEEPFILTERS(TREATAS({1, 2}, "
+                                   "'Sales'[Year]))), 'Sales'[Year] <> 3)\n"
+                                   "ORDER BY 'Sales'[Year]"));
+
+    // Only a single EVALUATE statement is rewritten
+    MSOLAP_CHECK(!MSOLAPDaxQuery::TryParse("EVALUATE 'Sales' EVALUATE 'Product'", query));
+    MSOLAP_CHECK(MSOLAPDaxQuery::TryParse("EVALUATE FILTER('Sales', [Year] = 2024)", query));
+    MSOLAP_CHECK_EQUAL(query.GetModelTable(), std::string());
+}
+
+int main() {
+    TestLiterals();
+    TestTranslateFilter();
+    TestTranslateValueFilters();
+    TestTranslateExactFilter();
+    TestQuery();
+    return msolap_test::Result("msolap_dax_filter_test");
+}
@@ -0,0 +1,345 @@
+// Byte-level tests of the XPRESS, binary XML and entity decoders of XMLA responses, with fixed inputs and with corrupt
+// and truncated ones that have to fail with an error instead of reading past their input. Runs without a server:
+//
+//   make cpp_test
+
+#include "msolap_binary_xml.hpp"
+#include "msolap_xml_reader.hpp"
+#include "msolap_xpress.hpp"
+#include "msolap_test.hpp"
+#include <algorithm>
+#include <vector>
+
+using namespace duckdb;
+
+using Bytes = std::vector<uint8_t>;
+
+// Stream over a byte vector handing out at most chunk_size bytes per read, so that decoders see their input
+// split at every position
+class ChunkedStream : public MSOLAPInputStream {
+public:
+    ChunkedStream(Bytes data, idx_t chunk_size) : data(std::move(data)), chunk_size(chunk_size), position(0) {
+    }
+
+    idx_t Read(char *buffer, idx_t length) override {
+        auto count = MinValue<idx_t>(MinValue<idx_t>(length, chunk_size), data.size() - position);
+        std::copy(data.begin() + position, data.begin() + position + count, buffer);
+        position += count;
+        return count;
+    }
+
+private:
+    Bytes data;
+    idx_t chunk_size;
+    idx_t position;
+};
+
+static void Append(Bytes &target, const Bytes &bytes) {
+    target.insert(target.end(), bytes.begin(), bytes.end());
+}
+
+static void AppendLE32(Bytes &target, uint32_t value) {
+    for (idx_t i = 0; i < 4; i++) {
+        target.push_back(uint8_t(value >> (8 * i)));
+    }
+}
+
+// Decompress a single block into exactly output_size bytes. The input is copied so that reading past its end is
+// caught by the address sanitizer.
+static std::string Decompress(const Bytes &input, idx_t output_size) {
+    std::unique_ptr<uint8_t[]> copy(new uint8_t[input.size()]);
+    std::copy(input.begin(), input.end(), copy.get());
+    std::string output(output_size, '\0');
+    MSOLAPXpressStream::Decompress(copy.get(), input.size(), (uint8_t *)&output[0], output_size);
+    return output;
+}
+
+// Read a whole XPRESS stream
+static std::string Inflate(const Bytes &data, idx_t chunk_size) {
+    ChunkedStream source(data, chunk_size);
+    MSOLAPXpressStream stream(source);
+    std::string result;
+    char buffer[7];
+    while (auto count = stream.Read(buffer, sizeof(buffer))) {
+        result.append(buffer, count);
+    }
+    return result;
+}
+
+static void TestXpressBlocks() {
+    // Flags of 32 literals, then the literals
+    MSOLAP_CHECK_EQUAL(Decompress({0x00, 0x00, 0x00, 0x00, 'a', 'b', 'c'}, 3), std::string("abc"));
+    // Three literals, then a match of length 6 at offset 3: ((3 - 1) << 3) | (6 - 3)
+    MSOLAP_CHECK_EQUAL(Decompress({0x00, 0x00, 0x00, 0x10, 'a', 'b', 'c', 0x13, 0x00}, 9), std::string("abcabcabc"));
+    // Matches overlapping their output: length 7 + 10 from the half byte
+    MSOLAP_CHECK_EQUAL(Decompress({0x00, 0x00, 0x00, 0x40, 'a', 0x07, 0x00, 0x0A}, 21), std::string(21, 'a'));
+    // Two matches sharing the half byte: 7 + 2 and 7 + 1
+    MSOLAP_CHECK_EQUAL(Decompress({0x00, 0x00, 0x00, 0x60, 'a', 0x07, 0x00, 0x12, 0x07, 0x00}, 24),
+                       std::string(24, 'a'));
+    // Length 15 + 7 + 3 + the next byte (75)
+    MSOLAP_CHECK_EQUAL(Decompress({0x00, 0x00, 0x00, 0x40, 'x', 0x07, 0x00, 0x0F, 0x4B}, 101), std::string(101, 'x'));
+    // Byte 255: the length follows as 16 bits (997 + 3)
+    MSOLAP_CHECK_EQUAL(Decompress({0x00, 0x00, 0x00, 0x40, 'x', 0x07, 0x00, 0x0F, 0xFF, 0xE5, 0x03}, 1001),
+                       std::string(1001, 'x'));
+    // 16 bits 0: the length follows as 32 bits (69997 + 3)
+    MSOLAP_CHECK_EQUAL(
+        Decompress({0x00, 0x00, 0x00, 0x40, 'x', 0x07, 0x00, 0x0F, 0xFF, 0x00, 0x00, 0x6D, 0x11, 0x01, 0x00}, 70001),
+        std::string(70001, 'x'));
+    // More than 32 literals read the next flags
+    Bytes literals {0x00, 0x00, 0x00, 0x00};
+    std::string expected;
+    for (idx_t i = 0; i < 32; i++) {
+        literals.push_back(uint8_t('A' + i % 26));
+        expected += char('A' + i % 26);
+    }
+    Append(literals, {0x00, 0x00, 0x00, 0x00, '!'});
+    MSOLAP_CHECK_EQUAL(Decompress(literals, 33), expected + "!");
+}
+
+static void TestCorruptXpressBlocks() {
+    MSOLAP_CHECK_THROWS(Decompress({}, 1), "Corrupt XPRESS block");
+    MSOLAP_CHECK_THROWS(Decompress({0x00, 0x00, 0x00}, 1), "Corrupt XPRESS block");
+    // Fewer literals than output
+    MSOLAP_CHECK_THROWS(Decompress({0x00, 0x00, 0x00, 0x00, 'a', 'b'}, 3), "Corrupt XPRESS block");
+    // Match before the start of the output
+    MSOLAP_CHECK_THROWS(Decompress({0x00, 0x00, 0x00, 0x40, 'a', 0x20, 0x00}, 4), "Corrupt XPRESS block");
+    MSOLAP_CHECK_THROWS(Decompress({0x00, 0x00, 0x00, 0x80, 0x00, 0x00}, 3), "Corrupt XPRESS block");
+    // Match past the end of the output
+    MSOLAP_CHECK_THROWS(Decompress({0x00, 0x00, 0x00, 0x40, 'a', 0x07, 0x00, 0x0A}, 20), "Corrupt XPRESS block");
+    // Truncated match and extended lengths
+    MSOLAP_CHECK_THROWS(Decompress({0x00, 0x00, 0x00, 0x40, 'a', 0x07}, 21), "Corrupt XPRESS block");
+    MSOLAP_CHECK_THROWS(Decompress({0x00, 0x00, 0x00, 0x40, 'a', 0x07, 0x00}, 21), "Corrupt XPRESS block");
+    MSOLAP_CHECK_THROWS(Decompress({0x00, 0x00, 0x00, 0x40, 'x', 0x07, 0x00, 0x0F}, 101), "Corrupt XPRESS block");
+    MSOLAP_CHECK_THROWS(Decompress({0x00, 0x00, 0x00, 0x40, 'x', 0x07, 0x00, 0x0F, 0xFF, 0xE5}, 1001),
+                        "Corrupt XPRESS block");
+    MSOLAP_CHECK_THROWS(Decompress({0x00, 0x00, 0x00, 0x40, 'x', 0x07, 0x00, 0x0F, 0xFF, 0x00, 0x00, 0x6D}, 70001),
+                        "Corrupt XPRESS block");
+    // A 16 bit length shorter than the lengths it extends
+    MSOLAP_CHECK_THROWS(Decompress({0x00, 0x00, 0x00, 0x40, 'x', 0x07, 0x00, 0x0F, 0xFF, 0x05, 0x00}, 30),
+                        "Corrupt XPRESS block");
+    // A 32 bit length beyond any output
+    MSOLAP_CHECK_THROWS(
+        Decompress({0x00, 0x00, 0x00, 0x40, 'x', 0x07, 0x00, 0x0F, 0xFF, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF}, 100),
+        "Corrupt XPRESS block");
+}
+
+static void TestXpressStream() {
+    Bytes data;
+    // Stored block: the compressed size equals the uncompressed size
+    AppendLE32(data, 5);
+    AppendLE32(data, 5);
+    Append(data, {'h', 'e', 'l', 'l', 'o'});
+    // Compressed block: "abc" and a match of 7 + 2 + 3 at offset 3
+    AppendLE32(data, 15);
+    AppendLE32(data, 10);
+    Append(data, {0x00, 0x00, 0x00, 0x10, 'a', 'b', 'c', 0x17, 0x00, 0x02});
+    // Empty block
+    AppendLE32(data, 0);
+    AppendLE32(data, 0);
+    MSOLAP_CHECK_EQUAL(Inflate(data, 1 << 20), std::string("helloabcabcabcabcabc"));
+    MSOLAP_CHECK_EQUAL(Inflate(data, 1), std::string("helloabcabcabcabcabc"));
+    MSOLAP_CHECK_EQUAL(Inflate({}, 1), std::string());
+}
+
+static void TestCorruptXpressStream() {
+    // Truncated header
+    MSOLAP_CHECK_THROWS(Inflate({0x05, 0x00, 0x00, 0x00}, 1), "Unexpected end");
+    // Truncated stored and compressed blocks
+    MSOLAP_CHECK_THROWS(Inflate({0x05, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 'h', 'e'}, 3), "Unexpected end");
+    MSOLAP_CHECK_THROWS(Inflate({0x09, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x00, 0x00}, 3), "Unexpected end");
+    MSOLAP_CHECK_THROWS(Inflate({0x09, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00}, 3), "Corrupt XPRESS block");
+    // Compressed size larger than the block, block larger than any block a server sends
+    MSOLAP_CHECK_THROWS(Inflate({0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 'a', 'b'}, 3),
+                        "Corrupt XPRESS block");
+    MSOLAP_CHECK_THROWS(Inflate({0xFF, 0xFF, 0xFF, 0x7F, 0x00, 0x00, 0x00, 0x00}, 3), "Corrupt XPRESS block");
+}
+
+// Binary XML document: the header, then the tokens
+static Bytes Document(const Bytes &tokens) {
+    Bytes result {0xDF, 0xFF, 0x01, 0xB0, 0x04};
+    Append(result, tokens);
+    return result;
+}
+
+// Length prefixed UTF-16LE text
+static Bytes Text(const std::u16string &text) {
+    Bytes result {uint8_t(text.size())};
+    for (auto unit : text) {
+        result.push_back(uint8_t(unit));
+        result.push_back(uint8_t(unit >> 8));
+    }
+    return result;
+}
+
+// Name table entries: name 1 is "row", name 2 is "a", and a qualified name for each
+static Bytes Names() {
+    Bytes result {0xF0};
+    Append(result, Text(u"row"));
+    Append(result, {0xEF, 0x00, 0x00, 0x01, 0xF0});
+    Append(result, Text(u"a"));
+    Append(result, {0xEF, 0x00, 0x00, 0x02});
+    return result;
+}
+
+// The nodes of a document, one line each
+static std::string ReadNodes(const Bytes &document, idx_t chunk_size) {
+    ChunkedStream stream(document, chunk_size);
+    MSOLAPBinaryXMLReader reader(stream);
+    std::string result;
+    while (true) {
+        switch (reader.Next()) {
+        case XMLNodeType::START_ELEMENT: {
+            result += "<" + reader.Name();
+            auto attribute = reader.GetAttribute("a");
+            if (attribute) {
+                result += " a=" + *attribute;
+            }
+            result += ">\n";
+            break;
+        }
+        case XMLNodeType::END_ELEMENT:
+            result += "</" + reader.Name() + ">\n";
+            break;
+        case XMLNodeType::TEXT:
+            result += reader.Text() + "\n";
+            break;
+        case XMLNodeType::END_OF_DOCUMENT:
+            return result;
+        }
+    }
+}
+
+static void TestBinaryXML() {
+    auto tokens = Names();
+    // <row a="42"> with an int atom as the attribute value
+    Append(tokens, {0xF8, 0x01, 0xF6, 0x02, 0x02, 0x2A, 0x00, 0x00, 0x00, 0xF5});
+    // nvarchar with a surrogate pair
+    tokens.push_back(0x11);
+    Append(tokens, Text(u"hé \U0001F600"));
+    // smallint -2, bigint -5000000000, tinyint 200, byte -1
+    Append(tokens, {0x01, 0xFE, 0xFF});
+    Append(tokens, {0x08, 0x00, 0x0E, 0xFA, 0xD5, 0xFE, 0xFF, 0xFF, 0xFF});
+    Append(tokens, {0x07, 0xC8, 0x88, 0xFF});
+    // unsignedShort 65535, unsignedInt 4000000000, unsignedLong 2^64 - 1
+    Append(tokens, {0x89, 0xFF, 0xFF, 0x8A, 0x00, 0x28, 0x6B, 0xEE});
+    Append(tokens, {0x8B, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
+    // real 1.5, float -0.25
+    Append(tokens, {0x03, 0x00, 0x00, 0xC0, 0x3F});
+    Append(tokens, {0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xD0, 0xBF});
+    // money -1234.5678 (high 32 bits first), smallmoney 12.5
+    Append(tokens, {0x05, 0xFF, 0xFF, 0xFF, 0xFF, 0xB2, 0x9E, 0x43, 0xFF});
+    Append(tokens, {0x14, 0x48, 0xE8, 0x01, 0x00});
+    // bit, boolean
+    Append(tokens, {0x06, 0x01, 0x86, 0x00});
+    // datetime 1970-01-01 00:00:01 (days since 1900 and 1/300 s), smalldatetime 1970-01-02 01:30
+    Append(tokens, {0x12, 0xDF, 0x63, 0x00, 0x00, 0x2C, 0x01, 0x00, 0x00});
+    Append(tokens, {0x13, 0xE0, 0x63, 0x5A, 0x00});
+    // uuid 00112233-4455-6677-8899-aabbccddeeff, the first three groups little endian
+    Append(tokens, {0x09, 0x33, 0x22, 0x11, 0x00, 0x55, 0x44, 0x77, 0x66, 0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD,
+                    0xEE, 0xFF});
+    // Comment, processing instruction and extension are skipped, CDATA is text
+    tokens.push_back(0xF3);
+    Append(tokens, Text(u"comment"));
+    Append(tokens, {0xF4, 0x01});
+    Append(tokens, Text(u"pi"));
+    Append(tokens, {0xEA, 0x02, 0x00, 0x00, 0xF2});
+    Append(tokens, Text(u"<cdata>"));
+    Append(tokens, {0xF1, 0xF7});
+
+    std::string expected = "<row a=42>\n"
+                           "h\xC3\xA9 \xF0\x9F\x98\x80\n"
+                           "-2\n-5000000000\n200\n-1\n"
+                           "65535\n4000000000\n18446744073709551615\n"
+                           "1.5\n-0.25\n"
+                           "-1234.5678\n12.5000\n"
+                           "true\nfalse\n"
+                           "1970-01-01 00:00:01\n1970-01-02 01:30:00\n"
+                           "00112233-4455-6677-8899-aabbccddeeff\n"
+                           "<cdata>\n"
+                           "</row>\n";
+    MSOLAP_CHECK_EQUAL(ReadNodes(Document(tokens), 1 << 20), expected);
+    // Split at every byte, the surrogate pair is split between reads
+    MSOLAP_CHECK_EQUAL(ReadNodes(Document(tokens), 1), expected);
+    MSOLAP_CHECK_EQUAL(ReadNodes(Document(tokens), 3), expected);
+
+    // Unpaired surrogates become U+FFFD
+    auto unpaired = Names();
+    Append(unpaired, {0xF8, 0x01, 0xF5, 0x11, 0x02, 0x3D, 0xD8, 0x61, 0x00, 0xF7});
+    MSOLAP_CHECK_EQUAL(ReadNodes(Document(unpaired), 1), std::string("<row>\n\xEF\xBF\xBD" "a\n</row>\n"));
+
+    // Flushed names are defined again
+    auto flushed = Names();
+    Append(flushed, {0xF8, 0x01, 0xF5, 0xF7, 0xE9, 0xF0});
+    Append(flushed, Text(u"next"));
+    Append(flushed, {0xEF, 0x00, 0x00, 0x01, 0xF8, 0x01, 0xF5, 0xF7});
+    MSOLAP_CHECK_EQUAL(ReadNodes(Document(flushed), 2), std::string("<row>\n</row>\n<next>\n</next>\n"));
+}
+
+static void TestCorruptBinaryXML() {
+    // Signature, version and encoding of the header
+    MSOLAP_CHECK_THROWS(ReadNodes({0xDF, 0xFE, 0x01, 0xB0, 0x04}, 1), "Invalid binary XMLA response signature");
+    MSOLAP_CHECK_THROWS(ReadNodes({0xDF, 0xFF, 0x03, 0xB0, 0x04}, 1), "Unsupported binary XML version");
+    MSOLAP_CHECK_THROWS(ReadNodes({0xDF, 0xFF, 0x01, 0xE9, 0xFD}, 1), "Unsupported binary XML encoding");
+    MSOLAP_CHECK_THROWS(ReadNodes({0xDF, 0xFF, 0x01}, 1), "Unexpected end");
+    // Names that were never defined, or were flushed
+    MSOLAP_CHECK_THROWS(ReadNodes(Document({0xF8, 0x01, 0xF5}), 1), "Undefined name");
+    MSOLAP_CHECK_THROWS(ReadNodes(Document({0xEF, 0x00, 0x00, 0x07}), 1), "Undefined name");
+    auto flushed = Names();
+    Append(flushed, {0xE9, 0xF8, 0x01, 0xF5});
+    MSOLAP_CHECK_THROWS(ReadNodes(Document(flushed), 1), "Undefined name");
+    // End element without a start element
+    MSOLAP_CHECK_THROWS(ReadNodes(Document({0xF7}), 1), "Unbalanced end element");
+    // Unknown tokens
+    MSOLAP_CHECK_THROWS(ReadNodes(Document({0x55}), 1), "Unsupported token 0x55");
+    // Lengths of more than 32 bits
+    MSOLAP_CHECK_THROWS(ReadNodes(Document({0x11, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01}), 1), "Invalid length");
+
+    // Truncated anywhere, the document ends or fails without reading past its end
+    auto tokens = Names();
+    Append(tokens, {0xF8, 0x01, 0xF6, 0x02, 0x08, 0x00, 0x0E, 0xFA, 0xD5, 0xFE, 0xFF, 0xFF, 0xFF, 0xF5, 0x11});
+    Append(tokens, Text(u"\U0001F600"));
+    Append(tokens, {0x12, 0xDF, 0x63, 0x00, 0x00, 0x2C, 0x01, 0x00, 0x00});
+    auto document = Document(tokens);
+    for (idx_t length = 0; length < document.size(); length++) {
+        Bytes prefix(document.begin(), document.begin() + length);
+        try {
+            // Ending after a complete token is the end of the document
+            ReadNodes(prefix, 1);
+        } catch (std::exception &e) {
+            MSOLAP_CHECK(std::string(e.what()).find("Unexpected end") != std::string::npos);
+        }
+    }
+}
+
+static std::string DecodeEntities(const std::string &text) {
+    std::string result;
+    MSOLAPXMLReader::DecodeEntities(text.data(), text.size(), result);
+    return result;
+}
+
+static void TestEntities() {
+    MSOLAP_CHECK_EQUAL(DecodeEntities("a &lt; b &amp;&amp; &#65;&#x42;&#X1F600;"), "a < b && AB\xF0\x9F\x98\x80");
+    // Unknown entities are kept
+    MSOLAP_CHECK_EQUAL(DecodeEntities("&nbsp;"), "&nbsp;");
+    // Character references without digits, with other characters or beyond the last code point
+    MSOLAP_CHECK_THROWS(DecodeEntities("&#;"), "Malformed character reference &#;");
+    MSOLAP_CHECK_THROWS(DecodeEntities("&#x;"), "Malformed character reference &#x;");
+    MSOLAP_CHECK_THROWS(DecodeEntities("&#12a;"), "Malformed character reference");
+    MSOLAP_CHECK_THROWS(DecodeEntities("&#x110000;"), "Malformed character reference");
+    MSOLAP_CHECK_THROWS(DecodeEntities("&#99999999999999999999;"), "Malformed character reference");
+    MSOLAP_CHECK_THROWS(DecodeEntities("&#xD800;"), "Malformed character reference");
+    // Names escaped beyond the last code point are not escapes
+    MSOLAP_CHECK_EQUAL(MSOLAPXMLReader::DecodeName("_x0041_"), "A");
+    MSOLAP_CHECK_EQUAL(MSOLAPXMLReader::DecodeName("_xFFFFFFFF_"), "_xFFFFFFFF_");
+}
+
+int main() {
+    TestXpressBlocks();
+    TestCorruptXpressBlocks();
+    TestXpressStream();
+    TestCorruptXpressStream();
+    TestBinaryXML();
+    TestCorruptBinaryXML();
+    TestEntities();
+    return msolap_test::Result("msolap_decoder_test");
+}
@@ -0,0 +1,205 @@
+// Tests of a result shared by concurrent scans, with a synthetic row source. Checks that the spool stays bounded
+// when a scan stops reading, that scans reading at different rates share one evaluation without waiting for each
+// other, the chunks the slower scan still needs going to the spill file. Runs without a server:
+//
+//   make cpp_test
+
+#include "msolap_single_flight.hpp"
+#include "msolap_test.hpp"
+#include <chrono>
+#include <thread>
+
+using namespace duckdb;
+
+// Rows 0, 1, 2, ... in chunks of 2048, starting from another row on every evaluation, like a server returning the
+// rows of a query without ORDER BY in any order
+class RotatingRowset : public MSOLAPRowset {
+public:
+    RotatingRowset(idx_t chunk_count, idx_t evaluation)
+        : chunk_count(chunk_count), first(evaluation * 1000), fetched(0) {
+    }
+
+    void GetColumnInfo(std::vector<std::string> &names, std::vector<LogicalType> &types) override {
+        names = {"Fake[Row]"};
+        types = {LogicalType::BIGINT};
+    }
+
+    idx_t Fetch(DataChunk &output) override {
+        if (fetched == chunk_count) {
+            output.SetCardinality(0);
+            return 0;
+        }
+        auto data = FlatVector::GetData<int64_t>(output.data[0]);
+        for (idx_t i = 0; i < STANDARD_VECTOR_SIZE; i++) {
+            data[i] = int64_t((first + fetched * STANDARD_VECTOR_SIZE + i) % (chunk_count * STANDARD_VECTOR_SIZE));
+        }
+        fetched++;
+        output.SetCardinality(STANDARD_VECTOR_SIZE);
+        return STANDARD_VECTOR_SIZE;
+    }
+
+private:
+    idx_t chunk_count;
+    idx_t first;
+    idx_t fetched;
+};
+
+// A scan of the shared result, checking it gets every row of one evaluation exactly once
+struct Scan {
+    Scan(unique_ptr<MSOLAPSharedRowset> rowset_p, idx_t chunk_count)
+        : rowset(std::move(rowset_p)), seen(chunk_count * STANDARD_VECTOR_SIZE, false), rows(0), correct(true) {
+        chunk.Initialize(Allocator::DefaultAllocator(), {LogicalType::BIGINT});
+    }
+
+    // Read up to chunk_count chunks, false once the rowset is exhausted
+    bool Read(idx_t chunk_count) {
+        for (idx_t i = 0; i < chunk_count; i++) {
+            // Like the scanner, the chunk may reference the spool
+            chunk.Reset();
+            auto count = rowset->Fetch(chunk);
+            if (count == 0) {
+                return false;
+            }
+            chunk.Flatten();
+            auto data = FlatVector::GetData<int64_t>(chunk.data[0]);
+            for (idx_t row = 0; row < count; row++) {
+                correct = correct && !seen[data[row]];
+                seen[data[row]] = true;
+            }
+            rows += count;
+        }
+        return true;
+    }
+
+    bool Complete() const {
+        return correct && rows == seen.size();
+    }
+
+    unique_ptr<MSOLAPSharedRowset> rowset;
+    DataChunk chunk;
+    std::vector<bool> seen;
+    idx_t rows;
+    bool correct;
+};
+
+static unique_ptr<MSOLAPSharedRowset> Subscribe(ClientContext &context, shared_ptr<MSOLAPSharedResult> &result) {
+    idx_t subscriber;
+    MSOLAP_CHECK(result->Subscribe(context, subscriber));
+    return make_uniq<MSOLAPSharedRowset>(result, subscriber);
+}
+
+static shared_ptr<MSOLAPSharedResult> MakeResult(ClientContext &context, idx_t chunk_count,
+                                                 std::atomic<idx_t> &opened) {
+    auto open = [&opened, chunk_count]() -> unique_ptr<MSOLAPRowset> {
+        return make_uniq<RotatingRowset>(chunk_count, opened++);
+    };
+    return make_shared_ptr<MSOLAPSharedResult>(context, open);
+}
+
+// One scan reads the whole result before the other starts (like the probe side of a join waiting for the build
+// side). The spool does not keep the whole result, the other scan evaluates the query on its own.
+static void TestUnreadScanDetached(ClientContext &context) {
+    const idx_t chunk_count = MSOLAPSharedResult::MAX_SPOOL_CHUNKS * 3;
+    std::atomic<idx_t> opened(0);
+    auto result = MakeResult(context, chunk_count, opened);
+    Scan reading(Subscribe(context, result), chunk_count);
+    Scan waiting(Subscribe(context, result), chunk_count);
+    result.reset();
+
+    while (reading.Read(1)) {
+    }
+    MSOLAP_CHECK(reading.Complete());
+    MSOLAP_CHECK_EQUAL(opened.load(), idx_t(1));
+
+    while (waiting.Read(1)) {
+    }
+    MSOLAP_CHECK(waiting.rowset->GetResult() == nullptr);
+    MSOLAP_CHECK(waiting.Complete());
+    MSOLAP_CHECK_EQUAL(opened.load(), idx_t(2));
+}
+
+// A scan that read part of the result and stops reading for a while (the other side of a self join waiting for
+// this one) does not hold up the other scan. It reads the chunks it missed from the spill file afterwards, both
+// read the single evaluation.
+static void TestStoppedScanSpilled(ClientContext &context) {
+    const idx_t chunk_count = MSOLAPSharedResult::MAX_SPOOL_CHUNKS * 3;
+    std::atomic<idx_t> opened(0);
+    auto result = MakeResult(context, chunk_count, opened);
+    Scan stopped(Subscribe(context, result), chunk_count);
+    Scan reading(Subscribe(context, result), chunk_count);
+
+    MSOLAP_CHECK(stopped.Read(1));
+    while (reading.Read(1)) {
+    }
+    MSOLAP_CHECK(reading.Complete());
+    MSOLAP_CHECK_EQUAL(result->GetSpilledChunks(), chunk_count - MSOLAPSharedResult::MAX_SPOOL_CHUNKS);
+
+    while (stopped.Read(1)) {
+    }
+    MSOLAP_CHECK(stopped.Complete());
+    MSOLAP_CHECK(stopped.rowset->GetResult() != nullptr);
+    MSOLAP_CHECK_EQUAL(opened.load(), idx_t(1));
+}
+
+// Two scans on their own threads, one reading much slower than the other. Neither waits for the other, both get
+// every row of the single evaluation.
+static void TestScansAtDifferentRates(ClientContext &context) {
+    const idx_t chunk_count = MSOLAPSharedResult::MAX_SPOOL_CHUNKS * 3;
+    std::atomic<idx_t> opened(0);
+    auto result = MakeResult(context, chunk_count, opened);
+    Scan slow(Subscribe(context, result), chunk_count);
+    Scan fast(Subscribe(context, result), chunk_count);
+
+    MSOLAP_CHECK(slow.Read(1));
+    std::atomic<bool> fast_done(false);
+    std::thread fast_thread([&]() {
+        while (fast.Read(1)) {
+        }
+        fast_done = true;
+    });
+    idx_t slow_reads_before_fast_done = 0;
+    while (slow.Read(1)) {
+        if (!fast_done) {
+            slow_reads_before_fast_done++;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    fast_thread.join();
+    MSOLAP_CHECK(slow.Complete());
+    MSOLAP_CHECK(fast.Complete());
+    // The fast scan finished long before the slow one
+    MSOLAP_CHECK(slow_reads_before_fast_done < chunk_count - 1);
+    MSOLAP_CHECK(slow.rowset->GetResult() != nullptr);
+    MSOLAP_CHECK(fast.rowset->GetResult() != nullptr);
+    MSOLAP_CHECK_EQUAL(opened.load(), idx_t(1));
+}
+
+// Scans reading close enough to each other share one evaluation
+static void TestScansShare(ClientContext &context) {
+    const idx_t chunk_count = MSOLAPSharedResult::MAX_SPOOL_CHUNKS * 3;
+    std::atomic<idx_t> opened(0);
+    auto result = MakeResult(context, chunk_count, opened);
+    Scan first(Subscribe(context, result), chunk_count);
+    Scan second(Subscribe(context, result), chunk_count);
+    result.reset();
+
+    bool reading = true;
+    while (reading) {
+        reading = first.Read(MSOLAPSharedResult::MAX_SPOOL_CHUNKS / 2);
+        reading = second.Read(MSOLAPSharedResult::MAX_SPOOL_CHUNKS / 2) || reading;
+    }
+    MSOLAP_CHECK(first.Complete());
+    MSOLAP_CHECK(second.Complete());
+    MSOLAP_CHECK(second.rowset->GetResult() != nullptr);
+    MSOLAP_CHECK_EQUAL(opened.load(), idx_t(1));
+}
+
+int main() {
+    DuckDB db(nullptr);
+    Connection connection(db);
+    TestUnreadScanDetached(*connection.context);
+    TestStoppedScanSpilled(*connection.context);
+    TestScansAtDifferentRates(*connection.context);
+    TestScansShare(*connection.context);
+    return msolap_test::Result("msolap_single_flight_test");
+}
@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// msolap_test.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+// Checks shared by the standalone C++ tests in this directory. Every test is a program that prints the checks
+// that failed and exits with the number of failures, so it runs without a test framework or a server. The tests
+// are listed in MSOLAP_CPP_TESTS in CMakeLists.txt and run by CTest (`make cpp_test`).
+
+#pragma once
+
+#include <cstdio>
+#include <exception>
+#include <string>
+
+namespace msolap_test {
+
+inline int &Failures() {
+    static int failures = 0;
+    return failures;
+}
+
+inline void Fail(const char *file, int line, const std::string &message) {
+    printf("%s:%d: %s\n", file, line, message.c_str());
+    Failures()++;
+}
+
+inline std::string Describe(const std::string &value) {
+    return "\"" + value + "\"";
+}
+
+inline std::string Describe(const char *value) {
+    return Describe(std::string(value));
+}
+
+template <class T>
+std::string Describe(T value) {
+    return std::to_string(value);
+}
+
+// Exit code of the test program
+inline int Result(const char *name) {
+    if (Failures() == 0) {
+        printf("%s: all checks passed\n", name);
+    } else {
+        printf("%s: %d checks failed\n", name, Failures());
+    }
+    return Failures();
+}
+
+} // namespace msolap_test
+
+#define MSOLAP_CHECK(condition)                                                                                        \
+    do {                                                                                                               \
+        try {                                                                                                          \
+            if (!(condition)) {                                                                                        \
+                msolap_test::Fail(__FILE__, __LINE__, "check failed: " #condition);                                    \
+            }                                                                                                          \
+        } catch (std::exception & e) {                                                                                 \
+            msolap_test::Fail(__FILE__, __LINE__, std::string("unexpected error in " #condition ": ") + e.what());     \
+        }                                                                                                              \
+    } while (0)
+
+#define MSOLAP_CHECK_EQUAL(actual, expected)                                                                           \
+    do {                                                                                                               \
+        try {                                                                                                          \
+            auto actual_value = (actual);                                                                              \
+            auto expected_value = (expected);                                                                          \
+            if (!(actual_value == expected_value)) {                                                                   \
+                msolap_test::Fail(__FILE__, __LINE__, std::string(#actual " is ") +                                    \
+                                                          msolap_test::Describe(actual_value) + ", expected " +        \
+                                                          msolap_test::Describe(expected_value));                      \
+            }                                                                                                          \
+        } catch (std::exception & e) {                                                                                 \
+            msolap_test::Fail(__FILE__, __LINE__, std::string("unexpected error in " #actual ": ") + e.what());        \
+        }                                                                                                              \
+    } while (0)
+
+// The statement has to throw an exception whose message contains message
+#define MSOLAP_CHECK_THROWS(statement, message)                                                                        \
+    do {                                                                                                               \
+        try {                                                                                                          \
+            statement;                                                                                                 \
+            msolap_test::Fail(__FILE__, __LINE__, "no error from " #statement);                                        \
+        } catch (std::exception & e) {                                                                                 \
+            if (std::string(e.what()).find(message) == std::string::npos) {                                            \
+                msolap_test::Fail(__FILE__, __LINE__,                                                                  \
+                                  std::string("unexpected error from " #statement ": ") + e.what());                   \
+            }                                                                                                          \
+        }                                                                                                              \
+    } while (0)
@@ -0,0 +1,1248 @@
+#!/usr/bin/env python3
+"""Stand-in XMLA endpoint for testing the msolap extension without Analysis Services.
+
+Serves XMLA Execute requests (SOAP over HTTP, like msmdpump.dll) against a small
+in-memory model and evaluates the subset of DAX used by the tests.
+
+    python3 test/xmla_server.py --port 8765
+    export MSOLAP_XMLA_CONNECTION_STRING="Data Source=http://localhost:8765/xmla;Catalog=Stub"
+"""
+
+import argparse
+import datetime
+import decimal
+import re
+import struct
+import sys
+import threading
+import time
+import xml.parsers.expat
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from xml.sax.saxutils import escape
+
+XMLA_NS = "urn:schemas-microsoft-com:xml-analysis"
+ROWSET_NS = "urn:schemas-microsoft-com:xml-analysis:rowset"
+
+# ---------------------------------------------------------------------------
+# Model
+# ---------------------------------------------------------------------------
+
+
+class Column:
+    def __init__(self, name, xsd_type, data_type=None):
+        # name is the DAX column reference as reported by the server, e.g. "Sales[Year]" or "[Total]"
+        self.name = name
+        self.xsd_type = xsd_type
+        # TMSCHEMA_COLUMNS data type, if not the one of xsd_type
+        self.data_type = data_type
+
+    @property
+    def local_name(self):
+        return self.name[self.name.index("[") + 1 : -1] if "[" in self.name else self.name
+
+    @property
+    def table_name(self):
+        return self.name[: self.name.index("[")] if "[" in self.name else ""
+
+
+class Table:
+    def __init__(self, columns, rows):
+        self.columns = columns
+        self.rows = rows
+
+    def index_of(self, reference):
+        """Resolve a column reference ("Table[Col]", "'Table'[Col]" or "[Col]") to a column index"""
+        table, _, local = reference.partition("[")
+        table = table.strip("'")
+        local = local.rstrip("]")
+        for i, column in enumerate(self.columns):
+            if column.local_name.lower() == local.lower() and (not table or column.table_name.lower() == table.lower()):
+                return i
+        for i, column in enumerate(self.columns):
+            if column.local_name.lower() == local.lower():
+                return i
+        raise DAXError("Column '%s' cannot be found" % reference)
+
+
+# TMSCHEMA_COLUMNS data types of the XSD types used by the model
+TMSCHEMA_DATA_TYPES = {
+    "xsd:string": 2,
+    "xsd:long": 6,
+    "xsd:double": 8,
+    "xsd:dateTime": 9,
+    "xsd:decimal": 10,
+    "xsd:boolean": 11,
+    "xsd:base64Binary": 17,
+    # Variant
+    "xsd:anyType": 20,
+}
+
+
+def build_model():
+    colors = ["Red", "Blue", "Black", "Silver", "Yellow"]
+    sales_rows = []
+    for key in range(1, 10001):
+        sales_rows.append(
+            (
+                key,
+                2020 + key % 5,
+                colors[key % len(colors)],
+                round(key * 1.25, 4),
+                key % 7 + 1,
+                datetime.datetime(2020, 1, 1) + datetime.timedelta(days=key % 1500, hours=key % 24),
+                key % 100 + 1,
+            )
+        )
+    sales = Table(
+        [
+            Column("Sales[SalesKey]", "xsd:long"),
+            Column("Sales[Year]", "xsd:long"),
+            Column("Sales[Color]", "xsd:string"),
+            Column("Sales[Amount]", "xsd:double"),
+            Column("Sales[Quantity]", "xsd:long"),
+            Column("Sales[OrderDate]", "xsd:dateTime"),
+            Column("Sales[CustomerKey]", "xsd:long"),
+        ],
+        sales_rows,
+    )
+    customer_rows = [(key, "Customer %d" % key, ["DE", "US", "NL"][key % 3]) for key in range(1, 101)]
+    customer = Table(
+        [
+            Column("Customer[CustomerKey]", "xsd:long"),
+            Column("Customer[Name]", "xsd:string"),
+            Column("Customer[Country]", "xsd:string"),
+        ],
+        customer_rows,
+    )
+    # Size and Weight are Variant columns. Queries report Size, of mixed values, untyped and Weight as the type of
+    # its values, like Analysis Services does. Thumbnail is a Binary column, returned as base64 text.
+    product = Table(
+        [
+            Column("Product[ProductKey]", "xsd:long"),
+            Column("Product[Size]", "xsd:anyType"),
+            Column("Product[Weight]", "xsd:double", data_type=TMSCHEMA_DATA_TYPES["xsd:anyType"]),
+            Column("Product[Thumbnail]", "xsd:base64Binary"),
+        ],
+        [(1, 42, 0.25, "AAEC"), (2, "XL", 1.5, "AwQF"), (3, None, 2.0, None)],
+    )
+    return {"sales": sales, "customer": customer, "product": product}
+
+
+MODEL = build_model()
+
+# When the model was last processed, as reported by $SYSTEM.MDSCHEMA_CUBES. Evaluating the StubRefresh table moves
+# it forward, which is all a refresh changes for the tests.
+LAST_DATA_UPDATE = [datetime.datetime(2024, 3, 1, 12, 0, 0)]
+
+# Type of the column of the Retyped table, outside the model. Evaluating the StubRetype table switches it between
+# xsd:long and xsd:string, as a model change in between two queries would, and moves LAST_DATA_UPDATE forward.
+RETYPED_TYPE = ["xsd:long"]
+
+
+def retyped_table():
+    values = [1, 2, 3] if RETYPED_TYPE[0] == "xsd:long" else ["1", "2", "3"]
+    return Table(
+        [Column("Retyped[Key]", "xsd:long"), Column("Retyped[Value]", RETYPED_TYPE[0])],
+        [(key, value) for key, value in zip([1, 2, 3], values)],
+    )
+
+
+# ---------------------------------------------------------------------------
+# DAX subset
+# ---------------------------------------------------------------------------
+
+
+class DAXError(Exception):
+    pass
+
+
+TOKEN_RE = re.compile(
+    r"""\s*(?:
+        (?P<comment>//[^\n]*|--[^\n]*)
+      | (?P<string>"(?:[^"]|"")*")
+      | (?P<number>\d+(?:\.\d+)?)
+      | (?P<column>(?:'(?:[^']|'')+'|[A-Za-z_][A-Za-z0-9_]*)?\[[^\]]*\])
+      | (?P<table>'(?:[^']|'')+')
+      | (?P<name>[A-Za-z_][A-Za-z0-9_.]*)
+      | (?P<op><=|>=|<>|==|&&|\|\||[-+*/(),{}=<>&])
+    )""",
+    re.VERBOSE,
+)
+
+
+def tokenize(text):
+    tokens = []
+    pos = 0
+    text = text.rstrip()
+    while pos < len(text):
+        match = TOKEN_RE.match(text, pos)
+        if not match or match.end() == pos:
+            raise DAXError("Syntax error near: %s" % text[pos : pos + 20])
+        pos = match.end()
+        kind = match.lastgroup
+        if kind == "comment":
+            continue
+        tokens.append((kind, match.group(kind)))
+    return tokens
+
+
+class Parser:
+    def __init__(self, text):
+        self.tokens = tokenize(text)
+        self.pos = 0
+
+    def peek(self, offset=0):
+        if self.pos + offset < len(self.tokens):
+            return self.tokens[self.pos + offset]
+        return (None, None)
+
+    def next(self):
+        token = self.peek()
+        self.pos += 1
+        return token
+
+    def accept(self, value):
+        kind, text = self.peek()
+        if text is not None and text.upper() == value.upper() and kind in ("op", "name"):
+            self.pos += 1
+            return True
+        return False
+
+    def expect(self, value):
+        if not self.accept(value):
+            raise DAXError("Expected %s but found %s" % (value, self.peek()[1]))
+
+    def at_end(self):
+        return self.pos >= len(self.tokens)
+
+    # expression grammar, lowest precedence first
+    def expression(self):
+        return self.or_expression()
+
+    def or_expression(self):
+        left = self.and_expression()
+        while self.accept("||"):
+            left = ("or", left, self.and_expression())
+        return left
+
+    def and_expression(self):
+        left = self.comparison()
+        while self.accept("&&"):
+            left = ("and", left, self.comparison())
+        return left
+
+    def comparison(self):
+        left = self.concat()
+        for op in ("<=", ">=", "<>", "==", "=", "<", ">"):
+            if self.accept(op):
+                return ("compare", op, left, self.concat())
+        if self.accept("IN"):
+            return ("in", left, self.primary())
+        return left
+
+    def concat(self):
+        left = self.additive()
+        while self.accept("&"):
+            left = ("concat", left, self.additive())
+        return left
+
+    def additive(self):
+        left = self.term()
+        while True:
+            if self.accept("+"):
+                left = ("arith", "+", left, self.term())
+            elif self.accept("-"):
+                left = ("arith", "-", left, self.term())
+            else:
+                return left
+
+    def term(self):
+        left = self.unary()
+        while True:
+            if self.accept("*"):
+                left = ("arith", "*", left, self.unary())
+            elif self.accept("/"):
+                left = ("arith", "/", left, self.unary())
+            else:
+                return left
+
+    def unary(self):
+        if self.accept("-"):
+            return ("neg", self.unary())
+        if self.accept("NOT"):
+            return ("not", self.unary())
+        return self.primary()
+
+    def primary(self):
+        kind, text = self.next()
+        if kind == "number":
+            # No exponents, like DAX
+            return ("const", float(text) if "." in text else int(text))
+        if kind == "string":
+            return ("const", text[1:-1].replace('""', '"'))
+        if kind == "column":
+            return ("column", text)
+        if kind == "table":
+            return ("table", text[1:-1].replace("''", "'"))
+        if text == "(":
+            inner = self.expression()
+            self.expect(")")
+            return inner
+        if text == "{":
+            rows = []
+            if not self.accept("}"):
+                while True:
+                    if self.peek()[1] in ("(", "{"):
+                        closing = ")" if self.next()[1] == "(" else "}"
+                        row = [self.expression()]
+                        while self.accept(","):
+                            row.append(self.expression())
+                        self.expect(closing)
+                    else:
+                        row = [self.expression()]
+                    rows.append(row)
+                    if self.accept("}"):
+                        break
+                    self.expect(",")
+            return ("constructor", rows)
+        if kind == "name":
+            upper = text.upper()
+            if upper in ("ASC", "DESC"):
+                return ("order", upper)
+            if self.accept("("):
+                args = []
+                if not self.accept(")"):
+                    while True:
+                        args.append(self.expression())
+                        if self.accept(")"):
+                            break
+                        self.expect(",")
+                return ("call", upper, args)
+            if upper in ("TRUE", "FALSE"):
+                return ("const", upper == "TRUE")
+            if upper in ("INTEGER", "STRING", "DOUBLE", "BOOLEAN", "DATETIME", "CURRENCY"):
+                return ("typename", upper)
+            return ("table", text)
+        raise DAXError("Unexpected token %s" % text)
+
+
+def parse_query(text):
+    """Parse "EVALUATE <table> [ORDER BY ...]" into (table expression, order by list)"""
+    parser = Parser(text)
+    parser.expect("EVALUATE")
+    table = parser.expression()
+    order_by = []
+    if parser.accept("ORDER"):
+        parser.expect("BY")
+        while True:
+            expression = parser.expression()
+            descending = False
+            if parser.accept("DESC"):
+                descending = True
+            else:
+                parser.accept("ASC")
+            order_by.append((expression, descending))
+            if not parser.accept(","):
+                break
+    if not parser.at_end():
+        raise DAXError("Unexpected token %s" % parser.peek()[1])
+    return table, order_by
+
+
+def xsd_type_of(value):
+    if isinstance(value, bool):
+        return "xsd:boolean"
+    if isinstance(value, int):
+        return "xsd:long"
+    if isinstance(value, float):
+        return "xsd:double"
+    if isinstance(value, datetime.datetime):
+        return "xsd:dateTime"
+    return "xsd:string"
+
+
+DATATABLE_TYPES = {
+    "INTEGER": "xsd:long",
+    "STRING": "xsd:string",
+    "DOUBLE": "xsd:double",
+    "BOOLEAN": "xsd:boolean",
+    "DATETIME": "xsd:dateTime",
+    "CURRENCY": "xsd:decimal",
+}
+
+
+def blank_as(value, other):
+    """BLANK converted to the zero value of the type it is compared with"""
+    if value is not None:
+        return value
+    if isinstance(other, str):
+        return ""
+    if isinstance(other, bool):
+        return False
+    if isinstance(other, datetime.datetime):
+        return datetime.datetime(1899, 12, 30)
+    return 0
+
+
+def compare(op, left, right):
+    """DAX comparison: BLANK equals the zero value of the other side, except for the strict == operator"""
+    if op == "==":
+        if left is None or right is None:
+            return left is None and right is None
+        op = "="
+    else:
+        left, right = blank_as(left, right), blank_as(right, left)
+    if isinstance(left, str) and isinstance(right, str):
+        # Text comparisons are case insensitive
+        left, right = left.lower(), right.lower()
+    if op == "=":
+        return left == right
+    if op == "<>":
+        return left != right
+    if op == "<":
+        return left < right
+    if op == "<=":
+        return left <= right
+    if op == ">":
+        return left > right
+    return left >= right
+
+
+def model_table_of(reference):
+    """Model table of a column reference such as 'Sales'[Year]"""
+    name = reference[: reference.index("[")].strip("'").lower()
+    if name not in MODEL:
+        raise DAXError("Column '%s' is not a model column" % reference)
+    return MODEL[name]
+
+
+class Evaluator:
+    def __init__(self, log):
+        self.log = log
+        # Rows of the model table visible to aggregations (filter context), None for all rows
+        self.filter_rows = None
+        # Row contexts of the tables being iterated around the current one, innermost last
+        self.outer_rows = []
+
+    def table(self, node):
+        kind = node[0]
+        if kind == "table":
+            name = node[1].lower()
+            if name == "stubquerylog":
+                return self.log.as_table()
+            if name == "stubrefresh":
+                LAST_DATA_UPDATE[0] += datetime.timedelta(seconds=1)
+                return Table([Column("[LastDataUpdate]", "xsd:dateTime")], [(LAST_DATA_UPDATE[0],)])
+            if name == "retyped":
+                return retyped_table()
+            if name == "stubretype":
+                RETYPED_TYPE[0] = "xsd:string" if RETYPED_TYPE[0] == "xsd:long" else "xsd:long"
+                LAST_DATA_UPDATE[0] += datetime.timedelta(seconds=1)
+                return Table([Column("[Type]", "xsd:string")], [(RETYPED_TYPE[0],)])
+            if name not in MODEL:
+                raise DAXError("Table '%s' cannot be found" % node[1])
+            return MODEL[name]
+        if kind == "call":
+            handler = getattr(self, "table_" + node[1].lower(), None)
+            if handler is None:
+                raise DAXError("Function %s is not supported by the stub" % node[1])
+            return handler(*node[2])
+        raise DAXError("Table expression expected")
+
+    def table_filter(self, table, predicate):
+        source = self.table(table)
+        return Table(source.columns, [row for row in source.rows if self.scalar(predicate, (source, row))])
+
+    def table_generate(self, table, expression):
+        # The rows of expression evaluated in the row context of every row of table, appended to it
+        source = self.table(table)
+        columns = None
+        rows = []
+        # A row of BLANKs gives the columns of an empty result
+        for row in source.rows or [tuple(None for _ in source.columns)]:
+            self.outer_rows.append((source, row))
+            try:
+                inner = self.table(expression)
+            finally:
+                self.outer_rows.pop()
+            if columns is None or (not rows and inner.rows):
+                columns = source.columns + inner.columns
+            if source.rows:
+                rows.extend(row + inner_row for inner_row in inner.rows)
+        return Table(columns, rows)
+
+    def table_calculatetable(self, table, *filters):
+        # CALCULATETABLE(<table>, <filter>...) with TREATAS lists and predicates on the columns of the table
+        source = self.table(table)
+        rows = source.rows
+        for filter_node in filters:
+            if filter_node[0] == "call" and filter_node[1] == "KEEPFILTERS":
+                filter_node = filter_node[2][0]
+            if filter_node[0] == "call" and filter_node[1] == "TREATAS":
+                values, column = filter_node[2]
+                index = source.index_of(column[1])
+                allowed = [self.scalar(value[0], None) for value in values[1]]
+                # Values match as in a filter context: BLANK only matches BLANK, text case insensitively
+                rows = [
+                    row
+                    for row in rows
+                    if row[index] is not None and any(compare("=", row[index], value) for value in allowed)
+                ]
+            else:
+                rows = [row for row in rows if self.scalar(filter_node, (source, row))]
+        return Table(source.columns, rows)
+
+    def table_selectcolumns(self, table, *args):
+        source = self.table(table)
+        names = [self.scalar(args[i], None) for i in range(0, len(args), 2)]
+        expressions = [args[i + 1] for i in range(0, len(args), 2)]
+        rows = [tuple(self.scalar(expression, (source, row)) for expression in expressions) for row in source.rows]
+        columns = []
+        for i, (name, expression) in enumerate(zip(names, expressions)):
+            if expression[0] == "column":
+                # Column references keep the type of the column
+                xsd_type = source.columns[source.index_of(expression[1])].xsd_type
+            else:
+                values = [row[i] for row in rows if row[i] is not None]
+                xsd_type = xsd_type_of(values[0]) if values else "xsd:string"
+            columns.append(Column("[%s]" % name, xsd_type))
+        return Table(columns, rows)
+
+    def table_topn(self, count, table, *args):
+        # TOPN(<count>, <table>[, <expression>, ASC|DESC]...), rows tied with the last one are returned as well
+        source = self.table(table)
+        count = self.scalar(count, None)
+        order_by = [(args[i], args[i + 1] == ("order", "DESC")) for i in range(0, len(args), 2)]
+        if not order_by:
+            return Table(source.columns, source.rows[:count])
+        rows = sort_rows(self, source, source.rows, order_by)
+        if len(rows) <= count:
+            return Table(source.columns, rows)
+        last = [self.scalar(expression, (source, rows[count - 1])) for expression, _ in order_by]
+        end = count
+        while end < len(rows) and [self.scalar(expression, (source, rows[end])) for expression, _ in order_by] == last:
+            end += 1
+        return Table(source.columns, rows[:end])
+
+    def table_summarizecolumns(self, *args):
+        # SUMMARIZECOLUMNS(<group column>..., <filter table>..., <name>, <expression>...) over a single model table
+        groups = [arg for arg in args if arg[0] == "column"]
+        filters = [arg for arg in args[len(groups) :] if arg[0] in ("table", "call") and not self.is_scalar(arg)]
+        measures = args[len(groups) + len(filters) :]
+        source = model_table_of(groups[0][1])
+        rows = source.rows
+        for filter_table in filters:
+            visible = set(self.table(filter_table).rows)
+            rows = [row for row in rows if row in visible]
+        indexes = [source.index_of(group[1]) for group in groups]
+        grouped = {}
+        for row in rows:
+            grouped.setdefault(tuple(row[i] for i in indexes), []).append(row)
+        names = [self.scalar(measures[i], None) for i in range(0, len(measures), 2)]
+        result = []
+        for key, group_rows in grouped.items():
+            values = [self.aggregate(measures[i + 1], group_rows) for i in range(0, len(measures), 2)]
+            # Groups where every measure is BLANK are left out
+            if not values or any(value is not None for value in values):
+                result.append(key + tuple(values))
+        columns = [source.columns[i] for i in indexes]
+        for i, name in enumerate(names):
+            values = [row[len(indexes) + i] for row in result if row[len(indexes) + i] is not None]
+            columns.append(Column("[%s]" % name, xsd_type_of(values[0]) if values else "xsd:string"))
+        return Table(columns, result)
+
+    def is_scalar(self, node):
+        return node[0] == "call" and hasattr(self, "scalar_" + node[1].lower())
+
+    def aggregate(self, expression, rows):
+        """Evaluate a measure with only the given rows of the model table visible"""
+        previous = self.filter_rows
+        self.filter_rows = rows
+        try:
+            return self.scalar(expression, None)
+        finally:
+            self.filter_rows = previous
+
+    def visible_values(self, reference):
+        source = model_table_of(reference[1])
+        rows = source.rows if self.filter_rows is None else self.filter_rows
+        index = source.index_of(reference[1])
+        return [row[index] for row in rows]
+
+    def table_datatable(self, *args):
+        columns = []
+        i = 0
+        while i + 1 < len(args) and args[i + 1][0] == "typename":
+            columns.append(Column("[%s]" % self.scalar(args[i], None), DATATABLE_TYPES[args[i + 1][1]]))
+            i += 2
+        rows = []
+        for row in args[i][1]:
+            values = []
+            for column, value in zip(columns, row):
+                value = self.scalar(value, None)
+                if column.xsd_type == "xsd:dateTime" and isinstance(value, str):
+                    value = datetime.datetime.fromisoformat(value)
+                values.append(value)
+            rows.append(tuple(values))
+        return Table(columns, rows)
+
+    def table_row(self, *args):
+        columns = []
+        values = []
+        for i in range(0, len(args), 2):
+            value = self.scalar(args[i + 1], None)
+            columns.append(Column("[%s]" % self.scalar(args[i], None), xsd_type_of(value)))
+            values.append(value)
+        return Table(columns, [tuple(values)])
+
+    def table_generateseries(self, start, end, step=("const", 1)):
+        first, last, increment = self.scalar(start, None), self.scalar(end, None), self.scalar(step, None)
+        rows = []
+        value = first
+        while value <= last:
+            rows.append((value,))
+            value += increment
+        return Table([Column("[Value]", xsd_type_of(first))], rows)
+
+    def scalar(self, node, row_context):
+        kind = node[0]
+        if kind == "const":
+            return node[1]
+        if kind == "column":
+            # Resolved in the innermost row context that has the column, like DAX
+            contexts = ([row_context] if row_context else []) + self.outer_rows[::-1]
+            for table, row in contexts:
+                try:
+                    index = table.index_of(node[1])
+                except DAXError:
+                    continue
+                return row[index]
+            raise DAXError("Column '%s' cannot be found" % node[1])
+        if kind == "neg":
+            return -self.scalar(node[1], row_context)
+        if kind == "arith":
+            left = self.scalar(node[2], row_context)
+            right = self.scalar(node[3], row_context)
+            left = 0 if left is None else left
+            right = 0 if right is None else right
+            if node[1] == "+":
+                return left + right
+            if node[1] == "-":
+                return left - right
+            if node[1] == "*":
+                return left * right
+            return left / right if right else None
+        if kind == "compare":
+            return compare(node[1], self.scalar(node[2], row_context), self.scalar(node[3], row_context))
+        if kind == "and":
+            return bool(self.scalar(node[1], row_context)) and bool(self.scalar(node[2], row_context))
+        if kind == "or":
+            return bool(self.scalar(node[1], row_context)) or bool(self.scalar(node[2], row_context))
+        if kind == "not":
+            return not self.scalar(node[1], row_context)
+        if kind == "in":
+            value = self.scalar(node[1], row_context)
+            return any(compare("==", value, self.scalar(row[0], row_context)) for row in node[2][1])
+        if kind == "concat":
+            return "%s%s" % (self.scalar(node[1], row_context) or "", self.scalar(node[2], row_context) or "")
+        if kind == "call":
+            handler = getattr(self, "scalar_" + node[1].lower(), None)
+            if handler is None:
+                raise DAXError("Function %s is not supported by the stub" % node[1])
+            return handler(row_context, *node[2])
+        raise DAXError("Scalar expression expected")
+
+    def scalar_blank(self, row_context):
+        return None
+
+    def scalar_true(self, row_context):
+        return True
+
+    def scalar_false(self, row_context):
+        return False
+
+    def scalar_isblank(self, row_context, value):
+        return self.scalar(value, row_context) is None
+
+    def scalar_time(self, row_context, hour, minute, second):
+        # Added to a DATE() to form a datetime
+        return datetime.timedelta(
+            hours=self.scalar(hour, row_context),
+            minutes=self.scalar(minute, row_context),
+            seconds=self.scalar(second, row_context),
+        )
+
+    def scalar_mod(self, row_context, number, divisor):
+        # Like DAX, the result has the sign of the divisor
+        return (self.scalar(number, row_context) or 0) % self.scalar(divisor, row_context)
+
+    def scalar_rept(self, row_context, text, count):
+        return (self.scalar(text, row_context) or "") * self.scalar(count, row_context)
+
+    def scalar_calculate(self, row_context, expression, *filters):
+        rows = None
+        for filter_table in filters:
+            visible = self.table(filter_table).rows
+            rows = visible if rows is None else [row for row in rows if row in set(visible)]
+        return self.aggregate(expression, rows)
+
+    def scalar_countrows(self, row_context, table):
+        rows = self.table(table).rows if self.filter_rows is None else self.filter_rows
+        return len(rows) or None
+
+    def scalar_counta(self, row_context, column):
+        return len([value for value in self.visible_values(column) if value is not None]) or None
+
+    def scalar_distinctcount(self, row_context, column):
+        # BLANK counts as a value
+        return len(set(self.visible_values(column))) or None
+
+    def scalar_distinctcountnoblank(self, row_context, column):
+        return len(set(value for value in self.visible_values(column) if value is not None)) or None
+
+    def scalar_sum(self, row_context, column):
+        values = [value for value in self.visible_values(column) if value is not None]
+        return sum(values) if values else None
+
+    def scalar_min(self, row_context, column):
+        values = [value for value in self.visible_values(column) if value is not None]
+        return min(values) if values else None
+
+    def scalar_max(self, row_context, column):
+        values = [value for value in self.visible_values(column) if value is not None]
+        return max(values) if values else None
+
+    def scalar_exact(self, row_context, left, right):
+        # Case-sensitive, BLANK is an empty string
+        return (self.scalar(left, row_context) or "") == (self.scalar(right, row_context) or "")
+
+    def scalar_date(self, row_context, year, month, day):
+        return datetime.datetime(
+            self.scalar(year, row_context), self.scalar(month, row_context), self.scalar(day, row_context)
+        )
+
+
+class QueryLog:
+    """Statements received by the server, exposed to the tests as the StubQueryLog table"""
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.entries = []
+
+    def add(self, statement, content):
+        with self.lock:
+            self.entries.append((len(self.entries) + 1, statement, content))
+
+    def as_table(self):
+        with self.lock:
+            rows = list(self.entries)
+        return Table(
+            [Column("[Id]", "xsd:long"), Column("[Statement]", "xsd:string"), Column("[Content]", "xsd:string")], rows
+        )
+
+
+def sort_rows(evaluator, table, rows, order_by):
+    """Rows sorted on a list of (expression, descending), BLANK sorts before any value"""
+    rows = list(rows)
+    for expression, descending in reversed(order_by):
+        rows.sort(
+            key=lambda row: (evaluator.scalar(expression, (table, row)) is not None, evaluator.scalar(expression, (table, row))),
+            reverse=descending,
+        )
+    return rows
+
+
+DMV_QUERY = re.compile(
+    r"^\s*SELECT\s+(.+?)\s+FROM\s+\$SYSTEM\.(\w+)(?:\s+WHERE\s+\[?(\w+)\]?\s*=\s*'((?:[^']|'')*)')?\s*$",
+    re.IGNORECASE | re.DOTALL,
+)
+
+
+def storage_ids(table_id, table):
+    """VertiPaq storage table ID of a model table and column IDs of its columns, as DISCOVER_STORAGE_TABLES has them"""
+    name = table.columns[0].table_name
+    column_ids = ["%s (%d)" % (column.local_name, table_id * 100 + index + 1) for index, column in enumerate(table.columns)]
+    return "%s (%d)" % (name, table_id), column_ids
+
+
+def schema_rowset(rowset):
+    """Schema rowsets known to the stub, describing MODEL like Analysis Services does"""
+    rowset = rowset.upper()
+    if rowset == "MDSCHEMA_CUBES":
+        return Table(
+            [Column("CUBE_NAME", "xsd:string"), Column("LAST_DATA_UPDATE", "xsd:dateTime")],
+            [("Model", LAST_DATA_UPDATE[0])],
+        )
+    if rowset == "DISCOVER_STORAGE_TABLES":
+        # The table, holding its row count, and the attribute hierarchy of every column, holding three rows more
+        # than the column has distinct values
+        rows = []
+        for table_id, table in enumerate(MODEL.values(), 1):
+            name = table.columns[0].table_name
+            storage_id, column_ids = storage_ids(table_id, table)
+            rows.append((name, storage_id, len(table.rows)))
+            for index, column_id in enumerate(column_ids):
+                distinct = len(set(row[index] for row in table.rows))
+                rows.append((name, "H$%s$%s" % (storage_id, column_id), distinct + 3))
+        return Table(
+            [Column("DIMENSION_NAME", "xsd:string"), Column("TABLE_ID", "xsd:string"), Column("ROWS_COUNT", "xsd:long")],
+            rows,
+        )
+    if rowset == "DISCOVER_STORAGE_TABLE_COLUMNS":
+        # The data column of every column, and the columns of its attribute hierarchy
+        rows = []
+        for table_id, table in enumerate(MODEL.values(), 1):
+            name = table.columns[0].table_name
+            storage_id, column_ids = storage_ids(table_id, table)
+            for column, column_id in zip(table.columns, column_ids):
+                rows.append((name, column.local_name, storage_id, column_id, "BASIC_DATA"))
+                rows.append((name, column.local_name, "H$%s$%s" % (storage_id, column_id), "POS_TO_ID", "HIERARCHY"))
+        return Table(
+            [
+                Column("DIMENSION_NAME", "xsd:string"),
+                Column("ATTRIBUTE_NAME", "xsd:string"),
+                Column("TABLE_ID", "xsd:string"),
+                Column("COLUMN_ID", "xsd:string"),
+                Column("COLUMN_TYPE", "xsd:string"),
+            ],
+            rows,
+        )
+    if rowset == "TMSCHEMA_TABLES":
+        rows = [(table_id, table.columns[0].table_name) for table_id, table in enumerate(MODEL.values(), 1)]
+        return Table([Column("ID", "xsd:unsignedLong"), Column("Name", "xsd:string")], rows)
+    if rowset == "TMSCHEMA_COLUMNS":
+        rows = []
+        for table_id, table in enumerate(MODEL.values(), 1):
+            # Every table has a hidden row number column (Type 3) first, listed after the data columns (Type 1).
+            # The IDs of the Customer columns run backwards, as for columns removed and added again: the order of
+            # the IDs is not the order EVALUATE 'Customer' returns them in.
+            for index, column in enumerate(table.columns):
+                position = len(table.columns) - index if column.table_name == "Customer" else index + 1
+                column_id = table_id * 100 + position
+                data_type = column.data_type or TMSCHEMA_DATA_TYPES[column.xsd_type]
+                rows.append((column_id, table_id, column.local_name, None, data_type, 19, 1))
+            rows.append((table_id * 100, table_id, "RowNumber-2662979B-1795-4F74-8F37-6A1BA8059B61", None, 6, 19, 3))
+        return Table(
+            [
+                Column("ID", "xsd:unsignedLong"),
+                Column("TableID", "xsd:unsignedLong"),
+                Column("ExplicitName", "xsd:string"),
+                Column("InferredName", "xsd:string"),
+                Column("ExplicitDataType", "xsd:int"),
+                Column("InferredDataType", "xsd:int"),
+                Column("Type", "xsd:int"),
+            ],
+            rows,
+        )
+    raise DAXError("Schema rowset $SYSTEM.%s is not supported by the stub" % rowset)
+
+
+def evaluate_dmv(columns, rowset, restricted_column=None, restriction=None):
+    """SELECT [Column], ... FROM $SYSTEM.<rowset> [WHERE [Column] = 'value']"""
+    table = schema_rowset(rowset)
+    if restricted_column:
+        index = table.index_of("[%s]" % restricted_column)
+        value = restriction.replace("''", "'")
+        table = Table(table.columns, [row for row in table.rows if str(row[index]).lower() == value.lower()])
+    if columns.strip() == "*":
+        return table
+    indexes = [table.index_of(name.strip()) for name in columns.split(",")]
+    return Table([table.columns[i] for i in indexes], [tuple(row[i] for i in indexes) for row in table.rows])
+
+
+def discover(request_type, property_name):
+    """DISCOVER_PROPERTIES, optionally restricted to one property, the only Discover request of the stub"""
+    if request_type != "DISCOVER_PROPERTIES":
+        raise DAXError("Discover request %s is not supported by the stub" % request_type)
+    properties = [("Catalog", "Stub"), ("Format", "Tabular"), ("Content", "SchemaData")]
+    return Table(
+        [Column("PropertyName", "xsd:string"), Column("Value", "xsd:string")],
+        [row for row in properties if property_name is None or row[0] == property_name],
+    )
+
+
+def evaluate(statement, log):
+    dmv = DMV_QUERY.match(statement)
+    if dmv:
+        return evaluate_dmv(dmv.group(1), dmv.group(2), dmv.group(3), dmv.group(4))
+    table_node, order_by = parse_query(statement)
+    evaluator = Evaluator(log)
+    table = evaluator.table(table_node)
+    return Table(table.columns, sort_rows(evaluator, table, table.rows, order_by))
+
+
+# ---------------------------------------------------------------------------
+# XMLA
+# ---------------------------------------------------------------------------
+
+
+def encode_name(name):
+    """XmlConvert.EncodeLocalName as used by Analysis Services for rowset element names"""
+    result = []
+    for i, char in enumerate(name):
+        if char.isalnum() and char.isascii() or char == "_" and not name[i + 1 : i + 2] == "x" or (char in "-." and i > 0):
+            result.append(char)
+        elif ord(char) > 0xFFFF:
+            result.append("_x%08X_" % ord(char))
+        else:
+            result.append("_x%04X_" % ord(char))
+    return "".join(result)
+
+
+def format_value(value):
+    if isinstance(value, bool):
+        return "true" if value else "false"
+    if isinstance(value, datetime.datetime):
+        return value.strftime("%Y-%m-%dT%H:%M:%S")
+    if isinstance(value, float):
+        return repr(value)
+    return escape(str(value))
+
+
+def rowset_response(table, content, response="ExecuteResponse"):
+    names = [encode_name(column.name) for column in table.columns]
+    out = []
+    out.append('<soap:Envelope xmlns:soap="http://schemas.xmlsoap.org/soap/envelope/"><soap:Body>')
+    out.append('<%s xmlns="%s"><return>' % (response, XMLA_NS))
+    out.append(
+        '<root xmlns="%s" xmlns:xsi="http://www.w3.org/2001/XMLSchema-instance" '
+        'xmlns:xsd="http://www.w3.org/2001/XMLSchema">' % ROWSET_NS
+    )
+    out.append(
+        '<xsd:schema targetNamespace="%s" xmlns:sql="urn:schemas-microsoft-com:xml-sql" '
+        'elementFormDefault="qualified">' % ROWSET_NS
+    )
+    out.append(
+        '<xsd:element name="root"><xsd:complexType><xsd:sequence minOccurs="0" maxOccurs="unbounded">'
+        '<xsd:element name="row" type="row"/></xsd:sequence></xsd:complexType></xsd:element>'
+    )
+    out.append('<xsd:complexType name="row"><xsd:sequence>')
+    for name, column in zip(names, table.columns):
+        out.append(
+            '<xsd:element sql:field="%s" name="%s" type="%s" minOccurs="0"/>'
+            % (escape(column.name, {'"': "&quot;"}), name, column.xsd_type)
+        )
+    out.append("</xsd:sequence></xsd:complexType></xsd:schema>")
+    yield "".join(out)
+    if content != "Schema":
+        batch = []
+        for row in table.rows:
+            cells = "".join(
+                "<%s>%s</%s>" % (name, format_value(value), name) for name, value in zip(names, row) if value is not None
+            )
+            batch.append("<row>%s</row>" % cells)
+            if len(batch) == 256:
+                yield "".join(batch)
+                batch = []
+        yield "".join(batch)
+    yield "</root></return></%s></soap:Body></soap:Envelope>" % response
+
+
+def fault_response(message):
+    yield (
+        '<soap:Envelope xmlns:soap="http://schemas.xmlsoap.org/soap/envelope/"><soap:Body><soap:Fault>'
+        "<faultcode>XMLAnalysisError</faultcode><faultstring>%s</faultstring>"
+        '<detail><Error ErrorCode="3238002695" Description="%s"/></detail>'
+        "</soap:Fault></soap:Body></soap:Envelope>" % (escape(message), escape(message, {'"': "&quot;"}))
+    )
+
+
+# ---------------------------------------------------------------------------
+# Binary XML and XPRESS response encodings
+# ---------------------------------------------------------------------------
+
+CONTENT_TYPE_XML = "text/xml"
+CONTENT_TYPE_BINARY = "application/sx"
+CONTENT_TYPE_XML_XPRESS = "application/xml+xpress"
+CONTENT_TYPE_BINARY_XPRESS = "application/sx+xpress"
+
+SQL_DATETIME_EPOCH = datetime.datetime(1900, 1, 1)
+
+
+def multi_byte(value):
+    """mb32 length: 7 bits per byte, least significant group first"""
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def text_data(text):
+    data = text.encode("utf-16-le")
+    return multi_byte(len(data) // 2) + data
+
+
+def binary_atom(text, xsd_type):
+    """Typed [MS-BINXML] atom for the lexical value of a rowset cell"""
+    if xsd_type in ("xsd:long", "xsd:integer"):
+        return b"\x08" + struct.pack("<q", int(text))
+    if xsd_type == "xsd:int":
+        return b"\x02" + struct.pack("<i", int(text))
+    if xsd_type == "xsd:double":
+        return b"\x04" + struct.pack("<d", float(text))
+    if xsd_type == "xsd:boolean":
+        return b"\x86" + (b"\x01" if text == "true" else b"\x00")
+    if xsd_type == "xsd:decimal":
+        # SQL-MONEY: 1/10000 units, high 32 bits first
+        value = int(decimal.Decimal(text) * 10000) & 0xFFFFFFFFFFFFFFFF
+        return b"\x05" + struct.pack("<II", value >> 32, value & 0xFFFFFFFF)
+    if xsd_type == "xsd:dateTime":
+        # SQL-DATETIME: days since 1900-01-01 and 1/300 second ticks
+        delta = datetime.datetime.strptime(text, "%Y-%m-%dT%H:%M:%S") - SQL_DATETIME_EPOCH
+        return b"\x12" + struct.pack("<iI", delta.days, delta.seconds * 300)
+    return b"\x11" + text_data(text)
+
+
+class BinaryXMLEncoder:
+    """Re-encodes a textual rowset response as SQL Server binary XML ([MS-BINXML]).
+
+    Rowset cells are sent as typed atoms according to the inline schema, like Analysis Services does.
+    """
+
+    def __init__(self):
+        self.parser = xml.parsers.expat.ParserCreate(namespace_separator=" ")
+        self.parser.StartElementHandler = self.start_element
+        self.parser.EndElementHandler = self.end_element
+        self.parser.CharacterDataHandler = self.character_data
+        self.out = bytearray(b"\xdf\xff\x01\xb0\x04")
+        self.names = {"": 0}
+        self.qualified_names = {}
+        self.column_types = {}
+        self.stack = []
+        self.text = []
+
+    def name_index(self, name):
+        if name not in self.names:
+            self.names[name] = len(self.names)
+            self.out += b"\xf0" + text_data(name)
+        return self.names[name]
+
+    def qualified_name(self, expat_name):
+        namespace, _, local = expat_name.rpartition(" ")
+        key = (namespace, local)
+        if key not in self.qualified_names:
+            namespace_index = self.name_index(namespace)
+            local_index = self.name_index(local)
+            self.qualified_names[key] = len(self.qualified_names) + 1
+            self.out += b"\xef" + multi_byte(namespace_index) + multi_byte(0) + multi_byte(local_index)
+        return self.qualified_names[key]
+
+    def flush_text(self):
+        text = "".join(self.text)
+        self.text = []
+        if not text:
+            return
+        cell_type = None
+        if len(self.stack) >= 2 and self.stack[-2] == "row":
+            cell_type = self.column_types.get(self.stack[-1])
+        self.out += binary_atom(text, cell_type)
+
+    def start_element(self, name, attributes):
+        self.flush_text()
+        local = name.rpartition(" ")[2]
+        if local == "element" and "name" in attributes and "type" in attributes:
+            self.column_types[attributes["name"]] = attributes["type"]
+        self.out += b"\xf8" + multi_byte(self.qualified_name(name))
+        for attribute, value in attributes.items():
+            self.out += b"\xf6" + multi_byte(self.qualified_name(attribute)) + b"\x11" + text_data(value)
+        if attributes:
+            self.out += b"\xf5"
+        self.stack.append(local)
+
+    def end_element(self, name):
+        self.flush_text()
+        self.out += b"\xf7"
+        self.stack.pop()
+
+    def character_data(self, data):
+        self.text.append(data)
+
+    def encode(self, text, final=False):
+        self.parser.Parse(text, final)
+        data = bytes(self.out)
+        self.out.clear()
+        return data
+
+
+XPRESS_BLOCK_SIZE = 65536
+
+
+def xpress_compress(data):
+    """Plain LZ77 compression of [MS-XCA], greedy matching over a 8KB window"""
+    out = bytearray(4)
+    flag_pos, flags, flag_count = 0, 0, 0
+    half_byte = None
+    last_seen = {}
+    i, n = 0, len(data)
+    while i < n:
+        if flag_count == 32:
+            out[flag_pos : flag_pos + 4] = struct.pack("<I", flags)
+            flag_pos = len(out)
+            out += bytes(4)
+            flags, flag_count = 0, 0
+        length = 0
+        if i + 3 <= n:
+            key = data[i : i + 3]
+            candidate = last_seen.get(key)
+            last_seen[key] = i
+            if candidate is not None and i - candidate <= 8192:
+                length = 3
+                while i + length < n and data[candidate + length] == data[i + length]:
+                    length += 1
+        if length == 0:
+            out.append(data[i])
+            flags <<= 1
+            i += 1
+        else:
+            offset = i - candidate
+            extra = length - 3
+            if extra < 7:
+                out += struct.pack("<H", ((offset - 1) << 3) | extra)
+            else:
+                out += struct.pack("<H", ((offset - 1) << 3) | 7)
+                extra -= 7
+                nibble = min(extra, 15)
+                # Two consecutive long matches share one byte for their length nibbles
+                if half_byte is None:
+                    half_byte = len(out)
+                    out.append(nibble)
+                else:
+                    out[half_byte] |= nibble << 4
+                    half_byte = None
+                if extra >= 15:
+                    extra -= 15
+                    if extra < 255:
+                        out.append(extra)
+                    elif length - 3 < 65536:
+                        out += b"\xff" + struct.pack("<H", length - 3)
+                    else:
+                        out += b"\xff" + struct.pack("<HI", 0, length - 3)
+            flags = (flags << 1) | 1
+            i += length
+        flag_count += 1
+    # Unused flag bits are set, the decoder stops once the block is complete
+    flags = (flags << (32 - flag_count)) | ((1 << (32 - flag_count)) - 1)
+    out[flag_pos : flag_pos + 4] = struct.pack("<I", flags & 0xFFFFFFFF)
+    return bytes(out)
+
+
+class XpressEncoder:
+    """Frames a byte stream as XPRESS blocks: uncompressed size, compressed size, payload"""
+
+    def __init__(self):
+        self.pending = bytearray()
+
+    def block(self, data):
+        compressed = xpress_compress(data)
+        if len(compressed) >= len(data):
+            return struct.pack("<II", len(data), len(data)) + data
+        return struct.pack("<II", len(data), len(compressed)) + compressed
+
+    def encode(self, data, final=False):
+        self.pending += data
+        out = bytearray()
+        while len(self.pending) >= XPRESS_BLOCK_SIZE or (final and self.pending):
+            out += self.block(bytes(self.pending[:XPRESS_BLOCK_SIZE]))
+            del self.pending[:XPRESS_BLOCK_SIZE]
+        return bytes(out)
+
+
+def negotiate_content_type(accept):
+    offered = [media_type.split(";")[0].strip().lower() for media_type in accept.split(",")]
+    for content_type in (CONTENT_TYPE_BINARY_XPRESS, CONTENT_TYPE_BINARY, CONTENT_TYPE_XML_XPRESS):
+        if content_type in offered:
+            return content_type
+    return CONTENT_TYPE_XML
+
+
+def encode_response(chunks, content_type):
+    """Encode the textual response chunks in the negotiated content type"""
+    binary = BinaryXMLEncoder() if content_type in (CONTENT_TYPE_BINARY, CONTENT_TYPE_BINARY_XPRESS) else None
+    compressor = XpressEncoder() if content_type in (CONTENT_TYPE_XML_XPRESS, CONTENT_TYPE_BINARY_XPRESS) else None
+    for chunk in chunks:
+        data = binary.encode(chunk) if binary else chunk.encode("utf-8")
+        yield compressor.encode(data) if compressor else data
+    if binary:
+        data = binary.encode("", True)
+        yield compressor.encode(data, True) if compressor else data
+    elif compressor:
+        yield compressor.encode(b"", True)
+
+
+def element_text(body, name):
+    match = re.search(r"<%s>(.*?)</%s>" % (name, name), body, re.S)
+    if not match:
+        return None
+    text = match.group(1)
+    return text.replace("&lt;", "<").replace("&gt;", ">").replace("&quot;", '"').replace("&apos;", "'").replace("&amp;", "&")
+
+
+class XMLAHandler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def log_message(self, format, *args):
+        if self.server.verbose:
+            sys.stderr.write(format % args + "\n")
+
+    def do_POST(self):
+        length = int(self.headers.get("Content-Length", 0))
+        body = self.rfile.read(length).decode("utf-8")
+        statement = element_text(body, "Statement") or ""
+        content = element_text(body, "Content") or "SchemaData"
+        request_type = element_text(body, "RequestType")
+        status = 200
+        content_type = negotiate_content_type(self.headers.get("Accept", CONTENT_TYPE_XML))
+        try:
+            if request_type:
+                # Discover requests are logged with their request type as statement
+                table = discover(request_type, element_text(body, "PropertyName"))
+                self.server.log.add(request_type, "Discover")
+                chunks = encode_response(rowset_response(table, "SchemaData", "DiscoverResponse"), content_type)
+            else:
+                table = evaluate(statement, self.server.log)
+                self.server.log.add(statement, content)
+                chunks = encode_response(rowset_response(table, content), content_type)
+        except DAXError as e:
+            # Faults are always sent as text
+            status = 500
+            content_type = CONTENT_TYPE_XML
+            chunks = encode_response(fault_response(str(e)), content_type)
+        self.send_response(status)
+        self.send_header("Content-Type", content_type)
+        self.send_header("Transfer-Encoding", "chunked")
+        self.end_headers()
+        try:
+            for data in chunks:
+                if data:
+                    if self.server.latency:
+                        # Like a remote server computing the result while it is sent
+                        time.sleep(self.server.latency / 1000.0)
+                    self.wfile.write(b"%x\r\n%s\r\n" % (len(data), data))
+            self.wfile.write(b"0\r\n\r\n")
+        except (BrokenPipeError, ConnectionResetError):
+            # The client stopped reading the result (e.g. LIMIT), like a cancelled query
+            self.close_connection = True
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", type=int, default=8765)
+    parser.add_argument("--verbose", action="store_true")
+    parser.add_argument("--latency", type=int, default=0, help="milliseconds to wait before each response chunk")
+    args = parser.parse_args()
+
+    server = ThreadingHTTPServer(("127.0.0.1", args.port), XMLAHandler)
+    server.log = QueryLog()
+    server.verbose = args.verbose
+    server.latency = args.latency
+    print("XMLA stand-in listening on http://127.0.0.1:%d/xmla" % args.port, flush=True)
+    server.serve_forever()
+
+
+if __name__ == "__main__":
+    main()